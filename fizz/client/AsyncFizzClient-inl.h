@@ -214,7 +214,7 @@ std::string AsyncFizzClientT<SM>::getApplicationProtocol() noexcept {
 
 template <typename SM>
 void AsyncFizzClientT<SM>::close() {
-  if (transport_->good()) {
+  if (good()) {
     fizzClient_.appClose();
   } else {
     DelayedDestruction::DestructorGuard dg(this);
@@ -228,7 +228,7 @@ void AsyncFizzClientT<SM>::close() {
 template <typename SM>
 void AsyncFizzClientT<SM>::closeWithReset() {
   DelayedDestruction::DestructorGuard dg(this);
-  if (transport_->good()) {
+  if (good()) {
     fizzClient_.appClose();
   }
   folly::AsyncSocketException ase(
@@ -240,7 +240,7 @@ void AsyncFizzClientT<SM>::closeWithReset() {
 template <typename SM>
 void AsyncFizzClientT<SM>::closeNow() {
   DelayedDestruction::DestructorGuard dg(this);
-  if (transport_->good()) {
+  if (good()) {
     fizzClient_.appClose();
   }
   folly::AsyncSocketException ase(
@@ -271,6 +271,105 @@ void AsyncFizzClientT<SM>::connectErr(
   deliverAllErrors(ex, false);
 }
 
+template <typename SM>
+bool AsyncFizzClientT<SM>::enableKTLSTx() {
+  if (ktlsTx_) {
+    return true;
+  }
+  if (state_.state() != StateEnum::Established || earlyDataState_ ||
+      fizzClient_.actionProcessing()) {
+    return false;
+  }
+  auto socket = transport_->getUnderlyingTransport<folly::AsyncSocket>();
+  if (!socket) {
+    return false;
+  }
+  ktlsTx_ = fizz::enableKTLSTx(
+      state_, *socket, AppTrafficSecrets::ClientAppTraffic);
+  return ktlsTx_ != nullptr;
+}
+
+template <typename SM>
+folly::Optional<KTLSCryptoParams> AsyncFizzClientT<SM>::getKTLSParams(
+    KTLSDirection direction) const {
+  if (state_.state() != StateEnum::Established) {
+    return folly::none;
+  }
+  return KTLS::getParams(
+      state_,
+      direction == KTLSDirection::Tx ? AppTrafficSecrets::ClientAppTraffic
+                                     : AppTrafficSecrets::ServerAppTraffic,
+      direction);
+}
+
+template <typename SM>
+Buf AsyncFizzClientT<SM>::exportConnectionState() {
+  if (state_.state() != StateEnum::Established ||
+      fizzClient_.actionProcessing()) {
+    throw std::runtime_error("connection not established");
+  }
+  if (ktlsTx_ || hasBufferedAppData()) {
+    throw std::runtime_error("connection state can't be exported");
+  }
+  auto exported = fizz::exportConnectionState(state_);
+  exported.sni = state_.sni();
+  exported.pskIdentity = pskIdentity_;
+  exported.peerCert = encodePeerCert(state_.serverCert());
+  if (state_.clientCert()) {
+    exported.selfCertIdentity = state_.clientCert()->getIdentity();
+  }
+  if (state_.resumptionSecret()) {
+    exported.resumptionSecret = (*state_.resumptionSecret())->clone();
+  }
+  if (!transportReadBuf_.empty()) {
+    exported.bufferedData = transportReadBuf_.front()->clone();
+  }
+  auto encoded = encodeConnectionState(exported);
+  transport_->setReadCB(nullptr);
+  retireExportedConnectionState(state_);
+  if (state_.resumptionSecret()) {
+    auto& secret = *state_.resumptionSecret();
+    secret->coalesce();
+    CryptoUtils::clean(
+        folly::MutableByteRange(secret->writableData(), secret->length()));
+    state_.resumptionSecret() = folly::none;
+  }
+  return encoded;
+}
+
+template <typename SM>
+void AsyncFizzClientT<SM>::importConnectionState(Buf encoded) {
+  auto exported = decodeConnectionState(std::move(encoded));
+  state_.context() = fizzContext_;
+  state_.extensions() = extensions_;
+  fizz::importConnectionState(
+      state_,
+      exported,
+      AppTrafficSecrets::ServerAppTraffic,
+      AppTrafficSecrets::ClientAppTraffic);
+  sni_ = exported.sni;
+  pskIdentity_ = exported.pskIdentity;
+  state_.sni() = std::move(exported.sni);
+  if (exported.peerCert) {
+    state_.serverCert() = CertUtils::makePeerCert(std::move(exported.peerCert));
+  }
+  if (!exported.selfCertIdentity.empty()) {
+    state_.clientCert() = fizzContext_->getClientCertificate();
+  }
+  if (exported.resumptionSecret) {
+    state_.resumptionSecret() = std::move(exported.resumptionSecret);
+  }
+  state_.state() = StateEnum::Established;
+
+  if (exported.bufferedData) {
+    transportReadBuf_.append(std::move(exported.bufferedData));
+  }
+  startTransportReads();
+  if (!transportReadBuf_.empty()) {
+    transportDataAvailable();
+  }
+}
+
 template <typename SM>
 void AsyncFizzClientT<SM>::writeAppData(
     folly::AsyncTransportWrapper::WriteCallback* callback,
@@ -319,6 +418,11 @@ void AsyncFizzClientT<SM>::writeAppData(
       earlyDataState_->remainingEarlyData -= size;
       fizzClient_.earlyAppWrite(std::move(w));
     }
+  } else if (ktlsTx_) {
+    // The kernel frames and encrypts everything written to the socket. EOR
+    // marks control records there (see KTLSControlRecordWriter).
+    transport_->writeChain(
+        callback, std::move(buf), flags & ~folly::WriteFlags::EOR);
   } else {
     AppWrite w;
     w.callback = callback;
@@ -340,6 +444,26 @@ void AsyncFizzClientT<SM>::transportDataAvailable() {
   fizzClient_.newTransportData();
 }
 
+template <typename SM>
+void AsyncFizzClientT<SM>::compact() {
+  AsyncFizzBase::compact();
+  if (state_.readRecordLayer()) {
+    state_.readRecordLayer()->compact();
+  }
+  // Early data parameters back the early data accessors until the handshake
+  // success callback resolves early data.
+  if (state_.state() == StateEnum::Established && !earlyDataState_) {
+    state_.handshakeContext() = nullptr;
+    state_.encodedClientHello() = folly::none;
+    state_.keyExchangers() = folly::none;
+    state_.attemptedPsk() = folly::none;
+    state_.earlyDataParams() = folly::none;
+    state_.requestedExtensions() = folly::none;
+    state_.unverifiedCertChain() = folly::none;
+    state_.handshakeTiming() = nullptr;
+  }
+}
+
 template <typename SM>
 void AsyncFizzClientT<SM>::deliverAllErrors(
     const folly::AsyncSocketException& ex,
@@ -453,6 +577,10 @@ template <typename SM>
 void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(
     ReportHandshakeSuccess& success) {
   client_.cancelHandshakeTimeout();
+  auto timingStats = client_.fizzContext_->getHandshakeTimingStats();
+  if (timingStats && client_.state_.handshakeTiming()) {
+    timingStats->add(*client_.state_.handshakeTiming());
+  }
   if (client_.earlyDataState_) {
     if (!success.earlyDataAccepted) {
       auto ex = client_.handleEarlyReject();
@@ -524,11 +652,27 @@ void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(WaitForData&) {
     // Make sure that the read callback is installed.
     client_.startTransportReads();
   }
+
+  if (client_.getIdleCompaction()) {
+    client_.compact();
+  }
 }
 
 template <typename SM>
 void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(MutateState& mutator) {
   mutator(client_.state_);
+  if (client_.ktlsTx_) {
+    try {
+      syncKTLSTx(
+          client_.state_,
+          *client_.ktlsTx_,
+          AppTrafficSecrets::ClientAppTraffic);
+    } catch (const std::exception& ex) {
+      folly::AsyncSocketException ase(
+          folly::AsyncSocketException::SSL_ERROR, ex.what());
+      client_.deliverAllErrors(ase);
+    }
+  }
 }
 
 template <typename SM>
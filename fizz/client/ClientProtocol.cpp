@@ -10,9 +10,11 @@
 
 #include <fizz/client/PskCache.h>
 #include <fizz/crypto/Utils.h>
+#include <fizz/protocol/DelegatedCredential.h>
 #include <fizz/protocol/CertificateVerifier.h>
 #include <fizz/protocol/Protocol.h>
 #include <fizz/protocol/StateMachine.h>
+#include <fizz/protocol/Stats.h>
 #include <fizz/record/Extensions.h>
 
 using folly::Optional;
@@ -72,6 +74,12 @@ FIZZ_DECLARE_EVENT_HANDLER(
     Event::Certificate,
     StateEnum::ExpectingCertificateVerify);
 
+FIZZ_DECLARE_EVENT_HANDLER(
+    ClientTypes,
+    StateEnum::ExpectingCertificate,
+    Event::CompressedCertificate,
+    StateEnum::ExpectingCertificateVerify);
+
 FIZZ_DECLARE_EVENT_HANDLER(
     ClientTypes,
     StateEnum::ExpectingCertificate,
@@ -216,6 +224,10 @@ Actions handleError(
   if (state.state() == StateEnum::Error) {
     return actions(std::move(error));
   }
+  if (state.context() && state.context()->getStats() &&
+      state.state() != StateEnum::Established) {
+    state.context()->getStats()->recordHandshakeError(alertDesc);
+  }
   auto transition = [](State& newState) {
     newState.state() = StateEnum::Error;
     newState.writeRecordLayer() = nullptr;
@@ -327,6 +339,9 @@ static ClientHello getClientHello(
     const std::vector<PskKeyExchangeMode>& supportedPskModes,
     const folly::Optional<std::string>& hostname,
     const std::vector<std::string>& supportedAlpns,
+    const std::vector<std::shared_ptr<CertificateDecompressor>>&
+        certDecompressors,
+    const std::vector<SignatureScheme>& delegatedCredentialSchemes,
     const Optional<EarlyDataParams>& earlyDataParams,
     const Buf& legacySessionId,
     ClientExtensions* extensions,
@@ -388,6 +403,20 @@ static ClientHello getClientHello(
     chlo.extensions.push_back(encodeExtension(ClientEarlyData()));
   }
 
+  if (!certDecompressors.empty()) {
+    CertificateCompressionAlgorithms algos;
+    for (const auto& decompressor : certDecompressors) {
+      algos.algorithms.push_back(decompressor->getAlgorithm());
+    }
+    chlo.extensions.push_back(encodeExtension(std::move(algos)));
+  }
+
+  if (!delegatedCredentialSchemes.empty()) {
+    DelegatedCredentialSupport dcSupport;
+    dcSupport.supported_signature_algorithms = delegatedCredentialSchemes;
+    chlo.extensions.push_back(encodeExtension(std::move(dcSupport)));
+  }
+
   if (cookie) {
     Cookie monster;
     monster.cookie = std::move(cookie);
@@ -543,7 +572,15 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
     legacySessionId = folly::IOBuf::create(0);
   }
 
-  auto keyExchangers = getKeyExchangers(*context->getFactory(), selectedShares);
+  std::unique_ptr<HandshakeTiming> handshakeTiming;
+  if (context->getHandshakeTimingStats()) {
+    handshakeTiming = std::make_unique<HandshakeTiming>();
+  }
+
+  auto keyExchangers = timeHandshakeStage(
+      handshakeTiming.get(), HandshakeStage::KeyExchange, [&] {
+        return getKeyExchangers(*context->getFactory(), selectedShares);
+      });
 
   auto chlo = getClientHello(
       *context->getFactory(),
@@ -557,6 +594,8 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
       context->getSupportedPskModes(),
       connect.sni,
       context->getSupportedAlpns(),
+      context->getCertDecompressors(),
+      context->getSupportedDelegatedCredentialSchemes(),
       earlyDataParams,
       legacySessionId,
       connect.extensions.get());
@@ -628,7 +667,9 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
                     psk = std::move(psk),
                     extensions = connect.extensions,
                     requestedExtensions = std::move(requestedExtensions),
-                    earlyDataType](State& newState) mutable {
+                    earlyDataType,
+                    handshakeTiming =
+                        std::move(handshakeTiming)](State& newState) mutable {
     newState.context() = std::move(context);
     newState.verifier() = verifier;
     newState.encodedClientHello() = std::move(encodedClientHello);
@@ -642,6 +683,7 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
     newState.extensions() = extensions;
     newState.requestedExtensions() = std::move(requestedExtensions);
     newState.earlyDataType() = earlyDataType;
+    newState.handshakeTiming() = std::move(handshakeTiming);
   };
 
   if (reportEarlySuccess) {
@@ -890,8 +932,12 @@ EventHandler<ClientTypes, StateEnum::ExpectingServerHello, Event::ServerHello>::
     Buf serverShare;
     const KeyExchange* kex;
     std::tie(group, serverShare, kex) = std::move(*exchange);
-    auto sharedSecret = kex->generateSharedSecret(serverShare->coalesce());
-    scheduler->deriveHandshakeSecret(sharedSecret->coalesce());
+    timeHandshakeStage(
+        state.handshakeTiming(), HandshakeStage::KeyExchange, [&] {
+          auto sharedSecret =
+              kex->generateSharedSecret(serverShare->coalesce());
+          scheduler->deriveHandshakeSecret(sharedSecret->coalesce());
+        });
   } else {
     keyExchangeType = KeyExchangeType::None;
     scheduler->deriveHandshakeSecret();
@@ -1038,6 +1084,10 @@ Actions EventHandler<
     throw FizzException("two HRRs", AlertDescription::unexpected_message);
   }
 
+  if (auto stats = state.context()->getStats()) {
+    stats->increment(StatsCounter::HelloRetryRequest);
+  }
+
   auto negotiatedParams = negotiateParameters(
       hrr,
       state.context()->getSupportedVersions(),
@@ -1073,6 +1123,8 @@ Actions EventHandler<
       state.context()->getSupportedPskModes(),
       state.sni(),
       state.context()->getSupportedAlpns(),
+      state.context()->getCertDecompressors(),
+      state.context()->getSupportedDelegatedCredentialSchemes(),
       folly::none,
       state.legacySessionId(),
       state.extensions(),
@@ -1323,30 +1375,46 @@ Actions EventHandler<
       std::move(mutateState), &Transition<StateEnum::ExpectingCertificate>);
 }
 
-Actions
-EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
-    handle(const State& state, Param param) {
-  auto certMsg = std::move(boost::get<CertificateMsg>(param));
-
-  state.handshakeContext()->appendToTranscript(*certMsg.originalEncoding);
-
+static std::vector<std::shared_ptr<const PeerCert>> getServerCerts(
+    const State& state,
+    CertificateMsg certMsg) {
   if (!certMsg.certificate_request_context->empty()) {
     throw FizzException(
         "certificate request context must be empty",
         AlertDescription::illegal_parameter);
   }
 
+  const auto& dcSchemes =
+      state.context()->getSupportedDelegatedCredentialSchemes();
   std::vector<std::shared_ptr<const PeerCert>> serverCerts;
   for (auto& certEntry : certMsg.certificate_list) {
-    // We don't request any certificate-related extensions
-    if (!certEntry.extensions.empty()) {
+    // The only certificate-related extension we request is a delegated
+    // credential, which is only allowed on the leaf.
+    folly::Optional<DelegatedCredential> credential;
+    if (serverCerts.empty() && !dcSchemes.empty()) {
+      credential = getExtension<DelegatedCredential>(certEntry.extensions);
+    }
+    if (certEntry.extensions.size() != (credential ? 1 : 0)) {
       throw FizzException(
-          "certificate extensions must be empty",
+          "unexpected certificate extensions",
           AlertDescription::illegal_parameter);
     }
 
-    serverCerts.emplace_back(state.context()->getFactory()->makePeerCert(
-        std::move(certEntry.cert_data)));
+    auto peerCert = state.context()->getFactory()->makePeerCert(
+        std::move(certEntry.cert_data));
+    if (credential) {
+      if (std::find(
+              dcSchemes.begin(),
+              dcSchemes.end(),
+              credential->expected_verify_scheme) == dcSchemes.end()) {
+        throw FizzException(
+            "server sent unsupported delegated credential",
+            AlertDescription::illegal_parameter);
+      }
+      peerCert = DelegatedCredentialUtils::makePeerDelegatedCredential(
+          std::move(peerCert), std::move(*credential));
+    }
+    serverCerts.push_back(std::move(peerCert));
   }
 
   if (serverCerts.empty()) {
@@ -1354,6 +1422,18 @@ EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
         "no certificates received", AlertDescription::illegal_parameter);
   }
 
+  return serverCerts;
+}
+
+Actions
+EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
+    handle(const State& state, Param param) {
+  auto certMsg = std::move(boost::get<CertificateMsg>(param));
+
+  state.handshakeContext()->appendToTranscript(*certMsg.originalEncoding);
+
+  auto serverCerts = getServerCerts(state, std::move(certMsg));
+
   ClientAuthType authType =
       state.clientAuthRequested().value_or(ClientAuthType::NotRequested);
 
@@ -1366,6 +1446,43 @@ EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
       &Transition<StateEnum::ExpectingCertificateVerify>);
 }
 
+Actions EventHandler<
+    ClientTypes,
+    StateEnum::ExpectingCertificate,
+    Event::CompressedCertificate>::handle(const State& state, Param param) {
+  auto compressedCert = std::move(boost::get<CompressedCertificate>(param));
+
+  // The compressed form is what goes into the transcript, not the
+  // reconstructed Certificate message.
+  state.handshakeContext()->appendToTranscript(
+      *compressedCert.originalEncoding);
+
+  auto decompressor =
+      state.context()->getCertDecompressor(compressedCert.algorithm);
+  if (!decompressor) {
+    // Only algorithms we advertised have a decompressor.
+    throw FizzException(
+        "unsupported certificate compression algorithm",
+        AlertDescription::bad_certificate);
+  }
+
+  auto certMsg = decompressor->decompress(compressedCert);
+  auto serverCerts = getServerCerts(state, std::move(certMsg));
+
+  ClientAuthType authType =
+      state.clientAuthRequested().value_or(ClientAuthType::NotRequested);
+
+  return actions(
+      [unverifiedCertChain = std::move(serverCerts),
+       authType,
+       algorithm = compressedCert.algorithm](State& newState) mutable {
+        newState.unverifiedCertChain() = std::move(unverifiedCertChain);
+        newState.clientAuthRequested() = authType;
+        newState.serverCertCompAlgo() = algorithm;
+      },
+      &Transition<StateEnum::ExpectingCertificateVerify>);
+}
+
 Actions EventHandler<
     ClientTypes,
     StateEnum::ExpectingCertificateVerify,
@@ -1467,8 +1584,13 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
 
       auto sigScheme = *state.clientAuthSigScheme();
       auto toSign = state.handshakeContext()->getHandshakeContext();
-      auto signature = selectedCert->sign(
-          sigScheme, CertificateVerifyContext::Client, toSign->coalesce());
+      auto signature = timeHandshakeStage(
+          state.handshakeTiming(), HandshakeStage::Signing, [&] {
+            return selectedCert->sign(
+                sigScheme,
+                CertificateVerifyContext::Client,
+                toSign->coalesce());
+          });
 
       CertificateVerify verify;
       verify.algorithm = sigScheme;
@@ -1554,6 +1676,14 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
   reportSuccess.earlyDataAccepted =
       state.earlyDataType() == EarlyDataType::Accepted;
 
+  if (auto stats = state.context()->getStats()) {
+    stats->recordHandshakeSuccess(
+        *state.cipher(),
+        state.group(),
+        *state.pskType(),
+        *state.earlyDataType());
+  }
+
   return actions(
       [readRecordLayer = std::move(readRecordLayer),
        writeRecordLayer = std::move(writeRecordLayer),
@@ -9,8 +9,11 @@
 #pragma once
 
 #include <fizz/client/PskCache.h>
+#include <fizz/compression/CertificateCompressor.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Factory.h>
+#include <fizz/protocol/HandshakeTiming.h>
+#include <fizz/protocol/Stats.h>
 #include <fizz/record/Types.h>
 
 namespace fizz {
@@ -44,7 +47,8 @@ class FizzClientContext {
   }
 
   /**
-   * Set the supported signature schemes, in preference order.
+   * Set the supported signature schemes, in preference order. ed25519 is not
+   * offered by default.
    */
   void setSupportedSigSchemes(std::vector<SignatureScheme> schemes) {
     supportedSigSchemes_ = std::move(schemes);
@@ -97,6 +101,45 @@ class FizzClientContext {
     return supportedAlpns_;
   }
 
+  /**
+   * Sets the certificate decompressors to use, in preference order. The
+   * algorithms they support will be advertised to the server.
+   */
+  void setCertDecompressors(
+      std::vector<std::shared_ptr<CertificateDecompressor>> decompressors) {
+    certDecompressors_ = std::move(decompressors);
+  }
+
+  const auto& getCertDecompressors() const {
+    return certDecompressors_;
+  }
+
+  /**
+   * Returns the decompressor for algo, or nullptr if it is not supported.
+   */
+  std::shared_ptr<CertificateDecompressor> getCertDecompressor(
+      CertificateCompressionAlgorithm algo) const {
+    for (const auto& decompressor : certDecompressors_) {
+      if (decompressor->getAlgorithm() == algo) {
+        return decompressor;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Sets the signature schemes this client accepts delegated credentials
+   * (RFC 9345) for. Delegated credentials are not advertised if empty.
+   */
+  void setSupportedDelegatedCredentialSchemes(
+      std::vector<SignatureScheme> schemes) {
+    supportedDelegatedCredentialSchemes_ = std::move(schemes);
+  }
+
+  const auto& getSupportedDelegatedCredentialSchemes() const {
+    return supportedDelegatedCredentialSchemes_;
+  }
+
   /**
    * Sets the certificate to use if the server requests client authentication
    */
@@ -181,6 +224,30 @@ class FizzClientContext {
     return factory_.get();
   }
 
+  /**
+   * Records the timing of every handshake using this context into stats.
+   * Unset by default, in which case no timing is recorded.
+   */
+  void setHandshakeTimingStats(std::shared_ptr<HandshakeTimingStats> stats) {
+    handshakeTimingStats_ = std::move(stats);
+  }
+
+  HandshakeTimingStats* getHandshakeTimingStats() const {
+    return handshakeTimingStats_.get();
+  }
+
+  /**
+   * Counts handshake outcomes of the connections using this context. Use a
+   * StatsFactory with the same stats to also count records.
+   */
+  void setStats(std::shared_ptr<FizzStats> stats) {
+    stats_ = std::move(stats);
+  }
+
+  FizzStats* getStats() const {
+    return stats_.get();
+  }
+
  private:
   std::unique_ptr<Factory> factory_;
 
@@ -203,6 +270,8 @@ class FizzClientContext {
       PskKeyExchangeMode::psk_dhe_ke,
       PskKeyExchangeMode::psk_ke};
   std::vector<std::string> supportedAlpns_;
+  std::vector<std::shared_ptr<CertificateDecompressor>> certDecompressors_;
+  std::vector<SignatureScheme> supportedDelegatedCredentialSchemes_;
   bool sendEarlyData_{false};
 
   bool compatMode_{false};
@@ -211,6 +280,9 @@ class FizzClientContext {
   std::shared_ptr<const SelfCert> clientCert_;
 
   bool useAlternateSniCodePoint_{false};
+
+  std::shared_ptr<HandshakeTimingStats> handshakeTimingStats_;
+  std::shared_ptr<FizzStats> stats_;
 };
 } // namespace client
 } // namespace fizz
@@ -0,0 +1,428 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/PersistentPskCache.h>
+
+#include <fizz/crypto/Sha256.h>
+#include <folly/hash/Checksum.h>
+#include <folly/hash/Hash.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+#include <openssl/crypto.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace fizz {
+namespace client {
+
+struct PersistentPskCache::FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t slotCount;
+  uint32_t slotSize;
+  uint32_t reserved;
+};
+
+/**
+ * Each slot starts with this header and is followed by the encoded record.
+ * A slot is empty while length is 0.
+ */
+struct PersistentPskCache::SlotHeader {
+  uint64_t identityHash;
+  uint64_t expiration;
+  uint32_t checksum;
+  uint32_t length;
+};
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'Z', 'P', 'S', 'K', 'C', '0', '1'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr uint32_t kMinSlotSize = 512;
+
+// Slots examined for an identity before an existing record is evicted.
+constexpr uint32_t kMaxProbes = 8;
+
+enum class StoredCert : uint8_t { None, X509, Identity };
+
+[[noreturn]] void throwErrno(const std::string& what) {
+  throw std::runtime_error(what + " failed: " + std::to_string(errno));
+}
+
+uint64_t toMillis(std::chrono::system_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+std::chrono::system_clock::time_point fromMillis(uint64_t millis) {
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::milliseconds(millis)));
+}
+
+uint32_t recordChecksum(
+    uint64_t identityHash,
+    uint64_t expiration,
+    const uint8_t* record,
+    size_t length) {
+  const uint64_t keys[] = {identityHash, expiration};
+  auto checksum =
+      folly::crc32c(reinterpret_cast<const uint8_t*>(keys), sizeof(keys));
+  return folly::crc32c(record, length, checksum);
+}
+
+template <typename LenType>
+void writeString(const std::string& str, folly::io::Appender& out) {
+  if (str.size() > std::numeric_limits<LenType>::max()) {
+    throw std::runtime_error("psk cache field too large");
+  }
+  fizz::detail::write(static_cast<LenType>(str.size()), out);
+  out.push(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+}
+
+template <typename LenType>
+std::string readString(folly::io::Cursor& cursor) {
+  LenType len;
+  fizz::detail::read(len, cursor);
+  return cursor.readFixedString(len);
+}
+
+void writeCert(
+    const std::shared_ptr<const Cert>& cert,
+    folly::io::Appender& out) {
+  if (!cert) {
+    fizz::detail::write(StoredCert::None, out);
+    return;
+  }
+  auto x509 = cert->getX509();
+  if (!x509) {
+    fizz::detail::write(StoredCert::Identity, out);
+    writeString<uint16_t>(cert->getIdentity(), out);
+    return;
+  }
+  auto der = folly::ssl::OpenSSLCertUtils::derEncode(*x509);
+  std::array<uint8_t, Sha256::HashLen> fingerprint;
+  Sha256::hash(*der, folly::range(fingerprint));
+  fizz::detail::write(StoredCert::X509, out);
+  out.push(fingerprint.data(), fingerprint.size());
+  fizz::detail::writeBuf<uint16_t>(der, out);
+}
+
+Buf encode(const std::string& identity, const CachedPsk& psk) {
+  auto record = folly::IOBuf::create(256);
+  folly::io::Appender appender(record.get(), 256);
+  writeString<uint16_t>(identity, appender);
+  writeString<uint16_t>(psk.psk, appender);
+  writeString<uint16_t>(psk.secret, appender);
+  fizz::detail::write(static_cast<uint8_t>(psk.type), appender);
+  fizz::detail::write(psk.version, appender);
+  fizz::detail::write(psk.cipher, appender);
+  fizz::detail::write(static_cast<uint8_t>(psk.group ? 1 : 0), appender);
+  if (psk.group) {
+    fizz::detail::write(*psk.group, appender);
+  }
+  fizz::detail::write(psk.maxEarlyDataSize, appender);
+  fizz::detail::write(psk.ticketAgeAdd, appender);
+  fizz::detail::write(toMillis(psk.ticketIssueTime), appender);
+  writeString<uint8_t>(psk.alpn ? *psk.alpn : std::string(), appender);
+  writeCert(psk.serverCert, appender);
+  writeCert(psk.clientCert, appender);
+  record->coalesce();
+  return record;
+}
+} // namespace
+
+PersistentPskCache::PersistentPskCache(
+    std::string path,
+    uint32_t slotCount,
+    uint32_t slotSize)
+    : path_(std::move(path)), slotCount_(slotCount), slotSize_(slotSize) {
+  if (slotCount_ == 0 || slotSize_ < kMinSlotSize ||
+      slotSize_ % alignof(SlotHeader) != 0) {
+    throw std::runtime_error("invalid psk cache geometry");
+  }
+  // The file header takes up the space of one slot to keep slots aligned.
+  mappedSize_ = (static_cast<size_t>(slotCount_) + 1) * slotSize_;
+
+  fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd_ < 0) {
+    throwErrno("open " + path_);
+  }
+  try {
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+      throwErrno("lock " + path_);
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+      throwErrno("stat " + path_);
+    }
+    FileHeader header;
+    bool valid = static_cast<size_t>(st.st_size) == mappedSize_ &&
+        pread(fd_, &header, sizeof(header), 0) ==
+            static_cast<ssize_t>(sizeof(header)) &&
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+        header.version == kFormatVersion && header.slotCount == slotCount_ &&
+        header.slotSize == slotSize_;
+    if (!valid &&
+        (ftruncate(fd_, 0) != 0 || ftruncate(fd_, mappedSize_) != 0)) {
+      throwErrno("truncate " + path_);
+    }
+
+    auto ptr = mmap(
+        nullptr, mappedSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (ptr == MAP_FAILED) {
+      throwErrno("mmap " + path_);
+    }
+    mapped_ = static_cast<uint8_t*>(ptr);
+    if (!valid) {
+      initialize();
+    }
+  } catch (...) {
+    if (mapped_) {
+      munmap(mapped_, mappedSize_);
+    }
+    close(fd_);
+    throw;
+  }
+}
+
+PersistentPskCache::~PersistentPskCache() {
+  munmap(mapped_, mappedSize_);
+  close(fd_);
+}
+
+void PersistentPskCache::initialize() {
+  auto header = reinterpret_cast<FileHeader*>(mapped_);
+  header->version = kFormatVersion;
+  header->slotCount = slotCount_;
+  header->slotSize = slotSize_;
+  sync();
+  // The magic goes in last: a crash before it is on disk leaves a file that
+  // is initialized again on the next open.
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  sync();
+}
+
+void PersistentPskCache::sync() {
+  if (msync(mapped_, mappedSize_, MS_SYNC) != 0) {
+    throwErrno("msync " + path_);
+  }
+}
+
+PersistentPskCache::SlotHeader* PersistentPskCache::getSlot(uint32_t index) {
+  return reinterpret_cast<SlotHeader*>(
+      mapped_ + (static_cast<size_t>(index) + 1) * slotSize_);
+}
+
+void PersistentPskCache::clearSlot(SlotHeader* slot) {
+  slot->length = 0;
+  OPENSSL_cleanse(slot + 1, slotSize_ - sizeof(SlotHeader));
+}
+
+bool PersistentPskCache::validSlot(const SlotHeader* slot) const {
+  if (slot->length == 0 || slot->length > slotSize_ - sizeof(SlotHeader)) {
+    return false;
+  }
+  return slot->checksum ==
+      recordChecksum(
+             slot->identityHash,
+             slot->expiration,
+             reinterpret_cast<const uint8_t*>(slot + 1),
+             slot->length);
+}
+
+bool PersistentPskCache::slotHasIdentity(
+    const SlotHeader* slot,
+    const std::string& identity) const {
+  auto record = folly::IOBuf::wrapBufferAsValue(slot + 1, slot->length);
+  folly::io::Cursor cursor(&record);
+  try {
+    return readString<uint16_t>(cursor) == identity;
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+}
+
+PersistentPskCache::SlotHeader* PersistentPskCache::findSlot(
+    const std::string& identity,
+    uint64_t hash) {
+  auto probes = std::min(kMaxProbes, slotCount_);
+  for (uint32_t i = 0; i < probes; ++i) {
+    auto slot = getSlot((hash % slotCount_ + i) % slotCount_);
+    if (slot->identityHash == hash && validSlot(slot) &&
+        slotHasIdentity(slot, identity)) {
+      return slot;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const Cert> PersistentPskCache::readCert(
+    folly::io::Cursor& cursor) {
+  StoredCert storage;
+  fizz::detail::read(storage, cursor);
+  switch (storage) {
+    case StoredCert::None:
+      return nullptr;
+    case StoredCert::Identity:
+      return std::make_shared<const IdentityCert>(
+          readString<uint16_t>(cursor));
+    case StoredCert::X509: {
+      auto fingerprint = cursor.readFixedString(Sha256::HashLen);
+      uint16_t len;
+      fizz::detail::read(len, cursor);
+      auto cached = certs_.find(fingerprint);
+      if (cached != certs_.end()) {
+        cursor.skip(len);
+        return cached->second;
+      }
+      auto der = folly::IOBuf::create(len);
+      cursor.pull(der->writableData(), len);
+      der->append(len);
+      std::shared_ptr<const Cert> cert =
+          CertUtils::makePeerCert(std::move(der));
+      if (certs_.size() >= slotCount_) {
+        certs_.clear();
+      }
+      certs_.emplace(std::move(fingerprint), cert);
+      return cert;
+    }
+  }
+  throw std::runtime_error("unknown certificate storage");
+}
+
+CachedPsk PersistentPskCache::decode(folly::io::Cursor& cursor) {
+  CachedPsk psk;
+  psk.psk = readString<uint16_t>(cursor);
+  psk.secret = readString<uint16_t>(cursor);
+  uint8_t type;
+  fizz::detail::read(type, cursor);
+  psk.type = static_cast<PskType>(type);
+  fizz::detail::read(psk.version, cursor);
+  fizz::detail::read(psk.cipher, cursor);
+  uint8_t hasGroup;
+  fizz::detail::read(hasGroup, cursor);
+  if (hasGroup) {
+    NamedGroup group;
+    fizz::detail::read(group, cursor);
+    psk.group = group;
+  }
+  fizz::detail::read(psk.maxEarlyDataSize, cursor);
+  fizz::detail::read(psk.ticketAgeAdd, cursor);
+  uint64_t issueTime;
+  fizz::detail::read(issueTime, cursor);
+  psk.ticketIssueTime = fromMillis(issueTime);
+  auto alpn = readString<uint8_t>(cursor);
+  if (!alpn.empty()) {
+    psk.alpn = std::move(alpn);
+  }
+  psk.serverCert = readCert(cursor);
+  psk.clientCert = readCert(cursor);
+  return psk;
+}
+
+folly::Optional<CachedPsk> PersistentPskCache::getPsk(
+    const std::string& identity) {
+  auto hash = folly::hash::fnv64(identity);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto slot = findSlot(identity, hash);
+  if (!slot) {
+    return folly::none;
+  }
+  if (fromMillis(slot->expiration) <= std::chrono::system_clock::now()) {
+    clearSlot(slot);
+    return folly::none;
+  }
+
+  auto record = folly::IOBuf::wrapBufferAsValue(slot + 1, slot->length);
+  folly::io::Cursor cursor(&record);
+  try {
+    // The identity was already matched by findSlot().
+    readString<uint16_t>(cursor);
+    auto psk = decode(cursor);
+    psk.ticketExpirationTime = fromMillis(slot->expiration);
+    return psk;
+  } catch (const std::exception& e) {
+    VLOG(4) << "Dropping unreadable cached psk for " << identity << ": "
+            << e.what();
+    clearSlot(slot);
+    return folly::none;
+  }
+}
+
+void PersistentPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  auto hash = folly::hash::fnv64(identity);
+  Buf record;
+  try {
+    record = encode(identity, psk);
+  } catch (const std::runtime_error& e) {
+    VLOG(4) << "Could not encode psk for " << identity << ": " << e.what();
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto slot = findSlot(identity, hash);
+  if (!record || record->length() > slotSize_ - sizeof(SlotHeader)) {
+    // A newer ticket was issued, don't keep offering the one it replaces.
+    if (slot) {
+      clearSlot(slot);
+    }
+    return;
+  }
+
+  if (!slot) {
+    // Take the first free slot, otherwise evict the record that expires
+    // soonest.
+    auto now = toMillis(std::chrono::system_clock::now());
+    auto probes = std::min(kMaxProbes, slotCount_);
+    for (uint32_t i = 0; i < probes; ++i) {
+      auto candidate = getSlot((hash % slotCount_ + i) % slotCount_);
+      if (!validSlot(candidate) || candidate->expiration <= now) {
+        slot = candidate;
+        break;
+      }
+      if (!slot || candidate->expiration < slot->expiration) {
+        slot = candidate;
+      }
+    }
+  }
+
+  // The slot is marked empty while it is overwritten; if the process dies
+  // part way through, the checksum will not match and the record is
+  // ignored.
+  auto length = static_cast<uint32_t>(record->length());
+  slot->length = 0;
+  slot->identityHash = hash;
+  slot->expiration = toMillis(psk.ticketExpirationTime);
+  std::memcpy(slot + 1, record->data(), length);
+  // Don't leave the end of a longer record that was here behind.
+  OPENSSL_cleanse(
+      reinterpret_cast<uint8_t*>(slot + 1) + length,
+      slotSize_ - sizeof(SlotHeader) - length);
+  slot->checksum = recordChecksum(
+      slot->identityHash, slot->expiration, record->data(), length);
+  slot->length = length;
+}
+
+void PersistentPskCache::removePsk(const std::string& identity) {
+  auto hash = folly::hash::fnv64(identity);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto slot = findSlot(identity, hash);
+  if (slot) {
+    clearSlot(slot);
+  }
+}
+} // namespace client
+} // namespace fizz
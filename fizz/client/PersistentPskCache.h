@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/io/Cursor.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PSK cache backed by a memory mapped file, so that a client process keeps
+ * its resumption tickets across restarts.
+ *
+ * The file is a header followed by slotCount fixed size slots forming an
+ * open addressed hash table keyed on the identity. Opening the cache only
+ * maps the file and checks the header; nothing is parsed until an identity
+ * is looked up, and a lookup only decodes the slots the identity hashes to.
+ *
+ * Every record carries a checksum that is written before the record is
+ * marked valid, so a record torn by a crash is ignored and overwritten
+ * rather than returned. Records that are removed, expire or are replaced
+ * are wiped from the file, not just marked empty. Writes reach the page
+ * cache immediately and survive the process exiting; call sync() to also
+ * make them durable against the machine going down.
+ *
+ * Certificates are stored as DER together with their SHA-256 fingerprint.
+ * Parsed certificates are kept in memory by fingerprint so that resuming
+ * against the same server does not parse its certificate again.
+ *
+ * The file is locked for the lifetime of the cache and only one cache, in
+ * one process, may use it at a time. It is in native byte order and is not
+ * meant to be moved between machines. Records that do not fit in a slot,
+ * e.g. because of a very large certificate, are not cached.
+ */
+class PersistentPskCache : public PskCache {
+ public:
+  /**
+   * Opens the cache file at path, creating it if needed. An existing file
+   * with a different slotCount or slotSize, or one that is not a cache
+   * file, is emptied. Throws if the file cannot be mapped or is already in
+   * use.
+   */
+  explicit PersistentPskCache(
+      std::string path,
+      uint32_t slotCount = 1024,
+      uint32_t slotSize = 4096);
+
+  ~PersistentPskCache() override;
+
+  PersistentPskCache(const PersistentPskCache&) = delete;
+  PersistentPskCache& operator=(const PersistentPskCache&) = delete;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+  /**
+   * Blocks until every change made so far has been written to disk.
+   */
+  void sync();
+
+ private:
+  struct FileHeader;
+  struct SlotHeader;
+
+  void initialize();
+  SlotHeader* getSlot(uint32_t index);
+  // Marks the slot empty and wipes the record it held.
+  void clearSlot(SlotHeader* slot);
+  bool validSlot(const SlotHeader* slot) const;
+  bool slotHasIdentity(const SlotHeader* slot, const std::string& identity)
+      const;
+  SlotHeader* findSlot(const std::string& identity, uint64_t hash);
+  CachedPsk decode(folly::io::Cursor& cursor);
+  std::shared_ptr<const Cert> readCert(folly::io::Cursor& cursor);
+
+  std::string path_;
+  uint32_t slotCount_;
+  uint32_t slotSize_;
+  int fd_{-1};
+  size_t mappedSize_{0};
+  uint8_t* mapped_{nullptr};
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const Cert>> certs_;
+};
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/ShardedPskCache.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace fizz {
+namespace client {
+
+constexpr size_t ShardedPskCache::kNumShards;
+
+static bool expired(
+    const CachedPsk& psk,
+    std::chrono::system_clock::time_point now) {
+  return psk.ticketExpirationTime <= now;
+}
+
+ShardedPskCache::ShardedPskCache(
+    size_t maxIdentities,
+    size_t ticketsPerIdentity)
+    : ticketsPerIdentity_(ticketsPerIdentity) {
+  if (ticketsPerIdentity_ == 0) {
+    throw std::runtime_error("psk cache must keep at least one ticket");
+  }
+  auto perShard = std::max<size_t>(
+      1, (maxIdentities + kNumShards - 1) / kNumShards);
+  for (auto& shard : shards_) {
+    shard.pools.lock()->setMaxSize(perShard);
+  }
+  scheduler_.setThreadName("PskCacheCleanup");
+}
+
+ShardedPskCache::~ShardedPskCache() {
+  stopCleanup();
+}
+
+ShardedPskCache::Shard& ShardedPskCache::getShard(
+    const std::string& identity) {
+  return shards_[std::hash<std::string>()(identity) % kNumShards];
+}
+
+folly::Optional<CachedPsk> ShardedPskCache::getPsk(
+    const std::string& identity) {
+  auto now = std::chrono::system_clock::now();
+  auto pools = getShard(identity).pools.lock();
+  auto result = pools->find(identity);
+  if (result == pools->end()) {
+    return folly::none;
+  }
+
+  // Hand out the most recently issued ticket; it has the longest left to
+  // live.
+  auto& pool = result->second;
+  folly::Optional<CachedPsk> psk;
+  while (!psk && !pool.empty()) {
+    if (!expired(pool.back(), now)) {
+      psk = std::move(pool.back());
+    }
+    pool.pop_back();
+  }
+  if (pool.empty()) {
+    pools->erase(identity);
+  }
+  return psk;
+}
+
+void ShardedPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  auto pools = getShard(identity).pools.lock();
+  auto result = pools->find(identity);
+  if (result == pools->end()) {
+    TicketPool pool;
+    pool.push_back(std::move(psk));
+    pools->set(identity, std::move(pool));
+    return;
+  }
+
+  auto& pool = result->second;
+  if (pool.size() >= ticketsPerIdentity_) {
+    pool.pop_front();
+  }
+  pool.push_back(std::move(psk));
+}
+
+void ShardedPskCache::removePsk(const std::string& identity) {
+  getShard(identity).pools.lock()->erase(identity);
+}
+
+void ShardedPskCache::removeExpired() {
+  for (auto& shard : shards_) {
+    auto now = std::chrono::system_clock::now();
+    std::vector<std::string> emptied;
+    auto pools = shard.pools.lock();
+    for (auto& entry : *pools) {
+      auto& pool = entry.second;
+      pool.erase(
+          std::remove_if(
+              pool.begin(),
+              pool.end(),
+              [now](const CachedPsk& psk) { return expired(psk, now); }),
+          pool.end());
+      if (pool.empty()) {
+        emptied.push_back(entry.first);
+      }
+    }
+    for (const auto& identity : emptied) {
+      pools->erase(identity);
+    }
+  }
+}
+
+void ShardedPskCache::startCleanup(std::chrono::milliseconds interval) {
+  if (cleanupStarted_) {
+    return;
+  }
+  scheduler_.addFunction(
+      [this]() { removeExpired(); }, interval, "removeExpired", interval);
+  scheduler_.start();
+  cleanupStarted_ = true;
+}
+
+void ShardedPskCache::stopCleanup() {
+  if (cleanupStarted_) {
+    scheduler_.shutdown();
+    scheduler_.cancelAllFunctions();
+    cleanupStarted_ = false;
+  }
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/experimental/FunctionScheduler.h>
+#include <folly/lang/Align.h>
+
+#include <array>
+#include <deque>
+#include <mutex>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PSK cache for clients that open many concurrent connections to the same
+ * servers from many threads.
+ *
+ * Identities are spread over shards, each with its own lock and least
+ * recently used order, so lookups for different identities rarely contend.
+ * Each identity keeps a pool of up to ticketsPerIdentity tickets, and
+ * getPsk() takes the ticket it returns out of the pool: a ticket is offered
+ * by at most one connection, which matters for servers that only accept each
+ * ticket once. The tickets a server issues on a connection are added back
+ * with putPsk(); once the pool is full the oldest ticket is dropped.
+ *
+ * Expired tickets are never returned. They are dropped when found by a
+ * lookup, by removeExpired(), and periodically on a background thread once
+ * startCleanup() is called.
+ */
+class ShardedPskCache : public PskCache {
+ public:
+  /**
+   * At most maxIdentities identities are cached; they are split evenly
+   * between shards and each shard evicts its least recently used identity
+   * when full.
+   */
+  explicit ShardedPskCache(size_t maxIdentities, size_t ticketsPerIdentity = 4);
+
+  ~ShardedPskCache() override;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+  /**
+   * Drops expired tickets, and identities left without any, from every
+   * shard.
+   */
+  void removeExpired();
+
+  /**
+   * Runs removeExpired() every interval on a background thread until
+   * stopCleanup() is called or the cache is destroyed.
+   */
+  void startCleanup(std::chrono::milliseconds interval);
+
+  void stopCleanup();
+
+ private:
+  static constexpr size_t kNumShards = 16;
+
+  using TicketPool = std::deque<CachedPsk>;
+  using PoolMap = folly::EvictingCacheMap<std::string, TicketPool>;
+
+  struct alignas(folly::hardware_destructive_interference_size) Shard {
+    folly::Synchronized<PoolMap, std::mutex> pools{PoolMap(1)};
+  };
+
+  Shard& getShard(const std::string& identity);
+
+  size_t ticketsPerIdentity_;
+  std::array<Shard, kNumShards> shards_;
+  folly::FunctionScheduler scheduler_;
+  bool cleanupStarted_{false};
+};
+} // namespace client
+} // namespace fizz
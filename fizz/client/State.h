@@ -11,6 +11,7 @@
 #include <fizz/client/ClientExtensions.h>
 #include <fizz/client/FizzClientContext.h>
 #include <fizz/protocol/Certificate.h>
+#include <fizz/protocol/HandshakeTiming.h>
 #include <fizz/protocol/KeyScheduler.h>
 #include <fizz/protocol/Types.h>
 #include <fizz/record/RecordLayer.h>
@@ -128,6 +129,14 @@ class State {
     return sigScheme_;
   }
 
+  /**
+   * The algorithm the server certificate was compressed with, if it was sent
+   * compressed.
+   */
+  folly::Optional<CertificateCompressionAlgorithm> serverCertCompAlgo() const {
+    return serverCertCompAlgo_;
+  }
+
   /**
    * Psk handshake flow used on this connection (psk not sent, psk rejected, psk
    * accepted, etc.).
@@ -337,6 +346,14 @@ class State {
     return extensions_.get();
   }
 
+  /**
+   * Timing of the handshake. Only present if the context has handshake timing
+   * stats set.
+   */
+  HandshakeTiming* handshakeTiming() const {
+    return handshakeTiming_.get();
+  }
+
   auto& state() {
     return state_;
   }
@@ -405,6 +422,10 @@ class State {
     return sigScheme_;
   }
 
+  auto& serverCertCompAlgo() {
+    return serverCertCompAlgo_;
+  }
+
   auto& pskType() {
     return pskType_;
   }
@@ -485,6 +506,10 @@ class State {
     return extensions_;
   }
 
+  auto& handshakeTiming() {
+    return handshakeTiming_;
+  }
+
  private:
   StateEnum state_{StateEnum::Uninitialized};
 
@@ -511,6 +536,7 @@ class State {
   folly::Optional<CipherSuite> cipher_;
   folly::Optional<NamedGroup> group_;
   folly::Optional<SignatureScheme> sigScheme_;
+  folly::Optional<CertificateCompressionAlgorithm> serverCertCompAlgo_;
   folly::Optional<PskType> pskType_;
   folly::Optional<PskKeyExchangeMode> pskMode_;
   folly::Optional<KeyExchangeType> keyExchangeType_;
@@ -537,6 +563,7 @@ class State {
   folly::Optional<CachedPsk> attemptedPsk_;
   folly::Optional<Buf> exporterMasterSecret_;
   std::shared_ptr<ClientExtensions> extensions_;
+  std::unique_ptr<HandshakeTiming> handshakeTiming_;
 };
 } // namespace client
 
@@ -12,6 +12,7 @@
 #include <fizz/client/ClientProtocol.h>
 #include <fizz/client/test/Mocks.h>
 #include <fizz/client/test/Utilities.h>
+#include <fizz/compression/ZlibCertificateCompressor.h>
 #include <fizz/protocol/test/Matchers.h>
 #include <fizz/protocol/test/ProtocolTest.h>
 #include <fizz/protocol/test/TestMessages.h>
@@ -639,6 +640,28 @@ TEST_F(ClientProtocolTest, TestConnectNoAlpn) {
       *state_.encodedClientHello(), encodeHandshake(std::move(chlo))));
 }
 
+TEST_F(ClientProtocolTest, TestConnectCompressionAlgos) {
+  context_->setCertDecompressors(
+      {std::make_shared<ZlibCertificateCompressor>()});
+  Connect connect;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto actions = detail::processEvent(state_, std::move(connect));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  queue.append(state_.encodedClientHello()->clone());
+  queue.trimStart(4);
+  auto chlo = decode<ClientHello>(queue.move());
+  auto algos = getExtension<CertificateCompressionAlgorithms>(chlo.extensions);
+  ASSERT_TRUE(algos);
+  EXPECT_EQ(
+      algos->algorithms,
+      std::vector<CertificateCompressionAlgorithm>{
+          CertificateCompressionAlgorithm::zlib});
+}
+
 TEST_F(ClientProtocolTest, TestConnectExtension) {
   Connect connect;
   connect.context = context_;
@@ -1963,6 +1986,64 @@ TEST_F(ClientProtocolTest, TestCertificateEmpty) {
   expectError(actions, AlertDescription::illegal_parameter, "no cert");
 }
 
+TEST_F(ClientProtocolTest, TestCompressedCertificateFlow) {
+  context_->setCertDecompressors(
+      {std::make_shared<ZlibCertificateCompressor>()});
+  setupExpectingCertificate();
+  // The compressed message, not the certificate it holds, is what goes into
+  // the transcript.
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      appendToTranscript(BufMatches("compressedcertencoding")));
+  mockLeaf_ = std::make_shared<MockPeerCert>();
+  mockIntermediate_ = std::make_shared<MockPeerCert>();
+  EXPECT_CALL(*factory_, _makePeerCert(BufMatches("cert1")))
+      .WillOnce(Return(mockLeaf_));
+  EXPECT_CALL(*factory_, _makePeerCert(BufMatches("cert2")))
+      .WillOnce(Return(mockIntermediate_));
+
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry1;
+  entry1.cert_data = folly::IOBuf::copyBuffer("cert1");
+  certificate.certificate_list.push_back(std::move(entry1));
+  CertificateEntry entry2;
+  entry2.cert_data = folly::IOBuf::copyBuffer("cert2");
+  certificate.certificate_list.push_back(std::move(entry2));
+  ZlibCertificateCompressor zlib;
+  auto compressed = zlib.compress(std::move(certificate));
+  compressed.originalEncoding =
+      folly::IOBuf::copyBuffer("compressedcertencoding");
+  auto actions = detail::processEvent(state_, std::move(compressed));
+
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->size(), 2);
+  EXPECT_EQ(state_.unverifiedCertChain()->at(0), mockLeaf_);
+  EXPECT_EQ(state_.unverifiedCertChain()->at(1), mockIntermediate_);
+  EXPECT_EQ(
+      *state_.serverCertCompAlgo(), CertificateCompressionAlgorithm::zlib);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
+}
+
+TEST_F(ClientProtocolTest, TestCompressedCertificateUnadvertisedAlgorithm) {
+  context_->setCertDecompressors(
+      {std::make_shared<ZlibCertificateCompressor>()});
+  setupExpectingCertificate();
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("cert");
+  certificate.certificate_list.push_back(std::move(entry));
+  ZlibCertificateCompressor zlib;
+  auto compressed = zlib.compress(std::move(certificate));
+  compressed.algorithm = CertificateCompressionAlgorithm::zstd;
+  compressed.originalEncoding = folly::IOBuf::copyBuffer("encoding");
+  auto actions = detail::processEvent(state_, std::move(compressed));
+  expectError(
+      actions,
+      AlertDescription::bad_certificate,
+      "unsupported certificate compression algorithm");
+}
+
 TEST_F(ClientProtocolTest, TestCertificateVerifyFlow) {
   setupExpectingCertificateVerify();
   Sequence contextSeq;
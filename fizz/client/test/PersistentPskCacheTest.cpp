@@ -0,0 +1,233 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/PersistentPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/experimental/TestUtil.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class PersistentPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    path_ = (dir_.path() / "psks").string();
+    cache_ = std::make_unique<PersistentPskCache>(path_, 64, 4096);
+    // Times are stored with millisecond precision.
+    ticketTime_ = std::chrono::time_point_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now());
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  void reopen(uint32_t slotCount = 64, uint32_t slotSize = 4096) {
+    cache_.reset();
+    cache_ = std::make_unique<PersistentPskCache>(path_, slotCount, slotSize);
+  }
+
+  std::string fileContents() {
+    std::string contents;
+    EXPECT_TRUE(folly::readFile(path_.c_str(), contents));
+    return contents;
+  }
+
+  folly::test::TemporaryDirectory dir_;
+  std::string path_;
+  std::unique_ptr<PersistentPskCache> cache_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(PersistentPskCacheTest, TestBasic) {
+  auto psk = getCachedPsk();
+  cache_->putPsk("fizz", psk);
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+}
+
+TEST_F(PersistentPskCacheTest, TestMissing) {
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(PersistentPskCacheTest, TestReopen) {
+  auto psk = getCachedPsk();
+  psk.group = folly::none;
+  psk.alpn = folly::none;
+  psk.maxEarlyDataSize = 1000;
+  cache_->putPsk("fizz", psk);
+  cache_->putPsk("other", getCachedPsk("other psk"));
+  cache_->sync();
+  reopen();
+
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+  EXPECT_EQ(cache_->getPsk("other")->psk, "other psk");
+}
+
+TEST_F(PersistentPskCacheTest, TestReplace) {
+  cache_->putPsk("fizz", getCachedPsk("psk 1"));
+  cache_->putPsk("fizz", getCachedPsk("psk 2"));
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 2");
+}
+
+TEST_F(PersistentPskCacheTest, TestRemove) {
+  cache_->putPsk("fizz", getCachedPsk());
+  cache_->removePsk("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  reopen();
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(PersistentPskCacheTest, TestExpired) {
+  ticketTime_ -= std::chrono::seconds(20);
+  cache_->putPsk("fizz", getCachedPsk());
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(PersistentPskCacheTest, TestNoStaleSecrets) {
+  auto removed = getCachedPsk();
+  removed.secret = "removedsecret";
+  cache_->putPsk("removed", removed);
+
+  auto replaced = getCachedPsk("a long ticket that is replaced");
+  replaced.secret = "replacedsecret";
+  cache_->putPsk("replaced", replaced);
+
+  auto tooLarge = getCachedPsk();
+  tooLarge.secret = "toolargesecret";
+  cache_->putPsk("toolarge", tooLarge);
+
+  auto expired = getCachedPsk();
+  expired.secret = "expiredsecret";
+  expired.ticketExpirationTime = ticketTime_ - std::chrono::seconds(10);
+  cache_->putPsk("expired", expired);
+
+  auto contents = fileContents();
+  for (auto secret :
+       {"removedsecret", "replacedsecret", "toolargesecret", "expiredsecret"}) {
+    EXPECT_NE(contents.find(secret), std::string::npos);
+  }
+
+  cache_->removePsk("removed");
+  // The shorter record is written over the start of the longer one.
+  cache_->putPsk("replaced", getCachedPsk("short"));
+  cache_->putPsk("toolarge", getCachedPsk(std::string(8192, 'x')));
+  EXPECT_FALSE(cache_->getPsk("expired"));
+
+  contents = fileContents();
+  for (auto secret : {"removedsecret",
+                      "replacedsecret",
+                      "a long ticket",
+                      "toolargesecret",
+                      "expiredsecret"}) {
+    EXPECT_EQ(contents.find(secret), std::string::npos) << secret;
+  }
+  EXPECT_EQ(cache_->getPsk("replaced")->psk, "short");
+}
+
+TEST_F(PersistentPskCacheTest, TestCerts) {
+  auto psk = getCachedPsk();
+  psk.serverCert = CertUtils::makePeerCert(
+      fizz::test::getCertData(fizz::test::kP256Certificate));
+  psk.clientCert = std::make_shared<const IdentityCert>("client");
+  cache_->putPsk("fizz", psk);
+  cache_->putPsk("other", psk);
+  reopen();
+
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+  EXPECT_EQ(
+      cachedPsk->serverCert->getIdentity(), psk.serverCert->getIdentity());
+  EXPECT_TRUE(cachedPsk->serverCert->getX509());
+  EXPECT_EQ(cachedPsk->clientCert->getIdentity(), "client");
+
+  // The parsed certificate is shared between records with the same one.
+  EXPECT_EQ(cache_->getPsk("other")->serverCert, cachedPsk->serverCert);
+}
+
+TEST_F(PersistentPskCacheTest, TestTooLarge) {
+  cache_->putPsk("fizz", getCachedPsk());
+  cache_->putPsk("fizz", getCachedPsk(std::string(8192, 'x')));
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(PersistentPskCacheTest, TestCorrupted) {
+  cache_->putPsk("fizz", getCachedPsk("corrupt me"));
+  cache_.reset();
+
+  std::string contents;
+  EXPECT_TRUE(folly::readFile(path_.c_str(), contents));
+  auto pos = contents.find("corrupt me");
+  ASSERT_NE(pos, std::string::npos);
+  contents[pos] = 'C';
+  EXPECT_TRUE(folly::writeFile(contents, path_.c_str()));
+
+  reopen();
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  cache_->putPsk("fizz", getCachedPsk());
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "PSK");
+}
+
+TEST_F(PersistentPskCacheTest, TestGeometryChange) {
+  cache_->putPsk("fizz", getCachedPsk());
+  reopen(128);
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  cache_->putPsk("fizz", getCachedPsk());
+  EXPECT_TRUE(cache_->getPsk("fizz"));
+}
+
+TEST_F(PersistentPskCacheTest, TestNotAFile) {
+  EXPECT_TRUE(folly::writeFile(std::string("garbage"), path_.c_str()));
+  reopen();
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(PersistentPskCacheTest, TestLocked) {
+  EXPECT_THROW(PersistentPskCache(path_, 64, 4096), std::runtime_error);
+}
+
+TEST_F(PersistentPskCacheTest, TestInvalidGeometry) {
+  auto path = (dir_.path() / "invalid").string();
+  EXPECT_THROW(PersistentPskCache(path, 0, 4096), std::runtime_error);
+  EXPECT_THROW(PersistentPskCache(path, 64, 100), std::runtime_error);
+}
+
+TEST_F(PersistentPskCacheTest, TestEviction) {
+  for (int i = 0; i < 1000; ++i) {
+    auto pskName = folly::sformat("psk {}", i);
+    cache_->putPsk(pskName, getCachedPsk(pskName));
+  }
+
+  // The most recently added identity is never the one evicted.
+  EXPECT_EQ(cache_->getPsk("psk 999")->psk, "psk 999");
+  size_t cached = 0;
+  for (int i = 0; i < 1000; ++i) {
+    if (cache_->getPsk(folly::sformat("psk {}", i))) {
+      cached++;
+    }
+  }
+  EXPECT_LE(cached, 64u);
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
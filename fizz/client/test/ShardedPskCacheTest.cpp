@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/client/ShardedPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <folly/Format.h>
+
+#include <set>
+#include <thread>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class ShardedPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    cache_ = std::make_unique<ShardedPskCache>(100, 3);
+    ticketTime_ = std::chrono::system_clock::now();
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  CachedPsk getExpiredPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_ - std::chrono::seconds(20));
+  }
+
+  std::unique_ptr<ShardedPskCache> cache_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(ShardedPskCacheTest, TestBasic) {
+  auto psk = getCachedPsk();
+  cache_->putPsk("fizz", psk);
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+
+  // Each ticket is only handed out once.
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestMissing) {
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestRemove) {
+  cache_->putPsk("fizz", getCachedPsk("psk 1"));
+  cache_->putPsk("fizz", getCachedPsk("psk 2"));
+  cache_->removePsk("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestMultipleTickets) {
+  cache_->putPsk("fizz", getCachedPsk("psk 1"));
+  cache_->putPsk("fizz", getCachedPsk("psk 2"));
+  cache_->putPsk("other", getCachedPsk("other psk"));
+
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 2");
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 1");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_EQ(cache_->getPsk("other")->psk, "other psk");
+}
+
+TEST_F(ShardedPskCacheTest, TestPoolLimit) {
+  for (int i : {1, 2, 3, 4}) {
+    cache_->putPsk("fizz", getCachedPsk(folly::sformat("psk {}", i)));
+  }
+
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 4");
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 3");
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "psk 2");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestExpired) {
+  cache_->putPsk("fizz", getExpiredPsk());
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+
+  cache_->putPsk("fizz", getCachedPsk("valid"));
+  cache_->putPsk("fizz", getExpiredPsk("expired"));
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "valid");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestRemoveExpired) {
+  cache_->putPsk("fizz", getCachedPsk("valid"));
+  cache_->putPsk("fizz", getExpiredPsk("expired"));
+  cache_->putPsk("other", getExpiredPsk("expired"));
+  cache_->removeExpired();
+
+  cache_->putPsk("fizz", getCachedPsk("new"));
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "new");
+  EXPECT_EQ(cache_->getPsk("fizz")->psk, "valid");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_FALSE(cache_->getPsk("other"));
+}
+
+TEST_F(ShardedPskCacheTest, TestCleanup) {
+  cache_->putPsk("fizz", getExpiredPsk());
+  cache_->startCleanup(std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  cache_->stopCleanup();
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedPskCacheTest, TestEviction) {
+  cache_ = std::make_unique<ShardedPskCache>(16);
+  for (int i = 0; i < 100; ++i) {
+    auto pskName = folly::sformat("psk {}", i);
+    cache_->putPsk(pskName, getCachedPsk(pskName));
+  }
+
+  // The most recently added identity is never the one evicted.
+  EXPECT_TRUE(cache_->getPsk("psk 99"));
+  size_t cached = 1;
+  for (int i = 0; i < 99; ++i) {
+    if (cache_->getPsk(folly::sformat("psk {}", i))) {
+      cached++;
+    }
+  }
+  EXPECT_LE(cached, 16u);
+}
+
+TEST_F(ShardedPskCacheTest, TestNoTickets) {
+  EXPECT_THROW(ShardedPskCache(100, 0), std::runtime_error);
+}
+
+TEST_F(ShardedPskCacheTest, TestConcurrentSingleUse) {
+  constexpr size_t kTickets = 1000;
+  cache_ = std::make_unique<ShardedPskCache>(100, kTickets);
+  for (size_t i = 0; i < kTickets; ++i) {
+    cache_->putPsk("fizz", getCachedPsk(folly::sformat("psk {}", i)));
+  }
+
+  std::vector<std::vector<std::string>> taken(8);
+  std::vector<std::thread> threads;
+  for (auto& names : taken) {
+    threads.emplace_back([this, &names]() {
+      while (auto psk = cache_->getPsk("fizz")) {
+        names.push_back(psk->psk);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::set<std::string> unique;
+  size_t total = 0;
+  for (const auto& names : taken) {
+    total += names.size();
+    unique.insert(names.begin(), names.end());
+  }
+  EXPECT_EQ(total, kTickets);
+  EXPECT_EQ(unique.size(), kTickets);
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
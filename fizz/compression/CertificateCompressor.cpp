@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/compression/CertificateCompressor.h>
+
+#include <folly/compression/Compression.h>
+
+namespace fizz {
+namespace detail {
+
+// Matches the record layer's handshake message limit so that a small
+// compressed message can't be used to force a large allocation.
+static constexpr uint32_t kMaxUncompressedLength = 0x20000; // 128k
+
+CompressedCertificate compressCertificate(
+    folly::io::Codec& codec,
+    CertificateCompressionAlgorithm algorithm,
+    CertificateMsg cert) {
+  auto encoded = encode(std::move(cert));
+  auto uncompressedLength = encoded->computeChainDataLength();
+  if (uncompressedLength > kMaxUncompressedLength) {
+    throw std::runtime_error("certificate message too large to compress");
+  }
+
+  CompressedCertificate cc;
+  cc.algorithm = algorithm;
+  cc.uncompressed_length = static_cast<uint32_t>(uncompressedLength);
+  cc.compressed_certificate_message = codec.compress(encoded.get());
+  return cc;
+}
+
+CertificateMsg decompressCertificate(
+    folly::io::Codec& codec,
+    const CompressedCertificate& cert) {
+  if (cert.uncompressed_length == 0 ||
+      cert.uncompressed_length > kMaxUncompressedLength) {
+    throw FizzException(
+        "invalid uncompressed certificate length",
+        AlertDescription::bad_certificate);
+  }
+  if (!cert.compressed_certificate_message ||
+      cert.compressed_certificate_message->empty()) {
+    throw FizzException(
+        "empty compressed certificate", AlertDescription::bad_certificate);
+  }
+
+  Buf decompressed;
+  try {
+    decompressed = codec.uncompress(
+        cert.compressed_certificate_message.get(),
+        static_cast<uint64_t>(cert.uncompressed_length));
+  } catch (const std::exception& e) {
+    throw FizzException(
+        folly::to<std::string>(
+            "certificate decompression failed: ", e.what()),
+        AlertDescription::bad_certificate);
+  }
+
+  if (decompressed->computeChainDataLength() != cert.uncompressed_length) {
+    throw FizzException(
+        "decompressed certificate length mismatch",
+        AlertDescription::bad_certificate);
+  }
+
+  try {
+    return decode<CertificateMsg>(std::move(decompressed));
+  } catch (const std::exception& e) {
+    throw FizzException(
+        folly::to<std::string>(
+            "invalid decompressed certificate: ", e.what()),
+        AlertDescription::bad_certificate);
+  }
+}
+
+} // namespace detail
+} // namespace fizz
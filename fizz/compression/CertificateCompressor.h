@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+
+namespace folly {
+namespace io {
+class Codec;
+} // namespace io
+} // namespace folly
+
+namespace fizz {
+
+/**
+ * Compresses certificate messages with a single algorithm (RFC 8879).
+ */
+class CertificateCompressor {
+ public:
+  virtual ~CertificateCompressor() = default;
+
+  virtual CertificateCompressionAlgorithm getAlgorithm() const = 0;
+
+  /**
+   * Compresses the encoded form of cert. Throws on error.
+   */
+  virtual CompressedCertificate compress(CertificateMsg cert) const = 0;
+};
+
+/**
+ * Decompresses certificate messages with a single algorithm (RFC 8879).
+ */
+class CertificateDecompressor {
+ public:
+  virtual ~CertificateDecompressor() = default;
+
+  virtual CertificateCompressionAlgorithm getAlgorithm() const = 0;
+
+  /**
+   * Decompresses and decodes cert. Throws FizzException with bad_certificate
+   * if the message does not decompress to exactly uncompressed_length bytes of
+   * a valid Certificate message.
+   */
+  virtual CertificateMsg decompress(
+      const CompressedCertificate& cert) const = 0;
+};
+
+namespace detail {
+
+CompressedCertificate compressCertificate(
+    folly::io::Codec& codec,
+    CertificateCompressionAlgorithm algorithm,
+    CertificateMsg cert);
+
+CertificateMsg decompressCertificate(
+    folly::io::Codec& codec,
+    const CompressedCertificate& cert);
+
+} // namespace detail
+} // namespace fizz
@@ -0,0 +1,28 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/compression/CertificateCompressor.h>
+
+namespace fizz {
+
+class ZlibCertificateCompressor : public CertificateCompressor,
+                                  public CertificateDecompressor {
+ public:
+  ~ZlibCertificateCompressor() override = default;
+
+  CertificateCompressionAlgorithm getAlgorithm() const override {
+    return CertificateCompressionAlgorithm::zlib;
+  }
+
+  CompressedCertificate compress(CertificateMsg cert) const override;
+
+  CertificateMsg decompress(const CompressedCertificate& cert) const override;
+};
+} // namespace fizz
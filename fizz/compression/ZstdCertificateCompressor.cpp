@@ -0,0 +1,30 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/compression/ZstdCertificateCompressor.h>
+
+#include <folly/compression/Compression.h>
+
+namespace fizz {
+
+CompressedCertificate ZstdCertificateCompressor::compress(
+    CertificateMsg cert) const {
+  auto codec = folly::io::getCodec(
+      folly::io::CodecType::ZSTD, folly::io::COMPRESSION_LEVEL_BEST);
+  return detail::compressCertificate(*codec, getAlgorithm(), std::move(cert));
+}
+
+CertificateMsg ZstdCertificateCompressor::decompress(
+    const CompressedCertificate& cert) const {
+  if (cert.algorithm != getAlgorithm()) {
+    throw std::runtime_error("compressed certificate is not zstd");
+  }
+  auto codec = folly::io::getCodec(folly::io::CodecType::ZSTD);
+  return detail::decompressCertificate(*codec, cert);
+}
+} // namespace fizz
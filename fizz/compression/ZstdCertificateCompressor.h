@@ -0,0 +1,32 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/compression/CertificateCompressor.h>
+
+namespace fizz {
+
+/**
+ * Requires folly to be built with zstd support; compress() and decompress()
+ * throw otherwise.
+ */
+class ZstdCertificateCompressor : public CertificateCompressor,
+                                  public CertificateDecompressor {
+ public:
+  ~ZstdCertificateCompressor() override = default;
+
+  CertificateCompressionAlgorithm getAlgorithm() const override {
+    return CertificateCompressionAlgorithm::zstd;
+  }
+
+  CompressedCertificate compress(CertificateMsg cert) const override;
+
+  CertificateMsg decompress(const CompressedCertificate& cert) const override;
+};
+} // namespace fizz
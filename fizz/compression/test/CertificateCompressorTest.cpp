@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/compression/ZlibCertificateCompressor.h>
+#include <fizz/compression/ZstdCertificateCompressor.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/Certificate.h>
+#include <folly/compression/Compression.h>
+#include <folly/io/IOBufQueue.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+class CertificateCompressorTest : public Test {
+ public:
+  void SetUp() override {
+    OpenSSL_add_all_algorithms();
+  }
+
+  CertificateMsg getCertMsg() {
+    std::vector<ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kP256Certificate));
+    certs.emplace_back(getCert(kRSACertificate));
+    return CertUtils::getCertMessage(certs, nullptr);
+  }
+
+ protected:
+  ZlibCertificateCompressor zlib_;
+};
+
+TEST_F(CertificateCompressorTest, TestZlibRoundTrip) {
+  auto compressed = zlib_.compress(getCertMsg());
+  EXPECT_EQ(compressed.algorithm, CertificateCompressionAlgorithm::zlib);
+  EXPECT_EQ(
+      compressed.uncompressed_length,
+      encode(getCertMsg())->computeChainDataLength());
+  EXPECT_LT(
+      compressed.compressed_certificate_message->computeChainDataLength(),
+      compressed.uncompressed_length);
+
+  auto decompressed = zlib_.decompress(compressed);
+  EXPECT_TRUE(IOBufEqualTo()(
+      encode(std::move(decompressed)), encode(getCertMsg())));
+}
+
+TEST_F(CertificateCompressorTest, TestZstdRoundTrip) {
+  if (!io::hasCodec(io::CodecType::ZSTD)) {
+    // folly was built without zstd.
+    return;
+  }
+  ZstdCertificateCompressor zstd;
+  auto compressed = zstd.compress(getCertMsg());
+  EXPECT_EQ(compressed.algorithm, CertificateCompressionAlgorithm::zstd);
+  EXPECT_EQ(
+      compressed.uncompressed_length,
+      encode(getCertMsg())->computeChainDataLength());
+
+  auto decompressed = zstd.decompress(compressed);
+  EXPECT_TRUE(IOBufEqualTo()(
+      encode(std::move(decompressed)), encode(getCertMsg())));
+
+  compressed.algorithm = CertificateCompressionAlgorithm::zlib;
+  EXPECT_THROW(zstd.decompress(compressed), std::runtime_error);
+}
+
+TEST_F(CertificateCompressorTest, TestEncodeDecode) {
+  auto compressed = zlib_.compress(getCertMsg());
+  auto uncompressedLength = compressed.uncompressed_length;
+  auto compressedData = compressed.compressed_certificate_message->clone();
+
+  auto encoded = encodeHandshake(std::move(compressed));
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  queue.append(std::move(encoded));
+  queue.trimStart(4);
+  auto decoded = decode<CompressedCertificate>(queue.move());
+  EXPECT_EQ(decoded.algorithm, CertificateCompressionAlgorithm::zlib);
+  EXPECT_EQ(decoded.uncompressed_length, uncompressedLength);
+  EXPECT_TRUE(
+      IOBufEqualTo()(decoded.compressed_certificate_message, compressedData));
+}
+
+TEST_F(CertificateCompressorTest, TestLengthMismatch) {
+  auto compressed = zlib_.compress(getCertMsg());
+  compressed.uncompressed_length -= 1;
+  EXPECT_THROW(zlib_.decompress(compressed), FizzException);
+}
+
+TEST_F(CertificateCompressorTest, TestBadData) {
+  auto compressed = zlib_.compress(getCertMsg());
+  compressed.compressed_certificate_message = IOBuf::copyBuffer("garbage");
+  EXPECT_THROW(zlib_.decompress(compressed), FizzException);
+}
+
+TEST_F(CertificateCompressorTest, TestWrongAlgorithm) {
+  auto compressed = zlib_.compress(getCertMsg());
+  compressed.algorithm = CertificateCompressionAlgorithm::zstd;
+  EXPECT_THROW(zlib_.decompress(compressed), std::runtime_error);
+}
+
+TEST_F(CertificateCompressorTest, TestSelfCertCache) {
+  std::vector<ssl::X509UniquePtr> certs;
+  certs.emplace_back(getCert(kP256Certificate));
+  SelfCertImpl<KeyType::P256> cert(
+      getPrivateKey(kP256Key),
+      std::move(certs),
+      {std::make_shared<ZlibCertificateCompressor>()});
+
+  EXPECT_FALSE(cert.getCompressedCert(CertificateCompressionAlgorithm::zstd));
+  auto compressed =
+      cert.getCompressedCert(CertificateCompressionAlgorithm::zlib);
+  ASSERT_TRUE(compressed);
+  auto decompressed = zlib_.decompress(*compressed);
+  EXPECT_TRUE(IOBufEqualTo()(
+      encode(std::move(decompressed)), encode(cert.getCertMessage())));
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Likely.h>
+
+#include <cstring>
+
+namespace fizz {
+
+template <typename Hash>
+typename KeyScheduleEngine<Hash>::Secret KeyScheduleEngine<Hash>::extract(
+    folly::ByteRange salt,
+    folly::ByteRange ikm) {
+  static const Secret kZeros{};
+  salt = salt.empty() ? folly::range(kZeros) : salt;
+  Secret out;
+  unsigned int len = 0;
+  if (!HMAC(
+          Hash::HashEngine(),
+          salt.data(),
+          salt.size(),
+          ikm.data(),
+          ikm.size(),
+          out.data(),
+          &len) ||
+      len != HashLen) {
+    throw std::runtime_error("HKDF extract failed");
+  }
+  return out;
+}
+
+template <typename Hash>
+folly::ByteRange KeyScheduleEngine<Hash>::encodeLabel(
+    folly::StringPiece label,
+    folly::ByteRange context,
+    uint16_t length,
+    LabelBuffer& buf) {
+  static constexpr folly::StringPiece kLabelPrefix = "tls13 ";
+  if (kLabelPrefix.size() + label.size() > 255 || context.size() > 255) {
+    throw std::runtime_error("HKDF label too long");
+  }
+  size_t offset = 0;
+  buf[offset++] = static_cast<uint8_t>(length >> 8);
+  buf[offset++] = static_cast<uint8_t>(length);
+  buf[offset++] = static_cast<uint8_t>(kLabelPrefix.size() + label.size());
+  memcpy(buf.data() + offset, kLabelPrefix.data(), kLabelPrefix.size());
+  offset += kLabelPrefix.size();
+  memcpy(buf.data() + offset, label.data(), label.size());
+  offset += label.size();
+  buf[offset++] = static_cast<uint8_t>(context.size());
+  if (!context.empty()) {
+    memcpy(buf.data() + offset, context.data(), context.size());
+    offset += context.size();
+  }
+  return folly::ByteRange(buf.data(), offset);
+}
+
+template <typename Hash>
+void KeyScheduleEngine<Hash>::expand(
+    const PrecomputedHmac<Hash>& secret,
+    folly::ByteRange info,
+    folly::MutableByteRange out) {
+  if (UNLIKELY(out.size() > 255 * HashLen)) {
+    throw std::runtime_error("Output too long");
+  }
+  Secret t;
+  size_t offset = 0;
+  for (uint8_t round = 1; offset < out.size(); ++round) {
+    folly::ByteRange roundNum(&round, 1);
+    if (round == 1) {
+      secret.hmac({info, roundNum}, folly::range(t));
+    } else {
+      secret.hmac({folly::range(t), info, roundNum}, folly::range(t));
+    }
+    size_t length = std::min(HashLen, out.size() - offset);
+    memcpy(out.data() + offset, t.data(), length);
+    offset += length;
+  }
+}
+
+template <typename Hash>
+void KeyScheduleEngine<Hash>::expandLabel(
+    const PrecomputedHmac<Hash>& secret,
+    folly::StringPiece label,
+    folly::ByteRange context,
+    folly::MutableByteRange out) {
+  LabelBuffer buf;
+  expand(secret, encodeLabel(label, context, out.size(), buf), out);
+}
+
+template <typename Hash>
+typename KeyScheduleEngine<Hash>::Secret KeyScheduleEngine<Hash>::deriveSecret(
+    const PrecomputedHmac<Hash>& secret,
+    folly::StringPiece label,
+    folly::ByteRange messageHash) {
+  CHECK_EQ(messageHash.size(), HashLen);
+  Secret out;
+  expandLabel(secret, label, messageHash, folly::range(out));
+  return out;
+}
+} // namespace fizz
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/PrecomputedHmac.h>
+#include <fizz/crypto/Sha256.h>
+#include <fizz/crypto/Sha384.h>
+
+#include <array>
+
+namespace fizz {
+
+/**
+ * Allocation-free TLS 1.3 HKDF primitives for a fixed hash. Secrets are kept
+ * in fixed-size arrays and paired with their precomputed HMAC key state, so
+ * deriving several labels from the same secret only keys the HMAC once.
+ */
+template <typename Hash>
+class KeyScheduleEngine {
+ public:
+  static constexpr size_t HashLen = Hash::HashLen;
+
+  using Secret = std::array<uint8_t, HashLen>;
+
+  /**
+   * Large enough for any HkdfLabel: length, label<7..255>, context<0..255>.
+   */
+  using LabelBuffer = std::array<uint8_t, 2 + 1 + 255 + 1 + 255>;
+
+  /**
+   * A secret along with its HMAC key state. The secret is cleansed when it
+   * is cleared or destroyed.
+   */
+  class KeyedSecret {
+   public:
+    KeyedSecret() = default;
+    KeyedSecret(KeyedSecret&&) = default;
+    KeyedSecret& operator=(KeyedSecret&&) = default;
+
+    ~KeyedSecret() {
+      OPENSSL_cleanse(secret_.data(), secret_.size());
+    }
+
+    void set(const Secret& secret) {
+      secret_ = secret;
+      hmac_.setKey(folly::range(secret_));
+    }
+
+    const Secret& secret() const {
+      return secret_;
+    }
+
+    const PrecomputedHmac<Hash>& hmac() const {
+      return hmac_;
+    }
+
+    void clear() {
+      OPENSSL_cleanse(secret_.data(), secret_.size());
+      hmac_.reset();
+    }
+
+   private:
+    Secret secret_{};
+    PrecomputedHmac<Hash> hmac_;
+  };
+
+  /**
+   * HKDF-Extract(salt, ikm).
+   */
+  static Secret extract(folly::ByteRange salt, folly::ByteRange ikm);
+
+  /**
+   * Encodes the HkdfLabel for label and context into buf, returning the
+   * encoded range.
+   */
+  static folly::ByteRange encodeLabel(
+      folly::StringPiece label,
+      folly::ByteRange context,
+      uint16_t length,
+      LabelBuffer& buf);
+
+  /**
+   * HKDF-Expand(secret, info, out.size()) into out.
+   */
+  static void expand(
+      const PrecomputedHmac<Hash>& secret,
+      folly::ByteRange info,
+      folly::MutableByteRange out);
+
+  /**
+   * HKDF-Expand-Label(secret, label, context, out.size()) into out.
+   */
+  static void expandLabel(
+      const PrecomputedHmac<Hash>& secret,
+      folly::StringPiece label,
+      folly::ByteRange context,
+      folly::MutableByteRange out);
+
+  /**
+   * Derive-Secret(secret, label, messages) given the transcript hash.
+   */
+  static Secret deriveSecret(
+      const PrecomputedHmac<Hash>& secret,
+      folly::StringPiece label,
+      folly::ByteRange messageHash);
+};
+} // namespace fizz
+
+#include <fizz/crypto/KeyScheduleEngine-inl.h>
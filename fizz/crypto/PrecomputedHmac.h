@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Range.h>
+#include <folly/portability/OpenSSL.h>
+#include <glog/logging.h>
+#include <openssl/hmac.h>
+
+#include <initializer_list>
+#include <memory>
+
+namespace fizz {
+
+/**
+ * HMAC with a fixed key. The inner and outer padded key states are computed
+ * once in setKey() and copied for every hmac() call, instead of rehashing the
+ * key blocks each time.
+ *
+ * Not thread safe: hmac() reuses a scratch context.
+ */
+template <typename Hash>
+class PrecomputedHmac {
+ public:
+  PrecomputedHmac() = default;
+
+  explicit PrecomputedHmac(folly::ByteRange key) {
+    setKey(key);
+  }
+
+  void setKey(folly::ByteRange key) {
+    if (!keyed_) {
+      keyed_.reset(HMAC_CTX_new());
+      if (!keyed_) {
+        throw std::runtime_error("Could not allocate HMAC_CTX");
+      }
+    }
+    if (HMAC_Init_ex(
+            keyed_.get(),
+            key.data(),
+            key.size(),
+            Hash::HashEngine(),
+            nullptr) != 1) {
+      throw std::runtime_error("Could not initialize HMAC key");
+    }
+  }
+
+  /**
+   * Frees the key state and scratch context; HMAC_CTX_free cleanses them.
+   * hmac() throws until setKey() is called again.
+   */
+  void reset() {
+    keyed_.reset();
+    scratch_.reset();
+  }
+
+  bool hasKey() const {
+    return keyed_ != nullptr;
+  }
+
+  /**
+   * Puts HMAC(key, in[0] || in[1] || ...) into out. Out must be at least of
+   * size HashLen.
+   */
+  void hmac(
+      std::initializer_list<folly::ByteRange> in,
+      folly::MutableByteRange out) const {
+    if (!keyed_) {
+      throw std::runtime_error("HMAC key not set");
+    }
+    CHECK_GE(out.size(), Hash::HashLen);
+    if (!scratch_) {
+      scratch_.reset(HMAC_CTX_new());
+      if (!scratch_) {
+        throw std::runtime_error("Could not allocate HMAC_CTX");
+      }
+    }
+    if (HMAC_CTX_copy(scratch_.get(), keyed_.get()) != 1) {
+      throw std::runtime_error("Could not copy HMAC state");
+    }
+    for (auto range : in) {
+      if (HMAC_Update(scratch_.get(), range.data(), range.size()) != 1) {
+        throw std::runtime_error("Could not update HMAC");
+      }
+    }
+    unsigned int len = 0;
+    if (HMAC_Final(scratch_.get(), out.data(), &len) != 1) {
+      throw std::runtime_error("Could not finalize HMAC");
+    }
+    DCHECK_EQ(len, Hash::HashLen);
+  }
+
+ private:
+  struct HmacCtxDeleter {
+    void operator()(HMAC_CTX* ctx) const {
+      HMAC_CTX_free(ctx);
+    }
+  };
+  using HmacCtxPtr = std::unique_ptr<HMAC_CTX, HmacCtxDeleter>;
+
+  HmacCtxPtr keyed_;
+  mutable HmacCtxPtr scratch_;
+};
+} // namespace fizz
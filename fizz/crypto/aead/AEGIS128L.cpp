@@ -0,0 +1,417 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/aead/AEGIS128L.h>
+
+#include <fizz/crypto/aead/AESGCMNative.h>
+#include <fizz/crypto/aead/IOBufUtil.h>
+#include <folly/lang/Bits.h>
+#include <openssl/crypto.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if FIZZ_AESGCM_NATIVE_X86
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define FIZZ_AEGIS_TARGET \
+  __attribute__((target("aes,sse4.1"), always_inline)) inline
+#define FIZZ_AEGIS_ENTRY __attribute__((target("aes,sse4.1")))
+#endif
+
+namespace fizz {
+namespace detail {
+
+#if FIZZ_AESGCM_NATIVE_X86
+
+namespace {
+
+// Fibonacci sequence mod 256, the initialization constants from the spec.
+const uint8_t kC0[16] = {
+    0x00, 0x01, 0x01, 0x02, 0x03, 0x05, 0x08, 0x0d,
+    0x15, 0x22, 0x37, 0x59, 0x90, 0xe9, 0x79, 0x62};
+const uint8_t kC1[16] = {
+    0xdb, 0x3d, 0x18, 0x55, 0x6d, 0xc2, 0x2f, 0xf1,
+    0x20, 0x11, 0x31, 0x42, 0x73, 0xb5, 0x28, 0xdd};
+
+FIZZ_AEGIS_TARGET __m128i load(const uint8_t* in) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+}
+
+FIZZ_AEGIS_TARGET void store(uint8_t* out, __m128i v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+}
+
+/**
+ * The state is kept in registers while a call processes its input and
+ * written back to the record between calls.
+ */
+struct State {
+  FIZZ_AEGIS_TARGET explicit State(const uint8_t* bytes) {
+    for (size_t i = 0; i < 8; ++i) {
+      s[i] = load(bytes + 16 * i);
+    }
+  }
+
+  FIZZ_AEGIS_TARGET void save(uint8_t* bytes) const {
+    for (size_t i = 0; i < 8; ++i) {
+      store(bytes + 16 * i, s[i]);
+    }
+  }
+
+  /**
+   * Absorbs the 32 byte block m0 || m1. The eight AES rounds are independent
+   * of each other, so they pipeline through the AES unit.
+   */
+  FIZZ_AEGIS_TARGET void update(__m128i m0, __m128i m1) {
+    __m128i last = s[7];
+    s[7] = _mm_aesenc_si128(s[6], s[7]);
+    s[6] = _mm_aesenc_si128(s[5], s[6]);
+    s[5] = _mm_aesenc_si128(s[4], s[5]);
+    s[4] = _mm_aesenc_si128(s[3], _mm_xor_si128(s[4], m1));
+    s[3] = _mm_aesenc_si128(s[2], s[3]);
+    s[2] = _mm_aesenc_si128(s[1], s[2]);
+    s[1] = _mm_aesenc_si128(s[0], s[1]);
+    s[0] = _mm_aesenc_si128(last, _mm_xor_si128(s[0], m0));
+  }
+
+  FIZZ_AEGIS_TARGET void keystream(__m128i& z0, __m128i& z1) const {
+    z0 = _mm_xor_si128(
+        _mm_xor_si128(s[6], s[1]), _mm_and_si128(s[2], s[3]));
+    z1 = _mm_xor_si128(
+        _mm_xor_si128(s[2], s[5]), _mm_and_si128(s[6], s[7]));
+  }
+
+  __m128i s[8];
+};
+
+template <bool Encrypt>
+FIZZ_AEGIS_TARGET void
+cryptBlocks(State& state, const uint8_t* in, uint8_t* out, size_t len) {
+  for (size_t i = 0; i < len; i += 32) {
+    __m128i z0, z1;
+    state.keystream(z0, z1);
+    __m128i in0 = load(in + i);
+    __m128i in1 = load(in + i + 16);
+    __m128i out0 = _mm_xor_si128(in0, z0);
+    __m128i out1 = _mm_xor_si128(in1, z1);
+    store(out + i, out0);
+    store(out + i + 16, out1);
+    if (Encrypt) {
+      state.update(in0, in1);
+    } else {
+      state.update(out0, out1);
+    }
+  }
+}
+
+FIZZ_AEGIS_ENTRY void
+initState(uint8_t* bytes, const uint8_t* key, const uint8_t* nonce) {
+  __m128i k = load(key);
+  __m128i n = load(nonce);
+  __m128i c0 = load(kC0);
+  __m128i c1 = load(kC1);
+  __m128i kn = _mm_xor_si128(k, n);
+  store(bytes, kn);
+  store(bytes + 16, c1);
+  store(bytes + 32, c0);
+  store(bytes + 48, c1);
+  store(bytes + 64, kn);
+  store(bytes + 80, _mm_xor_si128(k, c0));
+  store(bytes + 96, _mm_xor_si128(k, c1));
+  store(bytes + 112, _mm_xor_si128(k, c0));
+  State state(bytes);
+  for (size_t i = 0; i < 10; ++i) {
+    state.update(n, k);
+  }
+  state.save(bytes);
+}
+} // namespace
+
+bool aegis128lSupported() {
+  static const bool supported = [] {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    return (ecx & bit_AES) && (ecx & bit_SSE4_1);
+  }();
+  return supported;
+}
+
+AEGIS128LRecord::AEGIS128LRecord(const uint8_t* key, const uint8_t* nonce) {
+  initState(state_, key, nonce);
+}
+
+AEGIS128LRecord::~AEGIS128LRecord() {
+  OPENSSL_cleanse(state_, sizeof(state_));
+  OPENSSL_cleanse(keystream_, sizeof(keystream_));
+  OPENSSL_cleanse(pending_, sizeof(pending_));
+}
+
+FIZZ_AEGIS_ENTRY void AEGIS128LRecord::addAad(const uint8_t* in, size_t len) {
+  if (aadDone_) {
+    throw std::runtime_error("associated data after payload");
+  }
+  aadLen_ += len;
+  State state(state_);
+  while (len > 0) {
+    if (pendingLen_ == 0 && len >= 32) {
+      state.update(load(in), load(in + 16));
+      in += 32;
+      len -= 32;
+      continue;
+    }
+    size_t take = std::min(len, 32 - pendingLen_);
+    memcpy(pending_ + pendingLen_, in, take);
+    pendingLen_ += take;
+    in += take;
+    len -= take;
+    if (pendingLen_ == 32) {
+      state.update(load(pending_), load(pending_ + 16));
+      pendingLen_ = 0;
+    }
+  }
+  state.save(state_);
+}
+
+FIZZ_AEGIS_ENTRY void AEGIS128LRecord::finishAad() {
+  if (pendingLen_ != 0) {
+    memset(pending_ + pendingLen_, 0, 32 - pendingLen_);
+    State state(state_);
+    state.update(load(pending_), load(pending_ + 16));
+    state.save(state_);
+    pendingLen_ = 0;
+  }
+  aadDone_ = true;
+}
+
+template <bool Encrypt>
+FIZZ_AEGIS_ENTRY void
+AEGIS128LRecord::crypt(const uint8_t* in, uint8_t* out, size_t len) {
+  if (!aadDone_) {
+    finishAad();
+  }
+  dataLen_ += len;
+  State state(state_);
+
+  // Finish a block split across buffers with its saved keystream.
+  while (pendingLen_ != 0 && len > 0) {
+    uint8_t inByte = *in++;
+    uint8_t outByte = inByte ^ keystream_[pendingLen_];
+    *out++ = outByte;
+    pending_[pendingLen_++] = Encrypt ? inByte : outByte;
+    --len;
+    if (pendingLen_ == 32) {
+      state.update(load(pending_), load(pending_ + 16));
+      pendingLen_ = 0;
+    }
+  }
+
+  size_t whole = len & ~static_cast<size_t>(31);
+  cryptBlocks<Encrypt>(state, in, out, whole);
+  in += whole;
+  out += whole;
+  len -= whole;
+
+  if (len != 0) {
+    __m128i z0, z1;
+    state.keystream(z0, z1);
+    store(keystream_, z0);
+    store(keystream_ + 16, z1);
+    for (size_t i = 0; i < len; ++i) {
+      uint8_t inByte = in[i];
+      uint8_t outByte = inByte ^ keystream_[i];
+      out[i] = outByte;
+      pending_[i] = Encrypt ? inByte : outByte;
+    }
+    pendingLen_ = len;
+  }
+  state.save(state_);
+}
+
+void AEGIS128LRecord::encrypt(const uint8_t* in, uint8_t* out, size_t len) {
+  crypt<true>(in, out, len);
+}
+
+void AEGIS128LRecord::decrypt(const uint8_t* in, uint8_t* out, size_t len) {
+  crypt<false>(in, out, len);
+}
+
+FIZZ_AEGIS_ENTRY void AEGIS128LRecord::tag(uint8_t* out) {
+  if (!aadDone_) {
+    finishAad();
+  }
+  State state(state_);
+  if (pendingLen_ != 0) {
+    memset(pending_ + pendingLen_, 0, 32 - pendingLen_);
+    state.update(load(pending_), load(pending_ + 16));
+    pendingLen_ = 0;
+  }
+  __m128i lengths = _mm_set_epi64x(
+      static_cast<int64_t>(dataLen_ * 8), static_cast<int64_t>(aadLen_ * 8));
+  __m128i t = _mm_xor_si128(state.s[2], lengths);
+  for (size_t i = 0; i < 7; ++i) {
+    state.update(t, t);
+  }
+  __m128i result = state.s[0];
+  for (size_t i = 1; i < 7; ++i) {
+    result = _mm_xor_si128(result, state.s[i]);
+  }
+  store(out, result);
+  state.save(state_);
+}
+
+#else
+
+bool aegis128lSupported() {
+  return false;
+}
+
+AEGIS128LRecord::AEGIS128LRecord(const uint8_t*, const uint8_t*) {
+  throw std::runtime_error("AEGIS-128L not supported on this platform");
+}
+
+AEGIS128LRecord::~AEGIS128LRecord() {}
+
+void AEGIS128LRecord::addAad(const uint8_t*, size_t) {}
+
+void AEGIS128LRecord::finishAad() {}
+
+void AEGIS128LRecord::encrypt(const uint8_t*, uint8_t*, size_t) {}
+
+void AEGIS128LRecord::decrypt(const uint8_t*, uint8_t*, size_t) {}
+
+void AEGIS128LRecord::tag(uint8_t*) {}
+
+#endif
+} // namespace detail
+
+AEGIS128L::~AEGIS128L() {
+  OPENSSL_cleanse(key_.data(), key_.size());
+  OPENSSL_cleanse(iv_.data(), iv_.size());
+}
+
+void AEGIS128L::setKey(TrafficKey trafficKey) {
+  if (!isSupported()) {
+    throw std::runtime_error("AEGIS-128L requires AES-NI");
+  }
+  trafficKey.key->coalesce();
+  trafficKey.iv->coalesce();
+  if (trafficKey.key->length() != kKeyLength) {
+    throw std::runtime_error("Invalid key");
+  }
+  if (trafficKey.iv->length() != kIVLength) {
+    throw std::runtime_error("Invalid IV");
+  }
+  memcpy(key_.data(), trafficKey.key->data(), key_.size());
+  memcpy(iv_.data(), trafficKey.iv->data(), iv_.size());
+}
+
+std::unique_ptr<folly::IOBuf> AEGIS128L::encrypt(
+    std::unique_ptr<folly::IOBuf>&& plaintext,
+    const folly::IOBuf* associatedData,
+    uint64_t seqNum) const {
+  auto inputLength = plaintext->computeChainDataLength();
+  std::unique_ptr<folly::IOBuf> output;
+  folly::IOBuf* input;
+  if (plaintext->isShared()) {
+    output = folly::IOBuf::create(headroom_ + inputLength + kTagLength);
+    output->advance(headroom_);
+    output->append(inputLength);
+    input = plaintext.get();
+  } else {
+    output = std::move(plaintext);
+    input = output.get();
+  }
+
+  auto iv = createIV(seqNum);
+  detail::AEGIS128LRecord record(key_.data(), iv.data());
+  if (associatedData) {
+    for (auto current : *associatedData) {
+      record.addAad(current.data(), current.size());
+    }
+  }
+  transformBuffer(
+      *input, *output, [&](uint8_t* out, const uint8_t* in, size_t len) {
+        record.encrypt(in, out, len);
+      });
+
+  auto lastBuf = output->prev();
+  if (lastBuf->tailroom() < kTagLength) {
+    auto tag = folly::IOBuf::create(kTagLength);
+    record.tag(tag->writableData());
+    tag->append(kTagLength);
+    output->prependChain(std::move(tag));
+  } else {
+    record.tag(lastBuf->writableTail());
+    lastBuf->append(kTagLength);
+  }
+  return output;
+}
+
+folly::Optional<std::unique_ptr<folly::IOBuf>> AEGIS128L::tryDecrypt(
+    std::unique_ptr<folly::IOBuf>&& ciphertext,
+    const folly::IOBuf* associatedData,
+    uint64_t seqNum) const {
+  auto inputLength = ciphertext->computeChainDataLength();
+  if (inputLength < kTagLength) {
+    return folly::none;
+  }
+  inputLength -= kTagLength;
+
+  std::array<uint8_t, kTagLength> tag;
+  trimBytes(*ciphertext, folly::range(tag));
+  folly::IOBuf* input;
+  std::unique_ptr<folly::IOBuf> output;
+  if (ciphertext->isShared()) {
+    output = folly::IOBuf::create(inputLength);
+    output->append(inputLength);
+    input = ciphertext.get();
+  } else {
+    output = std::move(ciphertext);
+    input = output.get();
+  }
+
+  auto iv = createIV(seqNum);
+  detail::AEGIS128LRecord record(key_.data(), iv.data());
+  if (associatedData) {
+    for (auto current : *associatedData) {
+      record.addAad(current.data(), current.size());
+    }
+  }
+  transformBuffer(
+      *input, *output, [&](uint8_t* out, const uint8_t* in, size_t len) {
+        record.decrypt(in, out, len);
+      });
+
+  std::array<uint8_t, kTagLength> expectedTag;
+  record.tag(expectedTag.data());
+  if (CRYPTO_memcmp(expectedTag.data(), tag.data(), kTagLength) != 0) {
+    return folly::none;
+  }
+  return std::move(output);
+}
+
+std::array<uint8_t, AEGIS128L::kIVLength> AEGIS128L::createIV(
+    uint64_t seqNum) const {
+  std::array<uint8_t, kIVLength> iv;
+  uint64_t bigEndianSeqNum = folly::Endian::big(seqNum);
+  const size_t prefixLength = kIVLength - sizeof(uint64_t);
+  memset(iv.data(), 0, prefixLength);
+  memcpy(iv.data() + prefixLength, &bigEndianSeqNum, 8);
+  XOR(folly::range(iv_), folly::range(iv));
+  return iv;
+}
+
+constexpr size_t AEGIS128L::kKeyLength;
+constexpr size_t AEGIS128L::kIVLength;
+constexpr size_t AEGIS128L::kTagLength;
+} // namespace fizz
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/aead/Aead.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fizz {
+namespace detail {
+
+/**
+ * Returns true if the CPU supports the AES-NI instructions AEGIS-128L needs.
+ */
+bool aegis128lSupported();
+
+/**
+ * Seals or opens a single AEGIS-128L record. Like AESGCMNativeRecord, the
+ * associated data must all be added before the payload, and the payload may
+ * be supplied in pieces of any size.
+ */
+class AEGIS128LRecord {
+ public:
+  AEGIS128LRecord(const uint8_t* key, const uint8_t* nonce);
+  ~AEGIS128LRecord();
+
+  void addAad(const uint8_t* in, size_t len);
+
+  void encrypt(const uint8_t* in, uint8_t* out, size_t len);
+
+  void decrypt(const uint8_t* in, uint8_t* out, size_t len);
+
+  /**
+   * Writes the 16 byte tag. Must be called last.
+   */
+  void tag(uint8_t* out);
+
+ private:
+  void finishAad();
+
+  template <bool Encrypt>
+  void crypt(const uint8_t* in, uint8_t* out, size_t len);
+
+  // The eight 128-bit state words S0..S7.
+  uint8_t state_[8 * 16];
+  // Keystream for a 32 byte block split across input buffers.
+  uint8_t keystream_[32];
+  // Plaintext (or associated data) of the current incomplete block.
+  uint8_t pending_[32];
+  size_t pendingLen_{0};
+  size_t aadLen_{0};
+  size_t dataLen_{0};
+  bool aadDone_{false};
+};
+} // namespace detail
+
+/**
+ * The AEGIS-128L authenticated cipher (draft-irtf-cfrg-aegis-aead) with a
+ * 128-bit nonce and tag. Each 32 byte block costs eight parallel AES rounds,
+ * so on AES-NI hardware it runs several times faster than AES-GCM. It is
+ * only available when isSupported() is true; there is no portable fallback.
+ */
+class AEGIS128L final : public Aead {
+ public:
+  static constexpr size_t kKeyLength = 16;
+  static constexpr size_t kIVLength = 16;
+  static constexpr size_t kTagLength = 16;
+
+  AEGIS128L() = default;
+  ~AEGIS128L() override;
+
+  static bool isSupported() {
+    return detail::aegis128lSupported();
+  }
+
+  void setKey(TrafficKey trafficKey) override;
+
+  size_t keyLength() const override {
+    return kKeyLength;
+  }
+
+  size_t ivLength() const override {
+    return kIVLength;
+  }
+
+  std::unique_ptr<folly::IOBuf> encrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  folly::Optional<std::unique_ptr<folly::IOBuf>> tryDecrypt(
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  size_t getCipherOverhead() const override {
+    return kTagLength;
+  }
+
+  bool supportsConcurrentUse() const override {
+    return true;
+  }
+
+  void setEncryptedBufferHeadroom(size_t headroom) override {
+    headroom_ = headroom;
+  }
+
+ private:
+  std::array<uint8_t, kIVLength> createIV(uint64_t seqNum) const;
+
+  std::array<uint8_t, kKeyLength> key_;
+  std::array<uint8_t, kIVLength> iv_;
+  size_t headroom_{5};
+};
+} // namespace fizz
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/lang/Bits.h>
+#include <openssl/crypto.h>
+
+namespace fizz {
+
+template <typename AESImpl>
+AESGCMNative<AESImpl>::~AESGCMNative() {
+  OPENSSL_cleanse(&key_, sizeof(key_));
+  OPENSSL_cleanse(iv_.data(), iv_.size());
+}
+
+template <typename AESImpl>
+void AESGCMNative<AESImpl>::setKey(TrafficKey trafficKey) {
+  trafficKey.key->coalesce();
+  trafficKey.iv->coalesce();
+  if (trafficKey.key->length() != AESImpl::kKeyLength) {
+    throw std::runtime_error("Invalid key");
+  }
+  if (trafficKey.iv->length() != AESImpl::kIVLength) {
+    throw std::runtime_error("Invalid IV");
+  }
+  detail::aesGcmNativeSetKey(
+      key_, trafficKey.key->data(), trafficKey.key->length());
+  memcpy(iv_.data(), trafficKey.iv->data(), iv_.size());
+}
+
+template <typename AESImpl>
+std::unique_ptr<folly::IOBuf> AESGCMNative<AESImpl>::encrypt(
+    std::unique_ptr<folly::IOBuf>&& plaintext,
+    const folly::IOBuf* associatedData,
+    uint64_t seqNum) const {
+  constexpr size_t tagLen = AESImpl::kTagLength;
+  auto inputLength = plaintext->computeChainDataLength();
+  std::unique_ptr<folly::IOBuf> output;
+  folly::IOBuf* input;
+  if (plaintext->isShared()) {
+    output = folly::IOBuf::create(headroom_ + inputLength + tagLen);
+    output->advance(headroom_);
+    output->append(inputLength);
+    input = plaintext.get();
+  } else {
+    output = std::move(plaintext);
+    input = output.get();
+  }
+
+  auto iv = createIV(seqNum);
+  detail::AESGCMNativeRecord record(key_, iv.data());
+  if (associatedData) {
+    for (auto current : *associatedData) {
+      record.addAad(current.data(), current.size());
+    }
+  }
+  transformBuffer(
+      *input, *output, [&](uint8_t* out, const uint8_t* in, size_t len) {
+        record.encrypt(in, out, len);
+      });
+
+  auto lastBuf = output->prev();
+  if (lastBuf->tailroom() < tagLen) {
+    auto tag = folly::IOBuf::create(tagLen);
+    record.tag(tag->writableData());
+    tag->append(tagLen);
+    output->prependChain(std::move(tag));
+  } else {
+    record.tag(lastBuf->writableTail());
+    lastBuf->append(tagLen);
+  }
+  return output;
+}
+
+template <typename AESImpl>
+folly::Optional<std::unique_ptr<folly::IOBuf>>
+AESGCMNative<AESImpl>::tryDecrypt(
+    std::unique_ptr<folly::IOBuf>&& ciphertext,
+    const folly::IOBuf* associatedData,
+    uint64_t seqNum) const {
+  constexpr size_t tagLen = AESImpl::kTagLength;
+  auto inputLength = ciphertext->computeChainDataLength();
+  if (inputLength < tagLen) {
+    return folly::none;
+  }
+  inputLength -= tagLen;
+
+  std::array<uint8_t, tagLen> tag;
+  trimBytes(*ciphertext, folly::range(tag));
+  folly::IOBuf* input;
+  std::unique_ptr<folly::IOBuf> output;
+  if (ciphertext->isShared()) {
+    output = folly::IOBuf::create(inputLength);
+    output->append(inputLength);
+    input = ciphertext.get();
+  } else {
+    output = std::move(ciphertext);
+    input = output.get();
+  }
+
+  auto iv = createIV(seqNum);
+  detail::AESGCMNativeRecord record(key_, iv.data());
+  if (associatedData) {
+    for (auto current : *associatedData) {
+      record.addAad(current.data(), current.size());
+    }
+  }
+  transformBuffer(
+      *input, *output, [&](uint8_t* out, const uint8_t* in, size_t len) {
+        record.decrypt(in, out, len);
+      });
+
+  std::array<uint8_t, tagLen> expectedTag;
+  record.tag(expectedTag.data());
+  if (CRYPTO_memcmp(expectedTag.data(), tag.data(), tagLen) != 0) {
+    return folly::none;
+  }
+  return std::move(output);
+}
+
+template <typename AESImpl>
+std::array<uint8_t, AESImpl::kIVLength> AESGCMNative<AESImpl>::createIV(
+    uint64_t seqNum) const {
+  std::array<uint8_t, AESImpl::kIVLength> iv;
+  uint64_t bigEndianSeqNum = folly::Endian::big(seqNum);
+  const size_t prefixLength = AESImpl::kIVLength - sizeof(uint64_t);
+  memset(iv.data(), 0, prefixLength);
+  memcpy(iv.data() + prefixLength, &bigEndianSeqNum, 8);
+  XOR(folly::range(iv_), folly::range(iv));
+  return iv;
+}
+} // namespace fizz
@@ -0,0 +1,495 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/aead/AESGCMNative.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if FIZZ_AESGCM_NATIVE_X86
+#include <cpuid.h>
+#include <immintrin.h>
+
+// Only the functions in this file are compiled for AES-NI and PCLMULQDQ; they
+// are only reached after aesGcmNativeSupported() has checked the CPU.
+#define FIZZ_AESNI_TARGET \
+  __attribute__((target("aes,pclmul,ssse3,sse4.1"), always_inline)) inline
+#define FIZZ_AESNI_ENTRY __attribute__((target("aes,pclmul,ssse3,sse4.1")))
+#endif
+
+namespace fizz {
+namespace detail {
+
+#if FIZZ_AESGCM_NATIVE_X86
+
+namespace {
+
+FIZZ_AESNI_TARGET __m128i load(const uint8_t* in) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+}
+
+FIZZ_AESNI_TARGET void store(uint8_t* out, __m128i v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+}
+
+/**
+ * GHASH works on bit-reflected field elements. Reversing the bytes of each
+ * block lets PCLMULQDQ operate on them directly, with a one-bit shift folded
+ * into the reduction.
+ */
+FIZZ_AESNI_TARGET __m128i byteSwap(__m128i v) {
+  const __m128i mask =
+      _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  return _mm_shuffle_epi8(v, mask);
+}
+
+/**
+ * Accumulates the unreduced 256-bit carry-less product a * b into lo, mid and
+ * hi, so that several products can share one reduction.
+ */
+FIZZ_AESNI_TARGET void
+clmulAccumulate(__m128i a, __m128i b, __m128i& lo, __m128i& mid, __m128i& hi) {
+  lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, b, 0x00));
+  hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, b, 0x11));
+  mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(a, b, 0x10));
+  mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(a, b, 0x01));
+}
+
+/**
+ * Reduces an accumulated product modulo x^128 + x^7 + x^2 + x + 1.
+ */
+FIZZ_AESNI_TARGET __m128i reduce(__m128i lo, __m128i mid, __m128i hi) {
+  lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+  hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+  // Shift the 256-bit product left by one to account for the reflection.
+  __m128i loCarry = _mm_srli_epi32(lo, 31);
+  __m128i hiCarry = _mm_srli_epi32(hi, 31);
+  lo = _mm_slli_epi32(lo, 1);
+  hi = _mm_slli_epi32(hi, 1);
+  __m128i crossCarry = _mm_srli_si128(loCarry, 12);
+  hiCarry = _mm_slli_si128(hiCarry, 4);
+  loCarry = _mm_slli_si128(loCarry, 4);
+  lo = _mm_or_si128(lo, loCarry);
+  hi = _mm_or_si128(hi, hiCarry);
+  hi = _mm_or_si128(hi, crossCarry);
+
+  __m128i a = _mm_slli_epi32(lo, 31);
+  __m128i b = _mm_slli_epi32(lo, 30);
+  __m128i c = _mm_slli_epi32(lo, 25);
+  a = _mm_xor_si128(a, b);
+  a = _mm_xor_si128(a, c);
+  b = _mm_srli_si128(a, 4);
+  a = _mm_slli_si128(a, 12);
+  lo = _mm_xor_si128(lo, a);
+
+  __m128i d = _mm_srli_epi32(lo, 1);
+  __m128i e = _mm_srli_epi32(lo, 2);
+  __m128i f = _mm_srli_epi32(lo, 7);
+  d = _mm_xor_si128(d, e);
+  d = _mm_xor_si128(d, f);
+  d = _mm_xor_si128(d, b);
+  lo = _mm_xor_si128(lo, d);
+  return _mm_xor_si128(hi, lo);
+}
+
+FIZZ_AESNI_TARGET __m128i gfmul(__m128i a, __m128i b) {
+  __m128i lo = _mm_setzero_si128();
+  __m128i mid = _mm_setzero_si128();
+  __m128i hi = _mm_setzero_si128();
+  clmulAccumulate(a, b, lo, mid, hi);
+  return reduce(lo, mid, hi);
+}
+
+template <int Rcon>
+FIZZ_AESNI_TARGET __m128i expand128(__m128i key) {
+  __m128i assist = _mm_aeskeygenassist_si128(key, Rcon);
+  assist = _mm_shuffle_epi32(assist, 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+template <int Rcon>
+FIZZ_AESNI_TARGET __m128i expand256Even(__m128i even, __m128i odd) {
+  __m128i assist = _mm_aeskeygenassist_si128(odd, Rcon);
+  assist = _mm_shuffle_epi32(assist, 0xff);
+  even = _mm_xor_si128(even, _mm_slli_si128(even, 4));
+  even = _mm_xor_si128(even, _mm_slli_si128(even, 4));
+  even = _mm_xor_si128(even, _mm_slli_si128(even, 4));
+  return _mm_xor_si128(even, assist);
+}
+
+FIZZ_AESNI_TARGET __m128i expand256Odd(__m128i even, __m128i odd) {
+  __m128i assist = _mm_aeskeygenassist_si128(even, 0x00);
+  assist = _mm_shuffle_epi32(assist, 0xaa);
+  odd = _mm_xor_si128(odd, _mm_slli_si128(odd, 4));
+  odd = _mm_xor_si128(odd, _mm_slli_si128(odd, 4));
+  odd = _mm_xor_si128(odd, _mm_slli_si128(odd, 4));
+  return _mm_xor_si128(odd, assist);
+}
+
+FIZZ_AESNI_TARGET void expandKey128(const uint8_t* key, __m128i* rk) {
+  rk[0] = load(key);
+  rk[1] = expand128<0x01>(rk[0]);
+  rk[2] = expand128<0x02>(rk[1]);
+  rk[3] = expand128<0x04>(rk[2]);
+  rk[4] = expand128<0x08>(rk[3]);
+  rk[5] = expand128<0x10>(rk[4]);
+  rk[6] = expand128<0x20>(rk[5]);
+  rk[7] = expand128<0x40>(rk[6]);
+  rk[8] = expand128<0x80>(rk[7]);
+  rk[9] = expand128<0x1b>(rk[8]);
+  rk[10] = expand128<0x36>(rk[9]);
+}
+
+FIZZ_AESNI_TARGET void expandKey256(const uint8_t* key, __m128i* rk) {
+  rk[0] = load(key);
+  rk[1] = load(key + 16);
+  rk[2] = expand256Even<0x01>(rk[0], rk[1]);
+  rk[3] = expand256Odd(rk[2], rk[1]);
+  rk[4] = expand256Even<0x02>(rk[2], rk[3]);
+  rk[5] = expand256Odd(rk[4], rk[3]);
+  rk[6] = expand256Even<0x04>(rk[4], rk[5]);
+  rk[7] = expand256Odd(rk[6], rk[5]);
+  rk[8] = expand256Even<0x08>(rk[6], rk[7]);
+  rk[9] = expand256Odd(rk[8], rk[7]);
+  rk[10] = expand256Even<0x10>(rk[8], rk[9]);
+  rk[11] = expand256Odd(rk[10], rk[9]);
+  rk[12] = expand256Even<0x20>(rk[10], rk[11]);
+  rk[13] = expand256Odd(rk[12], rk[11]);
+  rk[14] = expand256Even<0x40>(rk[12], rk[13]);
+}
+
+/**
+ * Round keys loaded into registers once per call.
+ */
+struct RoundKeys {
+  FIZZ_AESNI_TARGET explicit RoundKeys(const AESGCMNativeKey& key)
+      : rounds(key.rounds) {
+    for (size_t i = 0; i <= rounds; ++i) {
+      rk[i] = load(key.roundKeys + 16 * i);
+    }
+  }
+
+  __m128i rk[15];
+  size_t rounds;
+};
+
+FIZZ_AESNI_TARGET __m128i encryptBlock(const RoundKeys& keys, __m128i block) {
+  block = _mm_xor_si128(block, keys.rk[0]);
+  for (size_t i = 1; i < keys.rounds; ++i) {
+    block = _mm_aesenc_si128(block, keys.rk[i]);
+  }
+  return _mm_aesenclast_si128(block, keys.rk[keys.rounds]);
+}
+
+template <size_t N>
+FIZZ_AESNI_TARGET void encryptBlocks(const RoundKeys& keys, __m128i* blocks) {
+  for (size_t j = 0; j < N; ++j) {
+    blocks[j] = _mm_xor_si128(blocks[j], keys.rk[0]);
+  }
+  for (size_t i = 1; i < keys.rounds; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      blocks[j] = _mm_aesenc_si128(blocks[j], keys.rk[i]);
+    }
+  }
+  for (size_t j = 0; j < N; ++j) {
+    blocks[j] = _mm_aesenclast_si128(blocks[j], keys.rk[keys.rounds]);
+  }
+}
+
+FIZZ_AESNI_TARGET __m128i counterBlock(__m128i j0, uint32_t counter) {
+  return _mm_insert_epi32(j0, static_cast<int>(__builtin_bswap32(counter)), 3);
+}
+
+/**
+ * GHASH of the 8 blocks of ciphertext in blocks into x, using the
+ * precomputed H^8..H^1 and a single reduction.
+ */
+FIZZ_AESNI_TARGET __m128i
+ghash8(const AESGCMNativeKey& key, __m128i x, const __m128i* blocks) {
+  __m128i lo = _mm_setzero_si128();
+  __m128i mid = _mm_setzero_si128();
+  __m128i hi = _mm_setzero_si128();
+  clmulAccumulate(
+      _mm_xor_si128(x, byteSwap(blocks[0])),
+      load(key.hPowers + 16 * 7),
+      lo,
+      mid,
+      hi);
+  for (size_t j = 1; j < 8; ++j) {
+    clmulAccumulate(
+        byteSwap(blocks[j]), load(key.hPowers + 16 * (7 - j)), lo, mid, hi);
+  }
+  return reduce(lo, mid, hi);
+}
+
+FIZZ_AESNI_TARGET __m128i
+ghash1(const AESGCMNativeKey& key, __m128i x, __m128i block) {
+  return gfmul(_mm_xor_si128(x, byteSwap(block)), load(key.hPowers));
+}
+
+/**
+ * Encrypts or decrypts len bytes, which must be a multiple of 16, starting at
+ * counter and folding the ciphertext into x.
+ */
+template <bool Encrypt>
+FIZZ_AESNI_TARGET void ctrBlocks(
+    const AESGCMNativeKey& key,
+    __m128i j0,
+    uint32_t& counter,
+    __m128i& x,
+    const uint8_t* in,
+    uint8_t* out,
+    size_t len) {
+  RoundKeys keys(key);
+  size_t i = 0;
+  for (; len - i >= 8 * 16; i += 8 * 16) {
+    __m128i ks[8];
+    __m128i ct[8];
+    for (size_t j = 0; j < 8; ++j) {
+      ks[j] = counterBlock(j0, counter++);
+    }
+    if (!Encrypt) {
+      // Load (and hash) the ciphertext before anything is written, so that
+      // in-place decryption is safe.
+      for (size_t j = 0; j < 8; ++j) {
+        ct[j] = load(in + i + 16 * j);
+      }
+      x = ghash8(key, x, ct);
+    }
+    encryptBlocks<8>(keys, ks);
+    for (size_t j = 0; j < 8; ++j) {
+      if (Encrypt) {
+        ct[j] = _mm_xor_si128(load(in + i + 16 * j), ks[j]);
+        store(out + i + 16 * j, ct[j]);
+      } else {
+        store(out + i + 16 * j, _mm_xor_si128(ct[j], ks[j]));
+      }
+    }
+    if (Encrypt) {
+      x = ghash8(key, x, ct);
+    }
+  }
+  for (; i < len; i += 16) {
+    __m128i ks = encryptBlock(keys, counterBlock(j0, counter++));
+    __m128i ct;
+    if (Encrypt) {
+      ct = _mm_xor_si128(load(in + i), ks);
+      store(out + i, ct);
+    } else {
+      ct = load(in + i);
+      store(out + i, _mm_xor_si128(ct, ks));
+    }
+    x = ghash1(key, x, ct);
+  }
+}
+
+FIZZ_AESNI_TARGET void
+ghashBytes(const AESGCMNativeKey& key, uint8_t* x, const uint8_t* block) {
+  store(x, ghash1(key, load(x), load(block)));
+}
+
+FIZZ_AESNI_TARGET void keystreamBlock(
+    const AESGCMNativeKey& key,
+    const uint8_t* j0,
+    uint32_t counter,
+    uint8_t* out) {
+  store(out, encryptBlock(RoundKeys(key), counterBlock(load(j0), counter)));
+}
+} // namespace
+
+bool aesGcmNativeSupported() {
+  static const bool supported = [] {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    return (ecx & bit_AES) && (ecx & bit_PCLMUL) && (ecx & bit_SSSE3) &&
+        (ecx & bit_SSE4_1);
+  }();
+  return supported;
+}
+
+FIZZ_AESNI_ENTRY void
+aesGcmNativeSetKey(AESGCMNativeKey& state, const uint8_t* key, size_t len) {
+  __m128i rk[15];
+  if (len == 16) {
+    expandKey128(key, rk);
+    state.rounds = 10;
+  } else if (len == 32) {
+    expandKey256(key, rk);
+    state.rounds = 14;
+  } else {
+    throw std::runtime_error("Invalid key");
+  }
+  for (size_t i = 0; i <= state.rounds; ++i) {
+    store(state.roundKeys + 16 * i, rk[i]);
+  }
+
+  // H = E(K, 0^128), kept byte-swapped along with its powers H^2..H^8.
+  __m128i h = encryptBlock(RoundKeys(state), _mm_setzero_si128());
+  h = byteSwap(h);
+  __m128i power = h;
+  store(state.hPowers, power);
+  for (size_t i = 1; i < 8; ++i) {
+    power = gfmul(power, h);
+    store(state.hPowers + 16 * i, power);
+  }
+}
+
+FIZZ_AESNI_ENTRY AESGCMNativeRecord::AESGCMNativeRecord(
+    const AESGCMNativeKey& key,
+    const uint8_t* iv)
+    : key_(key) {
+  memcpy(j0_, iv, 12);
+  j0_[12] = 0;
+  j0_[13] = 0;
+  j0_[14] = 0;
+  j0_[15] = 1;
+  memset(x_, 0, sizeof(x_));
+}
+
+FIZZ_AESNI_ENTRY void AESGCMNativeRecord::addAad(
+    const uint8_t* in,
+    size_t len) {
+  if (aadDone_) {
+    throw std::runtime_error("associated data after payload");
+  }
+  aadLen_ += len;
+  while (len > 0) {
+    size_t take = std::min(len, 16 - pendingLen_);
+    memcpy(pending_ + pendingLen_, in, take);
+    pendingLen_ += take;
+    in += take;
+    len -= take;
+    if (pendingLen_ == 16) {
+      ghashBytes(key_, x_, pending_);
+      pendingLen_ = 0;
+    }
+  }
+}
+
+FIZZ_AESNI_ENTRY void AESGCMNativeRecord::finishAad() {
+  if (pendingLen_ != 0) {
+    memset(pending_ + pendingLen_, 0, 16 - pendingLen_);
+    ghashBytes(key_, x_, pending_);
+    pendingLen_ = 0;
+  }
+  aadDone_ = true;
+}
+
+template <bool Encrypt>
+FIZZ_AESNI_ENTRY void AESGCMNativeRecord::crypt(
+    const uint8_t* in,
+    uint8_t* out,
+    size_t len) {
+  if (!aadDone_) {
+    finishAad();
+  }
+  dataLen_ += len;
+
+  // Use up the keystream left over from a block split across buffers.
+  while (pendingLen_ != 0 && len > 0) {
+    uint8_t inByte = *in++;
+    uint8_t outByte = inByte ^ keystream_[pendingLen_];
+    *out++ = outByte;
+    pending_[pendingLen_++] = Encrypt ? outByte : inByte;
+    --len;
+    if (pendingLen_ == 16) {
+      ghashBytes(key_, x_, pending_);
+      pendingLen_ = 0;
+    }
+  }
+
+  size_t whole = len & ~static_cast<size_t>(15);
+  if (whole != 0) {
+    __m128i x = load(x_);
+    ctrBlocks<Encrypt>(key_, load(j0_), counter_, x, in, out, whole);
+    store(x_, x);
+    in += whole;
+    out += whole;
+    len -= whole;
+  }
+
+  if (len != 0) {
+    keystreamBlock(key_, j0_, counter_++, keystream_);
+    for (size_t i = 0; i < len; ++i) {
+      uint8_t inByte = in[i];
+      uint8_t outByte = inByte ^ keystream_[i];
+      out[i] = outByte;
+      pending_[i] = Encrypt ? outByte : inByte;
+    }
+    pendingLen_ = len;
+  }
+}
+
+void AESGCMNativeRecord::encrypt(const uint8_t* in, uint8_t* out, size_t len) {
+  crypt<true>(in, out, len);
+}
+
+void AESGCMNativeRecord::decrypt(const uint8_t* in, uint8_t* out, size_t len) {
+  crypt<false>(in, out, len);
+}
+
+FIZZ_AESNI_ENTRY void AESGCMNativeRecord::tag(uint8_t* out) {
+  if (!aadDone_) {
+    finishAad();
+  }
+  if (pendingLen_ != 0) {
+    memset(pending_ + pendingLen_, 0, 16 - pendingLen_);
+    ghashBytes(key_, x_, pending_);
+    pendingLen_ = 0;
+  }
+  uint64_t aadBits = static_cast<uint64_t>(aadLen_) * 8;
+  uint64_t dataBits = static_cast<uint64_t>(dataLen_) * 8;
+  uint8_t lengths[16];
+  for (size_t i = 0; i < 8; ++i) {
+    lengths[i] = static_cast<uint8_t>(aadBits >> (56 - 8 * i));
+    lengths[8 + i] = static_cast<uint8_t>(dataBits >> (56 - 8 * i));
+  }
+  ghashBytes(key_, x_, lengths);
+
+  RoundKeys keys(key_);
+  __m128i tagMask = encryptBlock(keys, load(j0_));
+  store(out, _mm_xor_si128(tagMask, byteSwap(load(x_))));
+}
+
+#else
+
+bool aesGcmNativeSupported() {
+  return false;
+}
+
+void aesGcmNativeSetKey(AESGCMNativeKey&, const uint8_t*, size_t) {
+  throw std::runtime_error("native AES-GCM not supported on this platform");
+}
+
+AESGCMNativeRecord::AESGCMNativeRecord(
+    const AESGCMNativeKey& key,
+    const uint8_t*)
+    : key_(key) {
+  throw std::runtime_error("native AES-GCM not supported on this platform");
+}
+
+void AESGCMNativeRecord::addAad(const uint8_t*, size_t) {}
+
+void AESGCMNativeRecord::finishAad() {}
+
+void AESGCMNativeRecord::encrypt(const uint8_t*, uint8_t*, size_t) {}
+
+void AESGCMNativeRecord::decrypt(const uint8_t*, uint8_t*, size_t) {}
+
+void AESGCMNativeRecord::tag(uint8_t*) {}
+
+#endif
+} // namespace detail
+} // namespace fizz
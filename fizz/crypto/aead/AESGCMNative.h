@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/AESGCM256.h>
+#include <fizz/crypto/aead/Aead.h>
+#include <fizz/crypto/aead/IOBufUtil.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FIZZ_AESGCM_NATIVE_X86 1
+#else
+#define FIZZ_AESGCM_NATIVE_X86 0
+#endif
+
+namespace fizz {
+namespace detail {
+
+/**
+ * Per-key state for native AES-GCM: the expanded AES key schedule and the
+ * powers H^1..H^8 of the GHASH key, computed once in setKey().
+ */
+struct AESGCMNativeKey {
+  uint8_t roundKeys[15 * 16];
+  uint8_t hPowers[8 * 16];
+  size_t rounds{0};
+};
+
+/**
+ * Returns true if the CPU supports the AES-NI and PCLMULQDQ instructions the
+ * native implementation needs.
+ */
+bool aesGcmNativeSupported();
+
+void aesGcmNativeSetKey(AESGCMNativeKey& state, const uint8_t* key, size_t len);
+
+/**
+ * Seals or opens a single record. Associated data must all be added before
+ * the payload; the payload may be supplied in pieces of any size, so a
+ * scattered record is processed in one pass without coalescing.
+ */
+class AESGCMNativeRecord {
+ public:
+  AESGCMNativeRecord(const AESGCMNativeKey& key, const uint8_t* iv);
+
+  void addAad(const uint8_t* in, size_t len);
+
+  void encrypt(const uint8_t* in, uint8_t* out, size_t len);
+
+  void decrypt(const uint8_t* in, uint8_t* out, size_t len);
+
+  /**
+   * Writes the 16 byte tag. Must be called last.
+   */
+  void tag(uint8_t* out);
+
+ private:
+  void finishAad();
+
+  template <bool Encrypt>
+  void crypt(const uint8_t* in, uint8_t* out, size_t len);
+
+  const AESGCMNativeKey& key_;
+  uint8_t j0_[16];
+  uint8_t x_[16];
+  uint8_t keystream_[16];
+  uint8_t pending_[16];
+  size_t pendingLen_{0};
+  size_t aadLen_{0};
+  size_t dataLen_{0};
+  uint32_t counter_{2};
+  bool aadDone_{false};
+};
+} // namespace detail
+
+/**
+ * AES-GCM using AES-NI and PCLMULQDQ directly instead of going through an
+ * EVP_CIPHER_CTX. The key schedule and GHASH key powers are computed once per
+ * key, and each record (associated data, payload and tag) is processed in a
+ * single pass over the possibly chained input. Check isSupported() before
+ * use.
+ *
+ * AESImpl is AESGCM128 or AESGCM256.
+ */
+template <typename AESImpl>
+class AESGCMNative final : public Aead {
+  static_assert(AESImpl::kIVLength == 12, "unsupported iv length");
+  static_assert(AESImpl::kTagLength == 16, "unsupported tag length");
+
+ public:
+  AESGCMNative() = default;
+  ~AESGCMNative() override;
+
+  static bool isSupported() {
+    return detail::aesGcmNativeSupported();
+  }
+
+  void setKey(TrafficKey trafficKey) override;
+
+  size_t keyLength() const override {
+    return AESImpl::kKeyLength;
+  }
+
+  size_t ivLength() const override {
+    return AESImpl::kIVLength;
+  }
+
+  std::unique_ptr<folly::IOBuf> encrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  folly::Optional<std::unique_ptr<folly::IOBuf>> tryDecrypt(
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  size_t getCipherOverhead() const override {
+    return AESImpl::kTagLength;
+  }
+
+  bool supportsConcurrentUse() const override {
+    return true;
+  }
+
+  void setEncryptedBufferHeadroom(size_t headroom) override {
+    headroom_ = headroom;
+  }
+
+ private:
+  std::array<uint8_t, AESImpl::kIVLength> createIV(uint64_t seqNum) const;
+
+  detail::AESGCMNativeKey key_;
+  std::array<uint8_t, AESImpl::kIVLength> iv_;
+  size_t headroom_{5};
+};
+} // namespace fizz
+
+#include <fizz/crypto/aead/AESGCMNative-inl.h>
@@ -88,5 +88,13 @@ class Aead {
    * ciphertext - size of plaintext).
    */
   virtual size_t getCipherOverhead() const = 0;
+
+  /**
+   * Whether encrypt() and tryDecrypt() may be called from several threads at
+   * once after the key has been set.
+   */
+  virtual bool supportsConcurrentUse() const {
+    return false;
+  }
 };
 } // namespace fizz
@@ -35,7 +35,7 @@ namespace fizz {
  *         explicitly
  */
 template <typename EVPImpl>
-class OpenSSLEVPCipher : public Aead {
+class OpenSSLEVPCipher final : public Aead {
   static_assert(EVPImpl::kIVLength >= sizeof(uint64_t), "iv too small");
 
  public:
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/crypto/aead/AEGIS128L.h>
+#include <fizz/crypto/aead/test/TestUtil.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+struct AEGISParams {
+  std::string key;
+  std::string nonce;
+  std::string aad;
+  std::string plaintext;
+  // Ciphertext followed by the tag.
+  std::string ciphertext;
+};
+
+class AEGIS128LTest : public ::testing::TestWithParam<AEGISParams> {
+ public:
+  void SetUp() override {
+    supported_ = AEGIS128L::isSupported();
+  }
+
+ protected:
+  static std::unique_ptr<AEGIS128L> makeCipher(
+      const std::string& key,
+      const std::string& nonce) {
+    auto cipher = std::make_unique<AEGIS128L>();
+    TrafficKey trafficKey;
+    trafficKey.key = toIOBuf(key);
+    trafficKey.iv = toIOBuf(nonce);
+    cipher->setKey(std::move(trafficKey));
+    return cipher;
+  }
+
+  bool supported_{false};
+};
+
+// The nonce is the iv xor the sequence number, so with sequence number 0 the
+// spec's nonce is used directly as the iv.
+TEST_P(AEGIS128LTest, TestEncrypt) {
+  if (!supported_) {
+    return;
+  }
+  auto cipher = makeCipher(GetParam().key, GetParam().nonce);
+  auto aad = toIOBuf(GetParam().aad);
+  auto out = cipher->encrypt(toIOBuf(GetParam().plaintext), aad.get(), 0);
+  EXPECT_TRUE(IOBufEqualTo()(out, toIOBuf(GetParam().ciphertext)));
+}
+
+TEST_P(AEGIS128LTest, TestDecrypt) {
+  if (!supported_) {
+    return;
+  }
+  auto cipher = makeCipher(GetParam().key, GetParam().nonce);
+  auto aad = toIOBuf(GetParam().aad);
+  auto out =
+      cipher->tryDecrypt(toIOBuf(GetParam().ciphertext), aad.get(), 0);
+  ASSERT_TRUE(out.hasValue());
+  EXPECT_TRUE(IOBufEqualTo()(*out, toIOBuf(GetParam().plaintext)));
+}
+
+TEST_P(AEGIS128LTest, TestDecryptChunked) {
+  if (!supported_) {
+    return;
+  }
+  auto cipher = makeCipher(GetParam().key, GetParam().nonce);
+  auto aad = chunkIOBuf(toIOBuf(GetParam().aad), 3);
+  auto ciphertext = toIOBuf(GetParam().ciphertext);
+  auto out = cipher->tryDecrypt(
+      chunkIOBuf(std::move(ciphertext), 5), aad.get(), 0);
+  ASSERT_TRUE(out.hasValue());
+  EXPECT_TRUE(IOBufEqualTo()(*out, toIOBuf(GetParam().plaintext)));
+}
+
+TEST_P(AEGIS128LTest, TestDecryptWrongSeqNum) {
+  if (!supported_) {
+    return;
+  }
+  auto cipher = makeCipher(GetParam().key, GetParam().nonce);
+  auto aad = toIOBuf(GetParam().aad);
+  EXPECT_FALSE(cipher->tryDecrypt(toIOBuf(GetParam().ciphertext), aad.get(), 1)
+                   .hasValue());
+}
+
+// Test vectors from draft-irtf-cfrg-aegis-aead.
+INSTANTIATE_TEST_CASE_P(
+    AEGISTestVectors,
+    AEGIS128LTest,
+    ::testing::Values(
+        AEGISParams{"10010000000000000000000000000000",
+                    "10000200000000000000000000000000",
+                    "",
+                    "00000000000000000000000000000000",
+                    "c1c0e58bd913006feba00f4b3cc3594e"
+                    "abe0ece80c24868a226a35d16bdae37a"},
+        AEGISParams{"10010000000000000000000000000000",
+                    "10000200000000000000000000000000",
+                    "",
+                    "",
+                    "c2b879a67def9d74e6c14f708bbcc9b4"},
+        AEGISParams{"10010000000000000000000000000000",
+                    "10000200000000000000000000000000",
+                    "0001020304050607",
+                    "000102030405060708090a0b0c0d0e0f"
+                    "101112131415161718191a1b1c1d1e1f",
+                    "79d94593d8c2119d7e8fd9b8fc77845c"
+                    "5c077a05b2528b6ac54b563aed8efe84"
+                    "cc6f3372f6aa1bb82388d695c3962d9a"}));
+
+TEST(AEGIS128LRoundTripTest, TestChunkedRoundTrip) {
+  if (!AEGIS128L::isSupported()) {
+    return;
+  }
+  AEGIS128L cipher;
+  TrafficKey trafficKey;
+  trafficKey.key = toIOBuf("000102030405060708090a0b0c0d0e0f");
+  trafficKey.iv = toIOBuf("0f0e0d0c0b0a09080706050403020100");
+  cipher.setKey(std::move(trafficKey));
+
+  auto plaintext = IOBuf::create(1000);
+  for (size_t i = 0; i < 1000; ++i) {
+    plaintext->writableData()[i] = static_cast<uint8_t>(i * 7);
+  }
+  plaintext->append(1000);
+  auto aad = IOBuf::copyBuffer("some associated data");
+  auto expected = cipher.encrypt(plaintext->clone(), aad.get(), 42);
+  for (size_t chunks : {2, 7, 33}) {
+    auto out =
+        cipher.encrypt(chunkIOBuf(plaintext->clone(), chunks), aad.get(), 42);
+    EXPECT_TRUE(IOBufEqualTo()(out, expected));
+    auto decrypted = cipher.tryDecrypt(std::move(out), aad.get(), 42);
+    ASSERT_TRUE(decrypted.hasValue());
+    EXPECT_TRUE(IOBufEqualTo()(*decrypted, plaintext));
+  }
+
+  auto tampered = expected->clone();
+  tampered->unshare();
+  tampered->coalesce();
+  tampered->writableData()[10] ^= 0x01;
+  EXPECT_FALSE(
+      cipher.tryDecrypt(std::move(tampered), aad.get(), 42).hasValue());
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/crypto/aead/AESGCMNative.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/crypto/aead/test/TestUtil.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+template <typename AESImpl>
+class AESGCMNativeTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    if (!AESGCMNative<AESImpl>::isSupported()) {
+      return;
+    }
+    supported_ = true;
+    native_.setKey(makeKey());
+    reference_.setKey(makeKey());
+  }
+
+ protected:
+  static TrafficKey makeKey() {
+    TrafficKey key;
+    key.key = IOBuf::create(AESImpl::kKeyLength);
+    for (size_t i = 0; i < AESImpl::kKeyLength; ++i) {
+      key.key->writableData()[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    key.key->append(AESImpl::kKeyLength);
+    key.iv = IOBuf::create(AESImpl::kIVLength);
+    for (size_t i = 0; i < AESImpl::kIVLength; ++i) {
+      key.iv->writableData()[i] = static_cast<uint8_t>(i * 13 + 5);
+    }
+    key.iv->append(AESImpl::kIVLength);
+    return key;
+  }
+
+  static std::unique_ptr<IOBuf> makeData(size_t len) {
+    auto buf = IOBuf::create(len);
+    for (size_t i = 0; i < len; ++i) {
+      buf->writableData()[i] = static_cast<uint8_t>(i * 31 + len);
+    }
+    buf->append(len);
+    return buf;
+  }
+
+  bool supported_{false};
+  AESGCMNative<AESImpl> native_;
+  OpenSSLEVPCipher<AESImpl> reference_;
+  IOBufEqualTo eq_;
+};
+
+using AESTypes = ::testing::Types<AESGCM128, AESGCM256>;
+TYPED_TEST_CASE(AESGCMNativeTest, AESTypes);
+
+TYPED_TEST(AESGCMNativeTest, TestMatchesOpenSSL) {
+  if (!this->supported_) {
+    return;
+  }
+  auto aad = IOBuf::copyBuffer("additional");
+  for (size_t len : {0, 1, 15, 16, 17, 127, 128, 129, 1000, 16384}) {
+    for (uint64_t seq : {0, 1, 1000000}) {
+      auto expected =
+          this->reference_.encrypt(this->makeData(len), aad.get(), seq);
+      auto actual = this->native_.encrypt(this->makeData(len), aad.get(), seq);
+      EXPECT_TRUE(this->eq_(expected, actual)) << len;
+
+      auto decrypted =
+          this->native_.tryDecrypt(std::move(actual), aad.get(), seq);
+      ASSERT_TRUE(decrypted.hasValue());
+      EXPECT_TRUE(this->eq_(*decrypted, this->makeData(len)));
+    }
+  }
+}
+
+TYPED_TEST(AESGCMNativeTest, TestChunked) {
+  if (!this->supported_) {
+    return;
+  }
+  auto aad = chunkIOBuf(IOBuf::copyBuffer("some additional data"), 3);
+  for (size_t chunks : {2, 7, 33}) {
+    auto expected =
+        this->reference_.encrypt(this->makeData(500), aad.get(), 3);
+    auto actual = this->native_.encrypt(
+        chunkIOBuf(this->makeData(500), chunks), aad.get(), 3);
+    EXPECT_TRUE(this->eq_(expected, actual));
+
+    auto decrypted = this->native_.tryDecrypt(
+        chunkIOBuf(std::move(actual), 5), aad.get(), 3);
+    ASSERT_TRUE(decrypted.hasValue());
+    EXPECT_TRUE(this->eq_(*decrypted, this->makeData(500)));
+  }
+}
+
+TYPED_TEST(AESGCMNativeTest, TestSharedInput) {
+  if (!this->supported_) {
+    return;
+  }
+  auto plaintext = this->makeData(100);
+  auto shared = plaintext->clone();
+  auto ciphertext = this->native_.encrypt(std::move(shared), nullptr, 0);
+  EXPECT_TRUE(this->eq_(plaintext, this->makeData(100)));
+  EXPECT_TRUE(this->eq_(
+      ciphertext, this->reference_.encrypt(this->makeData(100), nullptr, 0)));
+
+  auto ciphertextCopy = ciphertext->clone();
+  auto decrypted =
+      this->native_.tryDecrypt(std::move(ciphertextCopy), nullptr, 0);
+  ASSERT_TRUE(decrypted.hasValue());
+  EXPECT_TRUE(this->eq_(*decrypted, plaintext));
+}
+
+TYPED_TEST(AESGCMNativeTest, TestTamper) {
+  if (!this->supported_) {
+    return;
+  }
+  auto aad = IOBuf::copyBuffer("aad");
+  auto ciphertext = this->native_.encrypt(this->makeData(64), aad.get(), 9);
+  ciphertext->coalesce();
+  for (size_t i : {size_t(0), size_t(63), size_t(64), size_t(79)}) {
+    auto tampered = ciphertext->clone();
+    tampered->unshare();
+    tampered->writableData()[i] ^= 0x01;
+    EXPECT_FALSE(
+        this->native_.tryDecrypt(std::move(tampered), aad.get(), 9).hasValue());
+  }
+  EXPECT_FALSE(this->native_.tryDecrypt(ciphertext->clone(), aad.get(), 10)
+                   .hasValue());
+  EXPECT_FALSE(this->native_.tryDecrypt(this->makeData(15), aad.get(), 9)
+                   .hasValue());
+}
+} // namespace test
+} // namespace fizz
@@ -9,9 +9,11 @@
 #include <fizz/crypto/exchange/X25519.h>
 
 #include <fizz/crypto/Utils.h>
+#include <fizz/crypto/exchange/X25519KeyPairPool.h>
 
 #include <folly/Conv.h>
 #include <sodium/crypto_scalarmult.h>
+#include <sodium/utils.h>
 
 using namespace folly;
 
@@ -22,7 +24,22 @@ constexpr std::array<uint8_t, crypto_scalarmult_curve25519_BYTES> kZeros{};
 
 namespace fizz {
 
+X25519KeyExchange::X25519KeyExchange(std::shared_ptr<X25519KeyPairPool> pool)
+    : pool_(std::move(pool)) {}
+
+X25519KeyExchange::~X25519KeyExchange() {
+  if (privKey_) {
+    sodium_memzero(privKey_->data(), privKey_->size());
+  }
+}
+
 void X25519KeyExchange::generateKeyPair() {
+  if (pool_) {
+    auto keyPair = pool_->getKeyPair();
+    privKey_ = keyPair.privKey;
+    pubKey_ = keyPair.pubKey;
+    return;
+  }
   auto privKey = PrivKey();
   auto pubKey = PubKey();
   auto err = crypto_box_curve25519xsalsa20poly1305_keypair(
@@ -30,8 +47,9 @@ void X25519KeyExchange::generateKeyPair() {
   if (err != 0) {
     throw std::runtime_error(to<std::string>("Could not generate keys ", err));
   }
-  privKey_ = std::move(privKey);
+  privKey_ = privKey;
   pubKey_ = std::move(pubKey);
+  sodium_memzero(privKey.data(), privKey.size());
 }
 
 std::unique_ptr<IOBuf> X25519KeyExchange::getKeyShare() const {
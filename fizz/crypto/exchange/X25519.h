@@ -17,23 +17,34 @@
 
 namespace fizz {
 
+class X25519KeyPairPool;
+
 /**
  * X25519 key exchange implementation using libsodium.
  */
 class X25519KeyExchange : public KeyExchange {
  public:
-  ~X25519KeyExchange() override = default;
+  using PrivKey =
+      std::array<uint8_t, crypto_box_curve25519xsalsa20poly1305_SECRETKEYBYTES>;
+  using PubKey =
+      std::array<uint8_t, crypto_box_curve25519xsalsa20poly1305_PUBLICKEYBYTES>;
+
+  X25519KeyExchange() = default;
+
+  /**
+   * If pool is set, generateKeyPair() takes a pregenerated key pair from it
+   * instead of doing a scalar multiplication inline.
+   */
+  explicit X25519KeyExchange(std::shared_ptr<X25519KeyPairPool> pool);
+
+  ~X25519KeyExchange() override;
   void generateKeyPair() override;
   std::unique_ptr<folly::IOBuf> getKeyShare() const override;
   std::unique_ptr<folly::IOBuf> generateSharedSecret(
       folly::ByteRange keyShare) const override;
 
  private:
-  using PrivKey =
-      std::array<uint8_t, crypto_box_curve25519xsalsa20poly1305_SECRETKEYBYTES>;
-  using PubKey =
-      std::array<uint8_t, crypto_box_curve25519xsalsa20poly1305_PUBLICKEYBYTES>;
-
+  std::shared_ptr<X25519KeyPairPool> pool_;
   folly::Optional<PrivKey> privKey_;
   folly::Optional<PubKey> pubKey_;
 };
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/exchange/X25519KeyPairPool.h>
+
+#include <folly/Conv.h>
+#include <glog/logging.h>
+#include <sodium/utils.h>
+
+namespace fizz {
+
+X25519KeyPairPool::X25519KeyPairPool(
+    size_t batchSize,
+    folly::Executor* executor)
+    : batchSize_(batchSize), executor_(executor) {
+  if (batchSize_ == 0) {
+    throw std::runtime_error("batch size must be positive");
+  }
+}
+
+X25519KeyPairPool::KeyPair::~KeyPair() {
+  sodium_memzero(privKey.data(), privKey.size());
+}
+
+X25519KeyPairPool::KeyPair X25519KeyPairPool::generateKeyPair() {
+  KeyPair keyPair;
+  auto err = crypto_box_curve25519xsalsa20poly1305_keypair(
+      keyPair.pubKey.data(), keyPair.privKey.data());
+  if (err != 0) {
+    throw std::runtime_error(
+        folly::to<std::string>("Could not generate keys ", err));
+  }
+  return keyPair;
+}
+
+X25519KeyPairPool::KeyPair X25519KeyPairPool::getKeyPair() {
+  auto keyPair = takeKeyPair();
+  if (!keyPair && !executor_) {
+    refill();
+    keyPair = takeKeyPair();
+  }
+  if (keyPair) {
+    return *keyPair;
+  }
+  // The background refill hasn't caught up.
+  return generateKeyPair();
+}
+
+folly::Optional<X25519KeyPairPool::KeyPair> X25519KeyPairPool::takeKeyPair() {
+  folly::Optional<KeyPair> keyPair;
+  size_t remaining;
+  {
+    auto keyPairs = keyPairs_.wlock();
+    if (!keyPairs->empty()) {
+      keyPair = keyPairs->back();
+      keyPairs->pop_back();
+    }
+    remaining = keyPairs->size();
+  }
+  maybeScheduleRefill(remaining);
+  return keyPair;
+}
+
+void X25519KeyPairPool::maybeScheduleRefill(size_t remaining) {
+  if (!executor_ || remaining >= batchSize_ / 2) {
+    return;
+  }
+  if (refillPending_.exchange(true)) {
+    return;
+  }
+  executor_->add([self = shared_from_this()]() {
+    try {
+      self->refill();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Failed to refill X25519 key pool: " << e.what();
+    }
+    self->refillPending_ = false;
+  });
+}
+
+void X25519KeyPairPool::refill() {
+  std::vector<KeyPair> batch;
+  batch.reserve(batchSize_);
+  for (size_t i = 0; i < batchSize_; ++i) {
+    batch.push_back(generateKeyPair());
+  }
+  auto keyPairs = keyPairs_.wlock();
+  keyPairs->insert(keyPairs->end(), batch.begin(), batch.end());
+}
+
+size_t X25519KeyPairPool::size() const {
+  return keyPairs_.rlock()->size();
+}
+} // namespace fizz
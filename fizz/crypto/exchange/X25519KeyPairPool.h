@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/exchange/X25519.h>
+
+#include <folly/Executor.h>
+#include <folly/Optional.h>
+#include <folly/Synchronized.h>
+
+#include <atomic>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Pool of pregenerated X25519 key pairs shared across connections. Key pairs
+ * are generated in batches, off the handshake path when an executor is
+ * supplied, so that a handshake only needs the scalar multiplication for the
+ * shared secret. Each key pair is handed out exactly once.
+ */
+class X25519KeyPairPool
+    : public std::enable_shared_from_this<X25519KeyPairPool> {
+ public:
+  /**
+   * The private key is zeroed when a key pair is destroyed, so copies made
+   * while handing it out don't linger in memory.
+   */
+  struct KeyPair {
+    KeyPair() = default;
+    KeyPair(const KeyPair&) = default;
+    KeyPair& operator=(const KeyPair&) = default;
+    ~KeyPair();
+
+    X25519KeyExchange::PrivKey privKey;
+    X25519KeyExchange::PubKey pubKey;
+  };
+
+  /**
+   * batchSize key pairs are generated per refill. A refill is scheduled on
+   * executor once fewer than half of them remain, in which case the pool must
+   * be owned by a shared_ptr. If executor is null, refills happen inline when
+   * the pool runs empty.
+   */
+  explicit X25519KeyPairPool(
+      size_t batchSize,
+      folly::Executor* executor = nullptr);
+
+  /**
+   * Returns an unused key pair, generating one inline if the pool is empty.
+   */
+  KeyPair getKeyPair();
+
+  /**
+   * Generates a batch of key pairs and adds them to the pool.
+   */
+  void refill();
+
+  size_t size() const;
+
+ private:
+  static KeyPair generateKeyPair();
+
+  folly::Optional<KeyPair> takeKeyPair();
+
+  void maybeScheduleRefill(size_t remaining);
+
+  size_t batchSize_;
+  folly::Executor* executor_;
+  folly::Synchronized<std::vector<KeyPair>> keyPairs_;
+  std::atomic<bool> refillPending_{false};
+};
+} // namespace fizz
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Key share generation and shared secret computation for each supported
+ * group, and X25519 key pairs served from a pool.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/crypto/P256.h>
+#include <fizz/crypto/exchange/OpenSSLKeyExchange.h>
+#include <fizz/crypto/exchange/X25519.h>
+#include <fizz/crypto/exchange/X25519KeyPairPool.h>
+
+using namespace fizz;
+
+namespace {
+template <typename KeyExchangeType>
+void generateKeyPair(uint32_t n) {
+  KeyExchangeType kex;
+  for (uint32_t i = 0; i < n; ++i) {
+    kex.generateKeyPair();
+  }
+  folly::doNotOptimizeAway(kex);
+}
+
+template <typename KeyExchangeType>
+void generateSharedSecret(uint32_t n) {
+  KeyExchangeType kex;
+  std::unique_ptr<folly::IOBuf> peerShare;
+  BENCHMARK_SUSPEND {
+    KeyExchangeType peer;
+    peer.generateKeyPair();
+    peerShare = peer.getKeyShare();
+    kex.generateKeyPair();
+  }
+  auto share = peerShare->coalesce();
+  std::unique_ptr<folly::IOBuf> secret;
+  for (uint32_t i = 0; i < n; ++i) {
+    secret = kex.generateSharedSecret(share);
+  }
+  folly::doNotOptimizeAway(secret);
+}
+
+/**
+ * Everything one side of a handshake does: generate a key pair, encode the
+ * share, and compute the secret from the peer's share.
+ */
+template <typename KeyExchangeType>
+void handshakeKeyExchange(uint32_t n) {
+  std::unique_ptr<folly::IOBuf> peerShare;
+  BENCHMARK_SUSPEND {
+    KeyExchangeType peer;
+    peer.generateKeyPair();
+    peerShare = peer.getKeyShare();
+  }
+  auto share = peerShare->coalesce();
+  std::unique_ptr<folly::IOBuf> secret;
+  for (uint32_t i = 0; i < n; ++i) {
+    KeyExchangeType kex;
+    kex.generateKeyPair();
+    secret = kex.getKeyShare();
+    secret = kex.generateSharedSecret(share);
+  }
+  folly::doNotOptimizeAway(secret);
+}
+
+void x25519PooledKeyPair(uint32_t n, size_t batchSize) {
+  std::shared_ptr<X25519KeyPairPool> pool;
+  BENCHMARK_SUSPEND {
+    pool = std::make_shared<X25519KeyPairPool>(batchSize);
+  }
+  for (uint32_t i = 0; i < n; ++i) {
+    X25519KeyExchange kex(pool);
+    kex.generateKeyPair();
+    folly::doNotOptimizeAway(kex);
+  }
+}
+} // namespace
+
+BENCHMARK(x25519GenerateKeyPair, n) {
+  generateKeyPair<X25519KeyExchange>(n);
+}
+
+BENCHMARK(x25519GenerateSharedSecret, n) {
+  generateSharedSecret<X25519KeyExchange>(n);
+}
+
+BENCHMARK(x25519HandshakeKeyExchange, n) {
+  handshakeKeyExchange<X25519KeyExchange>(n);
+}
+
+// Refills run inline, so larger batches only amortize the pool's locking.
+BENCHMARK_PARAM(x25519PooledKeyPair, 1);
+BENCHMARK_PARAM(x25519PooledKeyPair, 16);
+BENCHMARK_PARAM(x25519PooledKeyPair, 256);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(p256GenerateKeyPair, n) {
+  generateKeyPair<OpenSSLKeyExchange<P256>>(n);
+}
+
+BENCHMARK(p256GenerateSharedSecret, n) {
+  generateSharedSecret<OpenSSLKeyExchange<P256>>(n);
+}
+
+BENCHMARK(p256HandshakeKeyExchange, n) {
+  handshakeKeyExchange<OpenSSLKeyExchange<P256>>(n);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  return 0;
+}
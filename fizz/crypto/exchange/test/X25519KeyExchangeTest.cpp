@@ -9,8 +9,12 @@
 #include <gtest/gtest.h>
 
 #include <fizz/crypto/exchange/X25519.h>
+#include <fizz/crypto/exchange/X25519KeyPairPool.h>
 #include <folly/Range.h>
 #include <folly/String.h>
+#include <folly/executors/ManualExecutor.h>
+
+#include <set>
 
 using namespace folly;
 
@@ -34,5 +38,52 @@ TEST(X25519KeyExchange, SmallKeyExchange) {
   EXPECT_THROW(
       kex.generateSharedSecret(folly::range(keyShare)), std::runtime_error);
 }
+
+TEST(X25519KeyExchange, PooledKeyExchange) {
+  auto pool = std::make_shared<X25519KeyPairPool>(4);
+  X25519KeyExchange kex1(pool);
+  X25519KeyExchange kex2(pool);
+  kex1.generateKeyPair();
+  EXPECT_EQ(pool->size(), 3u);
+  kex2.generateKeyPair();
+  EXPECT_EQ(pool->size(), 2u);
+  EXPECT_FALSE(IOBufEqualTo()(kex1.getKeyShare(), kex2.getKeyShare()));
+
+  auto secret1 = kex1.generateSharedSecret(kex2.getKeyShare()->coalesce());
+  auto secret2 = kex2.generateSharedSecret(kex1.getKeyShare()->coalesce());
+  EXPECT_TRUE(IOBufEqualTo()(secret1, secret2));
+}
+
+TEST(X25519KeyExchange, PoolInlineRefill) {
+  auto pool = std::make_shared<X25519KeyPairPool>(2);
+  std::set<std::string> shares;
+  for (size_t i = 0; i < 5; i++) {
+    X25519KeyExchange kex(pool);
+    kex.generateKeyPair();
+    shares.insert(kex.getKeyShare()->moveToFbString().toStdString());
+  }
+  EXPECT_EQ(shares.size(), 5u);
+  EXPECT_EQ(pool->size(), 1u);
+}
+
+TEST(X25519KeyExchange, PoolExecutorRefill) {
+  folly::ManualExecutor executor;
+  auto pool = std::make_shared<X25519KeyPairPool>(4, &executor);
+  X25519KeyExchange kex(pool);
+  // Empty pool falls back to inline generation and schedules a refill.
+  kex.generateKeyPair();
+  EXPECT_EQ(pool->size(), 0u);
+  EXPECT_EQ(executor.run(), 1u);
+  EXPECT_EQ(pool->size(), 4u);
+
+  X25519KeyExchange kex2(pool);
+  kex2.generateKeyPair();
+  kex2.generateKeyPair();
+  EXPECT_EQ(pool->size(), 2u);
+  EXPECT_EQ(executor.run(), 0u);
+  kex2.generateKeyPair();
+  EXPECT_EQ(executor.run(), 1u);
+  EXPECT_EQ(pool->size(), 5u);
+}
 } // namespace test
 } // namespace fizz
@@ -81,6 +81,24 @@ folly::ssl::EvpPkeyUniquePtr generateECKeyPair(int curveNid) {
   return evpKey;
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+folly::ssl::EvpPkeyUniquePtr generateEd25519KeyPair() {
+  folly::ssl::EvpPkeyCtxUniquePtr kctx(
+      EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr));
+  if (!kctx) {
+    throw std::runtime_error("Error creating kctx");
+  }
+  if (EVP_PKEY_keygen_init(kctx.get()) != 1) {
+    throw std::runtime_error("Error initializing ctx");
+  }
+  EVP_PKEY* pkey = nullptr;
+  if (EVP_PKEY_keygen(kctx.get(), &pkey) != 1) {
+    throw std::runtime_error("Error generating key");
+  }
+  return folly::ssl::EvpPkeyUniquePtr(pkey);
+}
+#endif
+
 folly::ssl::EvpPkeyUniquePtr decodeECPublicKey(
     folly::ByteRange range,
     int curveNid) {
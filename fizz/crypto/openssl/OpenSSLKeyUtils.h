@@ -12,6 +12,13 @@
 #include <folly/io/IOBuf.h>
 #include <folly/ssl/OpenSSLPtrTypes.h>
 
+// Ed25519 needs the one-shot EVP_DigestSign API from OpenSSL 1.1.1.
+#if FOLLY_OPENSSL_IS_110 && defined(NID_ED25519)
+#define FIZZ_OPENSSL_HAS_ED25519 1
+#else
+#define FIZZ_OPENSSL_HAS_ED25519 0
+#endif
+
 namespace fizz {
 namespace detail {
 
@@ -27,6 +34,14 @@ void validateECKey(const folly::ssl::EvpPkeyUniquePtr& key, int curveNid);
  */
 folly::ssl::EvpPkeyUniquePtr generateECKeyPair(int curveNid);
 
+#if FIZZ_OPENSSL_HAS_ED25519
+/**
+ * Generates a new Ed25519 EVP_PKEY.
+ * Throws an exception on error.
+ */
+folly::ssl::EvpPkeyUniquePtr generateEd25519KeyPair();
+#endif
+
 /**
  * Decodes a EC public key specified as a member of the curve
  * curveNid.
@@ -34,6 +34,17 @@ void rsaPssVerify(
     folly::ByteRange signature,
     const folly::ssl::EvpPkeyUniquePtr& pkey,
     int hashNid);
+
+#if FIZZ_OPENSSL_HAS_ED25519
+std::unique_ptr<folly::IOBuf> edSign(
+    folly::ByteRange data,
+    const folly::ssl::EvpPkeyUniquePtr& pkey);
+
+void edVerify(
+    folly::ByteRange data,
+    folly::ByteRange signature,
+    const folly::ssl::EvpPkeyUniquePtr& pkey);
+#endif
 } // namespace detail
 
 template <>
@@ -92,4 +103,32 @@ inline void OpenSSLSignature<KeyType::RSA>::setKey(
   }
   pkey_ = std::move(pkey);
 }
+
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+template <>
+inline std::unique_ptr<folly::IOBuf>
+OpenSSLSignature<KeyType::ED25519>::sign<SignatureScheme::ed25519>(
+    folly::ByteRange data) const {
+  return detail::edSign(data, pkey_);
+}
+
+template <>
+template <>
+inline void OpenSSLSignature<KeyType::ED25519>::verify<
+    SignatureScheme::ed25519>(
+    folly::ByteRange data,
+    folly::ByteRange signature) const {
+  return detail::edVerify(data, signature, pkey_);
+}
+
+template <>
+inline void OpenSSLSignature<KeyType::ED25519>::setKey(
+    folly::ssl::EvpPkeyUniquePtr pkey) {
+  if (EVP_PKEY_id(pkey.get()) != EVP_PKEY_ED25519) {
+    throw std::runtime_error("key not ed25519");
+  }
+  pkey_ = std::move(pkey);
+}
+#endif
 } // namespace fizz
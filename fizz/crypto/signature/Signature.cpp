@@ -154,5 +154,62 @@ void rsaPssVerify(
     throw std::runtime_error("Signature verification failed");
   }
 }
+
+#if FIZZ_OPENSSL_HAS_ED25519
+// Ed25519 hashes internally, so it only supports the one-shot API with no
+// digest.
+std::unique_ptr<folly::IOBuf> edSign(
+    folly::ByteRange data,
+    const folly::ssl::EvpPkeyUniquePtr& pkey) {
+  folly::ssl::EvpMdCtxUniquePtr mdCtx(EVP_MD_CTX_new());
+  if (!mdCtx) {
+    throw std::runtime_error(
+        to<std::string>("Could not allocate EVP_MD_CTX", getOpenSSLError()));
+  }
+
+  if (EVP_DigestSignInit(mdCtx.get(), nullptr, nullptr, nullptr, pkey.get()) !=
+      1) {
+    throw std::runtime_error("Could not initialize signature");
+  }
+
+  size_t bytesWritten = EVP_PKEY_size(pkey.get());
+  auto out = folly::IOBuf::create(bytesWritten);
+  if (EVP_DigestSign(
+          mdCtx.get(),
+          out->writableData(),
+          &bytesWritten,
+          data.data(),
+          data.size()) != 1) {
+    throw std::runtime_error("Failed to sign");
+  }
+  out->append(bytesWritten);
+  return out;
+}
+
+void edVerify(
+    folly::ByteRange data,
+    folly::ByteRange signature,
+    const folly::ssl::EvpPkeyUniquePtr& pkey) {
+  folly::ssl::EvpMdCtxUniquePtr mdCtx(EVP_MD_CTX_new());
+  if (!mdCtx) {
+    throw std::runtime_error(
+        to<std::string>("Could not allocate EVP_MD_CTX", getOpenSSLError()));
+  }
+
+  if (EVP_DigestVerifyInit(
+          mdCtx.get(), nullptr, nullptr, nullptr, pkey.get()) != 1) {
+    throw std::runtime_error("Could not initialize verification");
+  }
+
+  if (EVP_DigestVerify(
+          mdCtx.get(),
+          signature.data(),
+          signature.size(),
+          data.data(),
+          data.size()) != 1) {
+    throw std::runtime_error("Signature verification failed");
+  }
+}
+#endif
 } // namespace detail
 } // namespace fizz
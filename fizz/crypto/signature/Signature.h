@@ -8,13 +8,14 @@
 
 #pragma once
 
+#include <fizz/crypto/openssl/OpenSSLKeyUtils.h>
 #include <fizz/record/Types.h>
 #include <folly/Range.h>
 #include <folly/ssl/OpenSSLPtrTypes.h>
 
 namespace fizz {
 
-enum class KeyType { RSA, P256 };
+enum class KeyType { RSA, P256, ED25519 };
 
 /**
  * Signature implementation using OpenSSL.
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/crypto/signature/Signature.h>
+#include <folly/String.h>
+
+#if FIZZ_OPENSSL_HAS_ED25519
+
+using namespace folly;
+using namespace folly::ssl;
+
+namespace fizz {
+namespace testing {
+
+struct Params {
+  std::string msg;
+  std::string priv;
+  std::string pub;
+  std::string sig;
+};
+
+class Ed25519Test : public ::testing::TestWithParam<Params> {};
+
+static EvpPkeyUniquePtr getPrivateKey(const Params& param) {
+  auto priv = unhexlify(param.priv);
+  return EvpPkeyUniquePtr(EVP_PKEY_new_raw_private_key(
+      EVP_PKEY_ED25519,
+      nullptr,
+      reinterpret_cast<const uint8_t*>(priv.data()),
+      priv.size()));
+}
+
+static EvpPkeyUniquePtr getPublicKey(const Params& param) {
+  auto pub = unhexlify(param.pub);
+  return EvpPkeyUniquePtr(EVP_PKEY_new_raw_public_key(
+      EVP_PKEY_ED25519,
+      nullptr,
+      reinterpret_cast<const uint8_t*>(pub.data()),
+      pub.size()));
+}
+
+TEST_P(Ed25519Test, TestSignature) {
+  OpenSSLSignature<KeyType::ED25519> ed;
+  ed.setKey(getPrivateKey(GetParam()));
+  auto msg = unhexlify(GetParam().msg);
+  auto sig =
+      ed.sign<SignatureScheme::ed25519>(IOBuf::copyBuffer(msg)->coalesce());
+  // Ed25519 signatures are deterministic.
+  EXPECT_EQ(hexlify(sig->coalesce()), GetParam().sig);
+}
+
+TEST_P(Ed25519Test, TestVerify) {
+  OpenSSLSignature<KeyType::ED25519> ed;
+  ed.setKey(getPublicKey(GetParam()));
+  auto msg = unhexlify(GetParam().msg);
+  auto sig = unhexlify(GetParam().sig);
+  ed.verify<SignatureScheme::ed25519>(
+      IOBuf::copyBuffer(msg)->coalesce(), IOBuf::copyBuffer(sig)->coalesce());
+}
+
+TEST_P(Ed25519Test, TestSigModified) {
+  OpenSSLSignature<KeyType::ED25519> ed;
+  ed.setKey(getPublicKey(GetParam()));
+  auto msg = unhexlify(GetParam().msg);
+  auto sig = unhexlify(GetParam().sig);
+  sig[10] ^= 0x01;
+  EXPECT_THROW(
+      ed.verify<SignatureScheme::ed25519>(
+          IOBuf::copyBuffer(msg)->coalesce(),
+          IOBuf::copyBuffer(sig)->coalesce()),
+      std::runtime_error);
+}
+
+TEST_P(Ed25519Test, TestDataModified) {
+  OpenSSLSignature<KeyType::ED25519> ed;
+  ed.setKey(getPublicKey(GetParam()));
+  auto msg = unhexlify(GetParam().msg) + "x";
+  auto sig = unhexlify(GetParam().sig);
+  EXPECT_THROW(
+      ed.verify<SignatureScheme::ed25519>(
+          IOBuf::copyBuffer(msg)->coalesce(),
+          IOBuf::copyBuffer(sig)->coalesce()),
+      std::runtime_error);
+}
+
+TEST(Ed25519KeyTest, TestWrongKeyType) {
+  OpenSSLSignature<KeyType::ED25519> ed;
+  EXPECT_THROW(
+      ed.setKey(detail::generateECKeyPair(NID_X9_62_prime256v1)),
+      std::runtime_error);
+}
+
+// Test vectors from https://tools.ietf.org/html/rfc8032#section-7.1
+INSTANTIATE_TEST_CASE_P(
+    TestVectors,
+    Ed25519Test,
+    ::testing::Values(
+        (Params){
+            "",
+            "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+            "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+            "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+            "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b"},
+        (Params){
+            "72",
+            "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+            "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+            "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+            "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00"},
+        (Params){
+            "af82",
+            "c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+            "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+            "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac"
+            "18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a"}));
+} // namespace testing
+} // namespace fizz
+
+#endif // FIZZ_OPENSSL_HAS_ED25519
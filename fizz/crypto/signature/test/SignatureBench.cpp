@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * CertificateVerify signing and verification. RSA is swept over modulus
+ * sizes; keys are generated once per size before timing starts.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/crypto/signature/Signature.h>
+#include <fizz/crypto/test/TestUtil.h>
+
+#include <map>
+
+using namespace fizz;
+using namespace fizz::test;
+using namespace folly::ssl;
+
+namespace {
+
+// Size of the TLS 1.3 CertificateVerify input for a SHA-256 transcript.
+constexpr size_t kSignedDataSize = 64 + 33 + 1 + 32;
+
+const std::array<uint8_t, kSignedDataSize> kSignedData{{0x20}};
+
+EvpPkeyUniquePtr generateRSAKey(size_t bits) {
+  std::unique_ptr<
+      EVP_PKEY_CTX,
+      folly::static_function_deleter<EVP_PKEY_CTX, &EVP_PKEY_CTX_free>>
+      ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr));
+  EVP_PKEY_keygen_init(ctx.get());
+  EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), bits);
+  EVP_PKEY* keyPtr{nullptr};
+  EVP_PKEY_keygen(ctx.get(), &keyPtr);
+  return EvpPkeyUniquePtr(keyPtr);
+}
+
+const OpenSSLSignature<KeyType::RSA>& getRSA(size_t bits) {
+  static std::map<size_t, OpenSSLSignature<KeyType::RSA>> keys;
+  auto it = keys.find(bits);
+  if (it == keys.end()) {
+    it = keys.emplace(bits, OpenSSLSignature<KeyType::RSA>()).first;
+    it->second.setKey(generateRSAKey(bits));
+  }
+  return it->second;
+}
+
+template <KeyType Type, SignatureScheme Scheme>
+void sign(uint32_t n, const OpenSSLSignature<Type>& signer) {
+  std::unique_ptr<folly::IOBuf> sig;
+  for (uint32_t i = 0; i < n; ++i) {
+    sig = signer.template sign<Scheme>(folly::range(kSignedData));
+  }
+  folly::doNotOptimizeAway(sig);
+}
+
+template <KeyType Type, SignatureScheme Scheme>
+void verify(uint32_t n, const OpenSSLSignature<Type>& signer) {
+  std::unique_ptr<folly::IOBuf> sig;
+  BENCHMARK_SUSPEND {
+    sig = signer.template sign<Scheme>(folly::range(kSignedData));
+  }
+  auto sigRange = sig->coalesce();
+  for (uint32_t i = 0; i < n; ++i) {
+    signer.template verify<Scheme>(folly::range(kSignedData), sigRange);
+  }
+}
+
+void rsaPssSign(uint32_t n, size_t bits) {
+  const OpenSSLSignature<KeyType::RSA>* rsa;
+  BENCHMARK_SUSPEND {
+    rsa = &getRSA(bits);
+  }
+  sign<KeyType::RSA, SignatureScheme::rsa_pss_sha256>(n, *rsa);
+}
+
+void rsaPssVerify(uint32_t n, size_t bits) {
+  const OpenSSLSignature<KeyType::RSA>* rsa;
+  BENCHMARK_SUSPEND {
+    rsa = &getRSA(bits);
+  }
+  verify<KeyType::RSA, SignatureScheme::rsa_pss_sha256>(n, *rsa);
+}
+
+const OpenSSLSignature<KeyType::P256>& getP256() {
+  static OpenSSLSignature<KeyType::P256> p256 = [] {
+    OpenSSLSignature<KeyType::P256> signer;
+    signer.setKey(getPrivateKey(kP256Key));
+    return signer;
+  }();
+  return p256;
+}
+} // namespace
+
+BENCHMARK_PARAM(rsaPssSign, 2048);
+BENCHMARK_PARAM(rsaPssSign, 3072);
+BENCHMARK_PARAM(rsaPssSign, 4096);
+BENCHMARK_PARAM(rsaPssVerify, 2048);
+BENCHMARK_PARAM(rsaPssVerify, 3072);
+BENCHMARK_PARAM(rsaPssVerify, 4096);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(p256Sign, n) {
+  const OpenSSLSignature<KeyType::P256>* p256;
+  BENCHMARK_SUSPEND {
+    p256 = &getP256();
+  }
+  sign<KeyType::P256, SignatureScheme::ecdsa_secp256r1_sha256>(n, *p256);
+}
+
+BENCHMARK(p256Verify, n) {
+  const OpenSSLSignature<KeyType::P256>* p256;
+  BENCHMARK_SUSPEND {
+    p256 = &getP256();
+  }
+  verify<KeyType::P256, SignatureScheme::ecdsa_secp256r1_sha256>(n, *p256);
+}
+
+#if FIZZ_OPENSSL_HAS_ED25519
+BENCHMARK_DRAW_LINE();
+
+namespace {
+const OpenSSLSignature<KeyType::ED25519>& getEd25519() {
+  static OpenSSLSignature<KeyType::ED25519> ed25519 = [] {
+    OpenSSLSignature<KeyType::ED25519> signer;
+    signer.setKey(getPrivateKey(kEd25519Key));
+    return signer;
+  }();
+  return ed25519;
+}
+} // namespace
+
+BENCHMARK(ed25519Sign, n) {
+  const OpenSSLSignature<KeyType::ED25519>* ed25519;
+  BENCHMARK_SUSPEND {
+    ed25519 = &getEd25519();
+  }
+  sign<KeyType::ED25519, SignatureScheme::ed25519>(n, *ed25519);
+}
+
+BENCHMARK(ed25519Verify, n) {
+  const OpenSSLSignature<KeyType::ED25519>* ed25519;
+  BENCHMARK_SUSPEND {
+    ed25519 = &getEd25519();
+  }
+  verify<KeyType::ED25519, SignatureScheme::ed25519>(n, *ed25519);
+}
+#endif
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,248 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Hashing, HMAC, HKDF and key schedule helpers, and transcript hashing.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/crypto/Hkdf.h>
+#include <fizz/crypto/KeyDerivation.h>
+#include <fizz/crypto/Sha256.h>
+#include <fizz/crypto/Sha384.h>
+#include <fizz/protocol/HandshakeContext.h>
+
+using namespace fizz;
+
+namespace {
+std::unique_ptr<folly::IOBuf> makeBuf(size_t n) {
+  auto buf = folly::IOBuf::create(n);
+  memset(buf->writableData(), 'x', n);
+  buf->append(n);
+  return buf;
+}
+
+const std::array<uint8_t, 48> kSecret{{0x0b}};
+
+template <typename Hash>
+void hash(uint32_t n, size_t size) {
+  std::unique_ptr<folly::IOBuf> in;
+  BENCHMARK_SUSPEND {
+    in = makeBuf(size);
+  }
+  std::array<uint8_t, Hash::HashLen> out;
+  for (uint32_t i = 0; i < n; ++i) {
+    Hash::hash(*in, folly::range(out));
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+template <typename Hash>
+void hmac(uint32_t n, size_t size) {
+  std::unique_ptr<folly::IOBuf> in;
+  BENCHMARK_SUSPEND {
+    in = makeBuf(size);
+  }
+  std::array<uint8_t, Hash::HashLen> out;
+  auto key = folly::range(kSecret.data(), kSecret.data() + Hash::HashLen);
+  for (uint32_t i = 0; i < n; ++i) {
+    Hash::hmac(key, *in, folly::range(out));
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+template <typename Hash>
+void hkdfExtract(uint32_t n) {
+  HkdfImpl<Hash> hkdf;
+  auto secret = folly::range(kSecret.data(), kSecret.data() + Hash::HashLen);
+  std::vector<uint8_t> out;
+  for (uint32_t i = 0; i < n; ++i) {
+    out = hkdf.extract(secret, secret);
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+template <typename Hash>
+void hkdfExpand(uint32_t n, size_t length) {
+  HkdfImpl<Hash> hkdf;
+  std::unique_ptr<folly::IOBuf> info;
+  BENCHMARK_SUSPEND {
+    info = makeBuf(16);
+  }
+  auto secret = folly::range(kSecret.data(), kSecret.data() + Hash::HashLen);
+  std::unique_ptr<folly::IOBuf> out;
+  for (uint32_t i = 0; i < n; ++i) {
+    out = hkdf.expand(secret, *info, length);
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+template <typename Hash>
+void expandLabel(uint32_t n, size_t length) {
+  KeyDerivationImpl<Hash> deriver;
+  auto secret = folly::range(kSecret.data(), kSecret.data() + Hash::HashLen);
+  Buf out;
+  for (uint32_t i = 0; i < n; ++i) {
+    out = deriver.expandLabel(
+        secret, "key", folly::IOBuf::create(0), static_cast<uint16_t>(length));
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+template <typename Hash>
+void deriveSecret(uint32_t n) {
+  KeyDerivationImpl<Hash> deriver;
+  auto secret = folly::range(kSecret.data(), kSecret.data() + Hash::HashLen);
+  std::vector<uint8_t> out;
+  for (uint32_t i = 0; i < n; ++i) {
+    out = deriver.deriveSecret(secret, "c hs traffic", secret);
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+/**
+ * The transcript of a full handshake as seen by the server: every message is
+ * appended and the context is read at each point a secret is derived.
+ */
+template <typename Hash>
+void handshakeContext(uint32_t n, size_t certSize) {
+  std::vector<std::unique_ptr<folly::IOBuf>> messages;
+  BENCHMARK_SUSPEND {
+    // ClientHello, ServerHello, EncryptedExtensions, Certificate,
+    // CertificateVerify and Finished.
+    std::vector<size_t> sizes{512, 128, 64, certSize, 264, 36};
+    for (auto size : sizes) {
+      messages.push_back(makeBuf(size));
+    }
+  }
+  Buf out;
+  for (uint32_t i = 0; i < n; ++i) {
+    HandshakeContextImpl<Hash> context;
+    context.appendToTranscript(messages[0]);
+    context.appendToTranscript(messages[1]);
+    out = context.getHandshakeContext();
+    context.appendToTranscript(messages[2]);
+    context.appendToTranscript(messages[3]);
+    context.appendToTranscript(messages[4]);
+    out = context.getFinishedData(folly::range(kSecret));
+    context.appendToTranscript(messages[5]);
+    out = context.getHandshakeContext();
+    out = context.getFinishedData(folly::range(kSecret));
+    context.appendToTranscript(messages[5]);
+    out = context.getHandshakeContext();
+  }
+  folly::doNotOptimizeAway(out);
+}
+
+void sha256Hash(uint32_t n, size_t size) {
+  hash<Sha256>(n, size);
+}
+
+void sha384Hash(uint32_t n, size_t size) {
+  hash<Sha384>(n, size);
+}
+
+void sha256Hmac(uint32_t n, size_t size) {
+  hmac<Sha256>(n, size);
+}
+
+void sha384Hmac(uint32_t n, size_t size) {
+  hmac<Sha384>(n, size);
+}
+
+void sha256HkdfExpand(uint32_t n, size_t length) {
+  hkdfExpand<Sha256>(n, length);
+}
+
+void sha256ExpandLabel(uint32_t n, size_t length) {
+  expandLabel<Sha256>(n, length);
+}
+
+void sha384ExpandLabel(uint32_t n, size_t length) {
+  expandLabel<Sha384>(n, length);
+}
+
+void sha256HandshakeContext(uint32_t n, size_t certSize) {
+  handshakeContext<Sha256>(n, certSize);
+}
+
+void sha384HandshakeContext(uint32_t n, size_t certSize) {
+  handshakeContext<Sha384>(n, certSize);
+}
+} // namespace
+
+BENCHMARK_PARAM(sha256Hash, 32);
+BENCHMARK_PARAM(sha256Hash, 256);
+BENCHMARK_PARAM(sha256Hash, 1024);
+BENCHMARK_PARAM(sha256Hash, 16384);
+BENCHMARK_PARAM(sha384Hash, 32);
+BENCHMARK_PARAM(sha384Hash, 256);
+BENCHMARK_PARAM(sha384Hash, 1024);
+BENCHMARK_PARAM(sha384Hash, 16384);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(sha256Hmac, 32);
+BENCHMARK_PARAM(sha256Hmac, 256);
+BENCHMARK_PARAM(sha256Hmac, 1024);
+BENCHMARK_PARAM(sha256Hmac, 16384);
+BENCHMARK_PARAM(sha384Hmac, 32);
+BENCHMARK_PARAM(sha384Hmac, 256);
+BENCHMARK_PARAM(sha384Hmac, 1024);
+BENCHMARK_PARAM(sha384Hmac, 16384);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(sha256HkdfExtract, n) {
+  hkdfExtract<Sha256>(n);
+}
+
+BENCHMARK(sha384HkdfExtract, n) {
+  hkdfExtract<Sha384>(n);
+}
+
+BENCHMARK_PARAM(sha256HkdfExpand, 16);
+BENCHMARK_PARAM(sha256HkdfExpand, 32);
+BENCHMARK_PARAM(sha256HkdfExpand, 64);
+BENCHMARK_PARAM(sha256HkdfExpand, 255);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(sha256ExpandLabel, 12);
+BENCHMARK_PARAM(sha256ExpandLabel, 16);
+BENCHMARK_PARAM(sha256ExpandLabel, 32);
+BENCHMARK_PARAM(sha384ExpandLabel, 12);
+BENCHMARK_PARAM(sha384ExpandLabel, 32);
+BENCHMARK_PARAM(sha384ExpandLabel, 48);
+
+BENCHMARK(sha256DeriveSecret, n) {
+  deriveSecret<Sha256>(n);
+}
+
+BENCHMARK(sha384DeriveSecret, n) {
+  deriveSecret<Sha384>(n);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(sha256HandshakeContext, 1000);
+BENCHMARK_PARAM(sha256HandshakeContext, 4000);
+BENCHMARK_PARAM(sha256HandshakeContext, 16000);
+BENCHMARK_PARAM(sha384HandshakeContext, 1000);
+BENCHMARK_PARAM(sha384HandshakeContext, 4000);
+BENCHMARK_PARAM(sha384HandshakeContext, 16000);
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -8,6 +8,8 @@
 
 #include <fizz/protocol/AsyncFizzBase.h>
 
+#include <fizz/record/RecordLayer.h>
+
 #include <folly/Conv.h>
 #include <folly/io/Cursor.h>
 
@@ -70,13 +72,28 @@ void AsyncFizzBase::writeChain(
     folly::AsyncTransportWrapper::WriteCallback* callback,
     std::unique_ptr<folly::IOBuf>&& buf,
     folly::WriteFlags flags) {
-  appBytesWritten_ += buf->computeChainDataLength();
+  auto len = buf->computeChainDataLength();
+  appBytesWritten_ += len;
+
+  if (zeroCopyWrites_ && len >= zeroCopyMinBytes_) {
+    flags = flags | folly::WriteFlags::WRITE_MSG_ZEROCOPY;
+  }
 
   // TODO: break up buf into multiple records
 
   writeAppData(callback, std::move(buf), flags);
 }
 
+bool AsyncFizzBase::setZeroCopyWrites(bool enable, size_t minBytes) {
+  auto socket = transport_->getUnderlyingTransport<folly::AsyncSocket>();
+  if (!socket || !socket->setZeroCopy(enable)) {
+    return !enable && !zeroCopyWrites_;
+  }
+  zeroCopyWrites_ = enable;
+  zeroCopyMinBytes_ = minBytes;
+  return true;
+}
+
 size_t AsyncFizzBase::getAppBytesWritten() const {
   return appBytesWritten_;
 }
@@ -97,6 +114,11 @@ void AsyncFizzBase::cancelHandshakeTimeout() {
   handshakeTimeout_.cancelTimeout();
 }
 
+void AsyncFizzBase::compact() {
+  compactQueue(transportReadBuf_);
+  compactBuffer(appDataBuf_);
+}
+
 void AsyncFizzBase::deliverAppData(std::unique_ptr<folly::IOBuf> data) {
   if (data) {
     appBytesReceived_ += data->computeChainDataLength();
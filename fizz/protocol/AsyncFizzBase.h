@@ -58,6 +58,33 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
       std::unique_ptr<folly::IOBuf>&& buf,
       folly::WriteFlags flags = folly::WriteFlags::NONE) override;
 
+  /**
+   * Sends app writes of at least minBytes with MSG_ZEROCOPY. Only possible
+   * when the underlying transport is an AsyncSocket and the kernel supports
+   * it; returns whether the mode is now as requested. The socket holds the
+   * encrypted records until the kernel reports them sent, so their buffers
+   * are best taken from a RecordBufferPool (see RecordBufferPoolFactory).
+   */
+  bool setZeroCopyWrites(bool enable, size_t minBytes = 16 * 1024);
+  bool getZeroCopyWrites() const {
+    return zeroCopyWrites_;
+  }
+
+  /**
+   * With idle compaction, whenever the connection runs out of data to
+   * process it releases memory it won't need until more arrives: buffered
+   * data is moved into right-sized buffers, and once the handshake is
+   * complete the state only the handshake used is dropped (see the derived
+   * classes for what that includes). Buffers are allocated again as data is
+   * read. Meant for servers holding many mostly idle connections.
+   */
+  void setIdleCompaction(bool enabled) {
+    idleCompaction_ = enabled;
+  }
+  bool getIdleCompaction() const {
+    return idleCompaction_;
+  }
+
   /**
    * App data usage accounting.
    */
@@ -156,6 +183,20 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
   virtual void startHandshakeTimeout(std::chrono::milliseconds);
   virtual void cancelHandshakeTimeout();
 
+  /**
+   * Whether received app data is waiting for a read callback.
+   */
+  bool hasBufferedAppData() const {
+    return appDataBuf_ != nullptr;
+  }
+
+  /**
+   * Releases memory not needed while waiting for data. Derived classes call
+   * this when their state machine waits for data with idle compaction
+   * enabled, and extend it to compact the protocol state they own.
+   */
+  virtual void compact();
+
   /**
    * Interfaces for the derived class to interact with the app level read
    * callback.
@@ -216,6 +257,11 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
   size_t appBytesWritten_{0};
   size_t appBytesReceived_{0};
 
+  bool zeroCopyWrites_{false};
+  size_t zeroCopyMinBytes_{0};
+
+  bool idleCompaction_{false};
+
   HandshakeTimeout handshakeTimeout_;
 };
 } // namespace fizz
@@ -0,0 +1,733 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/AsyncIoUringSocket.h>
+
+#if FIZZ_HAVE_IO_URING
+
+#include <folly/Conv.h>
+#include <folly/io/Cursor.h>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fizz {
+
+using folly::AsyncSocketException;
+
+/**
+ * Maximum number of buffers gathered into one send.
+ */
+static constexpr size_t kMaxSendIovecs = 64;
+
+/**
+ * Shared between the backend and the buffers it handed out. refs counts the
+ * backend plus every outstanding buffer, and is only touched on the event
+ * base thread.
+ */
+struct IoUringBackend::BufferState {
+  std::unique_ptr<IoUring> ring;
+  folly::EventBase* eventBase;
+  // Null once the backend is destroyed.
+  IoUringBackend* backend;
+  size_t refs{1};
+
+  void release() {
+    if (--refs == 0) {
+      delete this;
+    }
+  }
+};
+
+IoUringBackend::IoUringBackend(folly::EventBase* eventBase, Options options)
+    : folly::EventHandler(eventBase),
+      eventBase_(eventBase),
+      copyThreshold_(options.copyThreshold) {
+  auto state = std::make_unique<BufferState>();
+  state->ring = std::make_unique<IoUring>(
+      options.entries, options.bufferCount, options.bufferSize);
+  state->eventBase = eventBase;
+  state->backend = this;
+
+  eventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (eventFd_ < 0) {
+    throw std::runtime_error("io_uring eventfd creation failed");
+  }
+  try {
+    state->ring->registerEventFd(eventFd_);
+  } catch (...) {
+    ::close(eventFd_);
+    throw;
+  }
+
+  ring_ = state->ring.get();
+  bufferState_ = state.release();
+  changeHandlerFD(eventFd_);
+  registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+}
+
+IoUringBackend::~IoUringBackend() {
+  unregisterHandler();
+  cancelLoopCallback();
+  // Completions are never reaped after this, so operations still waiting on
+  // the kernel are cancelled and freed here.
+  queuePendingCancels();
+  for (auto op : detached_) {
+    queueCancel(op);
+  }
+  submitNow();
+  for (auto op : detached_) {
+    delete op;
+  }
+  // The ring is closed, cancelling whatever is outstanding, once the last
+  // buffer handed out is freed.
+  bufferState_->backend = nullptr;
+  bufferState_->release();
+  ::close(eventFd_);
+}
+
+io_uring_sqe* IoUringBackend::getSqe() {
+  try {
+    return ring_->getSqe();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "io_uring submission failed: " << e.what();
+    return nullptr;
+  }
+}
+
+io_uring_sqe* IoUringBackend::prepare(Operation* op) {
+  auto sqe = getSqe();
+  if (!sqe) {
+    return nullptr;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(op);
+  scheduleSubmit();
+  return sqe;
+}
+
+void IoUringBackend::cancel(Operation* op) {
+  if (!queueCancel(op)) {
+    pendingCancels_.insert(op);
+  }
+  scheduleSubmit();
+}
+
+bool IoUringBackend::queueCancel(Operation* op) {
+  auto sqe = getSqe();
+  if (!sqe) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = reinterpret_cast<uint64_t>(op);
+  sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+  sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  // A failed cancellation completes with user data 0, which is ignored.
+  sqe->user_data = 0;
+  return true;
+}
+
+void IoUringBackend::queuePendingCancels() {
+  while (!pendingCancels_.empty()) {
+    auto op = *pendingCancels_.begin();
+    if (!queueCancel(op)) {
+      return;
+    }
+    pendingCancels_.erase(op);
+  }
+}
+
+void IoUringBackend::release(Operation* op, bool outstanding) {
+  bufferWaiters_.erase(op);
+  if (outstanding) {
+    detached_.insert(op);
+    return;
+  }
+  pendingCancels_.erase(op);
+  detached_.erase(op);
+  delete op;
+}
+
+void IoUringBackend::submitNow() {
+  try {
+    ring_->submit();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "io_uring submission failed: " << e.what();
+  }
+}
+
+void IoUringBackend::scheduleSubmit() {
+  if (!isLoopCallbackScheduled()) {
+    eventBase_->runInLoop(this);
+  }
+}
+
+void IoUringBackend::runLoopCallback() noexcept {
+  queuePendingCancels();
+  submitNow();
+  if (ring_->pendingSubmissions() > 0 || !pendingCancels_.empty()) {
+    // The kernel pushed back; try again once completions have been reaped.
+    eventBase_->runInLoop(this);
+  }
+}
+
+void IoUringBackend::handlerReady(uint16_t /* events */) noexcept {
+  uint64_t count;
+  if (::read(eventFd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    VLOG(4) << "io_uring eventfd read failed: " << errno;
+  }
+  ring_->reap([](const io_uring_cqe& cqe) {
+    if (cqe.user_data == 0) {
+      return;
+    }
+    reinterpret_cast<Operation*>(cqe.user_data)->complete(cqe.res, cqe.flags);
+  });
+}
+
+std::unique_ptr<folly::IOBuf> IoUringBackend::takeBuffer(
+    uint16_t bufferId,
+    size_t len) {
+  if (len < copyThreshold_) {
+    // AsyncFizzBase holds on to partial records; copy so a slow peer keeps
+    // only the bytes it sent, not a whole ring buffer.
+    auto copy = folly::IOBuf::copyBuffer(ring_->buffer(bufferId), len);
+    recycleBuffer(bufferId);
+    return copy;
+  }
+  ++bufferState_->refs;
+  return folly::IOBuf::takeOwnership(
+      ring_->buffer(bufferId),
+      ring_->bufferSize(),
+      len,
+      &IoUringBackend::freeBuffer,
+      bufferState_);
+}
+
+void IoUringBackend::freeBuffer(void* buf, void* userData) {
+  auto state = static_cast<BufferState*>(userData);
+  auto release = [state, buf] {
+    if (state->backend) {
+      state->backend->recycleBuffer(state->ring->bufferId(buf));
+    }
+    state->release();
+  };
+  if (state->eventBase->isInEventBaseThread()) {
+    release();
+  } else {
+    state->eventBase->runInEventBaseThread(std::move(release));
+  }
+}
+
+void IoUringBackend::recycleBuffer(uint16_t bufferId) {
+  ring_->recycleBuffer(bufferId);
+  if (!bufferWaiters_.empty()) {
+    auto waiters = std::move(bufferWaiters_);
+    bufferWaiters_.clear();
+    for (auto op : waiters) {
+      op->buffersAvailable();
+    }
+  }
+}
+
+void IoUringBackend::waitForBuffers(Operation* op) {
+  bufferWaiters_.insert(op);
+}
+
+void IoUringBackend::cancelWaitForBuffers(Operation* op) {
+  bufferWaiters_.erase(op);
+}
+
+/**
+ * The socket's multishot receive. If the socket is destroyed while the
+ * receive is armed, the backend keeps the operation until its final
+ * completion.
+ */
+class AsyncIoUringSocket::RecvOperation : public IoUringBackend::Operation {
+ public:
+  RecvOperation(AsyncIoUringSocket* socket, IoUringBackend* backend)
+      : socket_(socket), backend_(backend) {}
+
+  void complete(int32_t res, uint32_t flags) override {
+    if (socket_) {
+      socket_->handleRecv(res, flags);
+      return;
+    }
+    if (flags & IORING_CQE_F_BUFFER) {
+      backend_->recycleBuffer(flags >> IORING_CQE_BUFFER_SHIFT);
+    }
+    if (!(flags & IORING_CQE_F_MORE)) {
+      backend_->release(this, false);
+    }
+  }
+
+  void buffersAvailable() override {
+    if (!socket_) {
+      return;
+    }
+    socket_->waitingForBuffers_ = false;
+    if (socket_->readCallback_) {
+      socket_->armRecv();
+    }
+  }
+
+  AsyncIoUringSocket* socket_;
+
+ private:
+  IoUringBackend* backend_;
+};
+
+/**
+ * The socket's outstanding send, which owns the data being sent until the
+ * kernel is done with it.
+ */
+class AsyncIoUringSocket::SendOperation : public IoUringBackend::Operation {
+ public:
+  SendOperation(AsyncIoUringSocket* socket, IoUringBackend* backend)
+      : socket_(socket), backend_(backend) {}
+
+  void complete(int32_t res, uint32_t /* flags */) override {
+    if (socket_) {
+      socket_->handleSend(res);
+    } else {
+      backend_->release(this, false);
+    }
+  }
+
+  AsyncIoUringSocket* socket_;
+  std::unique_ptr<folly::IOBuf> data;
+  std::vector<iovec> iov;
+  msghdr msg;
+
+ private:
+  IoUringBackend* backend_;
+};
+
+AsyncIoUringSocket::AsyncIoUringSocket(IoUringBackend* backend, int fd)
+    : backend_(backend),
+      fd_(fd),
+      recvOp_(new RecvOperation(this, backend)),
+      sendOp_(new SendOperation(this, backend)) {}
+
+AsyncIoUringSocket::~AsyncIoUringSocket() {
+  if (!closed_) {
+    closed_ = true;
+    closeFd();
+  }
+  recvOp_->socket_ = nullptr;
+  backend_->release(recvOp_, recvArmed_);
+  sendOp_->socket_ = nullptr;
+  backend_->release(sendOp_, sendInFlight_);
+}
+
+void AsyncIoUringSocket::destroy() {
+  closeNow();
+  DelayedDestruction::destroy();
+}
+
+void AsyncIoUringSocket::setReadCB(ReadCallback* callback) {
+  readCallback_ = callback;
+  if (!callback) {
+    // Stop receiving so the caller's back pressure reaches the peer. Data
+    // that arrives before the cancellation takes effect is kept.
+    if (recvArmed_) {
+      backend_->cancel(recvOp_);
+    }
+    return;
+  }
+
+  DelayedDestruction::DestructorGuard dg(this);
+  if (!pendingReadData_.empty()) {
+    deliverData(pendingReadData_.move());
+  }
+  if (readCallback_ != callback) {
+    return;
+  }
+  if (readEOF_) {
+    deliverEOF();
+  } else if (closed_) {
+    deliverReadError(AsyncSocketException(
+        AsyncSocketException::NOT_OPEN,
+        "setReadCB() called with socket in invalid state"));
+  } else {
+    armRecv();
+  }
+}
+
+void AsyncIoUringSocket::armRecv() {
+  if (recvArmed_ || waitingForBuffers_ || closed_ || readEOF_) {
+    return;
+  }
+  auto sqe = backend_->prepare(recvOp_);
+  if (!sqe) {
+    return handleSubmitFailure();
+  }
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd_;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = IoUring::kBufferGroup;
+  recvArmed_ = true;
+}
+
+void AsyncIoUringSocket::handleRecv(int32_t res, uint32_t flags) {
+  DelayedDestruction::DestructorGuard dg(this);
+  if (!(flags & IORING_CQE_F_MORE)) {
+    recvArmed_ = false;
+  }
+
+  if (res > 0) {
+    auto data = backend_->takeBuffer(flags >> IORING_CQE_BUFFER_SHIFT, res);
+    if (closed_) {
+      return;
+    }
+    rawBytesReceived_ += res;
+    deliverData(std::move(data));
+  } else {
+    if (flags & IORING_CQE_F_BUFFER) {
+      backend_->recycleBuffer(flags >> IORING_CQE_BUFFER_SHIFT);
+    }
+    if (closed_) {
+      return;
+    }
+    if (res == 0) {
+      readEOF_ = true;
+      deliverEOF();
+      return;
+    } else if (res == -ENOBUFS) {
+      // Every buffer is in use; receive again once one is given back.
+      if (!recvArmed_) {
+        waitingForBuffers_ = true;
+        backend_->waitForBuffers(recvOp_);
+      }
+      return;
+    } else if (res != -ECANCELED) {
+      error_ = true;
+      AsyncSocketException ex(
+          AsyncSocketException::INTERNAL_ERROR, "io_uring recv failed", -res);
+      deliverReadError(ex);
+      failWrites(ex);
+      closeNow();
+      return;
+    }
+  }
+
+  if (!recvArmed_ && readCallback_) {
+    armRecv();
+  }
+}
+
+void AsyncIoUringSocket::deliverData(std::unique_ptr<folly::IOBuf> data) {
+  if (!readCallback_) {
+    pendingReadData_.append(std::move(data));
+    return;
+  }
+  if (readCallback_->isBufferMovable()) {
+    readCallback_->readBufferAvailable(std::move(data));
+    return;
+  }
+
+  folly::io::Cursor cursor(data.get());
+  while (!cursor.isAtEnd() && readCallback_) {
+    void* buf = nullptr;
+    size_t buflen = 0;
+    try {
+      readCallback_->getReadBuffer(&buf, &buflen);
+    } catch (const std::exception& e) {
+      return deliverReadError(AsyncSocketException(
+          AsyncSocketException::BAD_ARGS,
+          folly::to<std::string>("getReadBuffer() threw ", e.what())));
+    }
+    if (buflen == 0 || buf == nullptr) {
+      return deliverReadError(AsyncSocketException(
+          AsyncSocketException::BAD_ARGS,
+          "getReadBuffer() returned empty buffer"));
+    }
+    auto bytesToRead = std::min(buflen, cursor.totalLength());
+    cursor.pull(buf, bytesToRead);
+    readCallback_->readDataAvailable(bytesToRead);
+  }
+  if (!cursor.isAtEnd()) {
+    std::unique_ptr<folly::IOBuf> rest;
+    cursor.clone(rest, cursor.totalLength());
+    pendingReadData_.append(std::move(rest));
+  }
+}
+
+void AsyncIoUringSocket::deliverEOF() {
+  if (readCallback_) {
+    auto callback = readCallback_;
+    readCallback_ = nullptr;
+    callback->readEOF();
+  }
+}
+
+void AsyncIoUringSocket::deliverReadError(const AsyncSocketException& ex) {
+  if (readCallback_) {
+    auto callback = readCallback_;
+    readCallback_ = nullptr;
+    callback->readErr(ex);
+  }
+}
+
+void AsyncIoUringSocket::handleSubmitFailure() {
+  DelayedDestruction::DestructorGuard dg(this);
+  error_ = true;
+  AsyncSocketException ex(
+      AsyncSocketException::INTERNAL_ERROR, "io_uring submission queue full");
+  deliverReadError(ex);
+  failWrites(ex);
+  closeNow();
+}
+
+void AsyncIoUringSocket::write(
+    WriteCallback* callback,
+    const void* buf,
+    size_t bytes,
+    folly::WriteFlags flags) {
+  writeChain(callback, folly::IOBuf::wrapBuffer(buf, bytes), flags);
+}
+
+void AsyncIoUringSocket::writev(
+    WriteCallback* callback,
+    const iovec* vec,
+    size_t count,
+    folly::WriteFlags flags) {
+  std::unique_ptr<folly::IOBuf> buf;
+  for (size_t i = 0; i < count; ++i) {
+    auto next = folly::IOBuf::wrapBuffer(vec[i].iov_base, vec[i].iov_len);
+    if (buf) {
+      buf->prependChain(std::move(next));
+    } else {
+      buf = std::move(next);
+    }
+  }
+  if (!buf) {
+    buf = folly::IOBuf::create(0);
+  }
+  writeChain(callback, std::move(buf), flags);
+}
+
+void AsyncIoUringSocket::writeChain(
+    WriteCallback* callback,
+    std::unique_ptr<folly::IOBuf>&& buf,
+    folly::WriteFlags /* flags */) {
+  if (!good() || writeShutdown_ || shutdownWritePending_ || closePending_) {
+    if (callback) {
+      callback->writeErr(
+          0,
+          AsyncSocketException(
+              AsyncSocketException::NOT_OPEN,
+              "write on closed io_uring socket"));
+    }
+    return;
+  }
+  auto len = buf->computeChainDataLength();
+  appBytesWritten_ += len;
+  if (len == 0) {
+    if (callback) {
+      callback->writeSuccess();
+    }
+    return;
+  }
+  writes_.push_back(WriteRequest{callback, std::move(buf)});
+  startSend();
+}
+
+void AsyncIoUringSocket::startSend() {
+  if (sendInFlight_ || writes_.empty() || closed_) {
+    return;
+  }
+  // Nothing is taken from the front write until the request has an entry,
+  // so failing it leaves the writes to be failed whole.
+  auto sqe = backend_->prepare(sendOp_);
+  if (!sqe) {
+    return handleSubmitFailure();
+  }
+  sendOp_->data = std::move(writes_.front().data);
+  sendOp_->iov.clear();
+  for (auto range : *sendOp_->data) {
+    if (range.empty()) {
+      continue;
+    }
+    sendOp_->iov.push_back(
+        {const_cast<uint8_t*>(range.data()), range.size()});
+    if (sendOp_->iov.size() == kMaxSendIovecs) {
+      break;
+    }
+  }
+  memset(&sendOp_->msg, 0, sizeof(sendOp_->msg));
+  sendOp_->msg.msg_iov = sendOp_->iov.data();
+  sendOp_->msg.msg_iovlen = sendOp_->iov.size();
+
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(&sendOp_->msg);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sendInFlight_ = true;
+}
+
+void AsyncIoUringSocket::handleSend(int32_t res) {
+  DelayedDestruction::DestructorGuard dg(this);
+  sendInFlight_ = false;
+  auto data = std::move(sendOp_->data);
+  if (closed_ || writes_.empty()) {
+    // The writes were failed when the socket was closed or shut down.
+    return;
+  }
+  if (res < 0) {
+    error_ = true;
+    AsyncSocketException ex(
+        AsyncSocketException::INTERNAL_ERROR, "io_uring send failed", -res);
+    failWrites(ex);
+    deliverReadError(ex);
+    closeNow();
+    return;
+  }
+
+  rawBytesWritten_ += res;
+  folly::IOBufQueue remaining{folly::IOBufQueue::cacheChainLength()};
+  remaining.append(std::move(data));
+  remaining.trimStart(res);
+  if (remaining.empty()) {
+    auto callback = writes_.front().callback;
+    writes_.pop_front();
+    if (callback) {
+      callback->writeSuccess();
+    }
+  } else {
+    writes_.front().data = remaining.move();
+  }
+
+  if (closed_) {
+    return;
+  }
+  if (writes_.empty()) {
+    writesDrained();
+  } else {
+    startSend();
+  }
+}
+
+void AsyncIoUringSocket::failWrites(const AsyncSocketException& ex) {
+  auto writes = std::move(writes_);
+  writes_.clear();
+  for (auto& write : writes) {
+    if (write.callback) {
+      write.callback->writeErr(0, ex);
+    }
+  }
+}
+
+void AsyncIoUringSocket::writesDrained() {
+  if (closePending_) {
+    closeNow();
+  } else if (shutdownWritePending_) {
+    shutdownWritePending_ = false;
+    writeShutdown_ = true;
+    ::shutdown(fd_, SHUT_WR);
+  }
+}
+
+void AsyncIoUringSocket::close() {
+  if (writes_.empty()) {
+    return closeNow();
+  }
+  // Flush what's queued first, but stop reading now.
+  DelayedDestruction::DestructorGuard dg(this);
+  closePending_ = true;
+  if (recvArmed_) {
+    backend_->cancel(recvOp_);
+  }
+  deliverEOF();
+}
+
+void AsyncIoUringSocket::closeNow() {
+  if (closed_) {
+    return;
+  }
+  DelayedDestruction::DestructorGuard dg(this);
+  closed_ = true;
+  closeFd();
+  failWrites(AsyncSocketException(
+      AsyncSocketException::NOT_OPEN, "socket closed locally"));
+  deliverEOF();
+}
+
+void AsyncIoUringSocket::closeWithReset() {
+  if (fd_ >= 0) {
+    linger optLinger = {1, 0};
+    setsockopt(fd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
+  }
+  closeNow();
+}
+
+void AsyncIoUringSocket::shutdownWrite() {
+  if (writes_.empty()) {
+    shutdownWriteNow();
+  } else {
+    shutdownWritePending_ = true;
+  }
+}
+
+void AsyncIoUringSocket::shutdownWriteNow() {
+  if (closed_ || writeShutdown_) {
+    return;
+  }
+  DelayedDestruction::DestructorGuard dg(this);
+  writeShutdown_ = true;
+  shutdownWritePending_ = false;
+  if (sendInFlight_) {
+    backend_->cancel(sendOp_);
+  }
+  failWrites(AsyncSocketException(
+      AsyncSocketException::NOT_OPEN, "write shut down"));
+  ::shutdown(fd_, SHUT_WR);
+}
+
+void AsyncIoUringSocket::closeFd() {
+  waitingForBuffers_ = false;
+  backend_->cancelWaitForBuffers(recvOp_);
+  if (recvArmed_) {
+    backend_->cancel(recvOp_);
+  }
+  if (sendInFlight_) {
+    backend_->cancel(sendOp_);
+  }
+  // Anything still queued for this fd must reach the kernel before the fd
+  // number can be reused.
+  backend_->submitNow();
+  ::close(fd_);
+  fd_ = -1;
+}
+
+bool AsyncIoUringSocket::good() const {
+  return !closed_ && !error_;
+}
+
+bool AsyncIoUringSocket::readable() const {
+  return !pendingReadData_.empty();
+}
+
+void AsyncIoUringSocket::attachEventBase(folly::EventBase* eventBase) {
+  if (eventBase != backend_->getEventBase()) {
+    LOG(DFATAL) << "io_uring sockets can't change event base";
+  }
+}
+
+void AsyncIoUringSocket::getLocalAddress(folly::SocketAddress* address) const {
+  address->setFromLocalAddress(fd_);
+}
+
+void AsyncIoUringSocket::getPeerAddress(folly::SocketAddress* address) const {
+  address->setFromPeerAddress(fd_);
+}
+} // namespace fizz
+
+#endif
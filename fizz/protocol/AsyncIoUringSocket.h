@@ -0,0 +1,307 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/IoUring.h>
+
+#if FIZZ_HAVE_IO_URING
+
+#include <folly/io/IOBufQueue.h>
+#include <folly/io/async/AsyncTransport.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/EventHandler.h>
+
+#include <deque>
+#include <unordered_set>
+
+namespace fizz {
+
+/**
+ * io_uring instance shared by the AsyncIoUringSockets of one EventBase.
+ * Requests queued while the loop runs are submitted together at the end of
+ * the loop iteration, and completions are processed when the ring's eventfd
+ * becomes readable, so the number of system calls doesn't grow with the
+ * number of connections. Receives take their memory from a shared ring of
+ * provided buffers only once data has arrived.
+ *
+ * Must be created and used on the thread of its EventBase, and destroyed
+ * before it.
+ */
+class IoUringBackend : private folly::EventHandler,
+                       private folly::EventBase::LoopCallback {
+ public:
+  struct Options {
+    // Submission queue size.
+    uint32_t entries{1024};
+    // Number (a power of 2) and size of the shared receive buffers.
+    uint32_t bufferCount{4096};
+    uint32_t bufferSize{16 * 1024};
+    // Receives shorter than this are copied out and their buffer given back
+    // at once, so a peer trickling partial records can't pin the ring.
+    uint32_t copyThreshold{4 * 1024};
+  };
+
+  /**
+   * A request's owner; complete() is called for each of its completions.
+   * Operations are handed to the backend with release() once their owner is
+   * done with them.
+   */
+  class Operation {
+   public:
+    virtual ~Operation() = default;
+
+    virtual void complete(int32_t res, uint32_t flags) = 0;
+
+    /**
+     * Called after a receive failed with ENOBUFS (see waitForBuffers()) once
+     * buffers have been given back.
+     */
+    virtual void buffersAvailable() {}
+  };
+
+  IoUringBackend(folly::EventBase* eventBase, Options options);
+
+  ~IoUringBackend() override;
+
+  /**
+   * Whether the kernel supports everything the backend relies on.
+   */
+  static bool isSupported() {
+    return IoUring::isSupported();
+  }
+
+  folly::EventBase* getEventBase() const {
+    return eventBase_;
+  }
+
+  /**
+   * Returns an entry to fill in for a request owned by op. It is submitted
+   * at the end of the loop iteration, or by submitNow(). Returns nullptr if
+   * the submission queue is full and the kernel won't take more yet.
+   */
+  io_uring_sqe* prepare(Operation* op);
+
+  /**
+   * Queues cancellation of op's outstanding requests. If the submission
+   * queue is full the cancellation is retried on later loop iterations.
+   */
+  void cancel(Operation* op);
+
+  /**
+   * Takes ownership of op, whose owner no longer needs it. It is deleted
+   * right away unless it still has requests outstanding, in which case the
+   * backend keeps it until it calls release(op, false) on its final
+   * completion, or until the backend is destroyed.
+   */
+  void release(Operation* op, bool outstanding);
+
+  /**
+   * Submits every queued request immediately.
+   */
+  void submitNow();
+
+  /**
+   * Wraps len bytes received into a provided buffer. The buffer goes back to
+   * the kernel once the IOBuf is freed. That may happen on any thread, as
+   * long as the EventBase is still alive. Receives shorter than
+   * Options::copyThreshold are copied instead and the buffer given back
+   * immediately.
+   */
+  std::unique_ptr<folly::IOBuf> takeBuffer(uint16_t bufferId, size_t len);
+
+  /**
+   * Gives a buffer that a completion selected back without using it.
+   */
+  void recycleBuffer(uint16_t bufferId);
+
+  /**
+   * Calls op->buffersAvailable() the next time a buffer is given back.
+   */
+  void waitForBuffers(Operation* op);
+  void cancelWaitForBuffers(Operation* op);
+
+ private:
+  struct BufferState;
+
+  static void freeBuffer(void* buf, void* userData);
+
+  void handlerReady(uint16_t events) noexcept override;
+  void runLoopCallback() noexcept override;
+
+  io_uring_sqe* getSqe();
+  bool queueCancel(Operation* op);
+  void queuePendingCancels();
+  void scheduleSubmit();
+
+  folly::EventBase* eventBase_;
+  int eventFd_{-1};
+  // Owns the ring; outlives the backend while buffers are outstanding.
+  BufferState* bufferState_;
+  IoUring* ring_;
+  uint32_t copyThreshold_;
+  std::unordered_set<Operation*> bufferWaiters_;
+  // Cancellations that didn't fit in the submission queue.
+  std::unordered_set<Operation*> pendingCancels_;
+  // Released operations with requests still outstanding.
+  std::unordered_set<Operation*> detached_;
+};
+
+/**
+ * AsyncTransportWrapper for a connected TCP socket whose I/O goes through an
+ * IoUringBackend instead of epoll and per-read system calls. Reads use a
+ * multishot receive, which stays armed across reads, and are delivered as
+ * the provided buffers the kernel filled (readBufferAvailable(), which
+ * AsyncFizzBase supports), so large reads are never copied on the way to
+ * the record layer. One send is outstanding at a time.
+ *
+ * The socket can't be moved to another EventBase, and send timeouts are not
+ * enforced.
+ */
+class AsyncIoUringSocket : public folly::AsyncTransportWrapper {
+ public:
+  using UniquePtr = std::
+      unique_ptr<AsyncIoUringSocket, folly::DelayedDestruction::Destructor>;
+
+  /**
+   * Takes ownership of fd, a connected socket.
+   */
+  AsyncIoUringSocket(IoUringBackend* backend, int fd);
+
+  void setReadCB(ReadCallback* callback) override;
+  ReadCallback* getReadCallback() const override {
+    return readCallback_;
+  }
+
+  void write(
+      WriteCallback* callback,
+      const void* buf,
+      size_t bytes,
+      folly::WriteFlags flags = folly::WriteFlags::NONE) override;
+  void writev(
+      WriteCallback* callback,
+      const iovec* vec,
+      size_t count,
+      folly::WriteFlags flags = folly::WriteFlags::NONE) override;
+  void writeChain(
+      WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf>&& buf,
+      folly::WriteFlags flags = folly::WriteFlags::NONE) override;
+
+  void close() override;
+  void closeNow() override;
+  void closeWithReset() override;
+  void shutdownWrite() override;
+  void shutdownWriteNow() override;
+
+  bool good() const override;
+  bool readable() const override;
+  bool connecting() const override {
+    return false;
+  }
+  bool error() const override {
+    return error_;
+  }
+
+  folly::EventBase* getEventBase() const override {
+    return backend_->getEventBase();
+  }
+  void attachEventBase(folly::EventBase* eventBase) override;
+  void detachEventBase() override {}
+  bool isDetachable() const override {
+    return false;
+  }
+
+  void setSendTimeout(uint32_t milliseconds) override {
+    sendTimeout_ = milliseconds;
+  }
+  uint32_t getSendTimeout() const override {
+    return sendTimeout_;
+  }
+
+  void getLocalAddress(folly::SocketAddress* address) const override;
+  void getPeerAddress(folly::SocketAddress* address) const override;
+
+  bool isEorTrackingEnabled() const override {
+    return false;
+  }
+  void setEorTracking(bool) override {}
+
+  size_t getAppBytesWritten() const override {
+    return appBytesWritten_;
+  }
+  size_t getRawBytesWritten() const override {
+    return rawBytesWritten_;
+  }
+  size_t getAppBytesReceived() const override {
+    return rawBytesReceived_;
+  }
+  size_t getRawBytesReceived() const override {
+    return rawBytesReceived_;
+  }
+
+  int getFd() const {
+    return fd_;
+  }
+
+  void destroy() override;
+
+ protected:
+  ~AsyncIoUringSocket() override;
+
+ private:
+  class RecvOperation;
+  class SendOperation;
+
+  struct WriteRequest {
+    WriteCallback* callback;
+    std::unique_ptr<folly::IOBuf> data;
+  };
+
+  void armRecv();
+  void handleRecv(int32_t res, uint32_t flags);
+  void deliverData(std::unique_ptr<folly::IOBuf> data);
+  void deliverEOF();
+  void deliverReadError(const folly::AsyncSocketException& ex);
+  void handleSubmitFailure();
+
+  void startSend();
+  void handleSend(int32_t res);
+  void failWrites(const folly::AsyncSocketException& ex);
+  void writesDrained();
+
+  void closeFd();
+
+  IoUringBackend* backend_;
+  int fd_;
+
+  ReadCallback* readCallback_{nullptr};
+  RecvOperation* recvOp_;
+  bool recvArmed_{false};
+  bool waitingForBuffers_{false};
+  bool readEOF_{false};
+  folly::IOBufQueue pendingReadData_{folly::IOBufQueue::cacheChainLength()};
+
+  SendOperation* sendOp_;
+  bool sendInFlight_{false};
+  std::deque<WriteRequest> writes_;
+  bool shutdownWritePending_{false};
+  bool closePending_{false};
+  bool writeShutdown_{false};
+
+  bool closed_{false};
+  bool error_{false};
+
+  uint32_t sendTimeout_{0};
+  size_t appBytesWritten_{0};
+  size_t rawBytesWritten_{0};
+  size_t rawBytesReceived_{0};
+};
+} // namespace fizz
+
+#endif
@@ -23,10 +23,19 @@ inline std::vector<SignatureScheme> CertUtils::getSigSchemes<KeyType::RSA>() {
   return {SignatureScheme::rsa_pss_sha256};
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+inline std::vector<SignatureScheme>
+CertUtils::getSigSchemes<KeyType::ED25519>() {
+  return {SignatureScheme::ed25519};
+}
+#endif
+
 template <KeyType T>
 SelfCertImpl<T>::SelfCertImpl(
     folly::ssl::EvpPkeyUniquePtr pkey,
-    std::vector<folly::ssl::X509UniquePtr> certs) {
+    std::vector<folly::ssl::X509UniquePtr> certs,
+    const std::vector<std::shared_ptr<CertificateCompressor>>& compressors) {
   if (certs.size() == 0) {
     throw std::runtime_error("Must supply at least 1 cert");
   }
@@ -36,6 +45,10 @@ SelfCertImpl<T>::SelfCertImpl(
   // TODO: more strict validation of chaining requirements.
   signature_.setKey(std::move(pkey));
   certs_ = std::move(certs);
+  for (const auto& compressor : compressors) {
+    compressedCerts_[compressor->getAlgorithm()] =
+        compressor->compress(getCertMessage());
+  }
 }
 
 template <KeyType T>
@@ -56,6 +69,21 @@ CertificateMsg SelfCertImpl<T>::getCertMessage(
       certs_, std::move(certificateRequestContext));
 }
 
+template <KeyType T>
+folly::Optional<CompressedCertificate> SelfCertImpl<T>::getCompressedCert(
+    CertificateCompressionAlgorithm algo) const {
+  auto it = compressedCerts_.find(algo);
+  if (it == compressedCerts_.end()) {
+    return folly::none;
+  }
+  CompressedCertificate cc;
+  cc.algorithm = it->second.algorithm;
+  cc.uncompressed_length = it->second.uncompressed_length;
+  cc.compressed_certificate_message =
+      it->second.compressed_certificate_message->clone();
+  return std::move(cc);
+}
+
 template <KeyType T>
 std::vector<SignatureScheme> SelfCertImpl<T>::getSigSchemes() const {
   return CertUtils::getSigSchemes<T>();
@@ -91,6 +119,22 @@ inline Buf SelfCertImpl<KeyType::RSA>::sign(
   }
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+inline Buf SelfCertImpl<KeyType::ED25519>::sign(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ed25519:
+      return signature_.sign<SignatureScheme::ed25519>(signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+#endif
+
 template <KeyType T>
 PeerCertImpl<T>::PeerCertImpl(folly::ssl::X509UniquePtr cert) {
   folly::ssl::EvpPkeyUniquePtr key(X509_get_pubkey(cert.get()));
@@ -138,6 +182,24 @@ inline void PeerCertImpl<KeyType::RSA>::verify(
   }
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+inline void PeerCertImpl<KeyType::ED25519>::verify(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned,
+    folly::ByteRange signature) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ed25519:
+      return signature_.verify<SignatureScheme::ed25519>(
+          signData->coalesce(), signature);
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+#endif
+
 template <KeyType T>
 folly::ssl::X509UniquePtr PeerCertImpl<T>::getX509() const {
   X509_up_ref(cert_.get());
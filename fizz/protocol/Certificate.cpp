@@ -17,14 +17,18 @@ Buf CertUtils::prepareSignData(
       "TLS 1.3, server CertificateVerify";
   static constexpr folly::StringPiece kClientLabel =
       "TLS 1.3, client CertificateVerify";
+  static constexpr folly::StringPiece kDelegatedCredLabel =
+      "TLS, server delegated credentials";
   static constexpr size_t kSigPrefixLen = 64;
   static constexpr uint8_t kSigPrefix = 32;
 
   folly::StringPiece label;
   if (context == CertificateVerifyContext::Server) {
     label = kServerLabel;
-  } else {
+  } else if (context == CertificateVerifyContext::Client) {
     label = kClientLabel;
+  } else {
+    label = kDelegatedCredLabel;
   }
 
   size_t sigDataLen = kSigPrefixLen + label.size() + 1 + toBeSigned.size();
@@ -94,6 +98,10 @@ std::unique_ptr<PeerCert> CertUtils::makePeerCert(Buf certData) {
     return std::make_unique<PeerCertImpl<KeyType::RSA>>(std::move(cert));
   } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_EC) {
     return std::make_unique<PeerCertImpl<KeyType::P256>>(std::move(cert));
+#if FIZZ_OPENSSL_HAS_ED25519
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_ED25519) {
+    return std::make_unique<PeerCertImpl<KeyType::ED25519>>(std::move(cert));
+#endif
   } else {
     throw std::runtime_error("unknown peer cert type");
   }
@@ -101,7 +109,8 @@ std::unique_ptr<PeerCert> CertUtils::makePeerCert(Buf certData) {
 
 std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
     std::string certData,
-    std::string keyData) {
+    std::string keyData,
+    const std::vector<std::shared_ptr<CertificateCompressor>>& compressors) {
   auto certs = folly::ssl::OpenSSLCertUtils::readCertsFromBuffer(
       folly::StringPiece(certData));
   if (certs.empty()) {
@@ -120,12 +129,13 @@ std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
     throw std::runtime_error("Failed to read key");
   }
 
-  return makeSelfCert(std::move(certs), std::move(key));
+  return makeSelfCert(std::move(certs), std::move(key), compressors);
 }
 
 std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
     std::vector<folly::ssl::X509UniquePtr> certs,
-    folly::ssl::EvpPkeyUniquePtr key) {
+    folly::ssl::EvpPkeyUniquePtr key,
+    const std::vector<std::shared_ptr<CertificateCompressor>>& compressors) {
   folly::ssl::EvpPkeyUniquePtr pubKey(X509_get_pubkey(certs.front().get()));
   if (!pubKey) {
     throw std::runtime_error("Failed to read public key");
@@ -134,10 +144,15 @@ std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
   std::unique_ptr<SelfCert> cert;
   if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_RSA) {
     cert = std::make_unique<SelfCertImpl<KeyType::RSA>>(
-        std::move(key), std::move(certs));
+        std::move(key), std::move(certs), compressors);
+#if FIZZ_OPENSSL_HAS_ED25519
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_ED25519) {
+    cert = std::make_unique<SelfCertImpl<KeyType::ED25519>>(
+        std::move(key), std::move(certs), compressors);
+#endif
   } else {
     cert = std::make_unique<SelfCertImpl<KeyType::P256>>(
-        std::move(key), std::move(certs));
+        std::move(key), std::move(certs), compressors);
   }
 
   return cert;
@@ -8,13 +8,16 @@
 
 #pragma once
 
+#include <fizz/compression/CertificateCompressor.h>
 #include <fizz/crypto/signature/Signature.h>
 #include <fizz/record/Types.h>
 #include <folly/io/async/AsyncTransportCertificate.h>
 
+#include <map>
+
 namespace fizz {
 
-enum class CertificateVerifyContext { Server, Client };
+enum class CertificateVerifyContext { Server, Client, DelegatedCredential };
 
 using Cert = folly::AsyncTransportCertificate;
 
@@ -49,6 +52,15 @@ class SelfCert : public Cert {
   virtual CertificateMsg getCertMessage(
       Buf certificateRequestContext = nullptr) const = 0;
 
+  /**
+   * Returns the certificate message (with an empty request context)
+   * compressed with algo, or none if no compressed form is available.
+   */
+  virtual folly::Optional<CompressedCertificate> getCompressedCert(
+      CertificateCompressionAlgorithm /* algo */) const {
+    return folly::none;
+  }
+
   virtual Buf sign(
       SignatureScheme scheme,
       CertificateVerifyContext context,
@@ -98,11 +110,15 @@ class CertUtils {
    */
   static std::unique_ptr<SelfCert> makeSelfCert(
       std::string certData,
-      std::string keyData);
+      std::string keyData,
+      const std::vector<std::shared_ptr<CertificateCompressor>>& compressors =
+          {});
 
   static std::unique_ptr<SelfCert> makeSelfCert(
       std::vector<folly::ssl::X509UniquePtr> certs,
-      folly::ssl::EvpPkeyUniquePtr key);
+      folly::ssl::EvpPkeyUniquePtr key,
+      const std::vector<std::shared_ptr<CertificateCompressor>>& compressors =
+          {});
 };
 
 template <KeyType T>
@@ -111,10 +127,14 @@ class SelfCertImpl : public SelfCert {
   /**
    * Private key is the private key associated with the leaf cert.
    * certs is a list of certs in the chain with the leaf first.
+   * The chain is compressed once with each of compressors up front so that
+   * handshakes only need to copy the cached result.
    */
   SelfCertImpl(
       folly::ssl::EvpPkeyUniquePtr pkey,
-      std::vector<folly::ssl::X509UniquePtr> certs);
+      std::vector<folly::ssl::X509UniquePtr> certs,
+      const std::vector<std::shared_ptr<CertificateCompressor>>& compressors =
+          {});
 
   ~SelfCertImpl() override = default;
 
@@ -127,6 +147,9 @@ class SelfCertImpl : public SelfCert {
   CertificateMsg getCertMessage(
       Buf certificateRequestContext = nullptr) const override;
 
+  folly::Optional<CompressedCertificate> getCompressedCert(
+      CertificateCompressionAlgorithm algo) const override;
+
   Buf sign(
       SignatureScheme scheme,
       CertificateVerifyContext context,
@@ -137,6 +160,8 @@ class SelfCertImpl : public SelfCert {
  private:
   OpenSSLSignature<T> signature_;
   std::vector<folly::ssl::X509UniquePtr> certs_;
+  std::map<CertificateCompressionAlgorithm, CompressedCertificate>
+      compressedCerts_;
 };
 
 template <KeyType T>
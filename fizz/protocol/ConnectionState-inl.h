@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+
+template <typename StateT>
+ExportedConnectionState exportConnectionState(const StateT& state) {
+  auto readLayer =
+      dynamic_cast<const EncryptedReadRecordLayer*>(state.readRecordLayer());
+  auto writeLayer =
+      dynamic_cast<const EncryptedWriteRecordLayer*>(state.writeRecordLayer());
+  if (!readLayer || !writeLayer || !state.keyScheduler() ||
+      !state.version() || !state.cipher()) {
+    throw std::runtime_error("connection state can't be exported");
+  }
+  if (readLayer->hasUnparsedHandshakeData()) {
+    throw std::runtime_error("handshake message partially received");
+  }
+
+  ExportedConnectionState exported;
+  exported.version = *state.version();
+  exported.cipher = *state.cipher();
+  exported.group = state.group();
+  if (state.pskType()) {
+    exported.pskType = *state.pskType();
+  }
+
+  const auto& scheduler = *state.keyScheduler();
+  exported.clientAppTrafficSecret =
+      scheduler.getSecret(AppTrafficSecrets::ClientAppTraffic);
+  exported.clientAppTrafficGeneration =
+      scheduler.getAppTrafficGeneration(AppTrafficSecrets::ClientAppTraffic);
+  exported.serverAppTrafficSecret =
+      scheduler.getSecret(AppTrafficSecrets::ServerAppTraffic);
+  exported.serverAppTrafficGeneration =
+      scheduler.getAppTrafficGeneration(AppTrafficSecrets::ServerAppTraffic);
+
+  exported.readSeqNum = readLayer->getSequenceNumber();
+  exported.writeSeqNum = writeLayer->getSequenceNumber();
+  exported.alpn = state.alpn();
+  if (state.exporterMasterSecret()) {
+    exported.exporterMasterSecret = (*state.exporterMasterSecret())->clone();
+  }
+  return exported;
+}
+
+template <typename StateT>
+void retireExportedConnectionState(StateT& state) {
+  using StateEnumT = std::decay_t<decltype(state.state())>;
+  state.state() = StateEnumT::Error;
+  state.writeRecordLayer() = nullptr;
+  state.readRecordLayer() = nullptr;
+  state.keyScheduler() = nullptr;
+  if (state.exporterMasterSecret()) {
+    auto& secret = *state.exporterMasterSecret();
+    secret->coalesce();
+    CryptoUtils::clean(
+        folly::MutableByteRange(secret->writableData(), secret->length()));
+    state.exporterMasterSecret() = folly::none;
+  }
+}
+
+template <typename StateT>
+void importConnectionState(
+    StateT& state,
+    const ExportedConnectionState& exported,
+    AppTrafficSecrets readSecret,
+    AppTrafficSecrets writeSecret) {
+  const auto& factory = *state.context()->getFactory();
+  auto scheduler = factory.makeKeyScheduler(exported.cipher);
+  scheduler->setAppTrafficSecrets(
+      folly::range(exported.clientAppTrafficSecret),
+      exported.clientAppTrafficGeneration,
+      folly::range(exported.serverAppTrafficSecret),
+      exported.serverAppTrafficGeneration);
+
+  auto readLayer = factory.makeEncryptedReadRecordLayer();
+  readLayer->setProtocolVersion(exported.version);
+  auto readTrafficSecret = scheduler->getSecret(readSecret);
+  Protocol::setAead(
+      *readLayer,
+      exported.cipher,
+      folly::range(readTrafficSecret),
+      factory,
+      *scheduler);
+  readLayer->setSequenceNumber(exported.readSeqNum);
+
+  auto writeLayer = factory.makeEncryptedWriteRecordLayer();
+  writeLayer->setProtocolVersion(exported.version);
+  auto writeTrafficSecret = scheduler->getSecret(writeSecret);
+  Protocol::setAead(
+      *writeLayer,
+      exported.cipher,
+      folly::range(writeTrafficSecret),
+      factory,
+      *scheduler);
+  writeLayer->setSequenceNumber(exported.writeSeqNum);
+
+  state.keyScheduler() = std::move(scheduler);
+  state.readRecordLayer() = std::move(readLayer);
+  state.writeRecordLayer() = std::move(writeLayer);
+  state.version() = exported.version;
+  state.cipher() = exported.cipher;
+  state.group() = exported.group;
+  state.pskType() = exported.pskType;
+  state.alpn() = exported.alpn;
+  if (exported.exporterMasterSecret) {
+    state.exporterMasterSecret() = exported.exporterMasterSecret->clone();
+  }
+}
+} // namespace fizz
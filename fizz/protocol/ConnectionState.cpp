@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/ConnectionState.h>
+
+#include <fizz/record/Types.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+
+namespace fizz {
+
+namespace {
+
+constexpr uint16_t kConnectionStateFormat = 1;
+
+void writeString(
+    const folly::Optional<std::string>& str,
+    folly::io::Appender& appender) {
+  fizz::detail::write(static_cast<uint8_t>(str.hasValue()), appender);
+  if (str) {
+    fizz::detail::writeBuf<uint16_t>(
+        folly::IOBuf::copyBuffer(*str), appender);
+  }
+}
+
+folly::Optional<std::string> readString(folly::io::Cursor& cursor) {
+  uint8_t present;
+  fizz::detail::read(present, cursor);
+  if (!present) {
+    return folly::none;
+  }
+  Buf buf;
+  fizz::detail::readBuf<uint16_t>(buf, cursor);
+  return buf->moveToFbString().toStdString();
+}
+
+std::vector<uint8_t> readSecret(folly::io::Cursor& cursor) {
+  Buf buf;
+  fizz::detail::readBuf<uint8_t>(buf, cursor);
+  auto range = buf->coalesce();
+  return std::vector<uint8_t>(range.begin(), range.end());
+}
+
+Buf nullIfEmpty(Buf buf) {
+  if (buf->computeChainDataLength() == 0) {
+    return nullptr;
+  }
+  return buf;
+}
+} // namespace
+
+Buf encodeConnectionState(const ExportedConnectionState& state) {
+  auto buf = folly::IOBuf::create(256);
+  folly::io::Appender appender(buf.get(), 256);
+
+  fizz::detail::write(kConnectionStateFormat, appender);
+  fizz::detail::write(state.version, appender);
+  fizz::detail::write(state.cipher, appender);
+  fizz::detail::write(static_cast<uint8_t>(state.group.hasValue()), appender);
+  if (state.group) {
+    fizz::detail::write(*state.group, appender);
+  }
+  fizz::detail::write(static_cast<uint8_t>(state.pskType), appender);
+
+  fizz::detail::writeBuf<uint8_t>(
+      folly::IOBuf::copyBuffer(folly::range(state.clientAppTrafficSecret)),
+      appender);
+  fizz::detail::write(state.clientAppTrafficGeneration, appender);
+  fizz::detail::writeBuf<uint8_t>(
+      folly::IOBuf::copyBuffer(folly::range(state.serverAppTrafficSecret)),
+      appender);
+  fizz::detail::write(state.serverAppTrafficGeneration, appender);
+  fizz::detail::write(state.readSeqNum, appender);
+  fizz::detail::write(state.writeSeqNum, appender);
+
+  writeString(state.alpn, appender);
+  writeString(state.sni, appender);
+  writeString(state.pskIdentity, appender);
+
+  fizz::detail::writeBuf<fizz::detail::bits24>(state.peerCert, appender);
+  fizz::detail::writeBuf<uint16_t>(
+      folly::IOBuf::copyBuffer(state.selfCertIdentity), appender);
+  fizz::detail::writeBuf<uint8_t>(state.exporterMasterSecret, appender);
+  fizz::detail::writeBuf<uint8_t>(state.resumptionSecret, appender);
+  fizz::detail::writeBuf<uint32_t>(state.bufferedData, appender);
+  return buf;
+}
+
+ExportedConnectionState decodeConnectionState(Buf encoded) {
+  folly::io::Cursor cursor(encoded.get());
+
+  uint16_t format;
+  fizz::detail::read(format, cursor);
+  if (format != kConnectionStateFormat) {
+    throw std::runtime_error("unsupported connection state format");
+  }
+
+  ExportedConnectionState state;
+  fizz::detail::read(state.version, cursor);
+  fizz::detail::read(state.cipher, cursor);
+  uint8_t hasGroup;
+  fizz::detail::read(hasGroup, cursor);
+  if (hasGroup) {
+    NamedGroup group;
+    fizz::detail::read(group, cursor);
+    state.group = group;
+  }
+  uint8_t pskType;
+  fizz::detail::read(pskType, cursor);
+  if (pskType > static_cast<uint8_t>(PskType::Resumption)) {
+    throw std::runtime_error("invalid psk type");
+  }
+  state.pskType = static_cast<PskType>(pskType);
+
+  state.clientAppTrafficSecret = readSecret(cursor);
+  fizz::detail::read(state.clientAppTrafficGeneration, cursor);
+  state.serverAppTrafficSecret = readSecret(cursor);
+  fizz::detail::read(state.serverAppTrafficGeneration, cursor);
+  fizz::detail::read(state.readSeqNum, cursor);
+  fizz::detail::read(state.writeSeqNum, cursor);
+
+  state.alpn = readString(cursor);
+  state.sni = readString(cursor);
+  state.pskIdentity = readString(cursor);
+
+  fizz::detail::readBuf<fizz::detail::bits24>(state.peerCert, cursor);
+  state.peerCert = nullIfEmpty(std::move(state.peerCert));
+  Buf selfCertIdentity;
+  fizz::detail::readBuf<uint16_t>(selfCertIdentity, cursor);
+  state.selfCertIdentity = selfCertIdentity->moveToFbString().toStdString();
+  fizz::detail::readBuf<uint8_t>(state.exporterMasterSecret, cursor);
+  state.exporterMasterSecret =
+      nullIfEmpty(std::move(state.exporterMasterSecret));
+  fizz::detail::readBuf<uint8_t>(state.resumptionSecret, cursor);
+  state.resumptionSecret = nullIfEmpty(std::move(state.resumptionSecret));
+  fizz::detail::readBuf<uint32_t>(state.bufferedData, cursor);
+  state.bufferedData = nullIfEmpty(std::move(state.bufferedData));
+
+  if (!cursor.isAtEnd()) {
+    throw std::runtime_error("trailing connection state data");
+  }
+  return state;
+}
+
+Buf encodePeerCert(const std::shared_ptr<const Cert>& cert) {
+  if (!cert) {
+    return nullptr;
+  }
+  auto x509 = cert->getX509();
+  if (!x509) {
+    return nullptr;
+  }
+  return folly::ssl::OpenSSLCertUtils::derEncode(*x509);
+}
+} // namespace fizz
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/Utils.h>
+#include <fizz/protocol/Certificate.h>
+#include <fizz/protocol/KeyScheduler.h>
+#include <fizz/protocol/Protocol.h>
+#include <fizz/protocol/Types.h>
+#include <fizz/record/EncryptedRecordLayer.h>
+
+namespace fizz {
+
+/**
+ * Everything needed to continue an established TLS 1.3 connection in another
+ * process that has been handed its socket: the app traffic secrets and
+ * record sequence numbers, plus the negotiated parameters the state
+ * machines consult after the handshake (for key updates, session tickets
+ * and exporters).
+ *
+ * This holds the connection's secrets; it must be kept and transferred as
+ * carefully as a private key.
+ */
+struct ExportedConnectionState {
+  ProtocolVersion version;
+  CipherSuite cipher;
+  folly::Optional<NamedGroup> group;
+  PskType pskType{PskType::NotAttempted};
+
+  std::vector<uint8_t> clientAppTrafficSecret;
+  uint32_t clientAppTrafficGeneration{0};
+  std::vector<uint8_t> serverAppTrafficSecret;
+  uint32_t serverAppTrafficGeneration{0};
+
+  // Sequence numbers of the next records to read and write.
+  uint64_t readSeqNum{0};
+  uint64_t writeSeqNum{0};
+
+  folly::Optional<std::string> alpn;
+  folly::Optional<std::string> sni;
+  // The client's identity for cached PSKs.
+  folly::Optional<std::string> pskIdentity;
+
+  // DER encoding of the peer's certificate, if it sent one.
+  Buf peerCert;
+  // Identity of our own certificate, if any, to look up in the context.
+  std::string selfCertIdentity;
+
+  Buf exporterMasterSecret;
+  // Resumption master secret (server) or resumption secret (client).
+  Buf resumptionSecret;
+
+  // Data read from the transport that wasn't processed yet, e.g. the start
+  // of a partial record.
+  Buf bufferedData;
+};
+
+/**
+ * Serializes exported state for transfer to another process. The encoding is
+ * versioned; decode() throws on versions or data it doesn't understand.
+ */
+Buf encodeConnectionState(const ExportedConnectionState& state);
+ExportedConnectionState decodeConnectionState(Buf encoded);
+
+/**
+ * DER encoding of a peer certificate, or null without one or if it isn't
+ * available in X509 form.
+ */
+Buf encodePeerCert(const std::shared_ptr<const Cert>& cert);
+
+/**
+ * Exports the parts of an established client or server state common to
+ * both. Throws if the connection isn't encrypted by fizz record layers in
+ * both directions (e.g. after kTLS offload), or if a handshake message is
+ * partially buffered.
+ */
+template <typename StateT>
+ExportedConnectionState exportConnectionState(const StateT& state);
+
+/**
+ * Called on an exported state once it has been encoded. The importing
+ * process continues with the same keys and sequence numbers, so the state is
+ * moved to Error and its record layers and key scheduler are dropped,
+ * leaving nothing that could protect another record. The exporter master
+ * secret is cleansed.
+ */
+template <typename StateT>
+void retireExportedConnectionState(StateT& state);
+
+/**
+ * Sets up state's key scheduler, record layers and negotiated parameters
+ * from exported state. The state's context must already be set.
+ */
+template <typename StateT>
+void importConnectionState(
+    StateT& state,
+    const ExportedConnectionState& exported,
+    AppTrafficSecrets readSecret,
+    AppTrafficSecrets writeSecret);
+} // namespace fizz
+
+#include <fizz/protocol/ConnectionState-inl.h>
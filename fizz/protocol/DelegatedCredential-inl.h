@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+
+template <KeyType T>
+SelfDelegatedCredentialImpl<T>::SelfDelegatedCredentialImpl(
+    DelegatedCredential credential,
+    folly::ssl::EvpPkeyUniquePtr pkey,
+    std::chrono::system_clock::time_point expiry)
+    : credential_(std::move(credential)), expiry_(expiry) {
+  signature_.setKey(std::move(pkey));
+}
+
+template <>
+inline Buf SelfDelegatedCredentialImpl<KeyType::P256>::sign(
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (credential_.expected_verify_scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return signature_.sign<SignatureScheme::ecdsa_secp256r1_sha256>(
+          signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+inline Buf SelfDelegatedCredentialImpl<KeyType::ED25519>::sign(
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (credential_.expected_verify_scheme) {
+    case SignatureScheme::ed25519:
+      return signature_.sign<SignatureScheme::ed25519>(signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+#endif
+
+template <KeyType T>
+PeerDelegatedCredentialImpl<T>::PeerDelegatedCredentialImpl(
+    std::shared_ptr<PeerCert> cert,
+    folly::ssl::EvpPkeyUniquePtr pubKey,
+    DelegatedCredential credential)
+    : cert_(std::move(cert)), credential_(std::move(credential)) {
+  signature_.setKey(std::move(pubKey));
+}
+
+template <>
+inline void PeerDelegatedCredentialImpl<KeyType::P256>::verify(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned,
+    folly::ByteRange signature) const {
+  if (scheme != credential_.expected_verify_scheme) {
+    throw FizzException(
+        "certificate verify didn't use credential's algorithm",
+        AlertDescription::illegal_parameter);
+  }
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return signature_.verify<SignatureScheme::ecdsa_secp256r1_sha256>(
+          signData->coalesce(), signature);
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+inline void PeerDelegatedCredentialImpl<KeyType::ED25519>::verify(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned,
+    folly::ByteRange signature) const {
+  if (scheme != credential_.expected_verify_scheme) {
+    throw FizzException(
+        "certificate verify didn't use credential's algorithm",
+        AlertDescription::illegal_parameter);
+  }
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ed25519:
+      return signature_.verify<SignatureScheme::ed25519>(
+          signData->coalesce(), signature);
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+#endif
+} // namespace fizz
@@ -0,0 +1,221 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/DelegatedCredential.h>
+
+#include <folly/Conv.h>
+#include <folly/ScopeGuard.h>
+#include <openssl/x509v3.h>
+
+namespace fizz {
+
+constexpr std::chrono::seconds DelegatedCredentialUtils::kMaxLifetime;
+
+// OID of the DelegationUsage certificate extension.
+static constexpr folly::StringPiece kDelegationUsageOid =
+    "1.3.6.1.4.1.44363.44";
+
+// valid_time is relative to the leaf certificate's notBefore.
+static std::chrono::seconds getSecondsSinceNotBefore(X509* cert) {
+  int days;
+  int seconds;
+  if (ASN1_TIME_diff(&days, &seconds, X509_get_notBefore(cert), nullptr) !=
+      1) {
+    throw std::runtime_error("could not compute certificate age");
+  }
+  return std::chrono::hours(24 * days) + std::chrono::seconds(seconds);
+}
+
+static Buf encodePublicKey(const folly::ssl::EvpPkeyUniquePtr& key) {
+  int len = i2d_PUBKEY(key.get(), nullptr);
+  if (len <= 0) {
+    throw std::runtime_error("could not encode credential public key");
+  }
+  auto buf = folly::IOBuf::create(len);
+  auto out = buf->writableData();
+  if (i2d_PUBKEY(key.get(), &out) != len) {
+    throw std::runtime_error("could not encode credential public key");
+  }
+  buf->append(len);
+  return buf;
+}
+
+bool DelegatedCredentialUtils::hasDelegationUsage(X509* cert) {
+  folly::ssl::ASN1ObjUniquePtr oid(
+      OBJ_txt2obj(kDelegationUsageOid.data(), 1 /* no_name */));
+  if (!oid) {
+    throw std::runtime_error("could not create DelegationUsage oid");
+  }
+  return X509_get_ext_by_OBJ(cert, oid.get(), -1) >= 0;
+}
+
+void DelegatedCredentialUtils::checkExtensions(X509* cert) {
+  if (!hasDelegationUsage(cert)) {
+    throw std::runtime_error("cert is missing DelegationUsage extension");
+  }
+  auto usage = static_cast<ASN1_BIT_STRING*>(
+      X509_get_ext_d2i(cert, NID_key_usage, nullptr, nullptr));
+  if (usage) {
+    SCOPE_EXIT {
+      ASN1_BIT_STRING_free(usage);
+    };
+    // Bit 0 is digitalSignature.
+    if (!ASN1_BIT_STRING_get_bit(usage, 0)) {
+      throw std::runtime_error("cert is missing digitalSignature key usage");
+    }
+  }
+}
+
+Buf DelegatedCredentialUtils::prepareSignatureBuffer(
+    const DelegatedCredential& credential,
+    const folly::ssl::X509UniquePtr& cert) {
+  int certLen = i2d_X509(cert.get(), nullptr);
+  if (certLen <= 0) {
+    throw std::runtime_error("Error converting cert to DER");
+  }
+  auto buf = folly::IOBuf::create(certLen);
+  auto out = buf->writableData();
+  i2d_X509(cert.get(), &out);
+  buf->append(certLen);
+
+  auto credBuf = folly::IOBuf::create(20);
+  folly::io::Appender appender(credBuf.get(), 20);
+  detail::write(credential.valid_time, appender);
+  detail::write(credential.expected_verify_scheme, appender);
+  detail::writeBuf<detail::bits24>(credential.public_key, appender);
+  detail::write(credential.credential_scheme, appender);
+  buf->prependChain(std::move(credBuf));
+  return buf;
+}
+
+std::unique_ptr<SelfDelegatedCredential>
+DelegatedCredentialUtils::generateCredential(
+    const SelfCert& cert,
+    SignatureScheme certScheme,
+    SignatureScheme credScheme,
+    folly::ssl::EvpPkeyUniquePtr credKey,
+    std::chrono::seconds validFor) {
+  if (validFor > kMaxLifetime) {
+    throw std::runtime_error("delegated credential lifetime too long");
+  }
+  auto leaf = cert.getX509();
+  if (!leaf) {
+    throw std::runtime_error("cert has no X509");
+  }
+  checkExtensions(leaf.get());
+
+  auto validTime = getSecondsSinceNotBefore(leaf.get()) + validFor;
+  if (validTime.count() < 0 ||
+      validTime.count() > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("delegated credential valid_time out of range");
+  }
+
+  DelegatedCredential credential;
+  credential.valid_time = static_cast<uint32_t>(validTime.count());
+  credential.expected_verify_scheme = credScheme;
+  credential.public_key = encodePublicKey(credKey);
+  credential.credential_scheme = certScheme;
+  auto toBeSigned = prepareSignatureBuffer(credential, leaf);
+  credential.signature = cert.sign(
+      certScheme,
+      CertificateVerifyContext::DelegatedCredential,
+      toBeSigned->coalesce());
+
+  auto expiry = std::chrono::system_clock::now() + validFor;
+  switch (credScheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return std::make_unique<SelfDelegatedCredentialImpl<KeyType::P256>>(
+          std::move(credential), std::move(credKey), expiry);
+#if FIZZ_OPENSSL_HAS_ED25519
+    case SignatureScheme::ed25519:
+      return std::make_unique<SelfDelegatedCredentialImpl<KeyType::ED25519>>(
+          std::move(credential), std::move(credKey), expiry);
+#endif
+    default:
+      throw std::runtime_error("unsupported delegated credential scheme");
+  }
+}
+
+std::shared_ptr<PeerCert>
+DelegatedCredentialUtils::makePeerDelegatedCredential(
+    std::shared_ptr<PeerCert> cert,
+    DelegatedCredential credential) {
+  auto leaf = cert->getX509();
+  if (!leaf) {
+    throw FizzException(
+        "delegated credential without X509 leaf",
+        AlertDescription::illegal_parameter);
+  }
+  try {
+    checkExtensions(leaf.get());
+  } catch (const std::exception& e) {
+    throw FizzException(e.what(), AlertDescription::illegal_parameter);
+  }
+
+  auto age = getSecondsSinceNotBefore(leaf.get());
+  auto validTime = std::chrono::seconds(credential.valid_time);
+  if (age >= validTime) {
+    throw FizzException(
+        "delegated credential expired", AlertDescription::illegal_parameter);
+  }
+  if (validTime - age > kMaxLifetime) {
+    throw FizzException(
+        "delegated credential lifetime too long",
+        AlertDescription::illegal_parameter);
+  }
+
+  auto toBeSigned = prepareSignatureBuffer(credential, leaf);
+  try {
+    cert->verify(
+        credential.credential_scheme,
+        CertificateVerifyContext::DelegatedCredential,
+        toBeSigned->coalesce(),
+        credential.signature->coalesce());
+  } catch (const std::exception& e) {
+    throw FizzException(
+        folly::to<std::string>(
+            "delegated credential signature invalid: ", e.what()),
+        AlertDescription::illegal_parameter);
+  }
+
+  auto keyRange = credential.public_key->coalesce();
+  const unsigned char* begin = keyRange.data();
+  folly::ssl::EvpPkeyUniquePtr pubKey(
+      d2i_PUBKEY(nullptr, &begin, keyRange.size()));
+  if (!pubKey || begin != keyRange.data() + keyRange.size()) {
+    throw FizzException(
+        "invalid delegated credential public key",
+        AlertDescription::illegal_parameter);
+  }
+
+  switch (credential.expected_verify_scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      if (EVP_PKEY_id(pubKey.get()) != EVP_PKEY_EC) {
+        throw FizzException(
+            "delegated credential key doesn't match scheme",
+            AlertDescription::illegal_parameter);
+      }
+      return std::make_shared<PeerDelegatedCredentialImpl<KeyType::P256>>(
+          std::move(cert), std::move(pubKey), std::move(credential));
+#if FIZZ_OPENSSL_HAS_ED25519
+    case SignatureScheme::ed25519:
+      if (EVP_PKEY_id(pubKey.get()) != EVP_PKEY_ED25519) {
+        throw FizzException(
+            "delegated credential key doesn't match scheme",
+            AlertDescription::illegal_parameter);
+      }
+      return std::make_shared<PeerDelegatedCredentialImpl<KeyType::ED25519>>(
+          std::move(cert), std::move(pubKey), std::move(credential));
+#endif
+    default:
+      throw FizzException(
+          "unsupported delegated credential scheme",
+          AlertDescription::illegal_parameter);
+  }
+}
+} // namespace fizz
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Certificate.h>
+#include <fizz/record/Extensions.h>
+
+#include <chrono>
+
+namespace fizz {
+
+/**
+ * A delegated credential (RFC 9345) along with its private key. Used by a
+ * server to sign CertificateVerify in place of the certificate's own key.
+ */
+class SelfDelegatedCredential {
+ public:
+  virtual ~SelfDelegatedCredential() = default;
+
+  /**
+   * The credential to send in the leaf CertificateEntry.
+   */
+  virtual const DelegatedCredential& getCredential() const = 0;
+
+  /**
+   * The signature scheme that must be used with this credential.
+   */
+  virtual SignatureScheme getSigScheme() const = 0;
+
+  /**
+   * Returns the time after which the credential must no longer be used.
+   */
+  virtual std::chrono::system_clock::time_point getExpiry() const = 0;
+
+  virtual Buf sign(
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const = 0;
+};
+
+template <KeyType T>
+class SelfDelegatedCredentialImpl : public SelfDelegatedCredential {
+ public:
+  SelfDelegatedCredentialImpl(
+      DelegatedCredential credential,
+      folly::ssl::EvpPkeyUniquePtr pkey,
+      std::chrono::system_clock::time_point expiry);
+
+  ~SelfDelegatedCredentialImpl() override = default;
+
+  const DelegatedCredential& getCredential() const override {
+    return credential_;
+  }
+
+  SignatureScheme getSigScheme() const override {
+    return credential_.expected_verify_scheme;
+  }
+
+  std::chrono::system_clock::time_point getExpiry() const override {
+    return expiry_;
+  }
+
+  Buf sign(CertificateVerifyContext context, folly::ByteRange toBeSigned)
+      const override;
+
+ private:
+  DelegatedCredential credential_;
+  OpenSSLSignature<T> signature_;
+  std::chrono::system_clock::time_point expiry_;
+};
+
+/**
+ * PeerCert for a leaf certificate that came with a verified delegated
+ * credential. Identity and X509 are those of the leaf certificate (so chain
+ * verification is unaffected) but signatures are verified with the
+ * credential's key.
+ */
+template <KeyType T>
+class PeerDelegatedCredentialImpl : public PeerCert {
+ public:
+  PeerDelegatedCredentialImpl(
+      std::shared_ptr<PeerCert> cert,
+      folly::ssl::EvpPkeyUniquePtr pubKey,
+      DelegatedCredential credential);
+
+  ~PeerDelegatedCredentialImpl() override = default;
+
+  std::string getIdentity() const override {
+    return cert_->getIdentity();
+  }
+
+  folly::ssl::X509UniquePtr getX509() const override {
+    return cert_->getX509();
+  }
+
+  void verify(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned,
+      folly::ByteRange signature) const override;
+
+  const DelegatedCredential& getCredential() const {
+    return credential_;
+  }
+
+ private:
+  std::shared_ptr<PeerCert> cert_;
+  OpenSSLSignature<T> signature_;
+  DelegatedCredential credential_;
+};
+
+class DelegatedCredentialUtils {
+ public:
+  /**
+   * Maximum lifetime of a credential allowed by RFC 9345.
+   */
+  static constexpr std::chrono::seconds kMaxLifetime{7 * 24 * 60 * 60};
+
+  /**
+   * Returns true if cert carries the DelegationUsage extension.
+   */
+  static bool hasDelegationUsage(X509* cert);
+
+  /**
+   * Throws if cert may not be used to issue delegated credentials.
+   */
+  static void checkExtensions(X509* cert);
+
+  /**
+   * Returns the data (minus the signature context) that the certificate key
+   * signs to issue credential.
+   */
+  static Buf prepareSignatureBuffer(
+      const DelegatedCredential& credential,
+      const folly::ssl::X509UniquePtr& cert);
+
+  /**
+   * Mints a credential for credKey, signed by cert using certScheme, that is
+   * valid for validFor from now.
+   */
+  static std::unique_ptr<SelfDelegatedCredential> generateCredential(
+      const SelfCert& cert,
+      SignatureScheme certScheme,
+      SignatureScheme credScheme,
+      folly::ssl::EvpPkeyUniquePtr credKey,
+      std::chrono::seconds validFor);
+
+  /**
+   * Verifies credential against the leaf certificate cert and returns a
+   * PeerCert that verifies with the credential key. Throws FizzException if
+   * the credential is invalid or expired.
+   */
+  static std::shared_ptr<PeerCert> makePeerDelegatedCredential(
+      std::shared_ptr<PeerCert> cert,
+      DelegatedCredential credential);
+};
+} // namespace fizz
+
+#include <fizz/protocol/DelegatedCredential-inl.h>
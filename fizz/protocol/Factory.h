@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fizz/crypto/RandomGenerator.h>
+#include <fizz/crypto/aead/AEGIS128L.h>
 #include <fizz/crypto/aead/AESGCM128.h>
 #include <fizz/crypto/aead/AESGCM256.h>
 #include <fizz/crypto/aead/AESOCB128.h>
@@ -20,9 +21,12 @@
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/HandshakeContext.h>
 #include <fizz/protocol/KeyScheduler.h>
+#include <fizz/protocol/Types.h>
 #include <fizz/record/EncryptedRecordLayer.h>
 #include <fizz/record/PlaintextRecordLayer.h>
 
+#include <typeinfo>
+
 namespace fizz {
 
 /**
@@ -52,9 +56,19 @@ class Factory {
     return std::make_unique<EncryptedWriteRecordLayer>();
   }
 
+  /**
+   * Uses KeySchedulerImpl when makeKeyDeriver() returns one of the stock
+   * derivers, and otherwise schedules with the deriver it returned.
+   */
   virtual std::unique_ptr<KeyScheduler> makeKeyScheduler(
       CipherSuite cipher) const {
     auto keyDer = makeKeyDeriver(cipher);
+    const auto& deriverType = typeid(*keyDer.get());
+    if (deriverType == typeid(KeyDerivationImpl<Sha256>)) {
+      return std::make_unique<KeySchedulerImpl<Sha256>>();
+    } else if (deriverType == typeid(KeyDerivationImpl<Sha384>)) {
+      return std::make_unique<KeySchedulerImpl<Sha384>>();
+    }
     return std::make_unique<KeyScheduler>(std::move(keyDer));
   }
 
@@ -64,6 +78,7 @@ class Factory {
       case CipherSuite::TLS_CHACHA20_POLY1305_SHA256:
       case CipherSuite::TLS_AES_128_GCM_SHA256:
       case CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL:
+      case CipherSuite::TLS_AEGIS_128L_SHA256_EXPERIMENTAL:
         return std::make_unique<KeyDerivationImpl<Sha256>>();
       case CipherSuite::TLS_AES_256_GCM_SHA384:
         return std::make_unique<KeyDerivationImpl<Sha384>>();
@@ -78,6 +93,7 @@ class Factory {
       case CipherSuite::TLS_CHACHA20_POLY1305_SHA256:
       case CipherSuite::TLS_AES_128_GCM_SHA256:
       case CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL:
+      case CipherSuite::TLS_AEGIS_128L_SHA256_EXPERIMENTAL:
         return std::make_unique<HandshakeContextImpl<Sha256>>();
       case CipherSuite::TLS_AES_256_GCM_SHA384:
         return std::make_unique<HandshakeContextImpl<Sha384>>();
@@ -107,6 +123,11 @@ class Factory {
         return std::make_unique<OpenSSLEVPCipher<AESGCM256>>();
       case CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL:
         return std::make_unique<OpenSSLEVPCipher<AESOCB128>>();
+      case CipherSuite::TLS_AEGIS_128L_SHA256_EXPERIMENTAL:
+        if (!AEGIS128L::isSupported()) {
+          throw std::runtime_error("aegis-128l support requires AES-NI");
+        }
+        return std::make_unique<AEGIS128L>();
       default:
         throw std::runtime_error("aead: not implemented");
     }
@@ -6,41 +6,99 @@
  *  LICENSE file in the root directory of this source tree.
  */
 
-#include <fizz/crypto/KeyDerivation.h>
+#include <fizz/crypto/KeyScheduleEngine.h>
+#include <folly/ScopeGuard.h>
 
 namespace fizz {
 
 template <typename Hash>
-HandshakeContextImpl<Hash>::HandshakeContextImpl() {
-  hashState = folly::ssl::OpenSSLHash::Digest();
-  hashState.hash_init(Hash::HashEngine());
+HandshakeContextImpl<Hash>::HandshakeContextImpl()
+    : hashState_(EVP_MD_CTX_new()) {
+  if (!hashState_ ||
+      EVP_DigestInit_ex(hashState_.get(), Hash::HashEngine(), nullptr) != 1) {
+    throw std::runtime_error("could not initialize transcript hash");
+  }
 }
 
 template <typename Hash>
 void HandshakeContextImpl<Hash>::appendToTranscript(const Buf& data) {
-  hashState.hash_update(*data);
+  for (auto range : *data) {
+    if (EVP_DigestUpdate(hashState_.get(), range.data(), range.size()) != 1) {
+      throw std::runtime_error("could not update transcript hash");
+    }
+  }
+  contextValid_ = false;
+}
+
+template <typename Hash>
+const typename HandshakeContextImpl<Hash>::Context&
+HandshakeContextImpl<Hash>::checkpoint() const {
+  if (!contextValid_) {
+    if (!scratch_) {
+      scratch_.reset(EVP_MD_CTX_new());
+      if (!scratch_) {
+        throw std::runtime_error("could not allocate transcript hash");
+      }
+    }
+    if (EVP_MD_CTX_copy_ex(scratch_.get(), hashState_.get()) != 1 ||
+        EVP_DigestFinal_ex(scratch_.get(), context_.data(), nullptr) != 1) {
+      throw std::runtime_error("could not finalize transcript hash");
+    }
+    contextValid_ = true;
+  }
+  return context_;
 }
 
 template <typename Hash>
 Buf HandshakeContextImpl<Hash>::getHandshakeContext() const {
-  folly::ssl::OpenSSLHash::Digest copied(hashState);
-  auto out = folly::IOBuf::create(Hash::HashLen);
-  out->append(Hash::HashLen);
-  folly::MutableByteRange outRange(out->writableData(), out->length());
-  copied.hash_final(outRange);
-  return out;
+  const auto& context = checkpoint();
+  return folly::IOBuf::copyBuffer(context.data(), context.size());
 }
 
 template <typename Hash>
 Buf HandshakeContextImpl<Hash>::getFinishedData(
     folly::ByteRange baseKey) const {
-  auto context = getHandshakeContext();
-  auto finishedKey = KeyDerivationImpl<Hash>().expandLabel(
-      baseKey, "finished", folly::IOBuf::create(0), Hash::HashLen);
+  using Engine = KeyScheduleEngine<Hash>;
+  const auto& context = checkpoint();
+
+  // HKDF-Expand-Label(baseKey, "finished", "", HashLen) is a single HMAC
+  // block, HMAC(baseKey, HkdfLabel || 0x01), so both HMACs are one-shot and
+  // the finished key never leaves the stack.
+  typename Engine::LabelBuffer labelBuf;
+  auto info = Engine::encodeLabel(
+      "finished", folly::ByteRange(), Hash::HashLen, labelBuf);
+  labelBuf[info.size()] = 1;
+
+  typename Engine::Secret finishedKey;
+  SCOPE_EXIT {
+    OPENSSL_cleanse(finishedKey.data(), finishedKey.size());
+  };
+  unsigned int len = 0;
+  if (!HMAC(
+          Hash::HashEngine(),
+          baseKey.data(),
+          baseKey.size(),
+          labelBuf.data(),
+          info.size() + 1,
+          finishedKey.data(),
+          &len) ||
+      len != Hash::HashLen) {
+    throw std::runtime_error("could not derive finished key");
+  }
+
   auto data = folly::IOBuf::create(Hash::HashLen);
+  if (!HMAC(
+          Hash::HashEngine(),
+          finishedKey.data(),
+          finishedKey.size(),
+          context.data(),
+          context.size(),
+          data->writableData(),
+          &len) ||
+      len != Hash::HashLen) {
+    throw std::runtime_error("could not compute finished data");
+  }
   data->append(Hash::HashLen);
-  auto outRange = folly::MutableByteRange(data->writableData(), data->length());
-  Hash::hmac(finishedKey->coalesce(), *context, outRange);
   return data;
 }
 } // namespace fizz
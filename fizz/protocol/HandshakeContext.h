@@ -9,7 +9,9 @@
 #pragma once
 
 #include <fizz/record/Types.h>
-#include <folly/ssl/OpenSSLHash.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+
+#include <array>
 
 namespace fizz {
 
@@ -43,6 +45,13 @@ class HandshakeContext {
   virtual folly::ByteRange getBlankContext() const = 0;
 };
 
+/**
+ * Hashes the transcript incrementally. The context is finalized from a copy of
+ * the running hash state the first time it is requested after the transcript
+ * changes and then reused, so the several secrets and binders derived at the
+ * same point of the handshake (truncated ClientHello, ServerHello, server
+ * Finished, client Finished) share one snapshot.
+ */
 template <typename Hash>
 class HandshakeContextImpl : public HandshakeContext {
  public:
@@ -59,8 +68,14 @@ class HandshakeContextImpl : public HandshakeContext {
   }
 
  private:
-  Buf transcript;
-  folly::ssl::OpenSSLHash::Digest hashState;
+  using Context = std::array<uint8_t, Hash::HashLen>;
+
+  const Context& checkpoint() const;
+
+  folly::ssl::EvpMdCtxUniquePtr hashState_;
+  mutable folly::ssl::EvpMdCtxUniquePtr scratch_;
+  mutable Context context_;
+  mutable bool contextValid_{false};
 };
 } // namespace fizz
 
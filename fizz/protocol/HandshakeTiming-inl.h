@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+
+template <typename StateEnum>
+folly::Optional<std::chrono::nanoseconds> HandshakeTiming::timeTo(
+    StateEnum state) const {
+  for (const auto& transition : transitions_) {
+    if (transition.to == static_cast<uint8_t>(state)) {
+      return transition.time - start_;
+    }
+  }
+  return folly::none;
+}
+
+namespace detail {
+
+template <typename T>
+struct HandshakeStageTimer {
+  template <typename Func>
+  static T run(HandshakeTiming* timing, HandshakeStage stage, Func&& func) {
+    auto start = HandshakeTiming::Clock::now();
+    SCOPE_EXIT {
+      timing->recordStage(stage, start);
+    };
+    return func();
+  }
+};
+
+template <typename T>
+struct HandshakeStageTimer<folly::Future<T>> {
+  template <typename Func>
+  static folly::Future<T>
+  run(HandshakeTiming* timing, HandshakeStage stage, Func&& func) {
+    auto start = HandshakeTiming::Clock::now();
+    return func().ensure(
+        [timing, stage, start]() { timing->recordStage(stage, start); });
+  }
+};
+} // namespace detail
+
+template <typename Func>
+auto timeHandshakeStage(
+    HandshakeTiming* timing,
+    HandshakeStage stage,
+    Func&& func) -> decltype(func()) {
+  if (!timing) {
+    return func();
+  }
+  return detail::HandshakeStageTimer<decltype(func())>::run(
+      timing, stage, std::forward<Func>(func));
+}
+} // namespace fizz
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/HandshakeTiming.h>
+
+namespace fizz {
+
+folly::StringPiece toString(HandshakeStage stage) {
+  switch (stage) {
+    case HandshakeStage::TicketDecrypt:
+      return "TicketDecrypt";
+    case HandshakeStage::ReplayCacheCheck:
+      return "ReplayCacheCheck";
+    case HandshakeStage::CertSelection:
+      return "CertSelection";
+    case HandshakeStage::Signing:
+      return "Signing";
+    case HandshakeStage::KeyExchange:
+      return "KeyExchange";
+    case HandshakeStage::NewSessionTicket:
+      return "NewSessionTicket";
+    case HandshakeStage::NUM_STAGES:
+      break;
+  }
+  return "Invalid HandshakeStage";
+}
+
+std::chrono::nanoseconds HandshakeTiming::elapsed() const {
+  if (transitions_.empty()) {
+    return std::chrono::nanoseconds::zero();
+  }
+  return transitions_.back().time - start_;
+}
+
+HandshakeTimingStats::HandshakeTimingStats(
+    std::chrono::microseconds bucketSize,
+    std::chrono::microseconds max)
+    : handshakes_(bucketSize.count(), 0, max.count()) {
+  for (size_t i = 0; i < static_cast<size_t>(HandshakeStage::NUM_STAGES);
+       ++i) {
+    stages_.emplace_back(bucketSize.count(), 0, max.count());
+  }
+}
+
+void HandshakeTimingStats::add(const HandshakeTiming& timing) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  handshakes_.addValue(duration_cast<microseconds>(timing.elapsed()).count());
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    const auto& stage = timing.stage(static_cast<HandshakeStage>(i));
+    if (stage.count > 0) {
+      stages_[i].addValue(duration_cast<microseconds>(stage.duration).count());
+    }
+  }
+}
+
+HandshakeTimingStats::Summary HandshakeTimingStats::getHandshakeSummary()
+    const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return summarize(handshakes_);
+}
+
+HandshakeTimingStats::Summary HandshakeTimingStats::getStageSummary(
+    HandshakeStage stage) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return summarize(stages_.at(static_cast<size_t>(stage)));
+}
+
+HandshakeTimingStats::Summary HandshakeTimingStats::summarize(
+    const Histogram& histogram) {
+  Summary summary;
+  summary.count = histogram.computeTotalCount();
+  if (summary.count > 0) {
+    summary.p50 =
+        std::chrono::microseconds(histogram.getPercentileEstimate(0.5));
+    summary.p90 =
+        std::chrono::microseconds(histogram.getPercentileEstimate(0.9));
+    summary.p99 =
+        std::chrono::microseconds(histogram.getPercentileEstimate(0.99));
+  }
+  return summary;
+}
+} // namespace fizz
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/ScopeGuard.h>
+#include <folly/futures/Future.h>
+#include <folly/stats/Histogram.h>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Parts of the handshake that may be slow or run asynchronously, timed
+ * separately from the state transitions.
+ */
+enum class HandshakeStage : uint8_t {
+  TicketDecrypt,
+  ReplayCacheCheck,
+  CertSelection,
+  Signing,
+  KeyExchange,
+  NewSessionTicket,
+  NUM_STAGES
+};
+
+folly::StringPiece toString(HandshakeStage stage);
+
+/**
+ * Timestamps of a single connection's handshake. Created when the handshake
+ * starts if the context has HandshakeTimingStats set, and only then, so a
+ * connection without it pays for a null check per transition.
+ *
+ * Transitions are recorded by the state machine. Stages may complete on the
+ * executor of an asynchronous operation (the ticket cipher or replay cache);
+ * each stage has its own slot, so stages running at the same time don't
+ * race.
+ */
+class HandshakeTiming {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct StateTransition {
+    // Values of the client or server StateEnum.
+    uint8_t from;
+    uint8_t to;
+    Clock::time_point time;
+  };
+
+  struct StageTiming {
+    // Total time spent in the stage, and the number of times it ran.
+    std::chrono::nanoseconds duration{0};
+    uint32_t count{0};
+  };
+
+  HandshakeTiming() : start_(Clock::now()) {}
+
+  /**
+   * Time the handshake started.
+   */
+  Clock::time_point start() const {
+    return start_;
+  }
+
+  void recordTransition(uint8_t from, uint8_t to) {
+    transitions_.push_back(StateTransition{from, to, Clock::now()});
+  }
+
+  const std::vector<StateTransition>& transitions() const {
+    return transitions_;
+  }
+
+  /**
+   * Time from the start of the handshake until the first transition to
+   * state, if it happened.
+   */
+  template <typename StateEnum>
+  folly::Optional<std::chrono::nanoseconds> timeTo(StateEnum state) const;
+
+  /**
+   * Time from the start of the handshake until the last transition.
+   */
+  std::chrono::nanoseconds elapsed() const;
+
+  void recordStage(HandshakeStage stage, Clock::time_point start) {
+    auto& timing = stages_[static_cast<size_t>(stage)];
+    timing.duration += Clock::now() - start;
+    timing.count++;
+  }
+
+  const StageTiming& stage(HandshakeStage stage) const {
+    return stages_[static_cast<size_t>(stage)];
+  }
+
+ private:
+  Clock::time_point start_;
+  std::vector<StateTransition> transitions_;
+  std::array<StageTiming, static_cast<size_t>(HandshakeStage::NUM_STAGES)>
+      stages_;
+};
+
+/**
+ * Runs func, recording the time it takes as stage on timing unless timing is
+ * null. If func returns a Future, the stage ends when the future completes.
+ */
+template <typename Func>
+auto timeHandshakeStage(
+    HandshakeTiming* timing,
+    HandshakeStage stage,
+    Func&& func) -> decltype(func());
+
+/**
+ * Histograms of handshake timings, aggregated over the connections of a
+ * context. Thread safe.
+ */
+class HandshakeTimingStats {
+ public:
+  struct Summary {
+    uint64_t count{0};
+    std::chrono::microseconds p50{0};
+    std::chrono::microseconds p90{0};
+    std::chrono::microseconds p99{0};
+  };
+
+  /**
+   * Timings are kept in buckets of bucketSize, up to max. Anything longer
+   * falls in an overflow bucket.
+   */
+  explicit HandshakeTimingStats(
+      std::chrono::microseconds bucketSize = std::chrono::microseconds(100),
+      std::chrono::microseconds max = std::chrono::seconds(1));
+
+  /**
+   * Adds a completed handshake.
+   */
+  void add(const HandshakeTiming& timing);
+
+  /**
+   * Distribution of complete handshake times.
+   */
+  Summary getHandshakeSummary() const;
+
+  /**
+   * Distribution of the time spent in stage, over the handshakes that went
+   * through it.
+   */
+  Summary getStageSummary(HandshakeStage stage) const;
+
+ private:
+  using Histogram = folly::Histogram<int64_t>;
+
+  static Summary summarize(const Histogram& histogram);
+
+  mutable std::mutex mutex_;
+  Histogram handshakes_;
+  std::vector<Histogram> stages_;
+};
+} // namespace fizz
+
+#include <fizz/protocol/HandshakeTiming-inl.h>
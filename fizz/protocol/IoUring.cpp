@@ -0,0 +1,294 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/IoUring.h>
+
+#if FIZZ_HAVE_IO_URING
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace fizz {
+
+namespace {
+
+int ioUringSetup(uint32_t entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(
+    int fd,
+    uint32_t toSubmit,
+    uint32_t minComplete,
+    uint32_t flags) {
+  return static_cast<int>(syscall(
+      __NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int fd, uint32_t opcode, void* arg, uint32_t nrArgs) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+[[noreturn]] void throwErrno(const char* what) {
+  throw std::runtime_error(
+      std::string(what) + " failed: " + std::to_string(errno));
+}
+
+void* mapRing(int fd, size_t size, off_t offset) {
+  auto ptr = mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      fd,
+      offset);
+  if (ptr == MAP_FAILED) {
+    throwErrno("io_uring mmap");
+  }
+  return ptr;
+}
+
+/**
+ * Checks multishot receive end to end on a socket pair: one receive must
+ * complete with data from the provided buffer ring and stay armed.
+ */
+bool probeMultishotReceive() {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    return false;
+  }
+  bool supported = false;
+  try {
+    IoUring ring(4, 2, 64);
+    auto sqe = ring.getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fds[0];
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = IoUring::kBufferGroup;
+    sqe->user_data = 1;
+    ring.submit();
+    if (write(fds[1], "x", 1) == 1) {
+      for (int i = 0; i < 1000 && !supported; ++i) {
+        bool done = false;
+        ring.reap([&](const io_uring_cqe& cqe) {
+          done = true;
+          supported = cqe.res == 1 && (cqe.flags & IORING_CQE_F_BUFFER) &&
+              (cqe.flags & IORING_CQE_F_MORE);
+        });
+        if (done) {
+          break;
+        }
+        usleep(100);
+      }
+    }
+  } catch (const std::exception&) {
+    supported = false;
+  }
+  close(fds[0]);
+  close(fds[1]);
+  return supported;
+}
+} // namespace
+
+IoUring::IoUring(uint32_t entries, uint32_t bufferCount, uint32_t bufferSize)
+    : bufferSize_(bufferSize) {
+  if (bufferCount == 0 || bufferCount > 32768 ||
+      (bufferCount & (bufferCount - 1)) != 0 || bufferSize == 0) {
+    throw std::runtime_error("invalid io_uring buffer configuration");
+  }
+
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  fd_ = ioUringSetup(entries, &params);
+  if (fd_ < 0) {
+    throwErrno("io_uring_setup");
+  }
+
+  try {
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+      throw std::runtime_error("io_uring single mmap not supported");
+    }
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqRingSize_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    sqRing_ = mapRing(fd_, sqRingSize_, IORING_OFF_SQ_RING);
+    cqRing_ = sqRing_;
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(
+        mapRing(fd_, sqesSize_, IORING_OFF_SQES));
+
+    auto sq = static_cast<uint8_t*>(sqRing_);
+    sqHead_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sqEntries_ =
+        *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_entries);
+    sqArray_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    auto cq = static_cast<uint8_t*>(cqRing_);
+    cqHead_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    setupBufferRing(bufferCount);
+  } catch (...) {
+    cleanup();
+    throw;
+  }
+}
+
+IoUring::~IoUring() {
+  cleanup();
+}
+
+void IoUring::cleanup() {
+  if (sqes_) {
+    munmap(sqes_, sqesSize_);
+    sqes_ = nullptr;
+  }
+  if (sqRing_) {
+    munmap(sqRing_, sqRingSize_);
+    sqRing_ = cqRing_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    // Closing the ring cancels anything in flight before the buffers go.
+    close(fd_);
+    fd_ = -1;
+  }
+  if (bufRing_) {
+    munmap(bufRing_, bufRingSize_);
+    bufRing_ = nullptr;
+  }
+  if (buffers_) {
+    munmap(buffers_, buffersSize_);
+    buffers_ = nullptr;
+  }
+}
+
+bool IoUring::isSupported() {
+  static const bool supported = probeMultishotReceive();
+  return supported;
+}
+
+void IoUring::setupBufferRing(uint32_t bufferCount) {
+  bufRingSize_ = bufferCount * sizeof(io_uring_buf);
+  auto ring = mmap(
+      nullptr,
+      bufRingSize_,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (ring == MAP_FAILED) {
+    throwErrno("io_uring buffer ring mmap");
+  }
+  bufRing_ = static_cast<io_uring_buf_ring*>(ring);
+  bufRingMask_ = bufferCount - 1;
+
+  buffersSize_ = size_t(bufferCount) * bufferSize_;
+  auto buffers = mmap(
+      nullptr,
+      buffersSize_,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (buffers == MAP_FAILED) {
+    throwErrno("io_uring buffers mmap");
+  }
+  buffers_ = static_cast<uint8_t*>(buffers);
+
+  io_uring_buf_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uint64_t>(bufRing_);
+  reg.ring_entries = bufferCount;
+  reg.bgid = kBufferGroup;
+  if (ioUringRegister(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+    throwErrno("io_uring buffer ring registration");
+  }
+
+  for (uint32_t i = 0; i < bufferCount; ++i) {
+    recycleBuffer(static_cast<uint16_t>(i));
+  }
+}
+
+io_uring_sqe* IoUring::getSqe() {
+  auto tail = *sqTail_;
+  if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+    submit();
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+      return nullptr;
+    }
+  }
+  auto index = tail & sqMask_;
+  auto sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqArray_[index] = index;
+  __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+  ++pendingSubmissions_;
+  return sqe;
+}
+
+size_t IoUring::submit() {
+  size_t submitted = 0;
+  while (pendingSubmissions_ > 0) {
+    auto ret = ioUringEnter(fd_, pendingSubmissions_, 0, 0);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EBUSY) {
+        // Completions need reaping first; the rest goes with the next
+        // submit.
+        break;
+      }
+      throwErrno("io_uring_enter");
+    }
+    pendingSubmissions_ -= ret;
+    submitted += ret;
+    if (ret == 0) {
+      break;
+    }
+  }
+  return submitted;
+}
+
+void IoUring::registerEventFd(int eventFd) {
+  if (ioUringRegister(fd_, IORING_REGISTER_EVENTFD, &eventFd, 1) != 0) {
+    throwErrno("io_uring eventfd registration");
+  }
+}
+
+void IoUring::recycleBuffer(uint16_t bufferId) {
+  auto tail = bufRing_->tail;
+  // Not bufRing_->bufs: in C++ the header's flexible array is preceded by an
+  // empty struct that takes up space, putting it at the wrong offset. The
+  // entries start at the beginning of the ring, the first one overlapping
+  // the tail.
+  auto bufs = reinterpret_cast<io_uring_buf*>(bufRing_);
+  auto& buf = bufs[tail & bufRingMask_];
+  buf.addr = reinterpret_cast<uint64_t>(buffer(bufferId));
+  buf.len = bufferSize_;
+  buf.bid = bufferId;
+  __atomic_store_n(&bufRing_->tail, tail + 1, __ATOMIC_RELEASE);
+}
+} // namespace fizz
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// Multishot receive is the newest feature relied on.
+#if defined(IORING_RECV_MULTISHOT)
+#define FIZZ_HAVE_IO_URING 1
+#else
+#define FIZZ_HAVE_IO_URING 0
+#endif
+
+#if FIZZ_HAVE_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fizz {
+
+/**
+ * Minimal io_uring instance on top of the raw system calls: a submission
+ * queue, a completion queue and one ring of provided receive buffers, which
+ * the kernel picks from as data arrives so that idle receives hold no
+ * memory. Not thread safe.
+ */
+class IoUring {
+ public:
+  /**
+   * Buffer group of the provided buffer ring, for IOSQE_BUFFER_SELECT.
+   */
+  static constexpr uint16_t kBufferGroup = 0;
+
+  /**
+   * entries is the submission queue size. bufferCount (a power of 2 of at
+   * most 32768) buffers of bufferSize bytes are provided for receives. Throws
+   * if the kernel doesn't support what's needed.
+   */
+  IoUring(uint32_t entries, uint32_t bufferCount, uint32_t bufferSize);
+
+  ~IoUring();
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  /**
+   * Whether the running kernel supports provided buffer rings and multishot
+   * receive. Probed once.
+   */
+  static bool isSupported();
+
+  /**
+   * Returns a zeroed submission queue entry, submitting what's queued first
+   * if the queue is full. Returns nullptr if the kernel didn't take enough of
+   * the queue to make room.
+   */
+  io_uring_sqe* getSqe();
+
+  /**
+   * Submits every queued entry with a single system call. Returns the number
+   * submitted.
+   */
+  size_t submit();
+
+  /**
+   * Number of entries queued but not yet submitted.
+   */
+  size_t pendingSubmissions() const {
+    return pendingSubmissions_;
+  }
+
+  /**
+   * Calls func(const io_uring_cqe&) for every available completion. Returns
+   * the number of completions.
+   */
+  template <typename Func>
+  size_t reap(Func&& func);
+
+  /**
+   * Has the kernel signal eventFd whenever a completion is posted.
+   */
+  void registerEventFd(int eventFd);
+
+  uint32_t bufferSize() const {
+    return bufferSize_;
+  }
+
+  uint8_t* buffer(uint16_t bufferId) const {
+    return buffers_ + size_t(bufferId) * bufferSize_;
+  }
+
+  /**
+   * Id of a buffer given its address.
+   */
+  uint16_t bufferId(const void* buf) const {
+    return static_cast<uint16_t>(
+        (static_cast<const uint8_t*>(buf) - buffers_) / bufferSize_);
+  }
+
+  /**
+   * Hands a buffer the kernel filled back to it for reuse.
+   */
+  void recycleBuffer(uint16_t bufferId);
+
+ private:
+  void setupBufferRing(uint32_t bufferCount);
+  void cleanup();
+
+  int fd_{-1};
+  size_t pendingSubmissions_{0};
+
+  void* sqRing_{nullptr};
+  size_t sqRingSize_{0};
+  void* cqRing_{nullptr};
+  size_t cqRingSize_{0};
+  io_uring_sqe* sqes_{nullptr};
+  size_t sqesSize_{0};
+
+  uint32_t* sqHead_;
+  uint32_t* sqTail_;
+  uint32_t sqMask_;
+  uint32_t sqEntries_;
+  uint32_t* sqArray_;
+  uint32_t* cqHead_;
+  uint32_t* cqTail_;
+  uint32_t cqMask_;
+  io_uring_cqe* cqes_;
+
+  io_uring_buf_ring* bufRing_{nullptr};
+  size_t bufRingSize_{0};
+  uint32_t bufRingMask_{0};
+  uint8_t* buffers_{nullptr};
+  size_t buffersSize_{0};
+  uint32_t bufferSize_;
+};
+
+template <typename Func>
+size_t IoUring::reap(Func&& func) {
+  auto head = *cqHead_;
+  auto tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  size_t count = 0;
+  while (head != tail) {
+    // Copy out so the slot can be released before func runs; func may
+    // submit more work.
+    io_uring_cqe cqe = cqes_[head & cqMask_];
+    __atomic_store_n(cqHead_, ++head, __ATOMIC_RELEASE);
+    ++count;
+    func(cqe);
+    tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  }
+  return count;
+}
+} // namespace fizz
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+
+template <typename StateT>
+folly::Optional<KTLSCryptoParams> KTLS::getParams(
+    const StateT& state,
+    AppTrafficSecrets secret,
+    KTLSDirection direction) {
+  if (!state.cipher() || !state.version() || !state.keyScheduler() ||
+      !isSupported(*state.cipher(), *state.version())) {
+    return folly::none;
+  }
+  uint64_t seqNum;
+  if (direction == KTLSDirection::Tx) {
+    auto layer = dynamic_cast<const EncryptedWriteRecordLayer*>(
+        state.writeRecordLayer());
+    if (!layer) {
+      return folly::none;
+    }
+    seqNum = layer->getSequenceNumber();
+  } else {
+    auto layer = dynamic_cast<const EncryptedReadRecordLayer*>(
+        state.readRecordLayer());
+    if (!layer) {
+      return folly::none;
+    }
+    seqNum = layer->getSequenceNumber();
+  }
+  auto trafficSecret = state.keyScheduler()->getSecret(secret);
+  return makeParams(
+      *state.cipher(),
+      folly::range(trafficSecret),
+      seqNum,
+      *state.context()->getFactory(),
+      *state.keyScheduler());
+}
+
+template <typename StateT>
+std::unique_ptr<KTLSControlRecordWriter> enableKTLSTx(
+    StateT& state,
+    folly::AsyncSocket& socket,
+    AppTrafficSecrets writeSecret) {
+  if (socket.getRawBytesBuffered() != 0) {
+    return nullptr;
+  }
+  auto params = KTLS::getParams(state, writeSecret, KTLSDirection::Tx);
+  if (!params) {
+    return nullptr;
+  }
+  auto fd = socket.getFd();
+  if (!KTLS::attach(fd) || !KTLS::install(fd, KTLSDirection::Tx, *params)) {
+    return nullptr;
+  }
+  auto writer = std::make_unique<KTLSControlRecordWriter>(&socket);
+  auto layer = std::make_unique<KTLSWriteRecordLayer>(writer.get());
+  layer->setProtocolVersion(*state.version());
+  state.writeRecordLayer() = std::move(layer);
+  return writer;
+}
+
+template <typename StateT>
+void syncKTLSTx(
+    StateT& state,
+    KTLSControlRecordWriter& writer,
+    AppTrafficSecrets writeSecret) {
+  auto writeLayer = state.writeRecordLayer().get();
+  if (!writeLayer || dynamic_cast<const KTLSWriteRecordLayer*>(writeLayer)) {
+    return;
+  }
+  auto params = KTLS::getParams(state, writeSecret, KTLSDirection::Tx);
+  if (!params ||
+      !KTLS::install(
+          writer.getSocket()->getFd(), KTLSDirection::Tx, *params)) {
+    throw std::runtime_error("kTLS rekey failed");
+  }
+  auto layer = std::make_unique<KTLSWriteRecordLayer>(&writer);
+  layer->setProtocolVersion(*state.version());
+  state.writeRecordLayer() = std::move(layer);
+}
+} // namespace fizz
@@ -0,0 +1,255 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/KTLS.h>
+
+#include <folly/lang/Bits.h>
+
+#if FIZZ_HAVE_KTLS
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/crypto.h>
+#include <sys/socket.h>
+#endif
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
+namespace fizz {
+
+bool KTLS::isSupported(CipherSuite cipher, ProtocolVersion version) {
+#if FIZZ_HAVE_KTLS
+  auto realVersion = getRealDraftVersion(version);
+  if (realVersion == ProtocolVersion::tls_1_3_23 ||
+      realVersion == ProtocolVersion::tls_1_3_22 ||
+      realVersion == ProtocolVersion::tls_1_3_21 ||
+      realVersion == ProtocolVersion::tls_1_3_20) {
+    return false;
+  }
+  switch (cipher) {
+    case CipherSuite::TLS_AES_128_GCM_SHA256:
+#ifdef TLS_CIPHER_AES_GCM_256
+    case CipherSuite::TLS_AES_256_GCM_SHA384:
+#endif
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+    case CipherSuite::TLS_CHACHA20_POLY1305_SHA256:
+#endif
+      return true;
+    default:
+      return false;
+  }
+#else
+  (void)cipher;
+  (void)version;
+  return false;
+#endif
+}
+
+KTLSCryptoParams KTLS::makeParams(
+    CipherSuite cipher,
+    folly::ByteRange trafficSecret,
+    uint64_t seqNum,
+    const Factory& factory,
+    const KeyScheduler& scheduler) {
+  auto aead = factory.makeAead(cipher);
+  KTLSCryptoParams params;
+  params.cipher = cipher;
+  params.key = scheduler.getTrafficKey(
+      trafficSecret, aead->keyLength(), aead->ivLength());
+  params.seqNum = seqNum;
+  return params;
+}
+
+#if FIZZ_HAVE_KTLS
+
+namespace {
+
+/**
+ * Fills in one of the kernel's crypto_info structs. In TLS 1.3 the 12 byte
+ * iv is split into a 4 byte salt and 8 byte iv for the AES-GCM suites.
+ */
+template <typename Info>
+void fillCryptoInfo(
+    Info& info,
+    uint16_t cipherType,
+    const KTLSCryptoParams& params) {
+  auto key = params.key.key->coalesce();
+  auto iv = params.key.iv->coalesce();
+  if (key.size() != sizeof(info.key) ||
+      iv.size() != sizeof(info.salt) + sizeof(info.iv)) {
+    throw std::runtime_error("kTLS key size mismatch");
+  }
+  memset(&info, 0, sizeof(info));
+  info.info.version = TLS_1_3_VERSION;
+  info.info.cipher_type = cipherType;
+  memcpy(info.key, key.data(), sizeof(info.key));
+  memcpy(info.salt, iv.data(), sizeof(info.salt));
+  memcpy(info.iv, iv.data() + sizeof(info.salt), sizeof(info.iv));
+  uint64_t seq = folly::Endian::big(params.seqNum);
+  memcpy(info.rec_seq, &seq, sizeof(info.rec_seq));
+}
+
+template <typename Info>
+bool setCryptoInfo(int fd, KTLSDirection direction, Info& info) {
+  int rc = setsockopt(
+      fd,
+      SOL_TLS,
+      direction == KTLSDirection::Tx ? TLS_TX : TLS_RX,
+      &info,
+      sizeof(info));
+  OPENSSL_cleanse(&info, sizeof(info));
+  if (rc != 0) {
+    VLOG(4) << "kTLS setsockopt failed: " << errno;
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+bool KTLS::attach(int fd) {
+  static const char kUlp[] = "tls";
+  if (setsockopt(fd, SOL_TCP, TCP_ULP, kUlp, sizeof(kUlp)) != 0) {
+    // EEXIST means the ULP is already attached.
+    if (errno != EEXIST) {
+      VLOG(4) << "kTLS unavailable: " << errno;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool KTLS::install(
+    int fd,
+    KTLSDirection direction,
+    const KTLSCryptoParams& params) {
+  switch (params.cipher) {
+    case CipherSuite::TLS_AES_128_GCM_SHA256: {
+      tls12_crypto_info_aes_gcm_128 info;
+      fillCryptoInfo(info, TLS_CIPHER_AES_GCM_128, params);
+      return setCryptoInfo(fd, direction, info);
+    }
+#ifdef TLS_CIPHER_AES_GCM_256
+    case CipherSuite::TLS_AES_256_GCM_SHA384: {
+      tls12_crypto_info_aes_gcm_256 info;
+      fillCryptoInfo(info, TLS_CIPHER_AES_GCM_256, params);
+      return setCryptoInfo(fd, direction, info);
+    }
+#endif
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+    case CipherSuite::TLS_CHACHA20_POLY1305_SHA256: {
+      // ChaCha20-Poly1305 takes the whole iv and has no salt.
+      tls12_crypto_info_chacha20_poly1305 info;
+      auto key = params.key.key->coalesce();
+      auto iv = params.key.iv->coalesce();
+      if (key.size() != sizeof(info.key) || iv.size() != sizeof(info.iv)) {
+        throw std::runtime_error("kTLS key size mismatch");
+      }
+      memset(&info, 0, sizeof(info));
+      info.info.version = TLS_1_3_VERSION;
+      info.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+      memcpy(info.key, key.data(), sizeof(info.key));
+      memcpy(info.iv, iv.data(), sizeof(info.iv));
+      uint64_t seq = folly::Endian::big(params.seqNum);
+      memcpy(info.rec_seq, &seq, sizeof(info.rec_seq));
+      return setCryptoInfo(fd, direction, info);
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+uint32_t KTLSControlRecordWriter::getAncillaryDataSize(
+    folly::WriteFlags flags) noexcept {
+  if (!folly::isSet(flags, folly::WriteFlags::EOR) || pending_.empty()) {
+    return 0;
+  }
+  return CMSG_SPACE(sizeof(uint8_t));
+}
+
+void KTLSControlRecordWriter::getAncillaryData(
+    folly::WriteFlags flags,
+    void* data) noexcept {
+  if (!folly::isSet(flags, folly::WriteFlags::EOR) || pending_.empty()) {
+    return;
+  }
+  memset(data, 0, CMSG_SPACE(sizeof(uint8_t)));
+  auto cmsg = static_cast<cmsghdr*>(data);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = static_cast<uint8_t>(pending_.front());
+}
+
+#else
+
+bool KTLS::attach(int) {
+  return false;
+}
+
+bool KTLS::install(int, KTLSDirection, const KTLSCryptoParams&) {
+  return false;
+}
+
+uint32_t KTLSControlRecordWriter::getAncillaryDataSize(
+    folly::WriteFlags) noexcept {
+  return 0;
+}
+
+void KTLSControlRecordWriter::getAncillaryData(
+    folly::WriteFlags,
+    void*) noexcept {}
+
+#endif
+
+KTLSControlRecordWriter::KTLSControlRecordWriter(folly::AsyncSocket* socket)
+    : socket_(socket) {
+  socket_->setSendMsgParamCB(this);
+}
+
+KTLSControlRecordWriter::~KTLSControlRecordWriter() {
+  socket_->setSendMsgParamCB(nullptr);
+}
+
+void KTLSControlRecordWriter::writeRecord(ContentType type, Buf data) {
+  // Queued first, as the socket may send (or fail) the write immediately.
+  pending_.push_back(type);
+  socket_->writeChain(this, std::move(data), folly::WriteFlags::EOR);
+}
+
+int KTLSControlRecordWriter::getFlagsImpl(
+    folly::WriteFlags,
+    int defaultFlags) noexcept {
+  // EOR only marks control records; kTLS sockets reject MSG_EOR.
+  return defaultFlags & ~MSG_EOR;
+}
+
+void KTLSControlRecordWriter::writeSuccess() noexcept {
+  pending_.pop_front();
+}
+
+void KTLSControlRecordWriter::writeErr(
+    size_t,
+    const folly::AsyncSocketException& ex) noexcept {
+  VLOG(4) << "kTLS control record write failed: " << ex.what();
+  pending_.pop_front();
+}
+
+Buf KTLSWriteRecordLayer::write(TLSMessage&& msg) const {
+  if (msg.type == ContentType::application_data) {
+    return std::move(msg.fragment);
+  }
+  writer_->writeRecord(msg.type, std::move(msg.fragment));
+  return folly::IOBuf::create(0);
+}
+} // namespace fizz
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Factory.h>
+#include <fizz/protocol/KeyScheduler.h>
+#include <fizz/record/EncryptedRecordLayer.h>
+#include <folly/io/async/AsyncSocket.h>
+
+#include <deque>
+
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#endif
+
+// Older headers lack the TLS 1.3 version or record type control messages.
+#if defined(TLS_1_3_VERSION) && defined(TLS_SET_RECORD_TYPE)
+#define FIZZ_HAVE_KTLS 1
+#else
+#define FIZZ_HAVE_KTLS 0
+#endif
+
+namespace fizz {
+
+enum class KTLSDirection { Tx, Rx };
+
+/**
+ * Everything the kernel needs to take over record protection for one
+ * direction of a connection.
+ */
+struct KTLSCryptoParams {
+  CipherSuite cipher;
+  TrafficKey key;
+  uint64_t seqNum{0};
+};
+
+/**
+ * Linux kernel TLS (kTLS) support. Once a connection is established its
+ * traffic keys can be handed to the kernel, after which plaintext written to
+ * the socket (including with sendfile) is sent as TLS application data.
+ */
+class KTLS {
+ public:
+  /**
+   * Whether the kernel can protect records of this cipher and version. Only
+   * the final TLS 1.3 record format (with the record header as additional
+   * data) is supported.
+   */
+  static bool isSupported(CipherSuite cipher, ProtocolVersion version);
+
+  /**
+   * Derives the key and iv for trafficSecret, to be installed starting at
+   * record seqNum.
+   */
+  static KTLSCryptoParams makeParams(
+      CipherSuite cipher,
+      folly::ByteRange trafficSecret,
+      uint64_t seqNum,
+      const Factory& factory,
+      const KeyScheduler& scheduler);
+
+  /**
+   * Exports the params for one direction of a connection (client or server
+   * state). Must only be called once the handshake has completed, so that
+   * the record layers use the application traffic keys. Returns none if the
+   * cipher can't be offloaded or the direction isn't encrypted by fizz.
+   */
+  template <typename StateT>
+  static folly::Optional<KTLSCryptoParams> getParams(
+      const StateT& state,
+      AppTrafficSecrets secret,
+      KTLSDirection direction);
+
+  /**
+   * Attaches the TLS upper layer protocol to a TCP socket. Returns false if
+   * the kernel doesn't support kTLS; the socket is unchanged in that case.
+   */
+  static bool attach(int fd);
+
+  /**
+   * Installs keys for one direction on a socket that attach() succeeded on.
+   * Installing Tx again after a key update replaces the key on kernels that
+   * support TLS 1.3 rekeying. Returns false on failure.
+   */
+  static bool install(
+      int fd,
+      KTLSDirection direction,
+      const KTLSCryptoParams& params);
+};
+
+/**
+ * Writes records other than application data (alerts, post-handshake
+ * messages) on a socket with kTLS Tx. The kernel needs their content type
+ * in a control message on the send that carries them, so each is queued on
+ * the socket like any other write, and this, installed as the socket's
+ * SendMsgParamsCallback, attaches the type when the socket sends it.
+ * Control records are marked with WriteFlags::EOR, which kTLS sockets don't
+ * otherwise accept; it is never passed to the kernel.
+ *
+ * Must outlive the socket's pending writes; destroy the socket first, or
+ * close it, which fails them.
+ */
+class KTLSControlRecordWriter
+    : public folly::AsyncSocket::SendMsgParamsCallback,
+      private folly::AsyncTransportWrapper::WriteCallback {
+ public:
+  explicit KTLSControlRecordWriter(folly::AsyncSocket* socket);
+  ~KTLSControlRecordWriter() override;
+
+  void writeRecord(ContentType type, Buf data);
+
+  folly::AsyncSocket* getSocket() const {
+    return socket_;
+  }
+
+  uint32_t getAncillaryDataSize(folly::WriteFlags flags) noexcept override;
+  void getAncillaryData(folly::WriteFlags flags, void* data) noexcept override;
+
+ private:
+  int getFlagsImpl(folly::WriteFlags flags, int defaultFlags) noexcept
+      override;
+
+  void writeSuccess() noexcept override;
+  void writeErr(size_t, const folly::AsyncSocketException& ex) noexcept
+      override;
+
+  folly::AsyncSocket* socket_;
+  // Types of the control records queued on the socket, oldest first. The
+  // socket writes in order, so the oldest is the one being sent.
+  std::deque<ContentType> pending_;
+};
+
+/**
+ * Write record layer for a socket whose Tx direction is in the kernel.
+ * Application data is returned as plaintext for the transport to write.
+ * Other records are handed to the KTLSControlRecordWriter, which queues
+ * them on the socket behind any data already buffered there.
+ */
+class KTLSWriteRecordLayer : public WriteRecordLayer {
+ public:
+  explicit KTLSWriteRecordLayer(KTLSControlRecordWriter* writer)
+      : writer_(writer) {}
+
+  Buf write(TLSMessage&& msg) const override;
+
+ private:
+  KTLSControlRecordWriter* writer_;
+};
+
+/**
+ * Moves the write direction of an established connection into the kernel
+ * and replaces the state's write record layer with a KTLSWriteRecordLayer.
+ * Returns the writer for the connection's control records, which the
+ * caller keeps for as long as the socket is in use, or nullptr, leaving
+ * the connection in user space, if moving isn't possible.
+ */
+template <typename StateT>
+std::unique_ptr<KTLSControlRecordWriter> enableKTLSTx(
+    StateT& state,
+    folly::AsyncSocket& socket,
+    AppTrafficSecrets writeSecret);
+
+/**
+ * To be called after the state machine mutates a state that has kTLS Tx
+ * enabled. If a key update installed a new user space write record layer,
+ * the new key is moved into the kernel. Throws if that fails, as the
+ * connection can't continue on the old key.
+ */
+template <typename StateT>
+void syncKTLSTx(
+    StateT& state,
+    KTLSControlRecordWriter& writer,
+    AppTrafficSecrets writeSecret);
+} // namespace fizz
+
+#include <fizz/protocol/KTLS-inl.h>
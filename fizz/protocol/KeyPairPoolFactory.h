@@ -0,0 +1,36 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/exchange/X25519KeyPairPool.h>
+#include <fizz/protocol/Factory.h>
+
+namespace fizz {
+
+/**
+ * Factory whose X25519 key exchanges take their key pairs from a pool shared
+ * by all connections using this factory.
+ */
+class KeyPairPoolFactory : public Factory {
+ public:
+  explicit KeyPairPoolFactory(std::shared_ptr<X25519KeyPairPool> pool)
+      : pool_(std::move(pool)) {}
+
+  std::unique_ptr<KeyExchange> makeKeyExchange(
+      NamedGroup group) const override {
+    if (group == NamedGroup::x25519) {
+      return std::make_unique<X25519KeyExchange>(pool_);
+    }
+    return Factory::makeKeyExchange(group);
+  }
+
+ private:
+  std::shared_ptr<X25519KeyPairPool> pool_;
+};
+} // namespace fizz
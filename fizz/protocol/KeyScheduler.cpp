@@ -189,6 +189,35 @@ std::vector<uint8_t> KeyScheduler::getSecret(AppTrafficSecrets s) const {
   }
 }
 
+uint32_t KeyScheduler::getAppTrafficGeneration(AppTrafficSecrets s) const {
+  auto& appTrafficSecret = *appTrafficSecret_;
+  switch (s) {
+    case AppTrafficSecrets::ClientAppTraffic:
+      return appTrafficSecret.clientGeneration;
+    case AppTrafficSecrets::ServerAppTraffic:
+      return appTrafficSecret.serverGeneration;
+    default:
+      LOG(FATAL) << "unknown secret";
+  }
+}
+
+void KeyScheduler::setAppTrafficSecrets(
+    folly::ByteRange client,
+    uint32_t clientGeneration,
+    folly::ByteRange server,
+    uint32_t serverGeneration) {
+  if (client.size() != deriver_->hashLength() ||
+      server.size() != deriver_->hashLength()) {
+    throw std::runtime_error("app traffic secret length mismatch");
+  }
+  AppTrafficSecret trafficSecret;
+  trafficSecret.client = std::vector<uint8_t>(client.begin(), client.end());
+  trafficSecret.clientGeneration = clientGeneration;
+  trafficSecret.server = std::vector<uint8_t>(server.begin(), server.end());
+  trafficSecret.serverGeneration = serverGeneration;
+  appTrafficSecret_ = std::move(trafficSecret);
+}
+
 TrafficKey KeyScheduler::getTrafficKey(
     folly::ByteRange trafficSecret,
     size_t keyLength,
@@ -210,4 +239,251 @@ Buf KeyScheduler::getResumptionSecret(
       folly::IOBuf::wrapBuffer(ticketNonce),
       deriver_->hashLength());
 }
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::checkStage(Stage stage) const {
+  if (stage_ != stage) {
+    throw std::runtime_error("key scheduler in wrong state");
+  }
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::advance(Stage from, folly::ByteRange ikm) {
+  checkStage(from);
+  auto preSecret = Engine::deriveSecret(
+      secret_.hmac(), kDerivedSecret, folly::ByteRange(Hash::BlankHash));
+  secret_.set(Engine::extract(folly::range(preSecret), ikm));
+  stage_ = static_cast<Stage>(static_cast<int>(from) + 1);
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::deriveEarlySecret(folly::ByteRange psk) {
+  if (stage_ != Stage::None) {
+    throw std::runtime_error("secret already set");
+  }
+  static const Secret kZeros{};
+  secret_.set(Engine::extract(folly::range(kZeros), psk));
+  stage_ = Stage::Early;
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::deriveHandshakeSecret() {
+  static const Secret kZeros{};
+  advance(Stage::Early, folly::range(kZeros));
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::deriveHandshakeSecret(folly::ByteRange ecdhe) {
+  if (stage_ == Stage::None) {
+    static const Secret kZeros{};
+    deriveEarlySecret(folly::range(kZeros));
+  }
+  advance(Stage::Early, ecdhe);
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::deriveMasterSecret() {
+  static const Secret kZeros{};
+  advance(Stage::Handshake, folly::range(kZeros));
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::deriveAppTrafficSecrets(
+    folly::ByteRange transcript) {
+  checkStage(Stage::Master);
+  appTrafficSecret_.emplace();
+  appTrafficSecret_->client.set(Engine::deriveSecret(
+      secret_.hmac(), kClientAppTraffic, transcript));
+  appTrafficSecret_->server.set(Engine::deriveSecret(
+      secret_.hmac(), kServerAppTraffic, transcript));
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::clearMasterSecret() {
+  checkStage(Stage::Master);
+  secret_.clear();
+  stage_ = Stage::None;
+}
+
+template <typename Hash>
+uint32_t KeySchedulerImpl<Hash>::clientKeyUpdate() {
+  auto& appTrafficSecret = appTrafficSecret_.value();
+  Secret next;
+  Engine::expandLabel(
+      appTrafficSecret.client.hmac(),
+      kTrafficKeyUpdate,
+      folly::ByteRange(),
+      folly::range(next));
+  appTrafficSecret.client.set(next);
+  return ++appTrafficSecret.clientGeneration;
+}
+
+template <typename Hash>
+uint32_t KeySchedulerImpl<Hash>::serverKeyUpdate() {
+  auto& appTrafficSecret = appTrafficSecret_.value();
+  Secret next;
+  Engine::expandLabel(
+      appTrafficSecret.server.hmac(),
+      kTrafficKeyUpdate,
+      folly::ByteRange(),
+      folly::range(next));
+  appTrafficSecret.server.set(next);
+  return ++appTrafficSecret.serverGeneration;
+}
+
+template <typename Hash>
+std::vector<uint8_t> KeySchedulerImpl<Hash>::deriveFromStage(
+    Stage stage,
+    folly::StringPiece label,
+    folly::ByteRange transcript) const {
+  checkStage(stage);
+  auto secret = Engine::deriveSecret(secret_.hmac(), label, transcript);
+  return std::vector<uint8_t>(secret.begin(), secret.end());
+}
+
+template <typename Hash>
+std::vector<uint8_t> KeySchedulerImpl<Hash>::getSecret(
+    EarlySecrets s,
+    folly::ByteRange transcript) const {
+  switch (s) {
+    case EarlySecrets::ExternalPskBinder:
+      return deriveFromStage(Stage::Early, kExternalPskBinder, transcript);
+    case EarlySecrets::ResumptionPskBinder:
+      return deriveFromStage(Stage::Early, kResumptionPskBinder, transcript);
+    case EarlySecrets::ClientEarlyTraffic:
+      return deriveFromStage(Stage::Early, kClientEarlyTraffic, transcript);
+    case EarlySecrets::EarlyExporter:
+      return deriveFromStage(Stage::Early, kEarlyExporter, transcript);
+  }
+  LOG(FATAL) << "unknown secret";
+}
+
+template <typename Hash>
+std::vector<uint8_t> KeySchedulerImpl<Hash>::getSecret(
+    HandshakeSecrets s,
+    folly::ByteRange transcript) const {
+  switch (s) {
+    case HandshakeSecrets::ClientHandshakeTraffic:
+      return deriveFromStage(
+          Stage::Handshake, kClientHandshakeTraffic, transcript);
+    case HandshakeSecrets::ServerHandshakeTraffic:
+      return deriveFromStage(
+          Stage::Handshake, kServerHandshakeTraffic, transcript);
+  }
+  LOG(FATAL) << "unknown secret";
+}
+
+template <typename Hash>
+std::vector<uint8_t> KeySchedulerImpl<Hash>::getSecret(
+    MasterSecrets s,
+    folly::ByteRange transcript) const {
+  switch (s) {
+    case MasterSecrets::ExporterMaster:
+      return deriveFromStage(Stage::Master, kExporterMaster, transcript);
+    case MasterSecrets::ResumptionMaster:
+      return deriveFromStage(Stage::Master, kResumptionMaster, transcript);
+  }
+  LOG(FATAL) << "unknown secret";
+}
+
+template <typename Hash>
+std::vector<uint8_t> KeySchedulerImpl<Hash>::getSecret(
+    AppTrafficSecrets s) const {
+  const auto& appTrafficSecret = appTrafficSecret_.value();
+  const Secret* secret = nullptr;
+  switch (s) {
+    case AppTrafficSecrets::ClientAppTraffic:
+      secret = &appTrafficSecret.client.secret();
+      break;
+    case AppTrafficSecrets::ServerAppTraffic:
+      secret = &appTrafficSecret.server.secret();
+      break;
+    default:
+      LOG(FATAL) << "unknown secret";
+  }
+  return std::vector<uint8_t>(secret->begin(), secret->end());
+}
+
+template <typename Hash>
+uint32_t KeySchedulerImpl<Hash>::getAppTrafficGeneration(
+    AppTrafficSecrets s) const {
+  const auto& appTrafficSecret = appTrafficSecret_.value();
+  switch (s) {
+    case AppTrafficSecrets::ClientAppTraffic:
+      return appTrafficSecret.clientGeneration;
+    case AppTrafficSecrets::ServerAppTraffic:
+      return appTrafficSecret.serverGeneration;
+  }
+  LOG(FATAL) << "unknown secret";
+}
+
+template <typename Hash>
+void KeySchedulerImpl<Hash>::setAppTrafficSecrets(
+    folly::ByteRange client,
+    uint32_t clientGeneration,
+    folly::ByteRange server,
+    uint32_t serverGeneration) {
+  if (client.size() != Hash::HashLen || server.size() != Hash::HashLen) {
+    throw std::runtime_error("app traffic secret length mismatch");
+  }
+  Secret secret;
+  appTrafficSecret_.emplace();
+  std::copy(client.begin(), client.end(), secret.begin());
+  appTrafficSecret_->client.set(secret);
+  appTrafficSecret_->clientGeneration = clientGeneration;
+  std::copy(server.begin(), server.end(), secret.begin());
+  appTrafficSecret_->server.set(secret);
+  appTrafficSecret_->serverGeneration = serverGeneration;
+}
+
+template <typename Hash>
+TrafficKey KeySchedulerImpl<Hash>::deriveTrafficKey(
+    folly::ByteRange trafficSecret,
+    folly::ByteRange keyLabel,
+    size_t keyLength,
+    folly::ByteRange ivLabel,
+    size_t ivLength) {
+  CHECK_EQ(trafficSecret.size(), Hash::HashLen);
+  PrecomputedHmac<Hash> hmac(trafficSecret);
+  TrafficKey trafficKey;
+  trafficKey.key = folly::IOBuf::create(keyLength);
+  Engine::expand(hmac, keyLabel, {trafficKey.key->writableData(), keyLength});
+  trafficKey.key->append(keyLength);
+  trafficKey.iv = folly::IOBuf::create(ivLength);
+  Engine::expand(hmac, ivLabel, {trafficKey.iv->writableData(), ivLength});
+  trafficKey.iv->append(ivLength);
+  return trafficKey;
+}
+
+template <typename Hash>
+TrafficKey KeySchedulerImpl<Hash>::getTrafficKey(
+    folly::ByteRange trafficSecret,
+    size_t keyLength,
+    size_t ivLength) const {
+  typename Engine::LabelBuffer keyLabelBuf;
+  typename Engine::LabelBuffer ivLabelBuf;
+  return deriveTrafficKey(
+      trafficSecret,
+      Engine::encodeLabel(
+          kTrafficKey, folly::ByteRange(), keyLength, keyLabelBuf),
+      keyLength,
+      Engine::encodeLabel(kTrafficIv, folly::ByteRange(), ivLength, ivLabelBuf),
+      ivLength);
+}
+
+template <typename Hash>
+Buf KeySchedulerImpl<Hash>::getResumptionSecret(
+    folly::ByteRange resumptionMasterSecret,
+    folly::ByteRange ticketNonce) const {
+  CHECK_EQ(resumptionMasterSecret.size(), Hash::HashLen);
+  PrecomputedHmac<Hash> hmac(resumptionMasterSecret);
+  auto out = folly::IOBuf::create(Hash::HashLen);
+  Engine::expandLabel(
+      hmac, kResumption, ticketNonce, {out->writableData(), Hash::HashLen});
+  out->append(Hash::HashLen);
+  return out;
+}
+
+template class KeySchedulerImpl<Sha256>;
+template class KeySchedulerImpl<Sha384>;
 } // namespace fizz
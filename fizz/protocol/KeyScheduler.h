@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fizz/crypto/KeyDerivation.h>
+#include <fizz/crypto/KeyScheduleEngine.h>
 #include <fizz/crypto/aead/Aead.h>
 #include <folly/Optional.h>
 
@@ -94,6 +95,23 @@ class KeyScheduler {
       folly::ByteRange transcript) const;
   virtual std::vector<uint8_t> getSecret(AppTrafficSecrets s) const;
 
+  /**
+   * Number of key updates that led to the current app traffic secret. Traffic
+   * secrets must be derived.
+   */
+  virtual uint32_t getAppTrafficGeneration(AppTrafficSecrets s) const;
+
+  /**
+   * Installs the app traffic secrets of a connection established elsewhere,
+   * along with their generations, for it to continue here. Any other secret
+   * is left unset.
+   */
+  virtual void setAppTrafficSecrets(
+      folly::ByteRange client,
+      uint32_t clientGeneration,
+      folly::ByteRange server,
+      uint32_t serverGeneration);
+
   /**
    * Derive a traffic key and iv from a traffic secret.
    */
@@ -110,6 +128,12 @@ class KeyScheduler {
       folly::ByteRange resumptionMasterSecret,
       folly::ByteRange ticketNonce) const;
 
+ protected:
+  /**
+   * For subclasses that do their own derivation.
+   */
+  KeyScheduler() = default;
+
  private:
   struct EarlySecret {
     std::vector<uint8_t> secret;
@@ -133,4 +157,85 @@ class KeyScheduler {
 
   std::unique_ptr<KeyDerivation> deriver_;
 };
+
+/**
+ * KeyScheduler for a fixed hash. Secrets live in fixed-size arrays alongside
+ * their precomputed HMAC key state, so each secret is keyed once no matter how
+ * many labels are derived from it, and no derivation allocates except to
+ * return a result.
+ */
+template <typename Hash>
+class KeySchedulerImpl : public KeyScheduler {
+ public:
+  KeySchedulerImpl() = default;
+  ~KeySchedulerImpl() override = default;
+
+  void deriveEarlySecret(folly::ByteRange psk) override;
+  void deriveHandshakeSecret() override;
+  void deriveHandshakeSecret(folly::ByteRange ecdhe) override;
+  void deriveMasterSecret() override;
+  void deriveAppTrafficSecrets(folly::ByteRange transcript) override;
+  void clearMasterSecret() override;
+  uint32_t clientKeyUpdate() override;
+  uint32_t serverKeyUpdate() override;
+
+  std::vector<uint8_t> getSecret(EarlySecrets s, folly::ByteRange transcript)
+      const override;
+  std::vector<uint8_t> getSecret(
+      HandshakeSecrets s,
+      folly::ByteRange transcript) const override;
+  std::vector<uint8_t> getSecret(MasterSecrets s, folly::ByteRange transcript)
+      const override;
+  std::vector<uint8_t> getSecret(AppTrafficSecrets s) const override;
+  uint32_t getAppTrafficGeneration(AppTrafficSecrets s) const override;
+  void setAppTrafficSecrets(
+      folly::ByteRange client,
+      uint32_t clientGeneration,
+      folly::ByteRange server,
+      uint32_t serverGeneration) override;
+
+  TrafficKey getTrafficKey(
+      folly::ByteRange trafficSecret,
+      size_t keyLength,
+      size_t ivLength) const override;
+
+  Buf getResumptionSecret(
+      folly::ByteRange resumptionMasterSecret,
+      folly::ByteRange ticketNonce) const override;
+
+ private:
+  using Engine = KeyScheduleEngine<Hash>;
+  using Secret = typename Engine::Secret;
+  using KeyedSecret = typename Engine::KeyedSecret;
+
+  enum class Stage { None, Early, Handshake, Master };
+
+  void checkStage(Stage stage) const;
+  std::vector<uint8_t> deriveFromStage(
+      Stage stage,
+      folly::StringPiece label,
+      folly::ByteRange transcript) const;
+  void advance(Stage from, folly::ByteRange ikm);
+  static TrafficKey deriveTrafficKey(
+      folly::ByteRange trafficSecret,
+      folly::ByteRange keyLabel,
+      size_t keyLength,
+      folly::ByteRange ivLabel,
+      size_t ivLength);
+
+  struct AppTrafficSecret {
+    KeyedSecret client;
+    uint32_t clientGeneration{0};
+    KeyedSecret server;
+    uint32_t serverGeneration{0};
+  };
+
+  Stage stage_{Stage::None};
+  KeyedSecret secret_;
+  folly::Optional<AppTrafficSecret> appTrafficSecret_;
+};
+
+// Defined in KeyScheduler.cpp for the hashes of the supported ciphers.
+extern template class KeySchedulerImpl<Sha256>;
+extern template class KeySchedulerImpl<Sha384>;
 } // namespace fizz
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/aead/AESGCMNative.h>
+#include <fizz/protocol/Factory.h>
+
+namespace fizz {
+
+/**
+ * Factory that protects AES-GCM records with AESGCMNative instead of
+ * OpenSSL when the CPU supports it. AESGCMNative is not yet the default
+ * because it has far less interop and fuzzing exposure than OpenSSL; opt in
+ * with this factory. Layered on top of BaseFactory, which it forwards its
+ * constructor arguments to.
+ */
+template <typename BaseFactory = Factory>
+class NativeAeadFactory : public BaseFactory {
+ public:
+  template <typename... Args>
+  explicit NativeAeadFactory(Args&&... args)
+      : BaseFactory(std::forward<Args>(args)...) {}
+
+  std::unique_ptr<Aead> makeAead(CipherSuite cipher) const override {
+    switch (cipher) {
+      case CipherSuite::TLS_AES_128_GCM_SHA256:
+        if (AESGCMNative<AESGCM128>::isSupported()) {
+          return std::make_unique<AESGCMNative<AESGCM128>>();
+        }
+        break;
+      case CipherSuite::TLS_AES_256_GCM_SHA384:
+        if (AESGCMNative<AESGCM256>::isSupported()) {
+          return std::make_unique<AESGCMNative<AESGCM256>>();
+        }
+        break;
+      default:
+        break;
+    }
+    return BaseFactory::makeAead(cipher);
+  }
+};
+} // namespace fizz
@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Factory.h>
+#include <fizz/record/RecordParallelism.h>
+
+namespace fizz {
+
+/**
+ * Factory whose encrypted record layers spread the aead work of large reads
+ * and writes over an executor, so that a single high bandwidth connection
+ * isn't limited to one core. Worthwhile for bulk transfers with ciphers
+ * whose aead supports concurrent use, i.e. AEGIS or the native AES-GCM one
+ * (see NativeAeadFactory).
+ * The executor must outlive every connection using this factory. Layered on
+ * top of BaseFactory, whose constructor arguments follow the parallelism.
+ */
+template <typename BaseFactory = Factory>
+class ParallelRecordFactory : public BaseFactory {
+ public:
+  template <typename... Args>
+  explicit ParallelRecordFactory(RecordParallelism parallelism, Args&&... args)
+      : BaseFactory(std::forward<Args>(args)...), parallelism_(parallelism) {}
+
+  std::unique_ptr<EncryptedReadRecordLayer> makeEncryptedReadRecordLayer()
+      const override {
+    auto layer = BaseFactory::makeEncryptedReadRecordLayer();
+    layer->setParallelism(parallelism_);
+    return layer;
+  }
+
+  std::unique_ptr<EncryptedWriteRecordLayer> makeEncryptedWriteRecordLayer()
+      const override {
+    auto layer = BaseFactory::makeEncryptedWriteRecordLayer();
+    layer->setParallelism(parallelism_);
+    return layer;
+  }
+
+ private:
+  RecordParallelism parallelism_;
+};
+} // namespace fizz
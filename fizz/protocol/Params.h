@@ -76,6 +76,7 @@ using Param = boost::variant<
     EncryptedExtensions,
     CertificateRequest,
     CertificateMsg,
+    CompressedCertificate,
     CertificateVerify,
     Finished,
     NewSessionTicket,
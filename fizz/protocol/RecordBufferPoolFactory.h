@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Factory.h>
+#include <fizz/record/RecordBufferPool.h>
+
+namespace fizz {
+
+/**
+ * Factory whose encrypted write record layers take their record buffers
+ * from a pool shared by all connections using this factory. Meant for
+ * transports with zero copy writes enabled, where buffers are recycled only
+ * after the kernel is done sending them. Layered on top of BaseFactory, whose
+ * constructor arguments follow the pool.
+ */
+template <typename BaseFactory = Factory>
+class RecordBufferPoolFactory : public BaseFactory {
+ public:
+  template <typename... Args>
+  explicit RecordBufferPoolFactory(
+      std::shared_ptr<RecordBufferPool> pool,
+      Args&&... args)
+      : BaseFactory(std::forward<Args>(args)...), pool_(std::move(pool)) {}
+
+  std::unique_ptr<EncryptedWriteRecordLayer> makeEncryptedWriteRecordLayer()
+      const override {
+    auto layer = BaseFactory::makeEncryptedWriteRecordLayer();
+    layer->setBufferPool(pool_);
+    return layer;
+  }
+
+ private:
+  std::shared_ptr<RecordBufferPool> pool_;
+};
+} // namespace fizz
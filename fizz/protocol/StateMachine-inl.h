@@ -36,6 +36,10 @@ class EventHandlerBase {
     CHECK_EQ(stateStruct.state(), state);
     VLOG(8) << "Transition from " << toString(state) << " to " << toString(to);
     stateStruct.state() = to;
+    if (stateStruct.handshakeTiming()) {
+      stateStruct.handshakeTiming()->recordTransition(
+          static_cast<uint8_t>(state), static_cast<uint8_t>(to));
+    }
   }
 };
 
@@ -0,0 +1,198 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/Stats.h>
+
+namespace fizz {
+
+folly::StringPiece toString(StatsCounter counter) {
+  switch (counter) {
+    case StatsCounter::HandshakeSuccess:
+      return "HandshakeSuccess";
+    case StatsCounter::PskAttempted:
+      return "PskAttempted";
+    case StatsCounter::PskAccepted:
+      return "PskAccepted";
+    case StatsCounter::PskRejected:
+      return "PskRejected";
+    case StatsCounter::TicketDecryptFailure:
+      return "TicketDecryptFailure";
+    case StatsCounter::EarlyDataAttempted:
+      return "EarlyDataAttempted";
+    case StatsCounter::EarlyDataAccepted:
+      return "EarlyDataAccepted";
+    case StatsCounter::EarlyDataRejected:
+      return "EarlyDataRejected";
+    case StatsCounter::HelloRetryRequest:
+      return "HelloRetryRequest";
+    case StatsCounter::ReplayCacheNotChecked:
+      return "ReplayCacheNotChecked";
+    case StatsCounter::ReplayCacheNotReplay:
+      return "ReplayCacheNotReplay";
+    case StatsCounter::ReplayCacheMaybeReplay:
+      return "ReplayCacheMaybeReplay";
+    case StatsCounter::ReplayCacheDefinitelyReplay:
+      return "ReplayCacheDefinitelyReplay";
+    case StatsCounter::HandshakeError:
+      return "HandshakeError";
+    case StatsCounter::RecordsEncrypted:
+      return "RecordsEncrypted";
+    case StatsCounter::BytesEncrypted:
+      return "BytesEncrypted";
+    case StatsCounter::RecordsDecrypted:
+      return "RecordsDecrypted";
+    case StatsCounter::BytesDecrypted:
+      return "BytesDecrypted";
+    case StatsCounter::NUM_COUNTERS:
+      break;
+  }
+  return "Invalid StatsCounter";
+}
+
+constexpr size_t FizzStats::kNumShards;
+constexpr size_t FizzStats::kNumCiphers;
+constexpr size_t FizzStats::kNumGroups;
+constexpr size_t FizzStats::kCipherOffset;
+constexpr size_t FizzStats::kGroupOffset;
+constexpr size_t FizzStats::kNumShardCounters;
+
+const std::array<CipherSuite, FizzStats::kNumCiphers> FizzStats::kCiphers = {
+    {CipherSuite::TLS_AES_128_GCM_SHA256,
+     CipherSuite::TLS_AES_256_GCM_SHA384,
+     CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+     CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL,
+     CipherSuite::TLS_AEGIS_128L_SHA256_EXPERIMENTAL}};
+
+const std::array<NamedGroup, FizzStats::kNumGroups> FizzStats::kGroups = {
+    {NamedGroup::secp256r1, NamedGroup::x25519}};
+
+FizzStats::Snapshot& FizzStats::Snapshot::operator+=(const Snapshot& other) {
+  for (size_t i = 0; i < counters.size(); ++i) {
+    counters[i] += other.counters[i];
+  }
+  for (const auto& cipher : other.ciphers) {
+    ciphers[cipher.first] += cipher.second;
+  }
+  for (const auto& group : other.groups) {
+    groups[group.first] += group.second;
+  }
+  for (const auto& error : other.errorsByAlert) {
+    errorsByAlert[error.first] += error.second;
+  }
+  return *this;
+}
+
+FizzStats::FizzStats() {
+  for (auto& shard : shards_) {
+    for (auto& counter : shard.counters) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+  }
+  for (auto& counter : errorsByAlert_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t FizzStats::shardIndex() {
+  static std::atomic<size_t> nextShard{0};
+  static thread_local size_t shard =
+      nextShard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+void FizzStats::recordHandshakeSuccess(
+    CipherSuite cipher,
+    folly::Optional<NamedGroup> group,
+    PskType pskType,
+    EarlyDataType earlyDataType) {
+  increment(StatsCounter::HandshakeSuccess);
+
+  for (size_t i = 0; i < kNumCiphers; ++i) {
+    if (kCiphers[i] == cipher) {
+      add(kCipherOffset + i, 1);
+      break;
+    }
+  }
+  if (group) {
+    for (size_t i = 0; i < kNumGroups; ++i) {
+      if (kGroups[i] == *group) {
+        add(kGroupOffset + i, 1);
+        break;
+      }
+    }
+  }
+
+  switch (pskType) {
+    case PskType::External:
+    case PskType::Resumption:
+      increment(StatsCounter::PskAttempted);
+      increment(StatsCounter::PskAccepted);
+      break;
+    case PskType::Rejected:
+      increment(StatsCounter::PskAttempted);
+      increment(StatsCounter::PskRejected);
+      break;
+    case PskType::NotSupported:
+    case PskType::NotAttempted:
+      break;
+  }
+
+  switch (earlyDataType) {
+    case EarlyDataType::Accepted:
+      increment(StatsCounter::EarlyDataAttempted);
+      increment(StatsCounter::EarlyDataAccepted);
+      break;
+    case EarlyDataType::Rejected:
+      increment(StatsCounter::EarlyDataAttempted);
+      increment(StatsCounter::EarlyDataRejected);
+      break;
+    case EarlyDataType::NotAttempted:
+    case EarlyDataType::Attempted:
+      break;
+  }
+}
+
+void FizzStats::recordHandshakeError(folly::Optional<AlertDescription> alert) {
+  increment(StatsCounter::HandshakeError);
+  if (alert) {
+    errorsByAlert_[static_cast<uint8_t>(*alert)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+}
+
+FizzStats::Snapshot FizzStats::snapshot() const {
+  std::array<uint64_t, kNumShardCounters> totals{};
+  for (const auto& shard : shards_) {
+    for (size_t i = 0; i < kNumShardCounters; ++i) {
+      totals[i] += shard.counters[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  Snapshot snapshot;
+  for (size_t i = 0; i < snapshot.counters.size(); ++i) {
+    snapshot.counters[i] = totals[i];
+  }
+  for (size_t i = 0; i < kNumCiphers; ++i) {
+    if (totals[kCipherOffset + i] > 0) {
+      snapshot.ciphers[kCiphers[i]] = totals[kCipherOffset + i];
+    }
+  }
+  for (size_t i = 0; i < kNumGroups; ++i) {
+    if (totals[kGroupOffset + i] > 0) {
+      snapshot.groups[kGroups[i]] = totals[kGroupOffset + i];
+    }
+  }
+  for (size_t i = 0; i < errorsByAlert_.size(); ++i) {
+    auto count = errorsByAlert_[i].load(std::memory_order_relaxed);
+    if (count > 0) {
+      snapshot.errorsByAlert[static_cast<AlertDescription>(i)] = count;
+    }
+  }
+  return snapshot;
+}
+} // namespace fizz
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Types.h>
+#include <fizz/record/RecordStats.h>
+#include <fizz/record/Types.h>
+#include <folly/Optional.h>
+#include <folly/lang/Align.h>
+
+#include <array>
+#include <atomic>
+#include <map>
+
+namespace fizz {
+
+enum class StatsCounter : uint8_t {
+  HandshakeSuccess,
+  // Successful handshakes that offered a PSK, and whether it was used.
+  PskAttempted,
+  PskAccepted,
+  PskRejected,
+  // Server only: tickets the ticket cipher couldn't decrypt.
+  TicketDecryptFailure,
+  // Successful handshakes that attempted early data, and the outcome.
+  EarlyDataAttempted,
+  EarlyDataAccepted,
+  EarlyDataRejected,
+  // HelloRetryRequests sent (server) or received (client).
+  HelloRetryRequest,
+  // Server only: results of the replay cache check for each resumption.
+  ReplayCacheNotChecked,
+  ReplayCacheNotReplay,
+  ReplayCacheMaybeReplay,
+  ReplayCacheDefinitelyReplay,
+  HandshakeError,
+  RecordsEncrypted,
+  BytesEncrypted,
+  RecordsDecrypted,
+  BytesDecrypted,
+  NUM_COUNTERS
+};
+
+folly::StringPiece toString(StatsCounter counter);
+
+/**
+ * Counters for the connections of a client or server context, set on it with
+ * setStats(). Handshake outcomes are counted by the protocol state machines;
+ * record counts need the record layers made by a StatsFactory holding the
+ * same object.
+ *
+ * Updates are lock free and don't share cache lines across threads: each
+ * thread is assigned one of a fixed number of cache line aligned shards of
+ * relaxed atomic counters. snapshot() sums the shards and may be called from
+ * any thread at any time.
+ */
+class FizzStats : public RecordStats {
+ public:
+  /**
+   * Aggregated counter values.
+   */
+  struct Snapshot {
+    std::array<uint64_t, static_cast<size_t>(StatsCounter::NUM_COUNTERS)>
+        counters{};
+    // Negotiated parameters of successful handshakes.
+    std::map<CipherSuite, uint64_t> ciphers;
+    std::map<NamedGroup, uint64_t> groups;
+    // Handshake errors by the alert sent. Errors that sent no alert are only
+    // counted in HandshakeError.
+    std::map<AlertDescription, uint64_t> errorsByAlert;
+
+    uint64_t operator[](StatsCounter counter) const {
+      return counters[static_cast<size_t>(counter)];
+    }
+
+    /**
+     * Adds other's counts, e.g. to aggregate the stats of several contexts.
+     */
+    Snapshot& operator+=(const Snapshot& other);
+  };
+
+  FizzStats();
+
+  FizzStats(const FizzStats&) = delete;
+  FizzStats& operator=(const FizzStats&) = delete;
+
+  void increment(StatsCounter counter, uint64_t amount = 1) {
+    add(static_cast<size_t>(counter), amount);
+  }
+
+  void recordEncrypted(size_t bytes) override {
+    increment(StatsCounter::RecordsEncrypted);
+    increment(StatsCounter::BytesEncrypted, bytes);
+  }
+
+  void recordDecrypted(size_t bytes) override {
+    increment(StatsCounter::RecordsDecrypted);
+    increment(StatsCounter::BytesDecrypted, bytes);
+  }
+
+  void recordHandshakeSuccess(
+      CipherSuite cipher,
+      folly::Optional<NamedGroup> group,
+      PskType pskType,
+      EarlyDataType earlyDataType);
+
+  void recordHandshakeError(folly::Optional<AlertDescription> alert);
+
+  Snapshot snapshot() const;
+
+ private:
+  static constexpr size_t kNumShards = 32;
+  static constexpr size_t kNumCiphers = 5;
+  static constexpr size_t kNumGroups = 2;
+
+  static constexpr size_t kCipherOffset =
+      static_cast<size_t>(StatsCounter::NUM_COUNTERS);
+  static constexpr size_t kGroupOffset = kCipherOffset + kNumCiphers;
+  static constexpr size_t kNumShardCounters = kGroupOffset + kNumGroups;
+
+  static const std::array<CipherSuite, kNumCiphers> kCiphers;
+  static const std::array<NamedGroup, kNumGroups> kGroups;
+
+  struct alignas(folly::hardware_destructive_interference_size) Shard {
+    std::array<std::atomic<uint64_t>, kNumShardCounters> counters;
+  };
+
+  static size_t shardIndex();
+
+  void add(size_t index, uint64_t amount) {
+    shards_[shardIndex()].counters[index].fetch_add(
+        amount, std::memory_order_relaxed);
+  }
+
+  std::array<Shard, kNumShards> shards_;
+
+  // Errors are rare enough not to need sharding.
+  std::array<std::atomic<uint64_t>, 256> errorsByAlert_;
+};
+} // namespace fizz
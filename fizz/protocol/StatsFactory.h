@@ -0,0 +1,46 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Factory.h>
+#include <fizz/protocol/Stats.h>
+
+namespace fizz {
+
+/**
+ * Factory whose encrypted record layers count the records and bytes they
+ * protect into stats, normally the same FizzStats set on the context.
+ * Layered on top of BaseFactory, whose constructor arguments follow the
+ * stats.
+ */
+template <typename BaseFactory = Factory>
+class StatsFactory : public BaseFactory {
+ public:
+  template <typename... Args>
+  explicit StatsFactory(std::shared_ptr<FizzStats> stats, Args&&... args)
+      : BaseFactory(std::forward<Args>(args)...), stats_(std::move(stats)) {}
+
+  std::unique_ptr<EncryptedReadRecordLayer> makeEncryptedReadRecordLayer()
+      const override {
+    auto layer = BaseFactory::makeEncryptedReadRecordLayer();
+    layer->setStats(stats_);
+    return layer;
+  }
+
+  std::unique_ptr<EncryptedWriteRecordLayer> makeEncryptedWriteRecordLayer()
+      const override {
+    auto layer = BaseFactory::makeEncryptedWriteRecordLayer();
+    layer->setStats(stats_);
+    return layer;
+  }
+
+ private:
+  std::shared_ptr<FizzStats> stats_;
+};
+} // namespace fizz
@@ -35,6 +35,15 @@ struct RSATest {
   using Invalid = P256Test;
 };
 
+#if FIZZ_OPENSSL_HAS_ED25519
+struct Ed25519Test {
+  static constexpr KeyType Type = KeyType::ED25519;
+  static constexpr SignatureScheme Scheme = SignatureScheme::ed25519;
+
+  using Invalid = P256Test;
+};
+#endif
+
 template <typename T>
 static ssl::X509UniquePtr getCert();
 
@@ -48,6 +57,13 @@ ssl::X509UniquePtr getCert<RSATest>() {
   return fizz::test::getCert(kRSACertificate);
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+ssl::X509UniquePtr getCert<Ed25519Test>() {
+  return fizz::test::getCert(kEd25519Certificate);
+}
+#endif
+
 template <typename T>
 static ssl::EvpPkeyUniquePtr getKey();
 
@@ -61,6 +77,13 @@ ssl::EvpPkeyUniquePtr getKey<RSATest>() {
   return getPrivateKey(kRSAKey);
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+template <>
+ssl::EvpPkeyUniquePtr getKey<Ed25519Test>() {
+  return getPrivateKey(kEd25519Key);
+}
+#endif
+
 template <typename T>
 class CertTestTyped : public Test {
  public:
@@ -69,7 +92,11 @@ class CertTestTyped : public Test {
   }
 };
 
+#if FIZZ_OPENSSL_HAS_ED25519
+using KeyTypes = Types<P256Test, RSATest, Ed25519Test>;
+#else
 using KeyTypes = Types<P256Test, RSATest>;
+#endif
 TYPED_TEST_CASE(CertTestTyped, KeyTypes);
 
 TEST(CertTest, GetIdentity) {
@@ -142,6 +169,15 @@ TEST(CertTest, MakePeerCertJunk) {
       CertUtils::makePeerCert(IOBuf::copyBuffer("blah")), std::runtime_error);
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+TEST(CertTest, MakeSelfCertEd25519) {
+  auto selfCert = CertUtils::makeSelfCert(
+      kEd25519Certificate.str(), kEd25519Key.str());
+  std::vector<SignatureScheme> expected{SignatureScheme::ed25519};
+  EXPECT_EQ(selfCert->getSigSchemes(), expected);
+}
+#endif
+
 TEST(CertTest, PeerCertGetX509) {
   PeerCertImpl<KeyType::P256> peerCert(getCert(kP256Certificate));
   auto x509 = peerCert.getX509();
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/ConnectionState.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+static ExportedConnectionState makeState() {
+  ExportedConnectionState state;
+  state.version = ProtocolVersion::tls_1_3;
+  state.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+  state.group = NamedGroup::x25519;
+  state.pskType = PskType::Resumption;
+  state.clientAppTrafficSecret = std::vector<uint8_t>(32, 0x01);
+  state.clientAppTrafficGeneration = 2;
+  state.serverAppTrafficSecret = std::vector<uint8_t>(32, 0x02);
+  state.serverAppTrafficGeneration = 3;
+  state.readSeqNum = 17;
+  state.writeSeqNum = (uint64_t(1) << 40) + 5;
+  state.alpn = "h2";
+  state.pskIdentity = "www.example.com";
+  state.selfCertIdentity = "self";
+  state.exporterMasterSecret = IOBuf::copyBuffer("exportermastersecret");
+  state.resumptionSecret = IOBuf::copyBuffer("resumptionsecret");
+  state.bufferedData = IOBuf::copyBuffer("partial record");
+  return state;
+}
+
+TEST(ConnectionStateTest, TestRoundTrip) {
+  auto state = makeState();
+  auto decoded = decodeConnectionState(encodeConnectionState(state));
+  EXPECT_EQ(decoded.version, state.version);
+  EXPECT_EQ(decoded.cipher, state.cipher);
+  EXPECT_EQ(decoded.group, state.group);
+  EXPECT_EQ(decoded.pskType, state.pskType);
+  EXPECT_EQ(decoded.clientAppTrafficSecret, state.clientAppTrafficSecret);
+  EXPECT_EQ(decoded.clientAppTrafficGeneration, 2u);
+  EXPECT_EQ(decoded.serverAppTrafficSecret, state.serverAppTrafficSecret);
+  EXPECT_EQ(decoded.serverAppTrafficGeneration, 3u);
+  EXPECT_EQ(decoded.readSeqNum, 17u);
+  EXPECT_EQ(decoded.writeSeqNum, state.writeSeqNum);
+  EXPECT_EQ(decoded.alpn, state.alpn);
+  EXPECT_FALSE(decoded.sni.hasValue());
+  EXPECT_EQ(decoded.pskIdentity, state.pskIdentity);
+  EXPECT_FALSE(decoded.peerCert);
+  EXPECT_EQ(decoded.selfCertIdentity, "self");
+  EXPECT_TRUE(IOBufEqualTo()(
+      decoded.exporterMasterSecret, state.exporterMasterSecret));
+  EXPECT_TRUE(
+      IOBufEqualTo()(decoded.resumptionSecret, state.resumptionSecret));
+  EXPECT_TRUE(IOBufEqualTo()(decoded.bufferedData, state.bufferedData));
+}
+
+TEST(ConnectionStateTest, TestEmptyOptionals) {
+  ExportedConnectionState state;
+  state.version = ProtocolVersion::tls_1_3;
+  state.cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+  auto decoded = decodeConnectionState(encodeConnectionState(state));
+  EXPECT_FALSE(decoded.group.hasValue());
+  EXPECT_FALSE(decoded.alpn.hasValue());
+  EXPECT_FALSE(decoded.exporterMasterSecret);
+  EXPECT_FALSE(decoded.resumptionSecret);
+  EXPECT_FALSE(decoded.bufferedData);
+  EXPECT_TRUE(decoded.selfCertIdentity.empty());
+}
+
+TEST(ConnectionStateTest, TestBadFormat) {
+  auto encoded = encodeConnectionState(makeState());
+  encoded->writableData()[1] = 0xff;
+  EXPECT_THROW(decodeConnectionState(std::move(encoded)), std::runtime_error);
+}
+
+TEST(ConnectionStateTest, TestTruncated) {
+  auto encoded = encodeConnectionState(makeState());
+  encoded->coalesce();
+  encoded->trimEnd(5);
+  EXPECT_ANY_THROW(decodeConnectionState(std::move(encoded)));
+}
+
+TEST(ConnectionStateTest, TestTrailingData) {
+  auto encoded = encodeConnectionState(makeState());
+  encoded->prependChain(IOBuf::copyBuffer("extra"));
+  EXPECT_THROW(decodeConnectionState(std::move(encoded)), std::runtime_error);
+}
+} // namespace test
+} // namespace fizz
@@ -8,6 +8,7 @@
 
 #include <gtest/gtest.h>
 
+#include <fizz/crypto/test/TestUtil.h>
 #include <fizz/protocol/DefaultCertificateVerifier.h>
 #include <fizz/protocol/test/Utilities.h>
 
@@ -71,6 +72,20 @@ TEST_F(DefaultCertificateVerifierTest, TestVerifySelfSignedCertWithOverride) {
   verifier_->verify({getPeerCert(selfsigned)});
 }
 
+#if FIZZ_OPENSSL_HAS_ED25519
+TEST_F(DefaultCertificateVerifierTest, TestVerifyEd25519) {
+  auto root = getCert(kEd25519Certificate);
+  folly::ssl::X509StoreUniquePtr store(X509_STORE_new());
+  ASSERT_EQ(X509_STORE_add_cert(store.get(), root.get()), 1);
+  DefaultCertificateVerifier verifier(
+      VerificationContext::Client, std::move(store));
+  verifier.verify({std::make_shared<PeerCertImpl<KeyType::ED25519>>(
+      getCert(kEd25519Certificate))});
+  EXPECT_THROW(
+      verifier.verify({getPeerCert(leafCertAndKey_)}), std::runtime_error);
+}
+#endif
+
 TEST_F(DefaultCertificateVerifierTest, TestVerifyWithIntermediateMissing) {
   auto subauth = createCert("subauth", true, &rootCertAndKey_);
   auto subleaf = createCert("subleaf", false, &subauth);
@@ -0,0 +1,220 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/crypto/openssl/OpenSSLKeyUtils.h>
+#include <fizz/protocol/DelegatedCredential.h>
+#include <fizz/protocol/test/Utilities.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+class DelegatedCredentialTest : public Test {
+ protected:
+  static void addDelegationUsage(CertAndKey& certAndKey) {
+    ssl::ASN1ObjUniquePtr oid(OBJ_txt2obj("1.3.6.1.4.1.44363.44", 1));
+    throwIfNull(oid, "failed to create oid");
+    // The extension value is an ASN.1 NULL.
+    static const unsigned char kNull[] = {0x05, 0x00};
+    std::unique_ptr<ASN1_OCTET_STRING, decltype(&ASN1_OCTET_STRING_free)>
+        value(ASN1_OCTET_STRING_new(), ASN1_OCTET_STRING_free);
+    throwIfNull(value, "failed to create extension value");
+    throwIfNeq(
+        ASN1_OCTET_STRING_set(value.get(), kNull, sizeof(kNull)),
+        1,
+        "failed to set extension value");
+    ssl::X509ExtensionUniquePtr ext(
+        X509_EXTENSION_create_by_OBJ(nullptr, oid.get(), 0, value.get()));
+    throwIfNull(ext, "failed to create extension");
+    throwIfNeq(
+        X509_add_ext(certAndKey.cert.get(), ext.get(), -1),
+        1,
+        "failed to add extension");
+    if (X509_sign(
+            certAndKey.cert.get(), certAndKey.key.get(), EVP_sha256()) == 0) {
+      throw std::runtime_error("failed to re-sign certificate");
+    }
+  }
+
+  static std::shared_ptr<SelfCert> getSelfCert(const CertAndKey& certAndKey) {
+    std::vector<ssl::X509UniquePtr> certs;
+    certs.emplace_back(X509_dup(certAndKey.cert.get()));
+    EVP_PKEY_up_ref(certAndKey.key.get());
+    return std::make_shared<SelfCertImpl<KeyType::P256>>(
+        ssl::EvpPkeyUniquePtr(certAndKey.key.get()), std::move(certs));
+  }
+
+  static std::unique_ptr<SelfDelegatedCredential> generate(
+      const SelfCert& cert,
+      std::chrono::seconds validFor = std::chrono::hours(1)) {
+    return DelegatedCredentialUtils::generateCredential(
+        cert,
+        SignatureScheme::ecdsa_secp256r1_sha256,
+        SignatureScheme::ecdsa_secp256r1_sha256,
+        detail::generateECKeyPair(NID_X9_62_prime256v1),
+        validFor);
+  }
+
+  static DelegatedCredential copy(const DelegatedCredential& credential) {
+    DelegatedCredential ret;
+    ret.valid_time = credential.valid_time;
+    ret.expected_verify_scheme = credential.expected_verify_scheme;
+    ret.public_key = credential.public_key->clone();
+    ret.credential_scheme = credential.credential_scheme;
+    ret.signature = credential.signature->clone();
+    return ret;
+  }
+};
+
+TEST_F(DelegatedCredentialTest, TestSignAndVerify) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto selfCert = getSelfCert(certAndKey);
+  auto credential = generate(*selfCert);
+  EXPECT_EQ(
+      credential->getSigScheme(), SignatureScheme::ecdsa_secp256r1_sha256);
+  EXPECT_GT(credential->getExpiry(), std::chrono::system_clock::now());
+
+  auto peerCert = DelegatedCredentialUtils::makePeerDelegatedCredential(
+      getPeerCert(certAndKey), copy(credential->getCredential()));
+  EXPECT_EQ(peerCert->getIdentity(), "dc");
+
+  auto data = IOBuf::copyBuffer("handshake context");
+  auto sig =
+      credential->sign(CertificateVerifyContext::Server, data->coalesce());
+  peerCert->verify(
+      SignatureScheme::ecdsa_secp256r1_sha256,
+      CertificateVerifyContext::Server,
+      data->coalesce(),
+      sig->coalesce());
+
+  // The certificate's own key doesn't verify signatures from the credential.
+  EXPECT_THROW(
+      getPeerCert(certAndKey)->verify(
+          SignatureScheme::ecdsa_secp256r1_sha256,
+          CertificateVerifyContext::Server,
+          data->coalesce(),
+          sig->coalesce()),
+      std::runtime_error);
+}
+
+#if FIZZ_OPENSSL_HAS_ED25519
+TEST_F(DelegatedCredentialTest, TestEd25519Credential) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto credential = DelegatedCredentialUtils::generateCredential(
+      *getSelfCert(certAndKey),
+      SignatureScheme::ecdsa_secp256r1_sha256,
+      SignatureScheme::ed25519,
+      detail::generateEd25519KeyPair(),
+      std::chrono::hours(1));
+  EXPECT_EQ(credential->getSigScheme(), SignatureScheme::ed25519);
+
+  auto peerCert = DelegatedCredentialUtils::makePeerDelegatedCredential(
+      getPeerCert(certAndKey), copy(credential->getCredential()));
+  auto data = IOBuf::copyBuffer("handshake context");
+  auto sig =
+      credential->sign(CertificateVerifyContext::Server, data->coalesce());
+  peerCert->verify(
+      SignatureScheme::ed25519,
+      CertificateVerifyContext::Server,
+      data->coalesce(),
+      sig->coalesce());
+}
+#endif
+
+TEST_F(DelegatedCredentialTest, TestWrongVerifyScheme) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto credential = generate(*getSelfCert(certAndKey));
+  auto peerCert = DelegatedCredentialUtils::makePeerDelegatedCredential(
+      getPeerCert(certAndKey), copy(credential->getCredential()));
+  auto data = IOBuf::copyBuffer("handshake context");
+  auto sig =
+      credential->sign(CertificateVerifyContext::Server, data->coalesce());
+  EXPECT_THROW(
+      peerCert->verify(
+          SignatureScheme::ecdsa_secp384r1_sha384,
+          CertificateVerifyContext::Server,
+          data->coalesce(),
+          sig->coalesce()),
+      FizzException);
+}
+
+TEST_F(DelegatedCredentialTest, TestMissingDelegationUsage) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  EXPECT_THROW(generate(*getSelfCert(certAndKey)), std::runtime_error);
+
+  addDelegationUsage(certAndKey);
+  auto credential = generate(*getSelfCert(certAndKey));
+  auto otherCert = createCert("other", false, nullptr);
+  EXPECT_THROW(
+      DelegatedCredentialUtils::makePeerDelegatedCredential(
+          getPeerCert(otherCert), copy(credential->getCredential())),
+      FizzException);
+}
+
+TEST_F(DelegatedCredentialTest, TestLifetimeTooLong) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto selfCert = getSelfCert(certAndKey);
+  EXPECT_THROW(
+      generate(*selfCert, std::chrono::hours(24 * 8)), std::runtime_error);
+
+  auto credential = copy(generate(*selfCert)->getCredential());
+  credential.valid_time += std::chrono::seconds(std::chrono::hours(24 * 8))
+                               .count();
+  EXPECT_THROW(
+      DelegatedCredentialUtils::makePeerDelegatedCredential(
+          getPeerCert(certAndKey), std::move(credential)),
+      FizzException);
+}
+
+TEST_F(DelegatedCredentialTest, TestTamperedCredential) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto credential = copy(generate(*getSelfCert(certAndKey))->getCredential());
+  credential.valid_time -= 1;
+  EXPECT_THROW(
+      DelegatedCredentialUtils::makePeerDelegatedCredential(
+          getPeerCert(certAndKey), std::move(credential)),
+      FizzException);
+}
+
+TEST_F(DelegatedCredentialTest, TestExpiredCredential) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto credential = copy(generate(*getSelfCert(certAndKey))->getCredential());
+  credential.valid_time = 0;
+  EXPECT_THROW(
+      DelegatedCredentialUtils::makePeerDelegatedCredential(
+          getPeerCert(certAndKey), std::move(credential)),
+      FizzException);
+}
+
+TEST_F(DelegatedCredentialTest, TestExtensionRoundTrip) {
+  auto certAndKey = createCert("dc", false, nullptr);
+  addDelegationUsage(certAndKey);
+  auto credential = generate(*getSelfCert(certAndKey));
+  std::vector<Extension> exts;
+  exts.push_back(encodeExtension(credential->getCredential()));
+  auto decoded = getExtension<DelegatedCredential>(exts);
+  ASSERT_TRUE(decoded.hasValue());
+  const auto& original = credential->getCredential();
+  EXPECT_EQ(decoded->valid_time, original.valid_time);
+  EXPECT_EQ(decoded->expected_verify_scheme, original.expected_verify_scheme);
+  EXPECT_EQ(decoded->credential_scheme, original.credential_scheme);
+  EXPECT_TRUE(IOBufEqualTo()(decoded->public_key, original.public_key));
+  EXPECT_TRUE(IOBufEqualTo()(decoded->signature, original.signature));
+}
+} // namespace test
+} // namespace fizz
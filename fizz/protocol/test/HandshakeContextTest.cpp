@@ -8,6 +8,7 @@
 
 #include <gtest/gtest.h>
 
+#include <fizz/crypto/KeyDerivation.h>
 #include <fizz/protocol/HandshakeContext.h>
 
 using namespace folly;
@@ -45,5 +46,53 @@ TEST_F(HandshakeContextTest, TestEmpty) {
   std::array<uint8_t, Sha256::HashLen> key{4};
   context.getFinishedData(folly::range(key));
 }
+
+static Buf hashOf(StringPiece data) {
+  auto out = IOBuf::create(Sha256::HashLen);
+  out->append(Sha256::HashLen);
+  Sha256::hash(
+      *IOBuf::copyBuffer(data),
+      MutableByteRange(out->writableData(), out->length()));
+  return out;
+}
+
+TEST_F(HandshakeContextTest, TestCheckpointInvalidatedOnAppend) {
+  HandshakeContextImpl<Sha256> context;
+  context.appendToTranscript(IOBuf::copyBuffer("ClientHello"));
+  auto first = context.getHandshakeContext();
+  EXPECT_TRUE(IOBufEqualTo()(first, hashOf("ClientHello")));
+  EXPECT_TRUE(IOBufEqualTo()(context.getHandshakeContext(), first));
+
+  context.appendToTranscript(IOBuf::copyBuffer("ServerHello"));
+  EXPECT_TRUE(IOBufEqualTo()(
+      context.getHandshakeContext(), hashOf("ClientHelloServerHello")));
+}
+
+TEST_F(HandshakeContextTest, TestChainedTranscript) {
+  HandshakeContextImpl<Sha256> context;
+  auto chain = IOBuf::copyBuffer("Client");
+  chain->prependChain(IOBuf::copyBuffer("Hello"));
+  context.appendToTranscript(chain);
+  EXPECT_TRUE(
+      IOBufEqualTo()(context.getHandshakeContext(), hashOf("ClientHello")));
+}
+
+TEST_F(HandshakeContextTest, TestFinishedMatchesKeyDerivation) {
+  HandshakeContextImpl<Sha256> context;
+  context.appendToTranscript(IOBuf::copyBuffer("ClientHello"));
+  std::vector<uint8_t> baseKey(Sha256::HashLen, 0x0b);
+
+  auto finishedKey = KeyDerivationImpl<Sha256>().expandLabel(
+      range(baseKey), "finished", IOBuf::create(0), Sha256::HashLen);
+  auto expected = IOBuf::create(Sha256::HashLen);
+  expected->append(Sha256::HashLen);
+  Sha256::hmac(
+      finishedKey->coalesce(),
+      *hashOf("ClientHello"),
+      MutableByteRange(expected->writableData(), expected->length()));
+
+  EXPECT_TRUE(
+      IOBufEqualTo()(context.getFinishedData(range(baseKey)), expected));
+}
 } // namespace test
 } // namespace fizz
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/HandshakeTiming.h>
+
+#include <thread>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+enum class TestState : uint8_t { First, Second, Third };
+
+TEST(HandshakeTimingTest, TestTransitions) {
+  HandshakeTiming timing;
+  EXPECT_EQ(timing.elapsed(), std::chrono::nanoseconds::zero());
+  EXPECT_FALSE(timing.timeTo(TestState::Second));
+
+  timing.recordTransition(
+      static_cast<uint8_t>(TestState::First),
+      static_cast<uint8_t>(TestState::Second));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  timing.recordTransition(
+      static_cast<uint8_t>(TestState::Second),
+      static_cast<uint8_t>(TestState::Third));
+
+  ASSERT_EQ(timing.transitions().size(), 2u);
+  EXPECT_EQ(timing.transitions()[1].to, static_cast<uint8_t>(TestState::Third));
+  auto toSecond = timing.timeTo(TestState::Second);
+  auto toThird = timing.timeTo(TestState::Third);
+  ASSERT_TRUE(toSecond);
+  ASSERT_TRUE(toThird);
+  EXPECT_GE(*toThird - *toSecond, std::chrono::milliseconds(1));
+  EXPECT_EQ(timing.elapsed(), *toThird);
+  EXPECT_FALSE(timing.timeTo(TestState::First));
+}
+
+TEST(HandshakeTimingTest, TestSyncStage) {
+  HandshakeTiming timing;
+  auto result = timeHandshakeStage(&timing, HandshakeStage::Signing, [] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return 5;
+  });
+  EXPECT_EQ(result, 5);
+  timeHandshakeStage(&timing, HandshakeStage::Signing, [] {});
+
+  const auto& signing = timing.stage(HandshakeStage::Signing);
+  EXPECT_EQ(signing.count, 2u);
+  EXPECT_GE(signing.duration, std::chrono::milliseconds(1));
+  EXPECT_EQ(timing.stage(HandshakeStage::KeyExchange).count, 0u);
+}
+
+TEST(HandshakeTimingTest, TestSyncStageThrows) {
+  HandshakeTiming timing;
+  EXPECT_THROW(
+      timeHandshakeStage(
+          &timing,
+          HandshakeStage::CertSelection,
+          []() -> int { throw std::runtime_error("no cert"); }),
+      std::runtime_error);
+  EXPECT_EQ(timing.stage(HandshakeStage::CertSelection).count, 1u);
+}
+
+TEST(HandshakeTimingTest, TestAsyncStage) {
+  HandshakeTiming timing;
+  Promise<int> promise;
+  auto future =
+      timeHandshakeStage(&timing, HandshakeStage::TicketDecrypt, [&] {
+        return promise.getFuture();
+      });
+  EXPECT_EQ(timing.stage(HandshakeStage::TicketDecrypt).count, 0u);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  promise.setValue(3);
+  EXPECT_EQ(std::move(future).get(), 3);
+  const auto& decrypt = timing.stage(HandshakeStage::TicketDecrypt);
+  EXPECT_EQ(decrypt.count, 1u);
+  EXPECT_GE(decrypt.duration, std::chrono::milliseconds(1));
+}
+
+TEST(HandshakeTimingTest, TestNoTiming) {
+  Promise<int> promise;
+  auto future = timeHandshakeStage(
+      nullptr, HandshakeStage::ReplayCacheCheck, [&] {
+        return promise.getFuture();
+      });
+  promise.setValue(1);
+  EXPECT_EQ(std::move(future).get(), 1);
+  EXPECT_EQ(
+      timeHandshakeStage(nullptr, HandshakeStage::Signing, [] { return 2; }),
+      2);
+}
+
+TEST(HandshakeTimingTest, TestStats) {
+  HandshakeTimingStats stats(
+      std::chrono::microseconds(100), std::chrono::milliseconds(100));
+  EXPECT_EQ(stats.getHandshakeSummary().count, 0u);
+
+  for (int i = 0; i < 10; i++) {
+    HandshakeTiming timing;
+    timeHandshakeStage(&timing, HandshakeStage::KeyExchange, [] {});
+    if (i % 2 == 0) {
+      timeHandshakeStage(&timing, HandshakeStage::Signing, [] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      });
+    }
+    timing.recordTransition(0, 1);
+    stats.add(timing);
+  }
+
+  auto handshakes = stats.getHandshakeSummary();
+  EXPECT_EQ(handshakes.count, 10u);
+  EXPECT_LE(handshakes.p50, handshakes.p99);
+  EXPECT_EQ(stats.getStageSummary(HandshakeStage::KeyExchange).count, 10u);
+  auto signing = stats.getStageSummary(HandshakeStage::Signing);
+  EXPECT_EQ(signing.count, 5u);
+  EXPECT_GE(signing.p50, std::chrono::milliseconds(1));
+  EXPECT_EQ(stats.getStageSummary(HandshakeStage::NewSessionTicket).count, 0u);
+}
+} // namespace test
+} // namespace fizz
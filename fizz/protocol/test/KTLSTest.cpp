@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/KTLS.h>
+
+#include <fizz/crypto/Sha256.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+TEST(KTLSTest, TestIsSupported) {
+  EXPECT_EQ(
+      KTLS::isSupported(
+          CipherSuite::TLS_AES_128_GCM_SHA256, ProtocolVersion::tls_1_3),
+      FIZZ_HAVE_KTLS == 1);
+  EXPECT_FALSE(KTLS::isSupported(
+      CipherSuite::TLS_AES_128_GCM_SHA256, ProtocolVersion::tls_1_3_23));
+  EXPECT_FALSE(KTLS::isSupported(
+      CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL,
+      ProtocolVersion::tls_1_3));
+}
+
+TEST(KTLSTest, TestMakeParams) {
+  Factory factory;
+  KeyScheduler scheduler(std::make_unique<KeyDerivationImpl<Sha256>>());
+  std::vector<uint8_t> secret(32, 0x2a);
+  auto params = KTLS::makeParams(
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      range(secret),
+      7,
+      factory,
+      scheduler);
+  EXPECT_EQ(params.cipher, CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_EQ(params.seqNum, 7u);
+  auto expected = scheduler.getTrafficKey(range(secret), 16, 12);
+  EXPECT_TRUE(IOBufEqualTo()(params.key.key, expected.key));
+  EXPECT_TRUE(IOBufEqualTo()(params.key.iv, expected.iv));
+}
+
+TEST(KTLSTest, TestAttachNotSocket) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  EXPECT_FALSE(KTLS::attach(fds[0]));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(KTLSTest, TestWriteRecordLayer) {
+  EventBase evb;
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  auto socket = AsyncSocket::newSocket(&evb, fds[0]);
+  KTLSControlRecordWriter writer(socket.get());
+  KTLSWriteRecordLayer layer(&writer);
+  auto out = layer.writeAppData(IOBuf::copyBuffer("plaintext"));
+  EXPECT_TRUE(IOBufEqualTo()(out, IOBuf::copyBuffer("plaintext")));
+  EXPECT_EQ(writer.getAncillaryDataSize(WriteFlags::EOR), 0u);
+
+  // Control records go through the socket's write queue, behind the
+  // application data already written to it.
+  socket->writeChain(nullptr, std::move(out));
+  out = layer.writeHandshake(IOBuf::copyBuffer("keyupdate"));
+  EXPECT_TRUE(out->empty());
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(writer.getAncillaryDataSize(WriteFlags::EOR), 0u);
+
+  std::string expected = "plaintextkeyupdate";
+  std::string received(expected.size(), '\0');
+  size_t got = 0;
+  while (got < received.size()) {
+    auto n = read(fds[1], &received[got], received.size() - got);
+    ASSERT_GT(n, 0);
+    got += n;
+  }
+  EXPECT_EQ(received, expected);
+  close(fds[1]);
+}
+} // namespace test
+} // namespace fizz
@@ -10,7 +10,10 @@
 
 #include <fizz/protocol/KeyScheduler.h>
 
+#include <fizz/crypto/Sha256.h>
+#include <fizz/crypto/Sha384.h>
 #include <fizz/crypto/test/Mocks.h>
+#include <fizz/protocol/Factory.h>
 
 using namespace folly;
 using namespace testing;
@@ -140,5 +143,249 @@ TEST_F(KeySchedulerTest, TestTrafficKey) {
   StringPiece trafficSecret{"secret"};
   ks_->getTrafficKey(trafficSecret, 10, 10);
 }
+
+class CustomDeriverFactory : public Factory {
+ public:
+  std::unique_ptr<KeyDerivation> makeKeyDeriver(CipherSuite) const override {
+    auto kd = std::make_unique<MockKeyDerivation>();
+    kd_ = kd.get();
+    ON_CALL(*kd_, hashLength()).WillByDefault(Return(4));
+    ON_CALL(*kd_, _expandLabel(_, _, _, _))
+        .WillByDefault(InvokeWithoutArgs([]() { return IOBuf::create(0); }));
+    return kd;
+  }
+
+  mutable MockKeyDerivation* kd_{nullptr};
+};
+
+TEST(KeySchedulerFactoryTest, TestStockDeriver) {
+  Factory factory;
+  auto ks = factory.makeKeyScheduler(CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_TRUE(dynamic_cast<KeySchedulerImpl<Sha256>*>(ks.get()));
+  ks = factory.makeKeyScheduler(CipherSuite::TLS_AES_256_GCM_SHA384);
+  EXPECT_TRUE(dynamic_cast<KeySchedulerImpl<Sha384>*>(ks.get()));
+}
+
+TEST(KeySchedulerFactoryTest, TestCustomDeriver) {
+  CustomDeriverFactory factory;
+  auto ks = factory.makeKeyScheduler(CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_FALSE(dynamic_cast<KeySchedulerImpl<Sha256>*>(ks.get()));
+  EXPECT_CALL(*factory.kd_, _expandLabel(_, _, _, _)).Times(2);
+  ks->getTrafficKey(StringPiece("secret"), 10, 10);
+}
+
+template <typename Hash>
+class KeySchedulerImplTest : public testing::Test {
+ public:
+  void SetUp() override {
+    reference_ = std::make_unique<KeyScheduler>(
+        std::make_unique<KeyDerivationImpl<Hash>>());
+    ks_ = std::make_unique<KeySchedulerImpl<Hash>>();
+    transcript_ = std::vector<uint8_t>(Hash::HashLen, 0x5a);
+  }
+
+ protected:
+  void expectSameTrafficKey(const TrafficKey& a, const TrafficKey& b) {
+    EXPECT_TRUE(IOBufEqualTo()(a.key, b.key));
+    EXPECT_TRUE(IOBufEqualTo()(a.iv, b.iv));
+  }
+
+  void expectSameAppTraffic() {
+    EXPECT_EQ(
+        ks_->getSecret(AppTrafficSecrets::ClientAppTraffic),
+        reference_->getSecret(AppTrafficSecrets::ClientAppTraffic));
+    EXPECT_EQ(
+        ks_->getSecret(AppTrafficSecrets::ServerAppTraffic),
+        reference_->getSecret(AppTrafficSecrets::ServerAppTraffic));
+  }
+
+  std::unique_ptr<KeyScheduler> reference_;
+  std::unique_ptr<KeyScheduler> ks_;
+  std::vector<uint8_t> transcript_;
+};
+
+using HashTypes = ::testing::Types<Sha256, Sha384>;
+TYPED_TEST_CASE(KeySchedulerImplTest, HashTypes);
+
+TYPED_TEST(KeySchedulerImplTest, TestFullSchedule) {
+  auto transcript = range(this->transcript_);
+  StringPiece psk{"psk"};
+  this->ks_->deriveEarlySecret(psk);
+  this->reference_->deriveEarlySecret(psk);
+  for (auto s : {EarlySecrets::ExternalPskBinder,
+                 EarlySecrets::ResumptionPskBinder,
+                 EarlySecrets::ClientEarlyTraffic,
+                 EarlySecrets::EarlyExporter}) {
+    EXPECT_EQ(
+        this->ks_->getSecret(s, transcript),
+        this->reference_->getSecret(s, transcript));
+  }
+
+  StringPiece ecdhe{"ecdhe"};
+  this->ks_->deriveHandshakeSecret(ecdhe);
+  this->reference_->deriveHandshakeSecret(ecdhe);
+  for (auto s : {HandshakeSecrets::ClientHandshakeTraffic,
+                 HandshakeSecrets::ServerHandshakeTraffic}) {
+    EXPECT_EQ(
+        this->ks_->getSecret(s, transcript),
+        this->reference_->getSecret(s, transcript));
+  }
+
+  this->ks_->deriveMasterSecret();
+  this->reference_->deriveMasterSecret();
+  for (auto s :
+       {MasterSecrets::ExporterMaster, MasterSecrets::ResumptionMaster}) {
+    EXPECT_EQ(
+        this->ks_->getSecret(s, transcript),
+        this->reference_->getSecret(s, transcript));
+  }
+
+  this->ks_->deriveAppTrafficSecrets(transcript);
+  this->reference_->deriveAppTrafficSecrets(transcript);
+  this->expectSameAppTraffic();
+
+  this->ks_->clearMasterSecret();
+  EXPECT_THROW(
+      this->ks_->getSecret(MasterSecrets::ExporterMaster, transcript),
+      std::runtime_error);
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestClearMasterSecret) {
+  this->ks_->deriveHandshakeSecret(StringPiece("ecdhe"));
+  this->ks_->deriveMasterSecret();
+  this->ks_->deriveAppTrafficSecrets(range(this->transcript_));
+  this->ks_->clearMasterSecret();
+  for (auto s :
+       {MasterSecrets::ExporterMaster, MasterSecrets::ResumptionMaster}) {
+    EXPECT_THROW(
+        this->ks_->getSecret(s, range(this->transcript_)),
+        std::runtime_error);
+  }
+  EXPECT_THROW(this->ks_->deriveMasterSecret(), std::runtime_error);
+  EXPECT_THROW(
+      this->ks_->deriveAppTrafficSecrets(range(this->transcript_)),
+      std::runtime_error);
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestKeyedSecretClear) {
+  using Engine = KeyScheduleEngine<TypeParam>;
+  typename Engine::KeyedSecret secret;
+  typename Engine::Secret value;
+  value.fill(0x11);
+  secret.set(value);
+  Engine::deriveSecret(secret.hmac(), "derived", range(this->transcript_));
+
+  // Clearing drops the keyed HMAC state, not just the secret bytes.
+  secret.clear();
+  EXPECT_FALSE(secret.hmac().hasKey());
+  EXPECT_THROW(
+      Engine::deriveSecret(
+          secret.hmac(), "derived", range(this->transcript_)),
+      std::runtime_error);
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestNoEarly) {
+  StringPiece ecdhe{"ecdhe"};
+  this->ks_->deriveHandshakeSecret(ecdhe);
+  this->reference_->deriveHandshakeSecret(ecdhe);
+  this->ks_->deriveMasterSecret();
+  this->reference_->deriveMasterSecret();
+  this->ks_->deriveAppTrafficSecrets(range(this->transcript_));
+  this->reference_->deriveAppTrafficSecrets(range(this->transcript_));
+  this->expectSameAppTraffic();
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestPskOnly) {
+  StringPiece psk{"psk"};
+  this->ks_->deriveEarlySecret(psk);
+  this->reference_->deriveEarlySecret(psk);
+  this->ks_->deriveHandshakeSecret();
+  this->reference_->deriveHandshakeSecret();
+  EXPECT_EQ(
+      this->ks_->getSecret(
+          HandshakeSecrets::ClientHandshakeTraffic, range(this->transcript_)),
+      this->reference_->getSecret(
+          HandshakeSecrets::ClientHandshakeTraffic, range(this->transcript_)));
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestKeyUpdate) {
+  StringPiece ecdhe{"ecdhe"};
+  this->ks_->deriveHandshakeSecret(ecdhe);
+  this->reference_->deriveHandshakeSecret(ecdhe);
+  this->ks_->deriveMasterSecret();
+  this->reference_->deriveMasterSecret();
+  this->ks_->deriveAppTrafficSecrets(range(this->transcript_));
+  this->reference_->deriveAppTrafficSecrets(range(this->transcript_));
+
+  EXPECT_EQ(this->ks_->clientKeyUpdate(), 1u);
+  EXPECT_EQ(this->ks_->clientKeyUpdate(), 2u);
+  EXPECT_EQ(this->ks_->serverKeyUpdate(), 1u);
+  this->reference_->clientKeyUpdate();
+  this->reference_->clientKeyUpdate();
+  this->reference_->serverKeyUpdate();
+  this->expectSameAppTraffic();
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestSetAppTrafficSecrets) {
+  StringPiece ecdhe{"ecdhe"};
+  this->reference_->deriveHandshakeSecret(ecdhe);
+  this->reference_->deriveMasterSecret();
+  this->reference_->deriveAppTrafficSecrets(range(this->transcript_));
+  this->reference_->serverKeyUpdate();
+
+  auto client =
+      this->reference_->getSecret(AppTrafficSecrets::ClientAppTraffic);
+  auto server =
+      this->reference_->getSecret(AppTrafficSecrets::ServerAppTraffic);
+  this->ks_->setAppTrafficSecrets(range(client), 0, range(server), 1);
+  this->expectSameAppTraffic();
+  EXPECT_EQ(
+      this->ks_->getAppTrafficGeneration(AppTrafficSecrets::ServerAppTraffic),
+      1u);
+
+  // Updates continue from the imported secrets.
+  EXPECT_EQ(this->ks_->serverKeyUpdate(), 2u);
+  EXPECT_EQ(this->reference_->serverKeyUpdate(), 2u);
+  this->expectSameAppTraffic();
+
+  std::vector<uint8_t> shortSecret(4);
+  EXPECT_THROW(
+      this->ks_->setAppTrafficSecrets(
+          range(shortSecret), 0, range(server), 0),
+      std::runtime_error);
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestTrafficKeys) {
+  std::vector<uint8_t> client(TypeParam::HashLen, 0x01);
+  auto key = this->ks_->getTrafficKey(range(client), 16, 12);
+  EXPECT_EQ(key.key->computeChainDataLength(), 16u);
+  EXPECT_EQ(key.iv->computeChainDataLength(), 12u);
+  this->expectSameTrafficKey(
+      key, this->reference_->getTrafficKey(range(client), 16, 12));
+
+  // Longer than one hash block.
+  this->expectSameTrafficKey(
+      this->ks_->getTrafficKey(range(client), 100, 12),
+      this->reference_->getTrafficKey(range(client), 100, 12));
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestResumptionSecret) {
+  std::vector<uint8_t> rms(TypeParam::HashLen, 0x03);
+  StringPiece nonce{"nonce"};
+  EXPECT_TRUE(IOBufEqualTo()(
+      this->ks_->getResumptionSecret(range(rms), nonce),
+      this->reference_->getResumptionSecret(range(rms), nonce)));
+}
+
+TYPED_TEST(KeySchedulerImplTest, TestWrongState) {
+  EXPECT_THROW(this->ks_->deriveMasterSecret(), std::runtime_error);
+  this->ks_->deriveEarlySecret(StringPiece("psk"));
+  EXPECT_THROW(
+      this->ks_->deriveEarlySecret(StringPiece("psk")), std::runtime_error);
+  EXPECT_THROW(
+      this->ks_->getSecret(
+          HandshakeSecrets::ClientHandshakeTraffic, range(this->transcript_)),
+      std::runtime_error);
+}
 } // namespace test
 } // namespace fizz
@@ -103,6 +103,10 @@ class MockSelfCert : public SelfCert {
     return _getCertMessage(buf);
   }
 
+  MOCK_CONST_METHOD1(
+      getCompressedCert,
+      folly::Optional<CompressedCertificate>(CertificateCompressionAlgorithm));
+
   MOCK_CONST_METHOD3(
       sign,
       Buf(SignatureScheme scheme,
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/protocol/Stats.h>
+
+#include <thread>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+TEST(StatsTest, TestEmpty) {
+  FizzStats stats;
+  auto snapshot = stats.snapshot();
+  for (auto count : snapshot.counters) {
+    EXPECT_EQ(count, 0u);
+  }
+  EXPECT_TRUE(snapshot.ciphers.empty());
+  EXPECT_TRUE(snapshot.groups.empty());
+  EXPECT_TRUE(snapshot.errorsByAlert.empty());
+}
+
+TEST(StatsTest, TestHandshakeSuccess) {
+  FizzStats stats;
+  stats.recordHandshakeSuccess(
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      NamedGroup::x25519,
+      PskType::NotAttempted,
+      EarlyDataType::NotAttempted);
+  stats.recordHandshakeSuccess(
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      none,
+      PskType::Resumption,
+      EarlyDataType::Accepted);
+  stats.recordHandshakeSuccess(
+      CipherSuite::TLS_AES_256_GCM_SHA384,
+      NamedGroup::secp256r1,
+      PskType::Rejected,
+      EarlyDataType::Rejected);
+
+  auto snapshot = stats.snapshot();
+  EXPECT_EQ(snapshot[StatsCounter::HandshakeSuccess], 3u);
+  EXPECT_EQ(snapshot[StatsCounter::PskAttempted], 2u);
+  EXPECT_EQ(snapshot[StatsCounter::PskAccepted], 1u);
+  EXPECT_EQ(snapshot[StatsCounter::PskRejected], 1u);
+  EXPECT_EQ(snapshot[StatsCounter::EarlyDataAttempted], 2u);
+  EXPECT_EQ(snapshot[StatsCounter::EarlyDataAccepted], 1u);
+  EXPECT_EQ(snapshot[StatsCounter::EarlyDataRejected], 1u);
+  EXPECT_EQ(snapshot.ciphers.size(), 2u);
+  EXPECT_EQ(snapshot.ciphers[CipherSuite::TLS_AES_128_GCM_SHA256], 2u);
+  EXPECT_EQ(snapshot.ciphers[CipherSuite::TLS_AES_256_GCM_SHA384], 1u);
+  EXPECT_EQ(snapshot.groups.size(), 2u);
+  EXPECT_EQ(snapshot.groups[NamedGroup::x25519], 1u);
+  EXPECT_EQ(snapshot.groups[NamedGroup::secp256r1], 1u);
+}
+
+TEST(StatsTest, TestReplayCacheAndErrors) {
+  FizzStats stats;
+  stats.increment(StatsCounter::ReplayCacheNotReplay);
+  stats.increment(StatsCounter::ReplayCacheNotReplay);
+  stats.increment(StatsCounter::ReplayCacheDefinitelyReplay);
+  stats.recordHandshakeError(AlertDescription::handshake_failure);
+  stats.recordHandshakeError(AlertDescription::handshake_failure);
+  stats.recordHandshakeError(AlertDescription::decode_error);
+  stats.recordHandshakeError(none);
+
+  auto snapshot = stats.snapshot();
+  EXPECT_EQ(snapshot[StatsCounter::ReplayCacheNotChecked], 0u);
+  EXPECT_EQ(snapshot[StatsCounter::ReplayCacheNotReplay], 2u);
+  EXPECT_EQ(snapshot[StatsCounter::ReplayCacheDefinitelyReplay], 1u);
+  EXPECT_EQ(snapshot[StatsCounter::HandshakeError], 4u);
+  EXPECT_EQ(snapshot.errorsByAlert.size(), 2u);
+  EXPECT_EQ(snapshot.errorsByAlert[AlertDescription::handshake_failure], 2u);
+  EXPECT_EQ(snapshot.errorsByAlert[AlertDescription::decode_error], 1u);
+}
+
+TEST(StatsTest, TestConcurrentUpdates) {
+  FizzStats stats;
+  constexpr size_t kThreads = 40;
+  constexpr size_t kRecords = 10000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&stats] {
+      for (size_t j = 0; j < kRecords; ++j) {
+        stats.recordEncrypted(100);
+        stats.recordDecrypted(10);
+      }
+    });
+  }
+  // Snapshots may be taken while counters are being updated.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_LE(
+        stats.snapshot()[StatsCounter::RecordsEncrypted], kThreads * kRecords);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = stats.snapshot();
+  EXPECT_EQ(snapshot[StatsCounter::RecordsEncrypted], kThreads * kRecords);
+  EXPECT_EQ(snapshot[StatsCounter::BytesEncrypted], kThreads * kRecords * 100);
+  EXPECT_EQ(snapshot[StatsCounter::RecordsDecrypted], kThreads * kRecords);
+  EXPECT_EQ(snapshot[StatsCounter::BytesDecrypted], kThreads * kRecords * 10);
+}
+
+TEST(StatsTest, TestAggregate) {
+  FizzStats stats1;
+  FizzStats stats2;
+  stats1.increment(StatsCounter::HelloRetryRequest);
+  stats2.increment(StatsCounter::HelloRetryRequest, 2);
+  stats1.recordHandshakeError(AlertDescription::decode_error);
+  stats2.recordHandshakeError(AlertDescription::decode_error);
+  stats2.increment(StatsCounter::ReplayCacheMaybeReplay);
+
+  auto total = stats1.snapshot();
+  total += stats2.snapshot();
+  EXPECT_EQ(total[StatsCounter::HelloRetryRequest], 3u);
+  EXPECT_EQ(total[StatsCounter::HandshakeError], 2u);
+  EXPECT_EQ(total.errorsByAlert[AlertDescription::decode_error], 2u);
+  EXPECT_EQ(total[StatsCounter::ReplayCacheMaybeReplay], 1u);
+}
+
+TEST(StatsTest, TestToString) {
+  EXPECT_EQ(toString(StatsCounter::PskAccepted), "PskAccepted");
+  EXPECT_EQ(toString(StatsCounter::BytesDecrypted), "BytesDecrypted");
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+namespace detail {
+
+using ContentTypeType = typename std::underlying_type<ContentType>::type;
+using ProtocolVersionType =
+    typename std::underlying_type<ProtocolVersion>::type;
+
+constexpr size_t kEncryptedHeaderSize =
+    sizeof(ContentType) + sizeof(ProtocolVersion) + sizeof(uint16_t);
+} // namespace detail
+
+template <typename AeadType>
+Buf EncryptedWriteRecordLayer::writeWithAead(
+    TLSMessage&& msg,
+    AeadType& aead) const {
+  if (parallelism_.executor && aead.supportsConcurrentUse()) {
+    return writeBatchWithAead(std::move(msg), aead);
+  }
+
+  folly::IOBufQueue queue;
+  queue.append(std::move(msg.fragment));
+  std::unique_ptr<folly::IOBuf> outBuf;
+  aead.setEncryptedBufferHeadroom(detail::kEncryptedHeaderSize);
+  while (!queue.empty()) {
+    auto dataBuf = getBufToEncrypt(queue);
+
+    if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
+      throw std::runtime_error("max write seq num");
+    }
+
+    auto record = sealRecord(std::move(dataBuf), msg.type, aead, seqNum_++);
+    if (!outBuf) {
+      outBuf = std::move(record);
+    } else {
+      outBuf->prependChain(std::move(record));
+    }
+  }
+
+  if (!outBuf) {
+    outBuf = folly::IOBuf::create(0);
+  }
+
+  return outBuf;
+}
+
+template <typename AeadType>
+Buf EncryptedWriteRecordLayer::writeBatchWithAead(
+    TLSMessage&& msg,
+    AeadType& aead) const {
+  folly::IOBufQueue queue;
+  queue.append(std::move(msg.fragment));
+  std::vector<Buf> records;
+  while (!queue.empty()) {
+    records.push_back(getBufToEncrypt(queue));
+  }
+  if (records.empty()) {
+    return folly::IOBuf::create(0);
+  }
+
+  if (records.size() > std::numeric_limits<uint64_t>::max() - seqNum_) {
+    throw std::runtime_error("max write seq num");
+  }
+  auto firstSeqNum = seqNum_;
+  seqNum_ += records.size();
+
+  aead.setEncryptedBufferHeadroom(detail::kEncryptedHeaderSize);
+  auto type = msg.type;
+  detail::forEachRecord(parallelism_, records.size(), [&](size_t i) {
+    records[i] =
+        sealRecord(std::move(records[i]), type, aead, firstSeqNum + i);
+  });
+
+  auto outBuf = std::move(records.front());
+  for (size_t i = 1; i < records.size(); ++i) {
+    outBuf->prependChain(std::move(records[i]));
+  }
+  return outBuf;
+}
+
+template <typename AeadType>
+Buf EncryptedWriteRecordLayer::sealRecord(
+    Buf dataBuf,
+    ContentType type,
+    AeadType& aead,
+    uint64_t seqNum) const {
+  using detail::ContentTypeType;
+  using detail::ProtocolVersionType;
+  using detail::kEncryptedHeaderSize;
+
+  if (bufferPool_ && dataBuf->isShared()) {
+    dataBuf = copyToPoolBuffer(*dataBuf);
+  }
+
+  // Currently we never send padding.
+
+  // check if we have enough room to add the encrypted footer.
+  if (!dataBuf->isShared() &&
+      dataBuf->prev()->tailroom() >= sizeof(ContentType)) {
+    // extend it and add it
+    folly::io::Appender appender(dataBuf.get(), 0);
+    appender.writeBE(static_cast<ContentTypeType>(type));
+  } else {
+    // not enough or shared - let's add enough for the tag as well
+    auto encryptedFooter = folly::IOBuf::create(
+        sizeof(ContentType) + aead.getCipherOverhead());
+    folly::io::Appender appender(encryptedFooter.get(), 0);
+    appender.writeBE(static_cast<ContentTypeType>(type));
+    dataBuf->prependChain(std::move(encryptedFooter));
+  }
+
+  // we will either be able to memcpy directly into the ciphertext or
+  // need to create a new buf to insert before the ciphertext but we need
+  // it for additional data
+  std::array<uint8_t, kEncryptedHeaderSize> headerBuf;
+  auto header = folly::IOBuf::wrapBufferAsValue(folly::range(headerBuf));
+  header.clear();
+  folly::io::Appender appender(&header, 0);
+  appender.writeBE(
+      static_cast<ContentTypeType>(ContentType::application_data));
+  appender.writeBE(static_cast<ProtocolVersionType>(recordVersion_));
+  auto ciphertextLength =
+      dataBuf->computeChainDataLength() + aead.getCipherOverhead();
+  appender.writeBE<uint16_t>(ciphertextLength);
+
+  if (stats_) {
+    stats_->recordEncrypted(
+        ciphertextLength - aead.getCipherOverhead() - sizeof(ContentType));
+  }
+
+  auto cipherText = aead.encrypt(
+      std::move(dataBuf), useAdditionalData_ ? &header : nullptr, seqNum);
+
+  if (!cipherText->isShared() &&
+      cipherText->headroom() >= kEncryptedHeaderSize) {
+    // prepend and then write it in
+    cipherText->prepend(kEncryptedHeaderSize);
+    memcpy(cipherText->writableData(), header.data(), header.length());
+    return cipherText;
+  } else {
+    auto record = folly::IOBuf::copyBuffer(header.data(), header.length());
+    record->prependChain(std::move(cipherText));
+    return record;
+  }
+}
+} // namespace fizz
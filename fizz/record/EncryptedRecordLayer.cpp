@@ -8,15 +8,22 @@
 
 #include <fizz/record/EncryptedRecordLayer.h>
 
+#include <fizz/crypto/aead/AEGIS128L.h>
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/AESGCM256.h>
+#include <fizz/crypto/aead/AESGCMNative.h>
+#include <fizz/crypto/aead/AESOCB128.h>
+#include <fizz/crypto/aead/ChaCha20Poly1305.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+
+#include <typeinfo>
+
 namespace fizz {
 
-using ContentTypeType = typename std::underlying_type<ContentType>::type;
-using ProtocolVersionType =
-    typename std::underlying_type<ProtocolVersion>::type;
+using detail::ContentTypeType;
+using detail::kEncryptedHeaderSize;
 
 static constexpr uint16_t kMaxEncryptedRecordSize = 0x4000 + 256; // 16k + 256
-static constexpr size_t kEncryptedHeaderSize =
-    sizeof(ContentType) + sizeof(ProtocolVersion) + sizeof(uint16_t);
 
 folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
     folly::IOBufQueue& buf) {
@@ -84,6 +91,19 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
         continue;
       }
     } else {
+      if (decryptedAhead_.empty() && parallelism_.executor &&
+          aead_->supportsConcurrentUse()) {
+        decryptAhead(buf, encrypted, folly::range(ad));
+      }
+      if (!decryptedAhead_.empty()) {
+        auto decryptedBuf = std::move(decryptedAhead_.front());
+        decryptedAhead_.pop_front();
+        seqNum_++;
+        if (!decryptedBuf) {
+          throw std::runtime_error("decryption failed");
+        }
+        return decryptedBuf;
+      }
       return aead_->decrypt(
           std::move(encrypted),
           useAdditionalData_ ? &adBuf : nullptr,
@@ -92,6 +112,63 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
   }
 }
 
+void EncryptedReadRecordLayer::decryptAhead(
+    const folly::IOBufQueue& buf,
+    Buf& encrypted,
+    folly::ByteRange ad) {
+  struct AheadRecord {
+    Buf ciphertext;
+    std::array<uint8_t, kEncryptedHeaderSize> ad;
+    folly::Optional<Buf> plaintext;
+  };
+  auto maxRecords = std::min<uint64_t>(
+      std::max<size_t>(parallelism_.maxReadAhead, 1),
+      std::numeric_limits<uint64_t>::max() - seqNum_);
+
+  std::vector<AheadRecord> records(1);
+  memcpy(records.front().ad.data(), ad.data(), kEncryptedHeaderSize);
+  if (!buf.empty()) {
+    // Only take records the next reads will decrypt in order. Anything else
+    // (including malformed headers) ends the batch and is left for the normal
+    // path to handle.
+    folly::io::Cursor cursor(buf.front());
+    while (records.size() < maxRecords &&
+           cursor.canAdvance(kEncryptedHeaderSize)) {
+      AheadRecord record;
+      folly::io::Cursor adCursor(cursor);
+      adCursor.pull(record.ad.data(), record.ad.size());
+      auto contentType =
+          static_cast<ContentType>(cursor.readBE<ContentTypeType>());
+      cursor.skip(sizeof(ProtocolVersion));
+      auto length = cursor.readBE<uint16_t>();
+      if (contentType != ContentType::application_data || length == 0 ||
+          length > kMaxEncryptedRecordSize || !cursor.canAdvance(length)) {
+        break;
+      }
+      cursor.clone(record.ciphertext, length);
+      records.push_back(std::move(record));
+    }
+  }
+  if (records.size() < parallelism_.minRecords) {
+    return;
+  }
+
+  records.front().ciphertext = std::move(encrypted);
+  auto firstSeqNum = seqNum_;
+  detail::forEachRecord(parallelism_, records.size(), [&](size_t i) {
+    auto& record = records[i];
+    folly::IOBuf adBuf{
+        folly::IOBuf::wrapBufferAsValue(folly::range(record.ad))};
+    record.plaintext = aead_->tryDecrypt(
+        std::move(record.ciphertext),
+        useAdditionalData_ ? &adBuf : nullptr,
+        firstSeqNum + i);
+  });
+  for (auto& record : records) {
+    decryptedAhead_.push_back(std::move(record.plaintext));
+  }
+}
+
 folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
     folly::IOBufQueue& buf) {
   auto decryptedBuf = getDecryptedBuf(buf);
@@ -111,6 +188,11 @@ folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
   decrypted.trimEnd(paddingCursor.totalLength() + sizeof(ContentType));
   msg.fragment = decrypted.move();
 
+  if (stats_) {
+    stats_->recordDecrypted(
+        msg.fragment ? msg.fragment->computeChainDataLength() : 0);
+  }
+
   switch (msg.type) {
     case ContentType::handshake:
     case ContentType::alert:
@@ -134,74 +216,58 @@ folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
 }
 
 Buf EncryptedWriteRecordLayer::write(TLSMessage&& msg) const {
-  folly::IOBufQueue queue;
-  queue.append(std::move(msg.fragment));
-  std::unique_ptr<folly::IOBuf> outBuf;
-  std::array<uint8_t, kEncryptedHeaderSize> headerBuf;
-  auto header = folly::IOBuf::wrapBufferAsValue(folly::range(headerBuf));
-  aead_->setEncryptedBufferHeadroom(kEncryptedHeaderSize);
-  while (!queue.empty()) {
-    auto dataBuf = getBufToEncrypt(queue);
-    // Currently we never send padding.
-
-    // check if we have enough room to add the encrypted footer.
-    if (!dataBuf->isShared() &&
-        dataBuf->prev()->tailroom() >= sizeof(ContentType)) {
-      // extend it and add it
-      folly::io::Appender appender(dataBuf.get(), 0);
-      appender.writeBE(static_cast<ContentTypeType>(msg.type));
-    } else {
-      // not enough or shared - let's add enough for the tag as well
-      auto encryptedFooter = folly::IOBuf::create(
-          sizeof(ContentType) + aead_->getCipherOverhead());
-      folly::io::Appender appender(encryptedFooter.get(), 0);
-      appender.writeBE(static_cast<ContentTypeType>(msg.type));
-      dataBuf->prependChain(std::move(encryptedFooter));
-    }
-
-    if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
-      throw std::runtime_error("max write seq num");
-    }
-
-    // we will either be able to memcpy directly into the ciphertext or
-    // need to create a new buf to insert before the ciphertext but we need
-    // it for additional data
-    header.clear();
-    folly::io::Appender appender(&header, 0);
-    appender.writeBE(
-        static_cast<ContentTypeType>(ContentType::application_data));
-    appender.writeBE(static_cast<ProtocolVersionType>(recordVersion_));
-    auto ciphertextLength =
-        dataBuf->computeChainDataLength() + aead_->getCipherOverhead();
-    appender.writeBE<uint16_t>(ciphertextLength);
-
-    auto cipherText = aead_->encrypt(
-        std::move(dataBuf), useAdditionalData_ ? &header : nullptr, seqNum_++);
-
-    std::unique_ptr<folly::IOBuf> record;
-    if (!cipherText->isShared() &&
-        cipherText->headroom() >= kEncryptedHeaderSize) {
-      // prepend and then write it in
-      cipherText->prepend(kEncryptedHeaderSize);
-      memcpy(cipherText->writableData(), header.data(), header.length());
-      record = std::move(cipherText);
-    } else {
-      record = folly::IOBuf::copyBuffer(header.data(), header.length());
-      record->prependChain(std::move(cipherText));
-    }
-
-    if (!outBuf) {
-      outBuf = std::move(record);
-    } else {
-      outBuf->prependChain(std::move(record));
-    }
+  if (typedWrite_) {
+    return (this->*typedWrite_)(std::move(msg));
   }
+  return writeWithAead(std::move(msg), *aead_);
+}
+
+template <typename AeadType>
+Buf EncryptedWriteRecordLayer::writeTyped(TLSMessage&& msg) const {
+  return writeWithAead(std::move(msg), static_cast<AeadType&>(*aead_));
+}
 
-  if (!outBuf) {
-    outBuf = folly::IOBuf::create(0);
+EncryptedWriteRecordLayer::TypedWrite
+EncryptedWriteRecordLayer::selectTypedWrite(const Aead& aead) {
+  // Exact type matches only; anything else, such as a wrapper or a mock,
+  // goes through the virtual interface.
+  const auto& type = typeid(aead);
+  if (type == typeid(OpenSSLEVPCipher<AESGCM128>)) {
+    return &EncryptedWriteRecordLayer::writeTyped<
+        OpenSSLEVPCipher<AESGCM128>>;
+  } else if (type == typeid(OpenSSLEVPCipher<AESGCM256>)) {
+    return &EncryptedWriteRecordLayer::writeTyped<
+        OpenSSLEVPCipher<AESGCM256>>;
+  } else if (type == typeid(OpenSSLEVPCipher<ChaCha20Poly1305>)) {
+    return &EncryptedWriteRecordLayer::writeTyped<
+        OpenSSLEVPCipher<ChaCha20Poly1305>>;
+  } else if (type == typeid(OpenSSLEVPCipher<AESOCB128>)) {
+    return &EncryptedWriteRecordLayer::writeTyped<
+        OpenSSLEVPCipher<AESOCB128>>;
+  } else if (type == typeid(AESGCMNative<AESGCM128>)) {
+    return &EncryptedWriteRecordLayer::writeTyped<AESGCMNative<AESGCM128>>;
+  } else if (type == typeid(AESGCMNative<AESGCM256>)) {
+    return &EncryptedWriteRecordLayer::writeTyped<AESGCMNative<AESGCM256>>;
+  } else if (type == typeid(AEGIS128L)) {
+    return &EncryptedWriteRecordLayer::writeTyped<AEGIS128L>;
   }
+  return nullptr;
+}
 
-  return outBuf;
+Buf EncryptedWriteRecordLayer::copyToPoolBuffer(
+    const folly::IOBuf& data) const {
+  auto buf = bufferPool_->get();
+  auto length = data.computeChainDataLength();
+  // Leave room for the header in front and the content type and tag behind.
+  DCHECK_LE(
+      kEncryptedHeaderSize + length + kMaxEncryptedRecordSize -
+          kMaxPlaintextRecordSize,
+      buf->capacity());
+  buf->advance(kEncryptedHeaderSize);
+  folly::io::Cursor cursor(&data);
+  cursor.pull(buf->writableData(), length);
+  buf->append(length);
+  return buf;
 }
 
 Buf EncryptedWriteRecordLayer::getBufToEncrypt(folly::IOBufQueue& queue) const {
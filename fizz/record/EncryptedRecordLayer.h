@@ -11,6 +11,11 @@
 #include <fizz/record/RecordLayer.h>
 
 #include <fizz/crypto/aead/Aead.h>
+#include <fizz/record/RecordBufferPool.h>
+#include <fizz/record/RecordParallelism.h>
+#include <fizz/record/RecordStats.h>
+
+#include <deque>
 
 namespace fizz {
 
@@ -33,6 +38,38 @@ class EncryptedReadRecordLayer : public ReadRecordLayer {
     skipFailedDecryption_ = enabled;
   }
 
+  /**
+   * When several complete records are queued, decrypt them concurrently on
+   * parallelism.executor. The results are handed out in order by later
+   * reads, so a record that fails to decrypt is only reported once it is
+   * reached.
+   */
+  void setParallelism(RecordParallelism parallelism) {
+    parallelism_ = parallelism;
+  }
+
+  /**
+   * Counts the records read and their plaintext bytes into stats.
+   */
+  void setStats(std::shared_ptr<RecordStats> stats) {
+    stats_ = std::move(stats);
+  }
+
+  /**
+   * Sequence number of the next record to be read.
+   */
+  uint64_t getSequenceNumber() const {
+    return seqNum_;
+  }
+
+  /**
+   * Continues the record sequence of a connection established elsewhere.
+   * Must be called after setAead().
+   */
+  void setSequenceNumber(uint64_t seqNum) {
+    seqNum_ = seqNum;
+  }
+
   void setProtocolVersion(ProtocolVersion version) {
     auto realVersion = getRealDraftVersion(version);
     if (realVersion == ProtocolVersion::tls_1_3_23 ||
@@ -48,11 +85,29 @@ class EncryptedReadRecordLayer : public ReadRecordLayer {
  private:
   folly::Optional<Buf> getDecryptedBuf(folly::IOBufQueue& buf);
 
+  /**
+   * Decrypts encrypted (the record with sequence number seqNum_ and header
+   * ad) along with the complete records following it in buf, without
+   * consuming them, into decryptedAhead_. Leaves encrypted untouched if there
+   * are too few records to be worth it.
+   */
+  void decryptAhead(
+      const folly::IOBufQueue& buf,
+      Buf& encrypted,
+      folly::ByteRange ad);
+
   std::unique_ptr<Aead> aead_;
   bool skipFailedDecryption_{false};
 
   bool useAdditionalData_{true};
 
+  RecordParallelism parallelism_;
+
+  // Results for the records starting at seqNum_ that were decrypted ahead.
+  std::deque<folly::Optional<Buf>> decryptedAhead_;
+
+  std::shared_ptr<RecordStats> stats_;
+
   mutable uint64_t seqNum_{0};
 };
 
@@ -62,11 +117,17 @@ class EncryptedWriteRecordLayer : public WriteRecordLayer {
 
   Buf write(TLSMessage&& msg) const override;
 
+  /**
+   * If aead is one of the stock implementations, records are protected
+   * through its concrete type, so that the per-record aead calls and the tag
+   * overhead are resolved statically.
+   */
   virtual void setAead(std::unique_ptr<Aead> aead) {
     if (seqNum_ != 0) {
       throw std::runtime_error("aead set after write");
     }
     aead_ = std::move(aead);
+    typedWrite_ = selectTypedWrite(*aead_);
   }
 
   void setMaxRecord(uint16_t size) {
@@ -75,13 +136,96 @@ class EncryptedWriteRecordLayer : public WriteRecordLayer {
     maxRecord_ = size;
   }
 
+  /**
+   * Split large writes into records up front and encrypt them concurrently
+   * on parallelism.executor, if the aead supports concurrent use.
+   */
+  void setParallelism(RecordParallelism parallelism) {
+    parallelism_ = parallelism;
+  }
+
+  /**
+   * Records that can't be encrypted in place (because their data is shared,
+   * e.g. split from a larger write) are copied into a buffer from pool and
+   * encrypted there, instead of into a buffer allocated by the aead.
+   */
+  void setBufferPool(std::shared_ptr<RecordBufferPool> pool) {
+    bufferPool_ = std::move(pool);
+  }
+
+  /**
+   * Counts the records written and their plaintext bytes into stats.
+   */
+  void setStats(std::shared_ptr<RecordStats> stats) {
+    stats_ = std::move(stats);
+  }
+
+  /**
+   * Sequence number of the next record to be written.
+   */
+  uint64_t getSequenceNumber() const {
+    return seqNum_;
+  }
+
+  /**
+   * Continues the record sequence of a connection established elsewhere.
+   * Must be called after setAead().
+   */
+  void setSequenceNumber(uint64_t seqNum) {
+    seqNum_ = seqNum;
+  }
+
+ protected:
+  /**
+   * Record protection with the aead given as its concrete type, so that the
+   * aead calls are resolved statically when that type is final.
+   */
+  template <typename AeadType>
+  Buf writeWithAead(TLSMessage&& msg, AeadType& aead) const;
+
  private:
+  using TypedWrite = Buf (EncryptedWriteRecordLayer::*)(TLSMessage&&) const;
+
+  static TypedWrite selectTypedWrite(const Aead& aead);
+
+  template <typename AeadType>
+  Buf writeTyped(TLSMessage&& msg) const;
+
   Buf getBufToEncrypt(folly::IOBufQueue& queue) const;
 
+  Buf copyToPoolBuffer(const folly::IOBuf& data) const;
+
+  /**
+   * Splits the whole message into records first, then encrypts them through
+   * parallelism_ and chains them in sequence number order.
+   */
+  template <typename AeadType>
+  Buf writeBatchWithAead(TLSMessage&& msg, AeadType& aead) const;
+
+  /**
+   * Protects one record's worth of data as record seqNum, returning the
+   * record including its header.
+   */
+  template <typename AeadType>
+  Buf sealRecord(
+      Buf dataBuf,
+      ContentType type,
+      AeadType& aead,
+      uint64_t seqNum) const;
+
   std::unique_ptr<Aead> aead_;
+  TypedWrite typedWrite_{nullptr};
 
   uint16_t maxRecord_{kMaxPlaintextRecordSize};
 
+  RecordParallelism parallelism_;
+
+  std::shared_ptr<RecordBufferPool> bufferPool_;
+
+  std::shared_ptr<RecordStats> stats_;
+
   mutable uint64_t seqNum_{0};
 };
 } // namespace fizz
+
+#include <fizz/record/EncryptedRecordLayer-inl.h>
@@ -164,6 +164,31 @@ inline CertificateAuthorities getExtension(folly::io::Cursor& cs) {
   return authorities;
 }
 
+template <>
+inline CertificateCompressionAlgorithms getExtension(folly::io::Cursor& cs) {
+  CertificateCompressionAlgorithms cca;
+  detail::readVector<uint8_t>(cca.algorithms, cs);
+  return cca;
+}
+
+template <>
+inline DelegatedCredentialSupport getExtension(folly::io::Cursor& cs) {
+  DelegatedCredentialSupport support;
+  detail::readVector<uint16_t>(support.supported_signature_algorithms, cs);
+  return support;
+}
+
+template <>
+inline DelegatedCredential getExtension(folly::io::Cursor& cs) {
+  DelegatedCredential cred;
+  detail::read(cred.valid_time, cs);
+  detail::read(cred.expected_verify_scheme, cs);
+  detail::readBuf<detail::bits24>(cred.public_key, cs);
+  detail::read(cred.credential_scheme, cs);
+  detail::readBuf<uint16_t>(cred.signature, cs);
+  return cred;
+}
+
 template <>
 inline Extension encodeExtension(const SignatureAlgorithms& sig) {
   Extension ext;
@@ -338,6 +363,41 @@ inline Extension encodeExtension(const CertificateAuthorities& authorities) {
   return ext;
 }
 
+template <>
+inline Extension encodeExtension(const CertificateCompressionAlgorithms& cca) {
+  Extension ext;
+  ext.extension_type = ExtensionType::compress_certificate;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::writeVector<uint8_t>(cca.algorithms, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const DelegatedCredentialSupport& support) {
+  Extension ext;
+  ext.extension_type = ExtensionType::delegated_credential;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::writeVector<uint16_t>(
+      support.supported_signature_algorithms, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const DelegatedCredential& cred) {
+  Extension ext;
+  ext.extension_type = ExtensionType::delegated_credential;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::write(cred.valid_time, appender);
+  detail::write(cred.expected_verify_scheme, appender);
+  detail::writeBuf<detail::bits24>(cred.public_key, appender);
+  detail::write(cred.credential_scheme, appender);
+  detail::writeBuf<uint16_t>(cred.signature, appender);
+  return ext;
+}
+
 inline size_t getBinderLength(const ClientHello& chlo) {
   if (chlo.extensions.empty() ||
       chlo.extensions.back().extension_type != ExtensionType::pre_shared_key) {
@@ -141,6 +141,28 @@ struct CertificateAuthorities {
       ExtensionType::certificate_authorities;
 };
 
+struct CertificateCompressionAlgorithms {
+  std::vector<CertificateCompressionAlgorithm> algorithms;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::compress_certificate;
+};
+
+struct DelegatedCredentialSupport {
+  std::vector<SignatureScheme> supported_signature_algorithms;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::delegated_credential;
+};
+
+struct DelegatedCredential {
+  uint32_t valid_time;
+  SignatureScheme expected_verify_scheme;
+  Buf public_key;
+  SignatureScheme credential_scheme;
+  Buf signature;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::delegated_credential;
+};
+
 template <class T>
 folly::Optional<T> getExtension(const std::vector<Extension>& extension);
 template <class T>
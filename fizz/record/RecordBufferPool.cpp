@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/record/RecordBufferPool.h>
+
+#include <glog/logging.h>
+#include <sys/mman.h>
+
+#include <cstdlib>
+
+namespace fizz {
+
+namespace {
+// Five pages, comfortably more than a 16k record with its header and tag.
+constexpr size_t kBlockSize = 5 * 4096;
+constexpr size_t kTrailerSize = 64;
+constexpr size_t kPageSize = 4096;
+} // namespace
+
+/**
+ * Lives at the end of every outstanding buffer, past the capacity given to
+ * the IOBuf, and keeps the pool alive until the buffer is returned.
+ */
+struct RecordBufferPool::BufferTrailer {
+  std::shared_ptr<RecordBufferPool> pool;
+};
+
+static_assert(
+    sizeof(std::shared_ptr<RecordBufferPool>) <= kTrailerSize,
+    "trailer too small");
+
+RecordBufferPool::RecordBufferPool(size_t maxCached, bool lockMemory)
+    : maxCached_(maxCached), lockMemory_(lockMemory) {}
+
+RecordBufferPool::~RecordBufferPool() {
+  auto freeBuffers = freeBuffers_.wlock();
+  for (auto buf : *freeBuffers) {
+    if (lockMemory_) {
+      munlock(buf, kBlockSize);
+    }
+    free(buf);
+  }
+}
+
+size_t RecordBufferPool::bufferSize() {
+  return kBlockSize - kTrailerSize;
+}
+
+size_t RecordBufferPool::cached() const {
+  return freeBuffers_.rlock()->size();
+}
+
+std::unique_ptr<folly::IOBuf> RecordBufferPool::get() {
+  auto self = shared_from_this();
+  void* buf = nullptr;
+  {
+    auto freeBuffers = freeBuffers_.wlock();
+    if (!freeBuffers->empty()) {
+      buf = freeBuffers->back();
+      freeBuffers->pop_back();
+    }
+  }
+  if (!buf) {
+    if (posix_memalign(&buf, kPageSize, kBlockSize) != 0) {
+      throw std::bad_alloc();
+    }
+    if (lockMemory_ && mlock(buf, kBlockSize) != 0) {
+      VLOG(4) << "mlock of record buffer failed: " << errno;
+    }
+  }
+  auto trailer = new (static_cast<uint8_t*>(buf) + bufferSize())
+      BufferTrailer{std::move(self)};
+  return folly::IOBuf::takeOwnership(
+      buf, bufferSize(), 0, &RecordBufferPool::freeBuffer, trailer);
+}
+
+void RecordBufferPool::freeBuffer(void* buf, void* userData) {
+  auto trailer = static_cast<BufferTrailer*>(userData);
+  auto pool = std::move(trailer->pool);
+  trailer->~BufferTrailer();
+  pool->release(buf);
+}
+
+void RecordBufferPool::release(void* buf) {
+  {
+    auto freeBuffers = freeBuffers_.wlock();
+    if (freeBuffers->size() < maxCached_) {
+      freeBuffers->push_back(buf);
+      return;
+    }
+  }
+  if (lockMemory_) {
+    munlock(buf, kBlockSize);
+  }
+  free(buf);
+}
+} // namespace fizz
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Synchronized.h>
+#include <folly/io/IOBuf.h>
+
+#include <memory>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Pool of page aligned buffers, each large enough for one full encrypted
+ * record, shared across connections. Buffers are handed out as IOBufs and
+ * return to the pool when the last reference to them is dropped. With
+ * MSG_ZEROCOPY the socket holds that reference until the kernel reports the
+ * send complete, so a buffer is only reused once the kernel is done with it.
+ *
+ * The pool must be owned by a shared_ptr; outstanding buffers keep it alive.
+ */
+class RecordBufferPool
+    : public std::enable_shared_from_this<RecordBufferPool> {
+ public:
+  /**
+   * Up to maxCached free buffers are kept for reuse. If lockMemory is set,
+   * buffers are locked into memory (mlock) when first allocated so the pages
+   * the kernel pins for zero copy sends are always resident.
+   */
+  explicit RecordBufferPool(size_t maxCached, bool lockMemory = false);
+
+  ~RecordBufferPool();
+
+  /**
+   * Returns an empty, unshared buffer with bufferSize() bytes of capacity.
+   */
+  std::unique_ptr<folly::IOBuf> get();
+
+  /**
+   * Capacity of every buffer: a full record plus its header, content type
+   * and tag.
+   */
+  static size_t bufferSize();
+
+  /**
+   * Number of free buffers currently cached.
+   */
+  size_t cached() const;
+
+ private:
+  struct BufferTrailer;
+
+  static void freeBuffer(void* buf, void* userData);
+
+  void release(void* buf);
+
+  size_t maxCached_;
+  bool lockMemory_;
+  folly::Synchronized<std::vector<void*>> freeBuffers_;
+};
+} // namespace fizz
@@ -17,6 +17,9 @@ static constexpr size_t kHandshakeHeaderSize =
 
 static constexpr size_t kMaxHandshakeSize = 0x20000; // 128k
 
+// Unused capacity a buffer may have before compactBuffer() copies it.
+static constexpr size_t kCompactionSlack = 4096;
+
 folly::Optional<Param> ReadRecordLayer::readEvent(
     folly::IOBufQueue& socketBuf) {
   if (!unparsedHandshakeData_.empty()) {
@@ -132,6 +135,9 @@ folly::Optional<Param> ReadRecordLayer::decodeHandshakeMessage(
     case HandshakeType::certificate:
       return parse<CertificateMsg>(
           std::move(handshakeMsg), std::move(original));
+    case HandshakeType::compressed_certificate:
+      return parse<CompressedCertificate>(
+          std::move(handshakeMsg), std::move(original));
     case HandshakeType::certificate_request:
       return parse<CertificateRequest>(
           std::move(handshakeMsg), std::move(original));
@@ -150,4 +156,44 @@ folly::Optional<Param> ReadRecordLayer::decodeHandshakeMessage(
 bool ReadRecordLayer::hasUnparsedHandshakeData() const {
   return !unparsedHandshakeData_.empty();
 }
+
+void ReadRecordLayer::compact() {
+  compactQueue(unparsedHandshakeData_);
+}
+
+void compactBuffer(Buf& buf) {
+  if (!buf) {
+    return;
+  }
+
+  size_t length = 0;
+  size_t capacity = 0;
+  auto current = buf.get();
+  do {
+    length += current->length();
+    capacity += current->capacity();
+    current = current->next();
+  } while (current != buf.get());
+
+  if (length == 0) {
+    buf.reset();
+  } else if (capacity > 2 * length + kCompactionSlack) {
+    auto compacted = folly::IOBuf::create(length);
+    folly::io::Cursor cursor(buf.get());
+    cursor.pull(compacted->writableData(), length);
+    compacted->append(length);
+    buf = std::move(compacted);
+  }
+}
+
+void compactQueue(folly::IOBufQueue& queue) {
+  if (!queue.front()) {
+    return;
+  }
+  auto buf = queue.move();
+  compactBuffer(buf);
+  if (buf) {
+    queue.append(std::move(buf));
+  }
+}
 } // namespace fizz
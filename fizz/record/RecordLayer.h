@@ -37,6 +37,13 @@ class ReadRecordLayer {
    */
   virtual bool hasUnparsedHandshakeData() const;
 
+  /**
+   * Shrinks any partially received handshake message to the size of its data
+   * so an idle connection doesn't hold on to the record buffers it arrived
+   * in.
+   */
+  virtual void compact();
+
  private:
   static folly::Optional<Param> decodeHandshakeMessage(folly::IOBufQueue& buf);
 
@@ -44,6 +51,19 @@ class ReadRecordLayer {
       folly::IOBufQueue::cacheChainLength()};
 };
 
+/**
+ * Copies buf into a single buffer of exactly its length if the buffers in the
+ * chain have more than twice as much capacity as they have data (plus some
+ * slack, so records arriving in small pieces aren't copied over and over).
+ * An empty chain is released.
+ */
+void compactBuffer(Buf& buf);
+
+/**
+ * Same as compactBuffer for the data in queue.
+ */
+void compactQueue(folly::IOBufQueue& queue);
+
 class WriteRecordLayer {
  public:
   virtual ~WriteRecordLayer() = default;
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Executor.h>
+#include <folly/ExceptionWrapper.h>
+#include <folly/futures/Future.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Configuration for spreading the aead work of one connection over several
+ * threads. A record's nonce depends only on its sequence number, so once the
+ * records of a batch have been split and numbered they can be protected
+ * independently and reassembled in order. This only applies to aeads that
+ * support concurrent use; others are always run on the calling thread.
+ */
+struct RecordParallelism {
+  /**
+   * Executor running the aead work. The calling thread blocks until the
+   * batch is done, so this must not be the thread's own event base.
+   */
+  folly::Executor* executor{nullptr};
+
+  /**
+   * Batches with fewer records than this are processed serially.
+   */
+  size_t minRecords{8};
+
+  /**
+   * Number of records in each task handed to the executor.
+   */
+  size_t recordsPerTask{4};
+
+  /**
+   * Maximum number of records decrypted ahead of the record being read.
+   */
+  size_t maxReadAhead{64};
+};
+
+namespace detail {
+
+/**
+ * Calls func(i) for every i in [0, count), spreading the calls over the
+ * executor if the batch is large enough. The calling thread processes the
+ * first task itself and returns once every call has finished. Rethrows the
+ * first exception thrown by func.
+ */
+template <typename Func>
+void forEachRecord(
+    const RecordParallelism& parallelism,
+    size_t count,
+    Func&& func) {
+  if (!parallelism.executor || count < parallelism.minRecords) {
+    for (size_t i = 0; i < count; ++i) {
+      func(i);
+    }
+    return;
+  }
+
+  auto perTask = std::max<size_t>(parallelism.recordsPerTask, 1);
+  std::vector<folly::Future<folly::Unit>> tasks;
+  tasks.reserve(count / perTask);
+  for (size_t begin = perTask; begin < count; begin += perTask) {
+    auto end = std::min(count, begin + perTask);
+    tasks.push_back(folly::via(parallelism.executor, [&func, begin, end] {
+      for (size_t i = begin; i < end; ++i) {
+        func(i);
+      }
+    }));
+  }
+
+  // Tasks reference func, so every one of them must finish before this
+  // returns, even if the calling thread's share throws.
+  folly::exception_wrapper ew;
+  try {
+    for (size_t i = 0; i < std::min(count, perTask); ++i) {
+      func(i);
+    }
+  } catch (...) {
+    ew = folly::exception_wrapper(std::current_exception());
+  }
+  auto results = folly::collectAll(tasks).get();
+  if (ew) {
+    ew.throw_exception();
+  }
+  for (auto& result : results) {
+    result.throwIfFailed();
+  }
+}
+} // namespace detail
+} // namespace fizz
@@ -0,0 +1,28 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace fizz {
+
+/**
+ * Counts the records protected and unprotected by the encrypted record
+ * layers, given their plaintext length. Called for every record, so
+ * implementations must be cheap.
+ */
+class RecordStats {
+ public:
+  virtual ~RecordStats() = default;
+
+  virtual void recordEncrypted(size_t bytes) = 0;
+
+  virtual void recordDecrypted(size_t bytes) = 0;
+};
+} // namespace fizz
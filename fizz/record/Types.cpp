@@ -90,6 +90,10 @@ std::string toString(ExtensionType extType) {
       return "token_binding";
     case ExtensionType::quic_transport_parameters:
       return "quic_transport_parameters";
+    case ExtensionType::compress_certificate:
+      return "compress_certificate";
+    case ExtensionType::delegated_credential:
+      return "delegated_credential";
     case ExtensionType::key_share_old:
       return "key_share_old";
     case ExtensionType::pre_shared_key:
@@ -190,6 +194,8 @@ std::string toString(CipherSuite cipher) {
       return "TLS_CHACHA20_POLY1305_SHA256";
     case CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL:
       return "TLS_AES_128_OCB_SHA256_EXPERIMENTAL";
+    case CipherSuite::TLS_AEGIS_128L_SHA256_EXPERIMENTAL:
+      return "TLS_AEGIS_128L_SHA256_EXPERIMENTAL";
   }
   return enumToHex(cipher);
 }
@@ -226,6 +232,18 @@ std::string toString(SignatureScheme sigScheme) {
   return enumToHex(sigScheme);
 }
 
+std::string toString(CertificateCompressionAlgorithm algo) {
+  switch (algo) {
+    case CertificateCompressionAlgorithm::zlib:
+      return "zlib";
+    case CertificateCompressionAlgorithm::brotli:
+      return "brotli";
+    case CertificateCompressionAlgorithm::zstd:
+      return "zstd";
+  }
+  return enumToHex(algo);
+}
+
 std::string toString(NamedGroup group) {
   switch (group) {
     case NamedGroup::secp256r1:
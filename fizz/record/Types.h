@@ -69,6 +69,7 @@ enum class HandshakeType : uint8_t {
   certificate_verify = 15,
   finished = 20,
   key_update = 24,
+  compressed_certificate = 25,
   message_hash = 254
 };
 
@@ -94,6 +95,8 @@ enum class ExtensionType : uint16_t {
   application_layer_protocol_negotiation = 16,
   token_binding = 24,
   quic_transport_parameters = 26,
+  compress_certificate = 27,
+  delegated_credential = 34,
   key_share_old = 40,
   pre_shared_key = 41,
   early_data = 42,
@@ -149,7 +152,8 @@ enum class CipherSuite : uint16_t {
   TLS_AES_256_GCM_SHA384 = 0x1302,
   TLS_CHACHA20_POLY1305_SHA256 = 0x1303,
   // experimental cipher suites
-  TLS_AES_128_OCB_SHA256_EXPERIMENTAL = 0xFF01
+  TLS_AES_128_OCB_SHA256_EXPERIMENTAL = 0xFF01,
+  TLS_AEGIS_128L_SHA256_EXPERIMENTAL = 0xFF02
 };
 
 std::string toString(CipherSuite);
@@ -234,6 +238,22 @@ struct CertificateRequest : HandshakeStruct<
   std::vector<Extension> extensions;
 };
 
+enum class CertificateCompressionAlgorithm : uint16_t {
+  zlib = 1,
+  brotli = 2,
+  zstd = 3,
+};
+
+std::string toString(CertificateCompressionAlgorithm);
+
+struct CompressedCertificate : HandshakeStruct<
+                                   Event::CompressedCertificate,
+                                   HandshakeType::compressed_certificate> {
+  CertificateCompressionAlgorithm algorithm;
+  uint32_t uncompressed_length;
+  Buf compressed_certificate_message;
+};
+
 enum class SignatureScheme : uint16_t {
   ecdsa_secp256r1_sha256 = 0x0403,
   ecdsa_secp384r1_sha384 = 0x0503,
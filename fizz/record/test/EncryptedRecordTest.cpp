@@ -11,8 +11,12 @@
 
 #include <fizz/record/EncryptedRecordLayer.h>
 
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/AESGCMNative.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
 #include <fizz/crypto/aead/test/Mocks.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 
 using namespace folly;
 using namespace folly::io;
@@ -375,5 +379,257 @@ TEST_F(EncryptedRecordTest, TestWriteMaxSize) {
           }));
   write_.write(std::move(msg));
 }
+
+static TrafficKey getTrafficKey() {
+  TrafficKey key;
+  key.key = IOBuf::copyBuffer(std::string(AESGCM128::kKeyLength, 'k'));
+  key.iv = IOBuf::copyBuffer(std::string(AESGCM128::kIVLength, 'i'));
+  return key;
+}
+
+template <typename Layer>
+static std::unique_ptr<Layer> makeGcmWriteLayer() {
+  auto layer = std::make_unique<Layer>();
+  auto aead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+  aead->setKey(getTrafficKey());
+  layer->setAead(std::move(aead));
+  return layer;
+}
+
+/**
+ * Hides the type of the aead it forwards to, so that a record layer can only
+ * use it through the Aead interface.
+ */
+class ForwardingAead : public Aead {
+ public:
+  explicit ForwardingAead(std::unique_ptr<Aead> aead)
+      : aead_(std::move(aead)) {}
+
+  size_t keyLength() const override {
+    return aead_->keyLength();
+  }
+
+  size_t ivLength() const override {
+    return aead_->ivLength();
+  }
+
+  void setKey(TrafficKey key) override {
+    aead_->setKey(std::move(key));
+  }
+
+  std::unique_ptr<IOBuf> encrypt(
+      std::unique_ptr<IOBuf>&& plaintext,
+      const IOBuf* associatedData,
+      uint64_t seqNum) const override {
+    return aead_->encrypt(std::move(plaintext), associatedData, seqNum);
+  }
+
+  void setEncryptedBufferHeadroom(size_t headroom) override {
+    aead_->setEncryptedBufferHeadroom(headroom);
+  }
+
+  folly::Optional<std::unique_ptr<IOBuf>> tryDecrypt(
+      std::unique_ptr<IOBuf>&& ciphertext,
+      const IOBuf* associatedData,
+      uint64_t seqNum) const override {
+    return aead_->tryDecrypt(std::move(ciphertext), associatedData, seqNum);
+  }
+
+  size_t getCipherOverhead() const override {
+    return aead_->getCipherOverhead();
+  }
+
+ private:
+  std::unique_ptr<Aead> aead_;
+};
+
+TEST_F(EncryptedRecordTest, TestTypedWriteMatchesVirtual) {
+  auto typed = makeGcmWriteLayer<EncryptedWriteRecordLayer>();
+  auto aead = std::make_unique<ForwardingAead>(
+      std::make_unique<OpenSSLEVPCipher<AESGCM128>>());
+  aead->setKey(getTrafficKey());
+  EncryptedWriteRecordLayer virtualWrite;
+  virtualWrite.setAead(std::move(aead));
+  for (size_t len : {0, 1, 1500, 0x4a00}) {
+    auto data = IOBuf::create(len);
+    memset(data->writableData(), 'a', len);
+    data->append(len);
+    auto expected = virtualWrite.writeAppData(data->clone());
+    auto actual = typed->writeAppData(std::move(data));
+    EXPECT_TRUE(eq_(expected, actual));
+  }
+  EXPECT_TRUE(eq_(
+      virtualWrite.writeHandshake(IOBuf::copyBuffer("handshake")),
+      typed->writeHandshake(IOBuf::copyBuffer("handshake"))));
+}
+
+template <typename AeadType, typename Layer>
+static std::unique_ptr<Layer> makeLayer() {
+  auto layer = std::make_unique<Layer>();
+  auto aead = std::make_unique<AeadType>();
+  aead->setKey(getTrafficKey());
+  layer->setAead(std::move(aead));
+  return layer;
+}
+
+static Buf makeBulkData(size_t len) {
+  auto data = IOBuf::create(len);
+  for (size_t i = 0; i < len; ++i) {
+    data->writableData()[i] = static_cast<uint8_t>(i * 7);
+  }
+  data->append(len);
+  return data;
+}
+
+static RecordParallelism makeParallelism(folly::Executor* executor) {
+  RecordParallelism parallelism;
+  parallelism.executor = executor;
+  parallelism.minRecords = 2;
+  parallelism.recordsPerTask = 1;
+  return parallelism;
+}
+
+TEST_F(EncryptedRecordTest, TestParallelWriteMatchesSerial) {
+  using NativeAead = AESGCMNative<AESGCM128>;
+  if (!NativeAead::isSupported()) {
+    return;
+  }
+  CPUThreadPoolExecutor executor(4);
+  auto serial = makeLayer<NativeAead, EncryptedWriteRecordLayer>();
+  auto parallel = makeLayer<NativeAead, EncryptedWriteRecordLayer>();
+  parallel->setParallelism(makeParallelism(&executor));
+  for (size_t len : {0, 1, 0x4000, 0x4001, 10 * 0x4000 + 17}) {
+    auto expected = serial->writeAppData(makeBulkData(len));
+    auto actual = parallel->writeAppData(makeBulkData(len));
+    EXPECT_TRUE(eq_(expected, actual)) << len;
+    EXPECT_EQ(serial->getSequenceNumber(), parallel->getSequenceNumber());
+  }
+}
+
+TEST_F(EncryptedRecordTest, TestParallelWriteNotConcurrentAead) {
+  CPUThreadPoolExecutor executor(4);
+  auto serial = makeGcmWriteLayer<EncryptedWriteRecordLayer>();
+  auto parallel = makeGcmWriteLayer<EncryptedWriteRecordLayer>();
+  parallel->setParallelism(makeParallelism(&executor));
+  EXPECT_TRUE(eq_(
+      serial->writeAppData(makeBulkData(5 * 0x4000)),
+      parallel->writeAppData(makeBulkData(5 * 0x4000))));
+}
+
+TEST_F(EncryptedRecordTest, TestParallelRead) {
+  using NativeAead = AESGCMNative<AESGCM128>;
+  if (!NativeAead::isSupported()) {
+    return;
+  }
+  CPUThreadPoolExecutor executor(4);
+  auto write = makeLayer<NativeAead, EncryptedWriteRecordLayer>();
+  auto read = makeLayer<NativeAead, EncryptedReadRecordLayer>();
+  read->setParallelism(makeParallelism(&executor));
+  queue_.append(write->writeAppData(makeBulkData(6 * 0x4000 + 5)));
+  queue_.append(write->writeHandshake(IOBuf::copyBuffer("handshake")));
+
+  IOBufQueue received{IOBufQueue::cacheChainLength()};
+  for (size_t i = 0; i < 7; ++i) {
+    auto msg = read->read(queue_);
+    ASSERT_TRUE(msg.hasValue());
+    EXPECT_EQ(msg->type, ContentType::application_data);
+    received.append(std::move(msg->fragment));
+    // Records decrypted ahead stay queued until they are read.
+    EXPECT_FALSE(queue_.empty());
+  }
+  EXPECT_TRUE(eq_(received.move(), makeBulkData(6 * 0x4000 + 5)));
+
+  auto msg = read->read(queue_);
+  ASSERT_TRUE(msg.hasValue());
+  EXPECT_EQ(msg->type, ContentType::handshake);
+  expectSame(msg->fragment, hexlify("handshake"));
+  EXPECT_TRUE(queue_.empty());
+  EXPECT_EQ(read->getSequenceNumber(), 8u);
+  EXPECT_FALSE(read->read(queue_).hasValue());
+}
+
+TEST_F(EncryptedRecordTest, TestParallelReadFailure) {
+  using NativeAead = AESGCMNative<AESGCM128>;
+  if (!NativeAead::isSupported()) {
+    return;
+  }
+  CPUThreadPoolExecutor executor(4);
+  auto write = makeLayer<NativeAead, EncryptedWriteRecordLayer>();
+  auto read = makeLayer<NativeAead, EncryptedReadRecordLayer>();
+  read->setParallelism(makeParallelism(&executor));
+  for (size_t i = 0; i < 4; ++i) {
+    auto record = write->writeAppData(makeBulkData(100));
+    if (i == 2) {
+      record->coalesce();
+      record->writableData()[20] ^= 0x01;
+    }
+    queue_.append(std::move(record));
+  }
+
+  EXPECT_TRUE(read->read(queue_).hasValue());
+  EXPECT_TRUE(read->read(queue_).hasValue());
+  EXPECT_THROW(read->read(queue_), std::runtime_error);
+}
+
+TEST_F(EncryptedRecordTest, TestWriteWithBufferPool) {
+  auto pool = std::make_shared<RecordBufferPool>(8);
+  auto plain = makeGcmWriteLayer<EncryptedWriteRecordLayer>();
+  auto pooled = makeGcmWriteLayer<EncryptedWriteRecordLayer>();
+  pooled->setBufferPool(pool);
+
+  // Split records share the original buffer, so they go through the pool.
+  auto expected = plain->writeAppData(makeBulkData(3 * 0x4000 + 10));
+  auto actual = pooled->writeAppData(makeBulkData(3 * 0x4000 + 10));
+  EXPECT_TRUE(eq_(expected, actual));
+  EXPECT_EQ(pool->cached(), 0u);
+  actual.reset();
+  // The last record was the rest of the original buffer, which was no longer
+  // shared by then.
+  EXPECT_EQ(pool->cached(), 3u);
+
+  // Unshared data is still encrypted in place.
+  auto data = makeBulkData(100);
+  auto dataPtr = data->data();
+  auto record = pooled->writeAppData(std::move(data));
+  EXPECT_EQ(record->next()->data(), dataPtr);
+  EXPECT_EQ(pool->cached(), 3u);
+}
+
+class CountingRecordStats : public RecordStats {
+ public:
+  void recordEncrypted(size_t bytes) override {
+    recordsEncrypted++;
+    bytesEncrypted += bytes;
+  }
+
+  void recordDecrypted(size_t bytes) override {
+    recordsDecrypted++;
+    bytesDecrypted += bytes;
+  }
+
+  size_t recordsEncrypted{0};
+  size_t bytesEncrypted{0};
+  size_t recordsDecrypted{0};
+  size_t bytesDecrypted{0};
+};
+
+TEST_F(EncryptedRecordTest, TestStats) {
+  auto stats = std::make_shared<CountingRecordStats>();
+  auto write = makeGcmWriteLayer<EncryptedWriteRecordLayer>();
+  write->setStats(stats);
+  auto read =
+      makeLayer<OpenSSLEVPCipher<AESGCM128>, EncryptedReadRecordLayer>();
+  read->setStats(stats);
+
+  queue_.append(write->writeAppData(makeBulkData(2 * 0x4000 + 10)));
+  EXPECT_EQ(stats->recordsEncrypted, 3u);
+  EXPECT_EQ(stats->bytesEncrypted, 2u * 0x4000 + 10);
+  EXPECT_EQ(stats->recordsDecrypted, 0u);
+
+  while (read->read(queue_)) {
+  }
+  EXPECT_EQ(stats->recordsDecrypted, 3u);
+  EXPECT_EQ(stats->bytesDecrypted, 2u * 0x4000 + 10);
+}
 } // namespace test
 } // namespace fizz
@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fizz/record/RecordBufferPool.h>
+
+namespace fizz {
+namespace test {
+
+TEST(RecordBufferPoolTest, TestGet) {
+  auto pool = std::make_shared<RecordBufferPool>(4);
+  auto buf = pool->get();
+  EXPECT_EQ(buf->length(), 0u);
+  EXPECT_EQ(buf->capacity(), RecordBufferPool::bufferSize());
+  EXPECT_GE(RecordBufferPool::bufferSize(), 0x4000 + 256 + 5);
+  EXPECT_FALSE(buf->isShared());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(buf->data()) % 4096, 0u);
+  EXPECT_EQ(pool->cached(), 0u);
+}
+
+TEST(RecordBufferPoolTest, TestReuse) {
+  auto pool = std::make_shared<RecordBufferPool>(4);
+  auto buf = pool->get();
+  auto data = buf->data();
+  auto clone = buf->clone();
+  buf.reset();
+  // Still referenced by the clone, as the socket would until the send is
+  // complete.
+  EXPECT_EQ(pool->cached(), 0u);
+  clone.reset();
+  EXPECT_EQ(pool->cached(), 1u);
+  buf = pool->get();
+  EXPECT_EQ(buf->data(), data);
+  EXPECT_EQ(pool->cached(), 0u);
+}
+
+TEST(RecordBufferPoolTest, TestMaxCached) {
+  auto pool = std::make_shared<RecordBufferPool>(2);
+  std::vector<std::unique_ptr<folly::IOBuf>> bufs;
+  for (size_t i = 0; i < 5; ++i) {
+    bufs.push_back(pool->get());
+  }
+  bufs.clear();
+  EXPECT_EQ(pool->cached(), 2u);
+}
+
+TEST(RecordBufferPoolTest, TestOutlivesPool) {
+  auto pool = std::make_shared<RecordBufferPool>(2, true);
+  std::weak_ptr<RecordBufferPool> weakPool = pool;
+  auto buf = pool->get();
+  pool.reset();
+  EXPECT_FALSE(weakPool.expired());
+  memset(buf->writableTail(), 'a', buf->tailroom());
+  buf.reset();
+  EXPECT_TRUE(weakPool.expired());
+}
+} // namespace test
+} // namespace fizz
@@ -154,6 +154,62 @@ TEST_F(RecordTest, TestHandshakeSpliced) {
   EXPECT_ANY_THROW(read_.readEvent(queue_));
 }
 
+TEST_F(RecordTest, TestCompactUnparsedHandshakeData) {
+  EXPECT_CALL(read_, read(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        auto fragment = IOBuf::create(0x4000);
+        fragment->append(4);
+        memcpy(fragment->writableData(), "\x14\x00\x00\x08", 4);
+        return TLSMessage{ContentType::handshake, std::move(fragment)};
+      }))
+      .WillOnce(InvokeWithoutArgs([]() { return folly::none; }));
+  EXPECT_FALSE(read_.readEvent(queue_).hasValue());
+  read_.compact();
+  EXPECT_TRUE(read_.hasUnparsedHandshakeData());
+  EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
+    return TLSMessage{ContentType::handshake, getBuf("aabbccdd11223344")};
+  }));
+  auto param = read_.readEvent(queue_);
+  auto& finished = boost::get<Finished>(*param);
+  expectSame(finished.verify_data, "aabbccdd11223344");
+}
+
+TEST_F(RecordTest, TestCompactBuffer) {
+  auto buf = IOBuf::create(0x4000);
+  buf->append(10);
+  memset(buf->writableData(), 'a', 10);
+  buf->prependChain(IOBuf::copyBuffer("bcd"));
+  compactBuffer(buf);
+  EXPECT_FALSE(buf->isChained());
+  EXPECT_LT(buf->capacity(), 0x4000);
+  EXPECT_TRUE(eq_(buf, IOBuf::copyBuffer("aaaaaaaaaabcd")));
+
+  // Mostly full buffers are left alone.
+  auto full = IOBuf::create(1000);
+  full->append(900);
+  auto fullPtr = full.get();
+  compactBuffer(full);
+  EXPECT_EQ(full.get(), fullPtr);
+
+  auto empty = IOBuf::create(100);
+  compactBuffer(empty);
+  EXPECT_FALSE(empty);
+}
+
+TEST_F(RecordTest, TestCompactQueue) {
+  compactQueue(queue_);
+  EXPECT_TRUE(queue_.empty());
+
+  auto buf = IOBuf::create(0x4000);
+  buf->append(5);
+  memset(buf->writableData(), 'x', 5);
+  queue_.append(std::move(buf));
+  compactQueue(queue_);
+  EXPECT_EQ(queue_.chainLength(), 5u);
+  EXPECT_LT(queue_.front()->capacity(), 0x4000);
+  EXPECT_TRUE(eq_(queue_.move(), IOBuf::copyBuffer("xxxxx")));
+}
+
 TEST_F(RecordTest, TestWriteAppData) {
   EXPECT_CALL(write_, _write(_)).WillOnce(Invoke([](TLSMessage& msg) {
     EXPECT_EQ(msg.type, ContentType::application_data);
@@ -114,7 +114,7 @@ std::string AsyncFizzServerT<SM>::getApplicationProtocol() noexcept {
 
 template <typename SM>
 void AsyncFizzServerT<SM>::close() {
-  if (transport_->good()) {
+  if (good()) {
     fizzServer_.appClose();
   } else {
     DelayedDestruction::DestructorGuard dg(this);
@@ -128,7 +128,7 @@ void AsyncFizzServerT<SM>::close() {
 template <typename SM>
 void AsyncFizzServerT<SM>::closeWithReset() {
   DelayedDestruction::DestructorGuard dg(this);
-  if (transport_->good()) {
+  if (good()) {
     fizzServer_.appClose();
   }
   folly::AsyncSocketException ase(
@@ -140,7 +140,7 @@ void AsyncFizzServerT<SM>::closeWithReset() {
 template <typename SM>
 void AsyncFizzServerT<SM>::closeNow() {
   DelayedDestruction::DestructorGuard dg(this);
-  if (transport_->good()) {
+  if (good()) {
     fizzServer_.appClose();
   }
   folly::AsyncSocketException ase(
@@ -165,6 +165,97 @@ Buf AsyncFizzServerT<SM>::getEarlyEkm(
   return fizzServer_.getEarlyEkm(label, context, length);
 }
 
+template <typename SM>
+bool AsyncFizzServerT<SM>::enableKTLSTx() {
+  if (ktlsTx_) {
+    return true;
+  }
+  if (state_.state() != StateEnum::AcceptingData ||
+      fizzServer_.actionProcessing()) {
+    return false;
+  }
+  auto socket = transport_->getUnderlyingTransport<folly::AsyncSocket>();
+  if (!socket) {
+    return false;
+  }
+  ktlsTx_ = fizz::enableKTLSTx(
+      state_, *socket, AppTrafficSecrets::ServerAppTraffic);
+  return ktlsTx_ != nullptr;
+}
+
+template <typename SM>
+folly::Optional<KTLSCryptoParams> AsyncFizzServerT<SM>::getKTLSParams(
+    KTLSDirection direction) const {
+  if (state_.state() != StateEnum::AcceptingData) {
+    return folly::none;
+  }
+  return KTLS::getParams(
+      state_,
+      direction == KTLSDirection::Tx ? AppTrafficSecrets::ServerAppTraffic
+                                     : AppTrafficSecrets::ClientAppTraffic,
+      direction);
+}
+
+template <typename SM>
+Buf AsyncFizzServerT<SM>::exportConnectionState() {
+  if (state_.state() != StateEnum::AcceptingData ||
+      fizzServer_.actionProcessing()) {
+    throw std::runtime_error("connection not established");
+  }
+  if (ktlsTx_ || hasBufferedAppData()) {
+    throw std::runtime_error("connection state can't be exported");
+  }
+  auto exported = fizz::exportConnectionState(state_);
+  exported.peerCert = encodePeerCert(state_.clientCert());
+  if (state_.serverCert()) {
+    exported.selfCertIdentity = state_.serverCert()->getIdentity();
+  }
+  exported.resumptionSecret =
+      folly::IOBuf::copyBuffer(folly::range(state_.resumptionMasterSecret()));
+  if (!transportReadBuf_.empty()) {
+    exported.bufferedData = transportReadBuf_.front()->clone();
+  }
+  auto encoded = encodeConnectionState(exported);
+  transport_->setReadCB(nullptr);
+  retireExportedConnectionState(state_);
+  CryptoUtils::clean(folly::range(state_.resumptionMasterSecret()));
+  state_.resumptionMasterSecret().clear();
+  return encoded;
+}
+
+template <typename SM>
+void AsyncFizzServerT<SM>::importConnectionState(Buf encoded) {
+  auto exported = decodeConnectionState(std::move(encoded));
+  state_.context() = fizzContext_;
+  state_.executor() = transport_->getEventBase();
+  state_.extensions() = extensions_;
+  fizz::importConnectionState(
+      state_,
+      exported,
+      AppTrafficSecrets::ClientAppTraffic,
+      AppTrafficSecrets::ServerAppTraffic);
+  if (exported.peerCert) {
+    state_.clientCert() = CertUtils::makePeerCert(std::move(exported.peerCert));
+  }
+  if (!exported.selfCertIdentity.empty()) {
+    state_.serverCert() = fizzContext_->getCert(exported.selfCertIdentity);
+  }
+  if (exported.resumptionSecret) {
+    auto secret = exported.resumptionSecret->coalesce();
+    state_.resumptionMasterSecret() =
+        std::vector<uint8_t>(secret.begin(), secret.end());
+  }
+  state_.state() = StateEnum::AcceptingData;
+
+  if (exported.bufferedData) {
+    transportReadBuf_.append(std::move(exported.bufferedData));
+  }
+  startTransportReads();
+  if (!transportReadBuf_.empty()) {
+    transportDataAvailable();
+  }
+}
+
 template <typename SM>
 void AsyncFizzServerT<SM>::writeAppData(
     folly::AsyncTransportWrapper::WriteCallback* callback,
@@ -181,6 +272,14 @@ void AsyncFizzServerT<SM>::writeAppData(
     return;
   }
 
+  if (ktlsTx_) {
+    // The kernel frames and encrypts everything written to the socket. EOR
+    // marks control records there (see KTLSControlRecordWriter).
+    transport_->writeChain(
+        callback, std::move(buf), flags & ~folly::WriteFlags::EOR);
+    return;
+  }
+
   AppWrite write;
   write.callback = callback;
   write.data = std::move(buf);
@@ -200,6 +299,23 @@ void AsyncFizzServerT<SM>::transportDataAvailable() {
   fizzServer_.newTransportData();
 }
 
+template <typename SM>
+void AsyncFizzServerT<SM>::compact() {
+  AsyncFizzBase::compact();
+  if (state_.readRecordLayer()) {
+    state_.readRecordLayer()->compact();
+  }
+  if (state_.state() == StateEnum::AcceptingData) {
+    state_.handshakeContext() = nullptr;
+    state_.handshakeReadRecordLayer() = nullptr;
+    state_.clientHandshakeSecret() = folly::none;
+    state_.unverifiedCertChain() = folly::none;
+    state_.appTokenValidator() = nullptr;
+    state_.handshakeLogging() = nullptr;
+    state_.handshakeTiming() = nullptr;
+  }
+}
+
 template <typename SM>
 void AsyncFizzServerT<SM>::deliverAllErrors(
     const folly::AsyncSocketException& ex,
@@ -242,6 +358,10 @@ void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(
 template <typename SM>
 void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(
     ReportHandshakeSuccess&) {
+  auto timingStats = server_.fizzContext_->getHandshakeTimingStats();
+  if (timingStats && server_.state_.handshakeTiming()) {
+    timingStats->add(*server_.state_.handshakeTiming());
+  }
   if (server_.handshakeCallback_) {
     auto callback = server_.handshakeCallback_;
     server_.handshakeCallback_ = nullptr;
@@ -265,11 +385,27 @@ void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(WaitForData&) {
     // Make sure that the read callback is installed.
     server_.startTransportReads();
   }
+
+  if (server_.getIdleCompaction()) {
+    server_.compact();
+  }
 }
 
 template <typename SM>
 void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(MutateState& mutator) {
   mutator(server_.state_);
+  if (server_.ktlsTx_) {
+    try {
+      syncKTLSTx(
+          server_.state_,
+          *server_.ktlsTx_,
+          AppTrafficSecrets::ServerAppTraffic);
+    } catch (const std::exception& ex) {
+      folly::AsyncSocketException ase(
+          folly::AsyncSocketException::SSL_ERROR, ex.what());
+      server_.deliverAllErrors(ase);
+    }
+  }
 }
 
 template <typename SM>
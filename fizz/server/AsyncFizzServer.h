@@ -9,7 +9,9 @@
 #pragma once
 
 #include <fizz/protocol/AsyncFizzBase.h>
+#include <fizz/protocol/ConnectionState.h>
 #include <fizz/protocol/Exporter.h>
+#include <fizz/protocol/KTLS.h>
 #include <fizz/server/FizzServer.h>
 #include <fizz/server/FizzServerContext.h>
 #include <fizz/server/ServerProtocol.h>
@@ -82,6 +84,50 @@ class AsyncFizzServerT : public AsyncFizzBase {
   const Cert* getPeerCertificate() const override;
   const Cert* getSelfCertificate() const override;
 
+  /**
+   * Moves record encryption for writes into the kernel (Linux kTLS). Must be
+   * called once the handshake has completed and no writes are pending.
+   * Afterwards application data is written to the socket as plaintext, so
+   * sendfile() on the socket's fd also works, and key updates are carried
+   * into the kernel. Returns false, leaving encryption in fizz, if kTLS is
+   * unavailable or the connection's cipher isn't supported by it.
+   *
+   * Reads stay in fizz: received records carry their content type in a
+   * control message that the transport's reads don't collect. Callers that
+   * read the socket themselves can install the Rx direction with
+   * getKTLSParams() and KTLS::install().
+   */
+  bool enableKTLSTx();
+
+  bool isKTLSTxEnabled() const {
+    return ktlsTx_ != nullptr;
+  }
+
+  /**
+   * Exports the current traffic key, iv and sequence number for one
+   * direction. Returns none before the handshake completes.
+   */
+  folly::Optional<KTLSCryptoParams> getKTLSParams(
+      KTLSDirection direction) const;
+
+  /**
+   * Serializes the established connection (see ExportedConnectionState) so
+   * that another process, handed the socket's fd, can continue it with
+   * importConnectionState(). Reads from the transport stop; afterwards the
+   * transport must not be used for the connection, and its fd should be
+   * detached rather than closed. Throws if the handshake isn't complete, an
+   * action is in progress, kTLS is enabled, or received app data is waiting
+   * for a read callback.
+   */
+  Buf exportConnectionState();
+
+  /**
+   * Continues a connection exported by exportConnectionState(), in place of
+   * accept(). The transport must wrap the same socket, and the context must
+   * offer the certificates and cipher suites the exporting process used.
+   */
+  void importConnectionState(Buf encoded);
+
  protected:
   void writeAppData(
       folly::AsyncTransportWrapper::WriteCallback* callback,
@@ -92,6 +138,13 @@ class AsyncFizzServerT : public AsyncFizzBase {
 
   void transportDataAvailable() override;
 
+  /**
+   * Once in AcceptingData, also drops the transcript, handshake record layer
+   * and secret, unverified client certificates, app token validator, and
+   * handshake logging and timing. The negotiated certificates stay available.
+   */
+  void compact() override;
+
  private:
   void deliverAllErrors(
       const folly::AsyncSocketException& ex,
@@ -127,6 +180,8 @@ class AsyncFizzServerT : public AsyncFizzBase {
   ActionMoveVisitor visitor_;
 
   FizzServer<ActionMoveVisitor, SM> fizzServer_;
+
+  std::unique_ptr<KTLSControlRecordWriter> ktlsTx_;
 };
 
 using AsyncFizzServer = AsyncFizzServerT<ServerStateMachine>;
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/CipherPreference.h>
+
+#include <algorithm>
+
+namespace fizz {
+namespace server {
+
+static std::unique_ptr<folly::IOBuf> makeZeroBuf(size_t len) {
+  auto buf = folly::IOBuf::create(len);
+  memset(buf->writableData(), 0, len);
+  buf->append(len);
+  return buf;
+}
+
+std::vector<CipherPreference::CipherCost> CipherPreference::measure(
+    const Factory& factory,
+    const std::vector<CipherSuite>& ciphers,
+    size_t recordSize,
+    size_t records) {
+  std::vector<CipherCost> costs;
+  for (auto cipher : ciphers) {
+    std::unique_ptr<Aead> aead;
+    try {
+      aead = factory.makeAead(cipher);
+    } catch (const std::exception&) {
+      continue;
+    }
+    TrafficKey key;
+    key.key = makeZeroBuf(aead->keyLength());
+    key.iv = makeZeroBuf(aead->ivLength());
+    aead->setKey(std::move(key));
+
+    // One untimed record to warm up caches and any lazy initialization.
+    aead->encrypt(makeZeroBuf(recordSize), nullptr, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < records; ++i) {
+      aead->encrypt(makeZeroBuf(recordSize), nullptr, i + 1);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    costs.push_back(
+        {cipher,
+         std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) /
+             std::max<size_t>(records, 1)});
+  }
+  return costs;
+}
+
+std::vector<std::vector<CipherSuite>> CipherPreference::makeTiers(
+    std::vector<CipherCost> costs,
+    double tolerance) {
+  std::stable_sort(
+      costs.begin(), costs.end(), [](const auto& a, const auto& b) {
+        return a.perRecord < b.perRecord;
+      });
+  std::vector<std::vector<CipherSuite>> tiers;
+  std::chrono::nanoseconds tierBase{0};
+  for (const auto& cost : costs) {
+    if (tiers.empty() ||
+        cost.perRecord.count() > tierBase.count() * tolerance) {
+      tiers.emplace_back();
+      tierBase = cost.perRecord;
+    }
+    tiers.back().push_back(cost.cipher);
+  }
+  return tiers;
+}
+
+std::vector<std::vector<CipherSuite>> CipherPreference::getMeasuredTiers(
+    const Factory& factory) {
+  return makeTiers(measure(
+      factory,
+      {CipherSuite::TLS_AES_128_GCM_SHA256,
+#if FOLLY_OPENSSL_IS_110
+       CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+#endif // FOLLY_OPENSSL_IS_110
+       CipherSuite::TLS_AES_256_GCM_SHA384}));
+}
+
+bool CipherPreference::clientPrefersChaCha(
+    const std::vector<CipherSuite>& clientPref) {
+  return !clientPref.empty() &&
+      clientPref.front() == CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Factory.h>
+
+#include <chrono>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Builds server cipher preference tiers from the measured cost of each
+ * cipher on this machine, and recognizes clients that ask for ChaCha20 first
+ * (typically because they lack AES hardware acceleration).
+ */
+class CipherPreference {
+ public:
+  struct CipherCost {
+    CipherSuite cipher;
+    std::chrono::nanoseconds perRecord;
+  };
+
+  /**
+   * Times sealing records of recordSize bytes with each cipher using aeads
+   * from factory. Ciphers the factory can't construct are left out.
+   */
+  static std::vector<CipherCost> measure(
+      const Factory& factory,
+      const std::vector<CipherSuite>& ciphers,
+      size_t recordSize = 16384,
+      size_t records = 64);
+
+  /**
+   * Groups ciphers into preference tiers, cheapest first. A cipher joins the
+   * current tier if it costs no more than tolerance times the cheapest cipher
+   * in that tier, so the client's order decides between ciphers of similar
+   * cost.
+   */
+  static std::vector<std::vector<CipherSuite>> makeTiers(
+      std::vector<CipherCost> costs,
+      double tolerance = 1.5);
+
+  /**
+   * Measures the default TLS 1.3 ciphers and returns tiers suitable for
+   * FizzServerContext::setSupportedCiphers(). Intended to be run once at
+   * startup.
+   */
+  static std::vector<std::vector<CipherSuite>> getMeasuredTiers(
+      const Factory& factory);
+
+  /**
+   * Returns true if the client listed ChaCha20-Poly1305 as its most
+   * preferred cipher.
+   */
+  static bool clientPrefersChaCha(const std::vector<CipherSuite>& clientPref);
+};
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/DelegatedCredentialManager.h>
+
+#include <fizz/crypto/openssl/OpenSSLKeyUtils.h>
+
+namespace fizz {
+namespace server {
+
+static folly::ssl::EvpPkeyUniquePtr generateCredentialKey(
+    SignatureScheme scheme) {
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return detail::generateECKeyPair(NID_X9_62_prime256v1);
+#if FIZZ_OPENSSL_HAS_ED25519
+    case SignatureScheme::ed25519:
+      return detail::generateEd25519KeyPair();
+#endif
+    default:
+      throw std::runtime_error("unsupported delegated credential scheme");
+  }
+}
+
+DelegatedCredentialManager::DelegatedCredentialManager(
+    std::shared_ptr<DelegatedCredentialSelfCert> cert,
+    SignatureScheme certScheme,
+    SignatureScheme credScheme,
+    std::chrono::seconds validFor,
+    std::chrono::seconds rotationInterval)
+    : cert_(std::move(cert)),
+      certScheme_(certScheme),
+      credScheme_(credScheme),
+      validFor_(validFor),
+      rotationInterval_(rotationInterval) {
+  if (rotationInterval_ >= validFor_) {
+    throw std::runtime_error(
+        "rotation interval must be shorter than credential lifetime");
+  }
+  scheduler_.setThreadName("DCRotation");
+}
+
+DelegatedCredentialManager::~DelegatedCredentialManager() {
+  stop();
+}
+
+void DelegatedCredentialManager::start() {
+  if (started_) {
+    return;
+  }
+  rotate();
+  scheduler_.addFunction(
+      [this]() {
+        try {
+          rotate();
+        } catch (const std::exception& e) {
+          // Keep serving the previous credential; it is still valid for
+          // validFor_ - rotationInterval_.
+          LOG(ERROR) << "Failed to rotate delegated credential: " << e.what();
+        }
+      },
+      std::chrono::duration_cast<std::chrono::milliseconds>(rotationInterval_),
+      "rotate",
+      std::chrono::duration_cast<std::chrono::milliseconds>(rotationInterval_));
+  scheduler_.start();
+  started_ = true;
+}
+
+void DelegatedCredentialManager::stop() {
+  if (started_) {
+    scheduler_.shutdown();
+    scheduler_.cancelAllFunctions();
+    started_ = false;
+  }
+}
+
+void DelegatedCredentialManager::rotate() {
+  auto credential = DelegatedCredentialUtils::generateCredential(
+      *cert_->getWrappedCert(),
+      certScheme_,
+      credScheme_,
+      generateCredentialKey(credScheme_),
+      validFor_);
+  cert_->setCredential(std::move(credential));
+}
+} // namespace server
+} // namespace fizz
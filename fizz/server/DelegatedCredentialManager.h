@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/DelegatedCredentialSelfCert.h>
+#include <folly/experimental/FunctionScheduler.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Keeps a DelegatedCredentialSelfCert supplied with a fresh credential. A new
+ * key is generated and signed with the certificate's key every
+ * rotationInterval; each credential is valid for validFor, which should be
+ * comfortably longer than rotationInterval so that clients with slightly
+ * skewed clocks still accept it.
+ */
+class DelegatedCredentialManager {
+ public:
+  DelegatedCredentialManager(
+      std::shared_ptr<DelegatedCredentialSelfCert> cert,
+      SignatureScheme certScheme,
+      SignatureScheme credScheme,
+      std::chrono::seconds validFor,
+      std::chrono::seconds rotationInterval);
+
+  ~DelegatedCredentialManager();
+
+  /**
+   * Mints a credential synchronously, then keeps rotating on a background
+   * thread until stop() is called.
+   */
+  void start();
+
+  void stop();
+
+  /**
+   * Mints and installs a new credential now. Throws if the credential could
+   * not be created.
+   */
+  void rotate();
+
+ private:
+  std::shared_ptr<DelegatedCredentialSelfCert> cert_;
+  SignatureScheme certScheme_;
+  SignatureScheme credScheme_;
+  std::chrono::seconds validFor_;
+  std::chrono::seconds rotationInterval_;
+  folly::FunctionScheduler scheduler_;
+  bool started_{false};
+};
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/DelegatedCredential.h>
+#include <fizz/server/AsyncSelfCert.h>
+#include <folly/Synchronized.h>
+
+namespace fizz {
+
+/**
+ * SelfCert that can also serve a delegated credential. It behaves exactly like
+ * the wrapped cert for clients that don't support delegated credentials. The
+ * current credential can be swapped at any time (see
+ * server::DelegatedCredentialManager); in-flight handshakes keep using the
+ * credential they started with.
+ *
+ * Signing with the certificate's own key is forwarded to the wrapped cert,
+ * asynchronously if it is an AsyncSelfCert.
+ */
+class DelegatedCredentialSelfCert : public AsyncSelfCert {
+ public:
+  explicit DelegatedCredentialSelfCert(std::shared_ptr<SelfCert> cert)
+      : cert_(std::move(cert)) {}
+
+  ~DelegatedCredentialSelfCert() override = default;
+
+  std::string getIdentity() const override {
+    return cert_->getIdentity();
+  }
+
+  std::vector<std::string> getAltIdentities() const override {
+    return cert_->getAltIdentities();
+  }
+
+  std::vector<SignatureScheme> getSigSchemes() const override {
+    return cert_->getSigSchemes();
+  }
+
+  CertificateMsg getCertMessage(
+      Buf certificateRequestContext = nullptr) const override {
+    return cert_->getCertMessage(std::move(certificateRequestContext));
+  }
+
+  folly::Optional<CompressedCertificate> getCompressedCert(
+      CertificateCompressionAlgorithm algo) const override {
+    return cert_->getCompressedCert(algo);
+  }
+
+  Buf sign(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const override {
+    return cert_->sign(scheme, context, toBeSigned);
+  }
+
+  folly::Future<folly::Optional<Buf>> signFuture(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const override {
+    auto asyncCert = dynamic_cast<const AsyncSelfCert*>(cert_.get());
+    if (asyncCert) {
+      return asyncCert->signFuture(scheme, context, toBeSigned);
+    }
+    return folly::Optional<Buf>(cert_->sign(scheme, context, toBeSigned));
+  }
+
+  folly::ssl::X509UniquePtr getX509() const override {
+    return cert_->getX509();
+  }
+
+  /**
+   * Returns the certificate message with credential attached to the leaf.
+   */
+  CertificateMsg getCertMessageWithCredential(
+      const SelfDelegatedCredential& credential) const {
+    auto msg = cert_->getCertMessage();
+    msg.certificate_list.front().extensions.push_back(
+        encodeExtension(credential.getCredential()));
+    return msg;
+  }
+
+  /**
+   * Returns the current credential, or nullptr if there is none or it has
+   * expired.
+   */
+  std::shared_ptr<const SelfDelegatedCredential> getCredential() const {
+    auto credential = *credential_.rlock();
+    if (credential &&
+        credential->getExpiry() <= std::chrono::system_clock::now()) {
+      return nullptr;
+    }
+    return credential;
+  }
+
+  void setCredential(
+      std::shared_ptr<const SelfDelegatedCredential> credential) {
+    *credential_.wlock() = std::move(credential);
+  }
+
+  const std::shared_ptr<SelfCert>& getWrappedCert() const {
+    return cert_;
+  }
+
+ private:
+  std::shared_ptr<SelfCert> cert_;
+  folly::Synchronized<std::shared_ptr<const SelfDelegatedCredential>>
+      credential_;
+};
+} // namespace fizz
@@ -10,6 +10,8 @@
 
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Factory.h>
+#include <fizz/protocol/HandshakeTiming.h>
+#include <fizz/protocol/Stats.h>
 #include <fizz/record/Types.h>
 #include <fizz/server/CertManager.h>
 #include <fizz/server/CookieCipher.h>
@@ -68,7 +70,21 @@ class FizzServerContext {
   }
 
   /**
-   * Set the supported signature schemes, in preference order.
+   * If enabled, a client that lists ChaCha20-Poly1305 first is given it
+   * whenever it is in any supported tier, regardless of tier order. Clients
+   * without AES hardware usually send this preference, and ChaCha20 is much
+   * cheaper for them than software AES-GCM. Default is false.
+   */
+  void setHonorClientChaChaPreference(bool enabled) {
+    honorClientChaChaPreference_ = enabled;
+  }
+  bool getHonorClientChaChaPreference() const {
+    return honorClientChaChaPreference_;
+  }
+
+  /**
+   * Set the supported signature schemes, in preference order. ed25519 is not
+   * offered by default.
    */
   void setSupportedSigSchemes(std::vector<SignatureScheme> schemes) {
     supportedSigSchemes_ = std::move(schemes);
@@ -97,6 +113,19 @@ class FizzServerContext {
     return supportedPskModes_;
   }
 
+  /**
+   * Set the supported certificate compression algorithms, in preference order.
+   * Compression is only used if the selected certificate has a precompressed
+   * form for the negotiated algorithm (see SelfCert::getCompressedCert).
+   */
+  void setSupportedCompressionAlgorithms(
+      std::vector<CertificateCompressionAlgorithm> algos) {
+    supportedCompressionAlgos_ = std::move(algos);
+  }
+  const auto& getSupportedCompressionAlgorithms() const {
+    return supportedCompressionAlgos_;
+  }
+
   /**
    * Set whether to request client authentication.
    */
@@ -273,6 +302,28 @@ class FizzServerContext {
     return sendNewSessionTicket_;
   }
 
+  /**
+   * Records the timing of every handshake using this context into stats.
+   * Unset by default, in which case no timing is recorded.
+   */
+  void setHandshakeTimingStats(std::shared_ptr<HandshakeTimingStats> stats) {
+    handshakeTimingStats_ = std::move(stats);
+  }
+  HandshakeTimingStats* getHandshakeTimingStats() const {
+    return handshakeTimingStats_.get();
+  }
+
+  /**
+   * Counts handshake outcomes of the connections using this context. Use a
+   * StatsFactory with the same stats to also count records.
+   */
+  void setStats(std::shared_ptr<FizzStats> stats) {
+    stats_ = std::move(stats);
+  }
+  FizzStats* getStats() const {
+    return stats_.get();
+  }
+
  private:
   std::unique_ptr<Factory> factory_;
 
@@ -293,6 +344,7 @@ class FizzServerContext {
       },
       {CipherSuite::TLS_AES_256_GCM_SHA384},
   };
+  bool honorClientChaChaPreference_{false};
   std::vector<SignatureScheme> supportedSigSchemes_ = {
       SignatureScheme::ecdsa_secp256r1_sha256,
       SignatureScheme::rsa_pss_sha256};
@@ -302,6 +354,7 @@ class FizzServerContext {
       PskKeyExchangeMode::psk_dhe_ke,
       PskKeyExchangeMode::psk_ke};
   std::vector<std::string> supportedAlpns_;
+  std::vector<CertificateCompressionAlgorithm> supportedCompressionAlgos_;
 
   bool versionFallbackEnabled_{false};
   ClientAuthMode clientAuthMode_{ClientAuthMode::None};
@@ -314,6 +367,9 @@ class FizzServerContext {
   bool earlyDataFbOnly_{false};
 
   bool sendNewSessionTicket_{true};
+
+  std::shared_ptr<HandshakeTimingStats> handshakeTimingStats_;
+  std::shared_ptr<FizzStats> stats_;
 };
 } // namespace server
 } // namespace fizz
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+namespace server {
+
+/**
+ * A single connection's handshake. Lives on the handshake EventBase and
+ * deletes itself once the result has been passed on.
+ */
+template <typename SM>
+class HandshakeWorkerPoolT<SM>::Handshake
+    : public Server::HandshakeCallback,
+      private folly::AsyncTimeout {
+ public:
+  Handshake(
+      typename Server::UniquePtr transport,
+      folly::EventBase* handshakeEventBase,
+      folly::EventBase* ioEventBase,
+      Callback* callback)
+      : folly::AsyncTimeout(handshakeEventBase),
+        transport_(std::move(transport)),
+        handshakeEventBase_(handshakeEventBase),
+        ioEventBase_(ioEventBase),
+        callback_(callback) {}
+
+  void start(std::chrono::milliseconds timeout) {
+    if (transport_->getEventBase() != handshakeEventBase_) {
+      transport_->attachEventBase(handshakeEventBase_);
+    }
+    if (timeout.count() > 0) {
+      scheduleTimeout(timeout);
+    }
+    transport_->accept(this);
+  }
+
+  void fizzHandshakeSuccess(Server*) noexcept override {
+    cancelTimeout();
+    migrating_ = true;
+    // The transport is still processing the action that reported success.
+    handshakeEventBase_->runInLoop([this]() { tryMigrate(); });
+  }
+
+  void fizzHandshakeError(Server*, folly::exception_wrapper ex) noexcept
+      override {
+    cancelTimeout();
+    auto callback = callback_;
+    runOnIoEventBase(
+        [callback, ex = std::move(ex)]() { callback->handshakeError(ex); });
+    transport_.reset();
+    delete this;
+  }
+
+  void fizzHandshakeAttemptFallback(
+      std::unique_ptr<folly::IOBuf> clientHello) override {
+    cancelTimeout();
+    migrating_ = true;
+    clientHello_ = std::move(clientHello);
+    handshakeEventBase_->runInLoop([this]() { tryMigrate(); });
+  }
+
+ private:
+  // Retry interval while the transport isn't detachable yet.
+  static constexpr std::chrono::milliseconds kMigrateRetry{1};
+
+  void timeoutExpired() noexcept override {
+    if (migrating_) {
+      tryMigrate();
+      return;
+    }
+    // Fails the handshake through fizzHandshakeError(), which deletes this.
+    transport_->closeNow();
+  }
+
+  void tryMigrate() {
+    if (handshakeEventBase_ != ioEventBase_) {
+      if (!transport_->isDetachable()) {
+        scheduleTimeout(kMigrateRetry);
+        return;
+      }
+      transport_->detachEventBase();
+    }
+    auto ioEventBase = ioEventBase_;
+    auto callback = callback_;
+    runOnIoEventBase([transport = std::move(transport_),
+                      clientHello = std::move(clientHello_),
+                      ioEventBase,
+                      callback,
+                      attach = handshakeEventBase_ != ioEventBase_]() mutable {
+      if (attach) {
+        transport->attachEventBase(ioEventBase);
+      }
+      if (clientHello) {
+        callback->handshakeAttemptFallback(
+            std::move(transport), std::move(clientHello));
+      } else {
+        callback->handshakeSuccess(std::move(transport));
+      }
+    });
+    delete this;
+  }
+
+  template <typename Func>
+  void runOnIoEventBase(Func&& func) {
+    if (handshakeEventBase_ == ioEventBase_) {
+      func();
+    } else {
+      ioEventBase_->runInEventBaseThread(std::forward<Func>(func));
+    }
+  }
+
+  typename Server::UniquePtr transport_;
+  folly::EventBase* handshakeEventBase_;
+  folly::EventBase* ioEventBase_;
+  Callback* callback_;
+  bool migrating_{false};
+  std::unique_ptr<folly::IOBuf> clientHello_;
+};
+
+template <typename SM>
+constexpr std::chrono::milliseconds
+    HandshakeWorkerPoolT<SM>::Handshake::kMigrateRetry;
+
+template <typename SM>
+HandshakeWorkerPoolT<SM>::HandshakeWorkerPoolT(
+    std::vector<folly::EventBase*> handshakeEventBases,
+    std::chrono::milliseconds handshakeTimeout)
+    : handshakeEventBases_(std::move(handshakeEventBases)),
+      handshakeTimeout_(handshakeTimeout) {}
+
+template <typename SM>
+folly::EventBase* HandshakeWorkerPoolT<SM>::nextHandshakeEventBase() {
+  auto index = next_.fetch_add(1, std::memory_order_relaxed);
+  return handshakeEventBases_[index % handshakeEventBases_.size()];
+}
+
+template <typename SM>
+void HandshakeWorkerPoolT<SM>::accept(
+    typename Server::UniquePtr transport,
+    folly::EventBase* ioEventBase,
+    Callback* callback) {
+  auto currentEventBase = transport->getEventBase();
+  if (!ioEventBase) {
+    ioEventBase = currentEventBase;
+  }
+
+  if (handshakeEventBases_.empty() || !transport->isDetachable()) {
+    auto handshake = new Handshake(
+        std::move(transport), currentEventBase, currentEventBase, callback);
+    handshake->start(handshakeTimeout_);
+    return;
+  }
+
+  auto handshakeEventBase = nextHandshakeEventBase();
+  transport->detachEventBase();
+  handshakeEventBase->runInEventBaseThread(
+      [transport = std::move(transport),
+       handshakeEventBase,
+       ioEventBase,
+       callback,
+       timeout = handshakeTimeout_]() mutable {
+        auto handshake = new Handshake(
+            std::move(transport), handshakeEventBase, ioEventBase, callback);
+        handshake->start(timeout);
+      });
+}
+} // namespace server
+} // namespace fizz
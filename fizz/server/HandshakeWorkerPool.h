@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/AsyncFizzServer.h>
+#include <folly/io/async/AsyncTimeout.h>
+
+#include <atomic>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Runs server handshakes on a dedicated set of EventBases and hands the
+ * connections over to an I/O EventBase once they are established, so that
+ * the signing, key exchange and certificate work of a burst of new
+ * connections doesn't delay the connections already carrying traffic.
+ *
+ * The transport is migrated with detachEventBase()/attachEventBase() once it
+ * is detachable, i.e. after the action that reported success has finished
+ * and the transport's writes have drained. Application data that arrives
+ * (or is decrypted as early data) before the application takes over is
+ * buffered by the transport and delivered once a read callback is set.
+ *
+ * Transports that can't be detached when handed to accept() (such as
+ * AsyncIoUringSocket) complete their handshake, and stay, on their current
+ * EventBase.
+ */
+template <typename SM>
+class HandshakeWorkerPoolT {
+ public:
+  using Server = AsyncFizzServerT<SM>;
+
+  /**
+   * Handshake results, all delivered on the connection's I/O EventBase.
+   */
+  class Callback {
+   public:
+    virtual ~Callback() = default;
+
+    /**
+     * The transport is attached to the I/O EventBase, without a read
+     * callback.
+     */
+    virtual void handshakeSuccess(
+        typename Server::UniquePtr transport) noexcept = 0;
+
+    virtual void handshakeError(folly::exception_wrapper ex) noexcept = 0;
+
+    /**
+     * See AsyncFizzServerT::HandshakeCallback::fizzHandshakeAttemptFallback.
+     */
+    virtual void handshakeAttemptFallback(
+        typename Server::UniquePtr transport,
+        std::unique_ptr<folly::IOBuf> clientHello) noexcept = 0;
+  };
+
+  /**
+   * The EventBases must outlive every handshake started on them. Handshakes
+   * taking longer than handshakeTimeout are failed.
+   */
+  explicit HandshakeWorkerPoolT(
+      std::vector<folly::EventBase*> handshakeEventBases,
+      std::chrono::milliseconds handshakeTimeout = std::chrono::seconds(5));
+
+  /**
+   * Starts the handshake of transport, which must not have been accepted
+   * yet, on one of the handshake EventBases. Must be called on the
+   * transport's EventBase. ioEventBase is where the connection lives
+   * afterwards; the transport's current EventBase if null.
+   */
+  void accept(
+      typename Server::UniquePtr transport,
+      folly::EventBase* ioEventBase,
+      Callback* callback);
+
+ private:
+  class Handshake;
+
+  folly::EventBase* nextHandshakeEventBase();
+
+  std::vector<folly::EventBase*> handshakeEventBases_;
+  std::chrono::milliseconds handshakeTimeout_;
+  std::atomic<size_t> next_{0};
+};
+
+using HandshakeWorkerPool = HandshakeWorkerPoolT<ServerStateMachine>;
+} // namespace server
+} // namespace fizz
+
+#include <fizz/server/HandshakeWorkerPool-inl.h>
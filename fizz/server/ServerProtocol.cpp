@@ -12,9 +12,12 @@
 #include <fizz/protocol/CertificateVerifier.h>
 #include <fizz/protocol/Protocol.h>
 #include <fizz/protocol/StateMachine.h>
+#include <fizz/protocol/Stats.h>
 #include <fizz/record/Extensions.h>
 #include <fizz/record/PlaintextRecordLayer.h>
 #include <fizz/server/AsyncSelfCert.h>
+#include <fizz/server/CipherPreference.h>
+#include <fizz/server/DelegatedCredentialSelfCert.h>
 #include <fizz/server/Negotiator.h>
 #include <fizz/server/ReplayCache.h>
 #include <folly/Overload.h>
@@ -212,6 +215,11 @@ Actions handleError(
   if (state.state() == StateEnum::Error) {
     return actions();
   }
+  if (state.context() && state.context()->getStats() &&
+      state.state() != StateEnum::AcceptingData &&
+      state.state() != StateEnum::Closed) {
+    state.context()->getStats()->recordHandshakeError(alertDesc);
+  }
   ReportError error(errorMsg);
   auto transition = [](State& newState) {
     newState.state() = StateEnum::Error;
@@ -278,18 +286,24 @@ EventHandler<ServerTypes, StateEnum::Uninitialized, Event::Accept>::handle(
   auto readRecordLayer = factory->makePlaintextReadRecordLayer();
   auto writeRecordLayer = factory->makePlaintextWriteRecordLayer();
   auto handshakeLogging = std::make_unique<HandshakeLogging>();
+  std::unique_ptr<HandshakeTiming> handshakeTiming;
+  if (accept.context->getHandshakeTimingStats()) {
+    handshakeTiming = std::make_unique<HandshakeTiming>();
+  }
   return actions(
       [executor = accept.executor,
        rrl = std::move(readRecordLayer),
        wrl = std::move(writeRecordLayer),
        context = std::move(accept.context),
        handshakeLogging = std::move(handshakeLogging),
+       handshakeTiming = std::move(handshakeTiming),
        extensions = accept.extensions](State& newState) mutable {
         newState.executor() = executor;
         newState.context() = std::move(context);
         newState.readRecordLayer() = std::move(rrl);
         newState.writeRecordLayer() = std::move(wrl);
         newState.handshakeLogging() = std::move(handshakeLogging);
+        newState.handshakeTiming() = std::move(handshakeTiming);
         newState.extensions() = std::move(extensions);
       },
       &Transition<StateEnum::ExpectingClientHello>);
@@ -434,7 +448,8 @@ struct ResumptionStateResult {
 static ResumptionStateResult getResumptionState(
     const ClientHello& chlo,
     const TicketCipher* ticketCipher,
-    const std::vector<PskKeyExchangeMode>& supportedModes) {
+    const std::vector<PskKeyExchangeMode>& supportedModes,
+    HandshakeTiming* timing) {
   auto psks = getExtension<ClientPresharedKey>(chlo.extensions);
   auto clientModes = getExtension<PskKeyExchangeModes>(chlo.extensions);
   if (psks && !clientModes) {
@@ -462,7 +477,10 @@ static ResumptionStateResult getResumptionState(
   } else {
     const auto& ident = psks->identities[kPskIndex].psk_identity;
     return ResumptionStateResult(
-        ticketCipher->decrypt(ident->clone()),
+        timeHandshakeStage(
+            timing,
+            HandshakeStage::TicketDecrypt,
+            [&] { return ticketCipher->decrypt(ident->clone()); }),
         pskMode,
         psks->identities[kPskIndex].obfuscated_ticket_age);
   }
@@ -471,13 +489,31 @@ static ResumptionStateResult getResumptionState(
 Future<ReplayCacheResult> getReplayCacheResult(
     const ClientHello& chlo,
     bool zeroRttEnabled,
-    ReplayCache* replayCache) {
+    ReplayCache* replayCache,
+    HandshakeTiming* timing) {
   if (!zeroRttEnabled || !replayCache ||
       !getExtension<ClientEarlyData>(chlo.extensions)) {
     return ReplayCacheResult::NotChecked;
   }
 
-  return replayCache->check(folly::range(chlo.random));
+  return timeHandshakeStage(
+      timing, HandshakeStage::ReplayCacheCheck, [&] {
+        return replayCache->check(folly::range(chlo.random));
+      });
+}
+
+static StatsCounter toStatsCounter(ReplayCacheResult result) {
+  switch (result) {
+    case ReplayCacheResult::NotChecked:
+      return StatsCounter::ReplayCacheNotChecked;
+    case ReplayCacheResult::NotReplay:
+      return StatsCounter::ReplayCacheNotReplay;
+    case ReplayCacheResult::MaybeReplay:
+      return StatsCounter::ReplayCacheMaybeReplay;
+    case ReplayCacheResult::DefinitelyReplay:
+      return StatsCounter::ReplayCacheDefinitelyReplay;
+  }
+  LOG(FATAL) << "unknown replay cache result";
 }
 
 static bool validateResumptionState(
@@ -500,7 +536,19 @@ static bool validateResumptionState(
 
 static CipherSuite negotiateCipher(
     const ClientHello& chlo,
-    const std::vector<std::vector<CipherSuite>>& supportedCiphers) {
+    const std::vector<std::vector<CipherSuite>>& supportedCiphers,
+    bool honorClientChaChaPreference) {
+  if (honorClientChaChaPreference &&
+      CipherPreference::clientPrefersChaCha(chlo.cipher_suites)) {
+    for (const auto& tier : supportedCiphers) {
+      if (std::find(
+              tier.begin(),
+              tier.end(),
+              CipherSuite::TLS_CHACHA20_POLY1305_SHA256) != tier.end()) {
+        return CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
+      }
+    }
+  }
   auto cipher = negotiate(supportedCiphers, chlo.cipher_suites);
   if (!cipher) {
     throw FizzException("no cipher match", AlertDescription::handshake_failure);
@@ -900,12 +948,102 @@ static std::pair<std::shared_ptr<SelfCert>, SignatureScheme> chooseCert(
   return *certAndScheme;
 }
 
-static Buf getCertificate(
+static Optional<CompressedCertificate> getCompressedCertificate(
+    const FizzServerContext& context,
+    const ClientHello& chlo,
+    const SelfCert& serverCert) {
+  if (context.getSupportedCompressionAlgorithms().empty()) {
+    return folly::none;
+  }
+  auto clientAlgos =
+      getExtension<CertificateCompressionAlgorithms>(chlo.extensions);
+  if (!clientAlgos) {
+    return folly::none;
+  }
+  if (clientAlgos->algorithms.empty()) {
+    throw FizzException(
+        "empty compress_certificate extension",
+        AlertDescription::decode_error);
+  }
+  for (const auto& algo : context.getSupportedCompressionAlgorithms()) {
+    if (std::find(
+            clientAlgos->algorithms.begin(),
+            clientAlgos->algorithms.end(),
+            algo) == clientAlgos->algorithms.end()) {
+      continue;
+    }
+    auto compressed = serverCert.getCompressedCert(algo);
+    if (compressed) {
+      return compressed;
+    }
+  }
+  return folly::none;
+}
+
+static std::shared_ptr<const SelfDelegatedCredential> getDelegatedCredential(
+    const ClientHello& chlo,
+    const SelfCert& serverCert) {
+  auto dcCert = dynamic_cast<const DelegatedCredentialSelfCert*>(&serverCert);
+  if (!dcCert) {
+    return nullptr;
+  }
+  auto support = getExtension<DelegatedCredentialSupport>(chlo.extensions);
+  if (!support) {
+    return nullptr;
+  }
+  auto credential = dcCert->getCredential();
+  if (!credential) {
+    return nullptr;
+  }
+  const auto& clientDcSchemes = support->supported_signature_algorithms;
+  if (std::find(
+          clientDcSchemes.begin(),
+          clientDcSchemes.end(),
+          credential->getSigScheme()) == clientDcSchemes.end()) {
+    return nullptr;
+  }
+  // The client also has to accept the certificate's signature on the
+  // credential.
+  auto clientSigSchemes = getExtension<SignatureAlgorithms>(chlo.extensions);
+  if (!clientSigSchemes) {
+    return nullptr;
+  }
+  const auto& sigSchemes = clientSigSchemes->supported_signature_algorithms;
+  if (std::find(
+          sigSchemes.begin(),
+          sigSchemes.end(),
+          credential->getCredential().credential_scheme) == sigSchemes.end()) {
+    return nullptr;
+  }
+  return credential;
+}
+
+static std::pair<Buf, Optional<CertificateCompressionAlgorithm>>
+getCertificate(
+    const FizzServerContext& context,
+    const ClientHello& chlo,
     const std::shared_ptr<const SelfCert>& serverCert,
+    const SelfDelegatedCredential* credential,
     HandshakeContext& handshakeContext) {
-  auto encodedCertificate = encodeHandshake(serverCert->getCertMessage());
+  Buf encodedCertificate;
+  Optional<CertificateCompressionAlgorithm> compressionAlgo;
+  if (credential) {
+    // Compressed certificates are precomputed without the credential, so
+    // they can't be used when sending one.
+    encodedCertificate = encodeHandshake(
+        dynamic_cast<const DelegatedCredentialSelfCert&>(*serverCert)
+            .getCertMessageWithCredential(*credential));
+  } else {
+    auto compressed = getCompressedCertificate(context, chlo, *serverCert);
+    if (compressed) {
+      compressionAlgo = compressed->algorithm;
+      encodedCertificate = encodeHandshake(std::move(*compressed));
+    } else {
+      encodedCertificate = encodeHandshake(serverCert->getCertMessage());
+    }
+  }
   handshakeContext.appendToTranscript(encodedCertificate);
-  return encodedCertificate;
+  return std::make_pair(std::move(encodedCertificate), compressionAlgo);
 }
 
 static Buf getCertificateVerify(
@@ -986,7 +1124,10 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
 
   validateClientHello(chlo);
 
-  auto cipher = negotiateCipher(chlo, state.context()->getSupportedCiphers());
+  auto cipher = negotiateCipher(
+      chlo,
+      state.context()->getSupportedCiphers(),
+      state.context()->getHonorClientChaChaPreference());
 
   auto cookieState = getCookieState(
       chlo, *version, cipher, state.context()->getCookieCipher());
@@ -994,12 +1135,14 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
   auto resStateResult = getResumptionState(
       chlo,
       state.context()->getTicketCipher(),
-      state.context()->getSupportedPskModes());
+      state.context()->getSupportedPskModes(),
+      state.handshakeTiming());
 
   auto replayCacheResultFuture = getReplayCacheResult(
       chlo,
       state.context()->getAcceptEarlyData(*version),
-      state.context()->getReplayCache());
+      state.context()->getReplayCache(),
+      state.handshakeTiming());
 
   auto results =
       collectAll(resStateResult.futureResState, replayCacheResultFuture);
@@ -1021,6 +1164,14 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
         auto resState = std::move(resumption.second);
         auto replayCacheResult = *std::get<1>(result);
 
+        if (auto stats = state.context()->getStats()) {
+          // The PSK mode is only set once the ticket was given to the cipher.
+          if (pskType == PskType::Rejected && pskMode) {
+            stats->increment(StatsCounter::TicketDecryptFailure);
+          }
+          stats->increment(toStatsCounter(replayCacheResult));
+        }
+
         if (resState) {
           if (!validateResumptionState(*resState, *pskMode, version, cipher)) {
             pskType = PskType::Rejected;
@@ -1138,6 +1289,10 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
             write.data = state.writeRecordLayer()->writeHandshake(
                 std::move(encodedHelloRetryRequest));
 
+            if (auto stats = state.context()->getStats()) {
+              stats->increment(StatsCounter::HelloRetryRequest);
+            }
+
             if (legacySessionId && !legacySessionId->empty()) {
               write.data->prependChain(
                   folly::IOBuf::wrapBuffer(FakeChangeCipherSpec));
@@ -1182,8 +1337,14 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
             keyExchangeType = KeyExchangeType::OneRtt;
           }
 
-          serverShare = doKex(
-              *state.context()->getFactory(), *group, *clientShare, *scheduler);
+          serverShare = timeHandshakeStage(
+              state.handshakeTiming(), HandshakeStage::KeyExchange, [&] {
+                return doKex(
+                    *state.context()->getFactory(),
+                    *group,
+                    *clientShare,
+                    *scheduler);
+              });
         } else {
           keyExchangeType = KeyExchangeType::None;
           scheduler->deriveHandshakeSecret();
@@ -1278,32 +1439,52 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
          * transcript.
          */
         Optional<Buf> encodedCertificate;
+        Optional<CertificateCompressionAlgorithm> certCompressionAlgo;
         Future<Optional<Buf>> signature = folly::none;
         Optional<SignatureScheme> sigScheme;
         Optional<std::shared_ptr<const Cert>> serverCert;
         std::shared_ptr<const Cert> clientCert;
         if (!resState) { // TODO or reauth
           std::shared_ptr<const SelfCert> originalSelfCert;
-          std::tie(originalSelfCert, sigScheme) =
-              chooseCert(*state.context(), chlo);
+          std::tie(originalSelfCert, sigScheme) = timeHandshakeStage(
+              state.handshakeTiming(), HandshakeStage::CertSelection, [&] {
+                return chooseCert(*state.context(), chlo);
+              });
 
-          encodedCertificate =
-              getCertificate(originalSelfCert, *handshakeContext);
+          auto credential = getDelegatedCredential(chlo, *originalSelfCert);
+          std::tie(encodedCertificate, certCompressionAlgo) = getCertificate(
+              *state.context(),
+              chlo,
+              originalSelfCert,
+              credential.get(),
+              *handshakeContext);
 
           auto toBeSigned = handshakeContext->getHandshakeContext();
           auto asyncSelfCert =
               dynamic_cast<const AsyncSelfCert*>(originalSelfCert.get());
-          if (asyncSelfCert) {
-            signature = asyncSelfCert->signFuture(
-                *sigScheme,
-                CertificateVerifyContext::Server,
-                toBeSigned->coalesce());
-          } else {
-            signature = originalSelfCert->sign(
-                *sigScheme,
-                CertificateVerifyContext::Server,
-                toBeSigned->coalesce());
+          if (credential) {
+            sigScheme = credential->getSigScheme();
           }
+          signature = timeHandshakeStage(
+              state.handshakeTiming(),
+              HandshakeStage::Signing,
+              [&]() -> Future<Optional<Buf>> {
+                if (credential) {
+                  return credential->sign(
+                      CertificateVerifyContext::Server,
+                      toBeSigned->coalesce());
+                } else if (asyncSelfCert) {
+                  return asyncSelfCert->signFuture(
+                      *sigScheme,
+                      CertificateVerifyContext::Server,
+                      toBeSigned->coalesce());
+                } else {
+                  return originalSelfCert->sign(
+                      *sigScheme,
+                      CertificateVerifyContext::Server,
+                      toBeSigned->coalesce());
+                }
+              });
           serverCert = std::move(originalSelfCert);
         } else {
           serverCert = std::move(resState->serverCert);
@@ -1332,6 +1513,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                    pskType,
                    pskMode,
                    sigScheme,
+                   certCompressionAlgo,
                    version,
                    keyExchangeType,
                    earlyDataType,
@@ -1435,6 +1617,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                                 cipher,
                                 group,
                                 sigScheme,
+                                certCompressionAlgo,
                                 clientHandshakeSecret =
                                     std::move(clientHandshakeSecret),
                                 pskType,
@@ -1456,6 +1639,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
                 newState.cipher() = cipher;
                 newState.group() = group;
                 newState.sigScheme() = sigScheme;
+                newState.serverCertCompAlgo() = certCompressionAlgo;
                 newState.clientHandshakeSecret() =
                     std::move(clientHandshakeSecret);
                 newState.pskType() = pskType;
@@ -1620,7 +1804,10 @@ static Future<Optional<WriteToSocket>> generateTicket(
   resState.ticketIssueTime = std::chrono::system_clock::now();
   resState.appToken = std::move(appToken);
 
-  auto ticketFuture = ticketCipher->encrypt(std::move(resState));
+  auto ticketFuture = timeHandshakeStage(
+      state.handshakeTiming(), HandshakeStage::NewSessionTicket, [&] {
+        return ticketCipher->encrypt(std::move(resState));
+      });
   return ticketFuture.via(state.executor())
       .then(
           [&state,
@@ -1779,6 +1966,14 @@ EventHandler<ServerTypes, StateEnum::ExpectingFinished, Event::Finished>::
     newState.resumptionMasterSecret() = std::move(resumptionMasterSecret);
   };
 
+  if (auto stats = state.context()->getStats()) {
+    stats->recordHandshakeSuccess(
+        *state.cipher(),
+        state.group(),
+        *state.pskType(),
+        state.earlyDataType().value_or(EarlyDataType::NotAttempted));
+  }
+
   if (!state.context()->getSendNewSessionTicket()) {
     return actions(
         std::move(saveState),
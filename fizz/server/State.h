@@ -11,6 +11,7 @@
 #include <folly/futures/Future.h>
 
 #include <fizz/protocol/Certificate.h>
+#include <fizz/protocol/HandshakeTiming.h>
 #include <fizz/protocol/KeyScheduler.h>
 #include <fizz/protocol/Types.h>
 #include <fizz/record/Extensions.h>
@@ -126,6 +127,14 @@ class State {
     return sigScheme_;
   }
 
+  /**
+   * The algorithm the server certificate was compressed with, if it was sent
+   * compressed.
+   */
+  folly::Optional<CertificateCompressionAlgorithm> serverCertCompAlgo() const {
+    return serverCertCompAlgo_;
+  }
+
   /**
    * Psk handshake flow used on this connection (psk not sent, psk rejected, psk
    * accepted, etc.).
@@ -194,6 +203,14 @@ class State {
     return handshakeLogging_.get();
   }
 
+  /**
+   * Timing of the handshake. Only present if the context has handshake timing
+   * stats set.
+   */
+  HandshakeTiming* handshakeTiming() const {
+    return handshakeTiming_.get();
+  }
+
   /**
    * Key scheduler used on this connection.
    *
@@ -322,6 +339,9 @@ class State {
   auto& sigScheme() {
     return sigScheme_;
   }
+  auto& serverCertCompAlgo() {
+    return serverCertCompAlgo_;
+  }
   auto& pskType() {
     return pskType_;
   }
@@ -352,6 +372,9 @@ class State {
   auto& handshakeLogging() {
     return handshakeLogging_;
   }
+  auto& handshakeTiming() {
+    return handshakeTiming_;
+  }
   auto& extensions() {
     return extensions_;
   }
@@ -391,6 +414,7 @@ class State {
   folly::Optional<CipherSuite> cipher_;
   folly::Optional<NamedGroup> group_;
   folly::Optional<SignatureScheme> sigScheme_;
+  folly::Optional<CertificateCompressionAlgorithm> serverCertCompAlgo_;
   folly::Optional<PskType> pskType_;
   folly::Optional<PskKeyExchangeMode> pskMode_;
   folly::Optional<KeyExchangeType> keyExchangeType_;
@@ -404,6 +428,7 @@ class State {
   std::vector<uint8_t> resumptionMasterSecret_;
 
   std::unique_ptr<HandshakeLogging> handshakeLogging_;
+  std::unique_ptr<HandshakeTiming> handshakeTiming_;
 
   folly::Optional<Buf> earlyExporterMasterSecret_;
   folly::Optional<Buf> exporterMasterSecret_;
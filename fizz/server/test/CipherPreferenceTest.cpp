@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/server/CipherPreference.h>
+
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+using std::chrono::nanoseconds;
+
+TEST(CipherPreferenceTest, TestTiersSimilarCost) {
+  auto tiers = CipherPreference::makeTiers(
+      {{CipherSuite::TLS_AES_256_GCM_SHA384, nanoseconds(120)},
+       {CipherSuite::TLS_AES_128_GCM_SHA256, nanoseconds(100)},
+       {CipherSuite::TLS_CHACHA20_POLY1305_SHA256, nanoseconds(400)}});
+  std::vector<std::vector<CipherSuite>> expected = {
+      {CipherSuite::TLS_AES_128_GCM_SHA256,
+       CipherSuite::TLS_AES_256_GCM_SHA384},
+      {CipherSuite::TLS_CHACHA20_POLY1305_SHA256}};
+  EXPECT_EQ(tiers, expected);
+}
+
+TEST(CipherPreferenceTest, TestTiersNoAesHardware) {
+  auto tiers = CipherPreference::makeTiers(
+      {{CipherSuite::TLS_AES_128_GCM_SHA256, nanoseconds(900)},
+       {CipherSuite::TLS_AES_256_GCM_SHA384, nanoseconds(1200)},
+       {CipherSuite::TLS_CHACHA20_POLY1305_SHA256, nanoseconds(300)}});
+  std::vector<std::vector<CipherSuite>> expected = {
+      {CipherSuite::TLS_CHACHA20_POLY1305_SHA256},
+      {CipherSuite::TLS_AES_128_GCM_SHA256,
+       CipherSuite::TLS_AES_256_GCM_SHA384}};
+  EXPECT_EQ(tiers, expected);
+}
+
+TEST(CipherPreferenceTest, TestTiersTolerance) {
+  std::vector<CipherPreference::CipherCost> costs = {
+      {CipherSuite::TLS_AES_128_GCM_SHA256, nanoseconds(100)},
+      {CipherSuite::TLS_CHACHA20_POLY1305_SHA256, nanoseconds(180)}};
+  EXPECT_EQ(CipherPreference::makeTiers(costs, 2.0).size(), 1u);
+  EXPECT_EQ(CipherPreference::makeTiers(costs, 1.0).size(), 2u);
+}
+
+TEST(CipherPreferenceTest, TestTiersEmpty) {
+  EXPECT_TRUE(CipherPreference::makeTiers({}).empty());
+}
+
+TEST(CipherPreferenceTest, TestMeasure) {
+  Factory factory;
+  auto costs = CipherPreference::measure(
+      factory,
+      {CipherSuite::TLS_AES_128_GCM_SHA256,
+       CipherSuite::TLS_AES_256_GCM_SHA384},
+      1024,
+      4);
+  ASSERT_EQ(costs.size(), 2u);
+  EXPECT_EQ(costs[0].cipher, CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_EQ(costs[1].cipher, CipherSuite::TLS_AES_256_GCM_SHA384);
+}
+
+TEST(CipherPreferenceTest, TestMeasureSkipsUnsupported) {
+  Factory factory;
+  auto costs = CipherPreference::measure(
+      factory, {static_cast<CipherSuite>(0x1399)}, 1024, 4);
+  EXPECT_TRUE(costs.empty());
+}
+
+TEST(CipherPreferenceTest, TestMeasuredTiers) {
+  Factory factory;
+  auto tiers = CipherPreference::getMeasuredTiers(factory);
+  size_t count = 0;
+  for (const auto& tier : tiers) {
+    EXPECT_FALSE(tier.empty());
+    count += tier.size();
+  }
+#if FOLLY_OPENSSL_IS_110
+  EXPECT_EQ(count, 3u);
+#else
+  EXPECT_EQ(count, 2u);
+#endif
+}
+
+TEST(CipherPreferenceTest, TestClientPrefersChaCha) {
+  EXPECT_TRUE(CipherPreference::clientPrefersChaCha(
+      {CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+       CipherSuite::TLS_AES_128_GCM_SHA256}));
+  EXPECT_FALSE(CipherPreference::clientPrefersChaCha(
+      {CipherSuite::TLS_AES_128_GCM_SHA256,
+       CipherSuite::TLS_CHACHA20_POLY1305_SHA256}));
+  EXPECT_FALSE(CipherPreference::clientPrefersChaCha({}));
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
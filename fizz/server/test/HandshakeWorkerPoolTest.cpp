@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fizz/server/HandshakeWorkerPool.h>
+
+#include <fizz/server/test/Mocks.h>
+#include <folly/io/async/test/MockAsyncTransport.h>
+
+namespace fizz {
+namespace server {
+namespace test {
+
+using namespace folly;
+using namespace folly::test;
+using namespace testing;
+
+template <typename... Args>
+AsyncActions actions(Args&&... act) {
+  return fizz::server::detail::actions(std::forward<Args>(act)...);
+}
+
+class MockPoolStateMachineInstance : public MockServerStateMachine {
+ public:
+  MockPoolStateMachineInstance() {
+    instance = this;
+  }
+  static MockPoolStateMachineInstance* instance;
+};
+MockPoolStateMachineInstance* MockPoolStateMachineInstance::instance;
+
+using TestPool = HandshakeWorkerPoolT<MockPoolStateMachineInstance>;
+using TestServer = AsyncFizzServerT<MockPoolStateMachineInstance>;
+
+class RecordingCallback : public TestPool::Callback {
+ public:
+  void handshakeSuccess(TestServer::UniquePtr transport) noexcept override {
+    eventBase = transport->getEventBase();
+    server = std::move(transport);
+  }
+
+  void handshakeError(folly::exception_wrapper) noexcept override {
+    ++errors;
+  }
+
+  void handshakeAttemptFallback(
+      TestServer::UniquePtr transport,
+      std::unique_ptr<IOBuf> hello) noexcept override {
+    server = std::move(transport);
+    clientHello = std::move(hello);
+  }
+
+  TestServer::UniquePtr server;
+  EventBase* eventBase{nullptr};
+  std::unique_ptr<IOBuf> clientHello;
+  size_t errors{0};
+};
+
+class HandshakeWorkerPoolTest : public Test {
+ public:
+  void SetUp() override {
+    context_ = std::make_shared<FizzServerContext>();
+    socket_ = new NiceMock<MockAsyncTransport>();
+    auto transport = AsyncTransportWrapper::UniquePtr(socket_);
+    server_.reset(new TestServer(std::move(transport), context_));
+    machine_ = MockPoolStateMachineInstance::instance;
+
+    socketEventBase_ = &acceptEvb_;
+    ON_CALL(*socket_, good()).WillByDefault(Return(true));
+    ON_CALL(*socket_, isDetachable()).WillByDefault(Return(true));
+    ON_CALL(*socket_, getEventBase()).WillByDefault(Invoke([this]() {
+      return socketEventBase_;
+    }));
+    ON_CALL(*socket_, attachEventBase(_))
+        .WillByDefault(SaveArg<0>(&socketEventBase_));
+    ON_CALL(*socket_, detachEventBase()).WillByDefault(Invoke([this]() {
+      socketEventBase_ = nullptr;
+    }));
+    ON_CALL(*socket_, setReadCB(_))
+        .WillByDefault(SaveArg<0>(&socketReadCallback_));
+    ON_CALL(*socket_, getReadCallback()).WillByDefault(Invoke([this]() {
+      return socketReadCallback_;
+    }));
+  }
+
+ protected:
+  void accept(TestPool& pool) {
+    EXPECT_CALL(*machine_, _processAccept(_, _, _, _))
+        .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
+    pool.accept(std::move(server_), &ioEvb_, &callback_);
+  }
+
+  void receiveClientHello(AsyncActions result) {
+    auto shared = std::make_shared<AsyncActions>(std::move(result));
+    EXPECT_CALL(*machine_, _processSocketData(_, _))
+        .WillOnce(InvokeWithoutArgs([shared]() { return std::move(*shared); }));
+    socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
+  }
+
+  void loopAll() {
+    handshakeEvb_.loopOnce(EVLOOP_NONBLOCK);
+    ioEvb_.loopOnce(EVLOOP_NONBLOCK);
+  }
+
+  std::shared_ptr<FizzServerContext> context_;
+  MockAsyncTransport* socket_;
+  TestServer::UniquePtr server_;
+  MockPoolStateMachineInstance* machine_;
+  AsyncTransportWrapper::ReadCallback* socketReadCallback_{nullptr};
+  EventBase* socketEventBase_;
+  EventBase acceptEvb_;
+  EventBase handshakeEvb_;
+  EventBase ioEvb_;
+  RecordingCallback callback_;
+};
+
+TEST_F(HandshakeWorkerPoolTest, TestMigrateAfterHandshake) {
+  TestPool pool({&handshakeEvb_});
+  accept(pool);
+  EXPECT_EQ(socketEventBase_, nullptr);
+
+  handshakeEvb_.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(socketEventBase_, &handshakeEvb_);
+  ASSERT_NE(socketReadCallback_, nullptr);
+
+  receiveClientHello(actions(ReportHandshakeSuccess(), WaitForData()));
+  EXPECT_FALSE(callback_.server);
+
+  loopAll();
+  ASSERT_TRUE(callback_.server);
+  EXPECT_EQ(callback_.eventBase, &ioEvb_);
+  EXPECT_EQ(socketEventBase_, &ioEvb_);
+  EXPECT_EQ(callback_.errors, 0u);
+}
+
+TEST_F(HandshakeWorkerPoolTest, TestMigrateWaitsUntilDetachable) {
+  TestPool pool({&handshakeEvb_});
+  accept(pool);
+  handshakeEvb_.loopOnce(EVLOOP_NONBLOCK);
+
+  // E.g. the session ticket write is still pending.
+  ON_CALL(*socket_, isDetachable()).WillByDefault(Return(false));
+  receiveClientHello(actions(ReportHandshakeSuccess(), WaitForData()));
+  for (size_t i = 0; i < 5; ++i) {
+    loopAll();
+  }
+  EXPECT_FALSE(callback_.server);
+  EXPECT_EQ(socketEventBase_, &handshakeEvb_);
+
+  ON_CALL(*socket_, isDetachable()).WillByDefault(Return(true));
+  handshakeEvb_.loopOnce();
+  ioEvb_.loopOnce(EVLOOP_NONBLOCK);
+  ASSERT_TRUE(callback_.server);
+  EXPECT_EQ(socketEventBase_, &ioEvb_);
+}
+
+TEST_F(HandshakeWorkerPoolTest, TestHandshakeError) {
+  TestPool pool({&handshakeEvb_});
+  accept(pool);
+  handshakeEvb_.loopOnce(EVLOOP_NONBLOCK);
+
+  receiveClientHello(actions(ReportError("unit test"), WaitForData()));
+  EXPECT_EQ(callback_.errors, 0u);
+  ioEvb_.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(callback_.errors, 1u);
+  EXPECT_FALSE(callback_.server);
+}
+
+TEST_F(HandshakeWorkerPoolTest, TestHandshakeTimeout) {
+  TestPool pool({&handshakeEvb_}, std::chrono::milliseconds(1));
+  ON_CALL(*socket_, good()).WillByDefault(Return(false));
+  accept(pool);
+  handshakeEvb_.loop();
+  ioEvb_.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(callback_.errors, 1u);
+  EXPECT_FALSE(callback_.server);
+}
+
+TEST_F(HandshakeWorkerPoolTest, TestFallback) {
+  TestPool pool({&handshakeEvb_});
+  accept(pool);
+  handshakeEvb_.loopOnce(EVLOOP_NONBLOCK);
+
+  AttemptVersionFallback fallback;
+  fallback.clientHello = IOBuf::copyBuffer("TLS 1.2 ClientHello");
+  receiveClientHello(actions(std::move(fallback)));
+  loopAll();
+  ASSERT_TRUE(callback_.server);
+  ASSERT_TRUE(callback_.clientHello);
+  EXPECT_EQ(socketEventBase_, &ioEvb_);
+}
+
+TEST_F(HandshakeWorkerPoolTest, TestNotDetachable) {
+  TestPool pool({&handshakeEvb_});
+  ON_CALL(*socket_, isDetachable()).WillByDefault(Return(false));
+  EXPECT_CALL(*socket_, detachEventBase()).Times(0);
+  accept(pool);
+  EXPECT_EQ(socketEventBase_, &acceptEvb_);
+
+  receiveClientHello(actions(ReportHandshakeSuccess(), WaitForData()));
+  acceptEvb_.loopOnce(EVLOOP_NONBLOCK);
+  ASSERT_TRUE(callback_.server);
+  EXPECT_EQ(callback_.eventBase, &acceptEvb_);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
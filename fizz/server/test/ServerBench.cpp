@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Per-handshake server work outside of the key schedule: token encryption,
+ * ticket encoding, and certificate selection as the number of certificates
+ * grows.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/test/Utilities.h>
+#include <fizz/server/AeadTokenCipher.h>
+#include <fizz/server/CertManager.h>
+#include <fizz/server/FizzServerContext.h>
+#include <fizz/server/TicketCodec.h>
+
+#include <map>
+
+using namespace fizz;
+using namespace fizz::server;
+
+namespace {
+
+std::unique_ptr<folly::IOBuf> makeBuf(size_t n) {
+  auto buf = folly::IOBuf::create(n);
+  memset(buf->writableData(), 'x', n);
+  buf->append(n);
+  return buf;
+}
+
+using TokenCipher =
+    AeadTokenCipher<OpenSSLEVPCipher<AESGCM128>, HkdfImpl<Sha256>>;
+
+std::unique_ptr<TokenCipher> makeTokenCipher() {
+  auto cipher = std::make_unique<TokenCipher>(
+      std::vector<std::string>({"Fizz Bench Token"}));
+  auto secret = makeBuf(TokenCipher::kMinTokenSecretLength);
+  CHECK(cipher->setSecrets({secret->coalesce()}));
+  return cipher;
+}
+
+void tokenEncrypt(uint32_t n, size_t size) {
+  std::unique_ptr<TokenCipher> cipher;
+  std::vector<Buf> plaintexts;
+  BENCHMARK_SUSPEND {
+    cipher = makeTokenCipher();
+    for (uint32_t i = 0; i < n; ++i) {
+      plaintexts.push_back(makeBuf(size));
+    }
+  }
+  folly::Optional<Buf> token;
+  for (auto& plaintext : plaintexts) {
+    token = cipher->encrypt(std::move(plaintext));
+  }
+  folly::doNotOptimizeAway(token);
+}
+
+void tokenDecrypt(uint32_t n, size_t size) {
+  std::unique_ptr<TokenCipher> cipher;
+  std::vector<Buf> tokens;
+  BENCHMARK_SUSPEND {
+    cipher = makeTokenCipher();
+    auto token = cipher->encrypt(makeBuf(size));
+    for (uint32_t i = 0; i < n; ++i) {
+      tokens.push_back((*token)->clone());
+    }
+  }
+  folly::Optional<Buf> plaintext;
+  for (auto& token : tokens) {
+    plaintext = cipher->decrypt(std::move(token));
+  }
+  folly::doNotOptimizeAway(plaintext);
+}
+
+/**
+ * Server context whose cert manager knows the certificate tickets refer to,
+ * as TicketCodec::decode looks it up.
+ */
+struct TicketSetup {
+  TicketSetup() {
+    auto certData = fizz::test::createCert("fizz-bench", false, nullptr);
+    std::vector<folly::ssl::X509UniquePtr> certChain;
+    certChain.push_back(std::move(certData.cert));
+    serverCert = std::make_shared<SelfCertImpl<KeyType::P256>>(
+        std::move(certData.key), std::move(certChain));
+    auto certManager = std::make_unique<CertManager>();
+    certManager->addCert(serverCert, true);
+    context.setCertManager(std::move(certManager));
+    clientCert = CertUtils::makePeerCert(
+        fizz::test::getCertData(fizz::test::kP256Certificate));
+  }
+
+  ResumptionState makeState(size_t appTokenSize, bool withClientCert) const {
+    ResumptionState state;
+    state.version = ProtocolVersion::tls_1_3;
+    state.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+    state.resumptionSecret = makeBuf(32);
+    state.serverCert = serverCert;
+    if (withClientCert) {
+      state.clientCert = clientCert;
+    }
+    state.ticketAgeAdd = 0x44444444;
+    state.ticketIssueTime = std::chrono::system_clock::now();
+    state.alpn = "h2";
+    if (appTokenSize > 0) {
+      state.appToken = makeBuf(appTokenSize);
+    }
+    return state;
+  }
+
+  FizzServerContext context;
+  std::shared_ptr<SelfCert> serverCert;
+  std::shared_ptr<const Cert> clientCert;
+};
+
+const TicketSetup& getTicketSetup() {
+  static TicketSetup setup;
+  return setup;
+}
+
+using Codec = TicketCodec<CertificateStorage::X509>;
+
+void ticketEncode(uint32_t n, size_t appTokenSize, bool withClientCert) {
+  std::vector<ResumptionState> states;
+  BENCHMARK_SUSPEND {
+    const auto& setup = getTicketSetup();
+    for (uint32_t i = 0; i < n; ++i) {
+      states.push_back(setup.makeState(appTokenSize, withClientCert));
+    }
+  }
+  Buf encoded;
+  for (auto& state : states) {
+    encoded = Codec::encode(std::move(state));
+  }
+  folly::doNotOptimizeAway(encoded);
+}
+
+void ticketDecode(uint32_t n, size_t appTokenSize, bool withClientCert) {
+  const TicketSetup* setup;
+  std::vector<Buf> tickets;
+  BENCHMARK_SUSPEND {
+    setup = &getTicketSetup();
+    auto encoded =
+        Codec::encode(setup->makeState(appTokenSize, withClientCert));
+    for (uint32_t i = 0; i < n; ++i) {
+      tickets.push_back(encoded->clone());
+    }
+  }
+  ResumptionState state;
+  for (auto& ticket : tickets) {
+    state = Codec::decode(std::move(ticket), &setup->context);
+  }
+  folly::doNotOptimizeAway(state);
+}
+
+const std::vector<SignatureScheme> kSigSchemes{
+    SignatureScheme::ecdsa_secp256r1_sha256};
+
+std::string certName(size_t i) {
+  return folly::to<std::string>("host", i, ".fizz.test");
+}
+
+const CertManager& getCertManager(size_t certs) {
+  static std::map<size_t, std::unique_ptr<CertManager>> managers;
+  auto& manager = managers[certs];
+  if (!manager) {
+    manager = std::make_unique<CertManager>();
+    for (size_t i = 0; i < certs; ++i) {
+      auto certData = fizz::test::createCert(certName(i), false, nullptr);
+      std::vector<folly::ssl::X509UniquePtr> certChain;
+      certChain.push_back(std::move(certData.cert));
+      manager->addCert(
+          std::make_shared<SelfCertImpl<KeyType::P256>>(
+              std::move(certData.key), std::move(certChain)),
+          i == 0);
+    }
+  }
+  return *manager;
+}
+
+void getCertBySni(uint32_t n, size_t certs) {
+  const CertManager* manager;
+  std::vector<folly::Optional<std::string>> snis;
+  BENCHMARK_SUSPEND {
+    manager = &getCertManager(certs);
+    for (uint32_t i = 0; i < n; ++i) {
+      snis.emplace_back(certName(i % certs));
+    }
+  }
+  CertManager::CertMatch match;
+  for (const auto& sni : snis) {
+    match = manager->getCert(sni, kSigSchemes, kSigSchemes);
+  }
+  folly::doNotOptimizeAway(match);
+}
+
+void getCertDefault(uint32_t n, size_t certs) {
+  const CertManager* manager;
+  folly::Optional<std::string> sni;
+  BENCHMARK_SUSPEND {
+    manager = &getCertManager(certs);
+    sni = std::string("unknown.fizz.test");
+  }
+  CertManager::CertMatch match;
+  for (uint32_t i = 0; i < n; ++i) {
+    match = manager->getCert(sni, kSigSchemes, kSigSchemes);
+  }
+  folly::doNotOptimizeAway(match);
+}
+} // namespace
+
+BENCHMARK_PARAM(tokenEncrypt, 32);
+BENCHMARK_PARAM(tokenEncrypt, 256);
+BENCHMARK_PARAM(tokenEncrypt, 1024);
+BENCHMARK_PARAM(tokenEncrypt, 4096);
+BENCHMARK_PARAM(tokenDecrypt, 32);
+BENCHMARK_PARAM(tokenDecrypt, 256);
+BENCHMARK_PARAM(tokenDecrypt, 1024);
+BENCHMARK_PARAM(tokenDecrypt, 4096);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(ticketEncode, appToken0, 0, false);
+BENCHMARK_NAMED_PARAM(ticketEncode, appToken256, 256, false);
+BENCHMARK_NAMED_PARAM(ticketEncode, appToken4096, 4096, false);
+BENCHMARK_NAMED_PARAM(ticketEncode, clientCert, 0, true);
+BENCHMARK_NAMED_PARAM(ticketDecode, appToken0, 0, false);
+BENCHMARK_NAMED_PARAM(ticketDecode, appToken256, 256, false);
+BENCHMARK_NAMED_PARAM(ticketDecode, appToken4096, 4096, false);
+BENCHMARK_NAMED_PARAM(ticketDecode, clientCert, 0, true);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(getCertBySni, 1);
+BENCHMARK_PARAM(getCertBySni, 10);
+BENCHMARK_PARAM(getCertBySni, 100);
+BENCHMARK_PARAM(getCertBySni, 1000);
+BENCHMARK_PARAM(getCertBySni, 10000);
+BENCHMARK_PARAM(getCertDefault, 1);
+BENCHMARK_PARAM(getCertDefault, 10);
+BENCHMARK_PARAM(getCertDefault, 100);
+BENCHMARK_PARAM(getCertDefault, 1000);
+BENCHMARK_PARAM(getCertDefault, 10000);
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  return 0;
+}
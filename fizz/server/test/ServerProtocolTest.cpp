@@ -2160,6 +2160,41 @@ TEST_F(ServerProtocolTest, TestClientHelloCipherMismatch) {
   expectError(actions, AlertDescription::handshake_failure, "no cipher match");
 }
 
+TEST_F(ServerProtocolTest, TestClientHelloChaChaPreference) {
+  setUpExpectingClientHello();
+  context_->setSupportedCiphers(
+      {{CipherSuite::TLS_AES_128_GCM_SHA256},
+       {CipherSuite::TLS_CHACHA20_POLY1305_SHA256}});
+  context_->setHonorClientChaChaPreference(true);
+  auto clientHello = TestMessages::clientHello();
+  clientHello.cipher_suites.insert(
+      clientHello.cipher_suites.begin(),
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256);
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(clientHello)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+  EXPECT_EQ(state_.cipher(), CipherSuite::TLS_CHACHA20_POLY1305_SHA256);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloChaChaPreferenceDisabled) {
+  setUpExpectingClientHello();
+  context_->setSupportedCiphers(
+      {{CipherSuite::TLS_AES_128_GCM_SHA256},
+       {CipherSuite::TLS_CHACHA20_POLY1305_SHA256}});
+  auto clientHello = TestMessages::clientHello();
+  clientHello.cipher_suites.insert(
+      clientHello.cipher_suites.begin(),
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256);
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(clientHello)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+  EXPECT_EQ(state_.cipher(), CipherSuite::TLS_AES_128_GCM_SHA256);
+}
+
 TEST_F(ServerProtocolTest, TestClientHelloNoSupportedGroups) {
   setUpExpectingClientHello();
   auto clientHello = TestMessages::clientHello();
@@ -2237,6 +2272,48 @@ TEST_F(ServerProtocolTest, TestClientHelloAlpnMismatch) {
   EXPECT_FALSE(state_.alpn().hasValue());
 }
 
+TEST_F(ServerProtocolTest, TestClientHelloCompressedCertificate) {
+  context_->setSupportedCompressionAlgorithms(
+      {CertificateCompressionAlgorithm::zlib});
+  setUpExpectingClientHello();
+  auto chlo = TestMessages::clientHello();
+  CertificateCompressionAlgorithms algos;
+  algos.algorithms = {CertificateCompressionAlgorithm::zlib};
+  chlo.extensions.push_back(encodeExtension(std::move(algos)));
+  EXPECT_CALL(
+      *cert_, getCompressedCert(CertificateCompressionAlgorithm::zlib))
+      .WillOnce(Invoke([](CertificateCompressionAlgorithm algo) {
+        CompressedCertificate compressed;
+        compressed.algorithm = algo;
+        compressed.uncompressed_length = 0x111111;
+        compressed.compressed_certificate_message =
+            IOBuf::copyBuffer("compressedcerts");
+        return folly::Optional<CompressedCertificate>(std::move(compressed));
+      }));
+  EXPECT_CALL(*cert_, _getCertMessage(_)).Times(0);
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(
+      *state_.serverCertCompAlgo(), CertificateCompressionAlgorithm::zlib);
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloCompressedCertificateMismatch) {
+  context_->setSupportedCompressionAlgorithms(
+      {CertificateCompressionAlgorithm::zlib});
+  setUpExpectingClientHello();
+  auto chlo = TestMessages::clientHello();
+  CertificateCompressionAlgorithms algos;
+  algos.algorithms = {CertificateCompressionAlgorithm::zstd};
+  chlo.extensions.push_back(encodeExtension(std::move(algos)));
+  EXPECT_CALL(*cert_, getCompressedCert(_)).Times(0);
+  EXPECT_CALL(*cert_, _getCertMessage(_));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_FALSE(state_.serverCertCompAlgo().hasValue());
+}
+
 TEST_F(ServerProtocolTest, TestClientHelloServerPref) {
   setUpExpectingClientHello();
   auto chlo = TestMessages::clientHello();
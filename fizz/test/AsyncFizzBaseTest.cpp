@@ -151,6 +151,17 @@ TEST_F(AsyncFizzBaseTest, TestWrite) {
   writeChain(nullptr, std::move(buf));
 }
 
+TEST_F(AsyncFizzBaseTest, TestZeroCopyNotSocket) {
+  EXPECT_FALSE(setZeroCopyWrites(true));
+  EXPECT_FALSE(getZeroCopyWrites());
+  EXPECT_TRUE(setZeroCopyWrites(false));
+
+  auto buf = IOBuf::create(32 * 1024);
+  buf->append(32 * 1024);
+  EXPECT_CALL(*this, writeAppDataInternal(_, _, WriteFlags::NONE));
+  writeChain(nullptr, std::move(buf));
+}
+
 TEST_F(AsyncFizzBaseTest, TestReadErr) {
   setReadCB(&readCallback_);
 
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/test/BenchUtil.h>
+
+#include <atomic>
+
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+} // namespace
+
+#if FIZZ_BENCH_HAS_ALLOCATIONS
+// glibc allows the executable to replace malloc; forward to its own
+// implementation, counting every allocation including those made by OpenSSL
+// and operator new.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+  __libc_free(ptr);
+}
+}
+#endif
+
+namespace fizz {
+namespace test {
+namespace bench {
+
+uint64_t allocations() {
+  return allocationCount.load(std::memory_order_relaxed);
+}
+} // namespace bench
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Helpers shared by the in-process connection benchmarks (HandshakeBench,
+ * TransferBench). The allocation counting hooks live in BenchUtil.cpp,
+ * which must be linked into every benchmark using allocations().
+ *
+ * On glibc, allocations are counted by wrapping malloc. Build with
+ * -DFIZZ_BENCH_COUNT_ALLOCATIONS=0 when linking another allocator such as
+ * jemalloc.
+ */
+
+#pragma once
+
+#include <fizz/test/LocalTransport.h>
+
+#include <folly/io/async/EventBase.h>
+
+#include <time.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#ifndef FIZZ_BENCH_COUNT_ALLOCATIONS
+#define FIZZ_BENCH_COUNT_ALLOCATIONS 1
+#endif
+
+#if defined(__GLIBC__) && FIZZ_BENCH_COUNT_ALLOCATIONS
+#define FIZZ_BENCH_HAS_ALLOCATIONS 1
+#else
+#define FIZZ_BENCH_HAS_ALLOCATIONS 0
+#endif
+
+namespace fizz {
+namespace test {
+namespace bench {
+
+/**
+ * Heap allocations made by the process so far, or 0 if they aren't counted.
+ */
+uint64_t allocations();
+
+inline std::chrono::nanoseconds threadCpuTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+/**
+ * Runs func, adding the CPU time it took on this thread to side.
+ */
+template <typename Func>
+void timeSide(std::chrono::nanoseconds& side, Func&& func) {
+  auto start = threadCpuTime();
+  func();
+  side += threadCpuTime() - start;
+}
+
+/**
+ * LocalTransport that delivers writes on the peer's next loop instead of
+ * synchronously, so that each side's work runs inside its own EventBase loop
+ * and can be timed separately. pending counts the deliveries still queued.
+ * Data still queued when the peer is destroyed is dropped.
+ */
+class QueuedTransport : public LocalTransport {
+ public:
+  explicit QueuedTransport(size_t* pending) : pending_(pending) {}
+
+  ~QueuedTransport() override {
+    *alive_ = false;
+  }
+
+  void setPeer(QueuedTransport* peer) {
+    LocalTransport::setPeer(peer);
+    peer_ = peer;
+  }
+
+  void writeChain(
+      WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf>&& buf,
+      folly::WriteFlags /*flags*/ = folly::WriteFlags::NONE) override {
+    ++*pending_;
+    peer_->getEventBase()->runInLoop([pending = pending_,
+                                      peer = peer_,
+                                      alive = peer_->alive_,
+                                      data = std::move(buf)]() mutable {
+      --*pending;
+      if (*alive) {
+        peer->receiveData(std::move(data));
+      }
+    });
+    if (callback) {
+      callback->writeSuccess();
+    }
+  }
+
+ private:
+  size_t* pending_;
+  QueuedTransport* peer_{nullptr};
+  std::shared_ptr<bool> alive_{std::make_shared<bool>(true)};
+};
+} // namespace bench
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,347 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * In-process handshake benchmark. Each iteration runs one complete handshake
+ * between an AsyncFizzClient and an AsyncFizzServer connected by a pair of
+ * LocalTransports, so no network is needed.
+ *
+ * The client and server each run on their own EventBase, and both EventBases
+ * are driven from the benchmark thread. Records written by one side are
+ * delivered on the other side's next loop. This way all of a side's work,
+ * including continuations queued on its executor, runs inside its own loop
+ * and can be timed separately. After the folly benchmark table, a second
+ * table shows each scenario's handshakes per CPU second, client and server
+ * CPU per handshake, and heap allocations per handshake (see BenchUtil.h).
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/client/PskCache.h>
+#include <fizz/crypto/RandomGenerator.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/server/AsyncFizzServer.h>
+#include <fizz/server/CertManager.h>
+#include <fizz/server/TicketTypes.h>
+#include <fizz/test/BenchUtil.h>
+
+#include <cstdio>
+#include <map>
+
+using namespace fizz;
+using namespace fizz::client;
+using namespace fizz::server;
+using namespace fizz::test;
+using namespace fizz::test::bench;
+using namespace folly;
+
+namespace {
+
+enum class Scenario {
+  FullRSA,
+  FullP256,
+  ResumePskDheKe,
+  ResumePskKe,
+  HelloRetryRequest,
+  EarlyData,
+};
+
+folly::StringPiece toString(Scenario scenario) {
+  switch (scenario) {
+    case Scenario::FullRSA:
+      return "full_rsa";
+    case Scenario::FullP256:
+      return "full_p256";
+    case Scenario::ResumePskDheKe:
+      return "resume_psk_dhe_ke";
+    case Scenario::ResumePskKe:
+      return "resume_psk_ke";
+    case Scenario::HelloRetryRequest:
+      return "hello_retry_request";
+    case Scenario::EarlyData:
+      return "early_data";
+  }
+  return "unknown";
+}
+
+/**
+ * CPU time and allocations accumulated over the measured handshakes of a
+ * scenario.
+ */
+struct Measurements {
+  uint64_t handshakes{0};
+  std::chrono::nanoseconds clientCpu{0};
+  std::chrono::nanoseconds serverCpu{0};
+  uint64_t allocations{0};
+};
+
+std::map<Scenario, Measurements>& measurements() {
+  static std::map<Scenario, Measurements> results;
+  return results;
+}
+
+class ClientCallback : public AsyncFizzClient::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(AsyncFizzClient*) noexcept override {
+    done = true;
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzClient*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "Client handshake error: " << ex.what();
+  }
+
+  bool done{false};
+};
+
+class ServerCallback : public AsyncFizzServer::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(AsyncFizzServer*) noexcept override {
+    done = true;
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "Server handshake error: " << ex.what();
+  }
+
+  void fizzHandshakeAttemptFallback(std::unique_ptr<IOBuf>) override {
+    LOG(FATAL) << "Unexpected fallback";
+  }
+
+  bool done{false};
+};
+
+class HandshakeBench {
+ public:
+  explicit HandshakeBench(Scenario scenario) : scenario_(scenario) {
+    clientContext_ = std::make_shared<FizzClientContext>();
+    serverContext_ = std::make_shared<FizzServerContext>();
+    clientContext_->setPskCache(std::make_shared<BasicPskCache>());
+
+    auto certManager = std::make_unique<CertManager>();
+    if (scenario == Scenario::FullRSA) {
+      std::vector<ssl::X509UniquePtr> certs;
+      certs.emplace_back(getCert(kRSACertificate));
+      certManager->addCert(
+          std::make_shared<SelfCertImpl<KeyType::RSA>>(
+              getPrivateKey(kRSAKey), std::move(certs)),
+          true);
+      clientContext_->setSupportedSigSchemes(
+          {SignatureScheme::rsa_pss_sha256});
+      serverContext_->setSupportedSigSchemes(
+          {SignatureScheme::rsa_pss_sha256});
+    } else {
+      std::vector<ssl::X509UniquePtr> certs;
+      certs.emplace_back(getCert(kP256Certificate));
+      certManager->addCert(
+          std::make_shared<SelfCertImpl<KeyType::P256>>(
+              getPrivateKey(kP256Key), std::move(certs)),
+          true);
+    }
+    serverContext_->setCertManager(std::move(certManager));
+
+    auto ticketCipher = std::make_shared<AES128TicketCipher>();
+    auto ticketSeed = RandomGenerator<32>().generateRandom();
+    ticketCipher->setTicketSecrets({{range(ticketSeed)}});
+    ticketCipher->setValidity(std::chrono::seconds(3600));
+    serverContext_->setTicketCipher(std::move(ticketCipher));
+
+    switch (scenario) {
+      case Scenario::FullRSA:
+      case Scenario::FullP256:
+      case Scenario::ResumePskDheKe:
+        break;
+      case Scenario::ResumePskKe:
+        serverContext_->setSupportedPskModes({PskKeyExchangeMode::psk_ke});
+        break;
+      case Scenario::HelloRetryRequest:
+        // The client's default x25519 share is unacceptable to the server.
+        serverContext_->setSupportedGroups({NamedGroup::secp256r1});
+        break;
+      case Scenario::EarlyData:
+        clientContext_->setSendEarlyData(true);
+        serverContext_->setEarlyDataSettings(
+            true,
+            {std::chrono::seconds(-60), std::chrono::seconds(60)},
+            std::make_shared<AllowAllReplayReplayCache>());
+        break;
+    }
+
+    if (resumes()) {
+      // Prime the PSK cache. Every resumed handshake replaces the ticket with
+      // a fresh one.
+      Measurements unused;
+      handshake(unused);
+    }
+  }
+
+  void run(size_t iters) {
+    auto& results = measurements()[scenario_];
+    for (size_t i = 0; i < iters; ++i) {
+      handshake(results);
+    }
+  }
+
+ private:
+  bool resumes() const {
+    return scenario_ == Scenario::ResumePskDheKe ||
+        scenario_ == Scenario::ResumePskKe || scenario_ == Scenario::EarlyData;
+  }
+
+  void handshake(Measurements& results) {
+    auto startAllocations = bench::allocations();
+    size_t pending = 0;
+    ClientCallback clientCallback;
+    ServerCallback serverCallback;
+    AsyncFizzClient::UniquePtr client;
+    AsyncFizzServer::UniquePtr server;
+
+    timeSide(results.clientCpu, [&] {
+      auto transport = new QueuedTransport(&pending);
+      LocalTransport::UniquePtr clientTransport(transport);
+      clientTransport_ = transport;
+      transport->attachEventBase(&clientEvb_);
+      client.reset(
+          new AsyncFizzClient(std::move(clientTransport), clientContext_));
+    });
+    timeSide(results.serverCpu, [&] {
+      auto transport = new QueuedTransport(&pending);
+      LocalTransport::UniquePtr serverTransport(transport);
+      serverTransport_ = transport;
+      transport->attachEventBase(&serverEvb_);
+      server.reset(
+          new AsyncFizzServer(std::move(serverTransport), serverContext_));
+    });
+    clientTransport_->setPeer(serverTransport_);
+    serverTransport_->setPeer(clientTransport_);
+
+    timeSide(results.clientCpu, [&] {
+      client->connect(
+          &clientCallback, nullptr, folly::none, std::string("Fizz"));
+    });
+    timeSide(results.serverCpu, [&] { server->accept(&serverCallback); });
+
+    // Keep going after both callbacks fire so the server's session ticket
+    // reaches the client.
+    while (!clientCallback.done || !serverCallback.done || pending > 0) {
+      timeSide(
+          results.clientCpu, [&] { clientEvb_.loopOnce(EVLOOP_NONBLOCK); });
+      timeSide(
+          results.serverCpu, [&] { serverEvb_.loopOnce(EVLOOP_NONBLOCK); });
+    }
+
+    timeSide(results.clientCpu, [&] { client.reset(); });
+    timeSide(results.serverCpu, [&] { server.reset(); });
+    // Flush anything written while closing; it is dropped on delivery.
+    while (pending > 0) {
+      clientEvb_.loopOnce(EVLOOP_NONBLOCK);
+      serverEvb_.loopOnce(EVLOOP_NONBLOCK);
+    }
+
+    results.handshakes++;
+    results.allocations += bench::allocations() - startAllocations;
+  }
+
+  Scenario scenario_;
+  std::shared_ptr<FizzClientContext> clientContext_;
+  std::shared_ptr<FizzServerContext> serverContext_;
+  EventBase clientEvb_;
+  EventBase serverEvb_;
+  QueuedTransport* clientTransport_{nullptr};
+  QueuedTransport* serverTransport_{nullptr};
+};
+
+HandshakeBench& getBench(Scenario scenario) {
+  static std::map<Scenario, std::unique_ptr<HandshakeBench>> benches;
+  auto& bench = benches[scenario];
+  if (!bench) {
+    bench = std::make_unique<HandshakeBench>(scenario);
+  }
+  return *bench;
+}
+
+void runHandshakes(Scenario scenario, size_t iters) {
+  HandshakeBench* bench;
+  BENCHMARK_SUSPEND {
+    bench = &getBench(scenario);
+  }
+  bench->run(iters);
+}
+
+void printMeasurements() {
+  printf(
+      "%-22s %12s %14s %14s %12s %12s\n",
+      "scenario",
+      "handshakes",
+      "hs/s/core",
+      "client us/hs",
+      "server us/hs",
+      "allocs/hs");
+  for (const auto& entry : measurements()) {
+    const auto& results = entry.second;
+    if (results.handshakes == 0) {
+      continue;
+    }
+    auto count = static_cast<double>(results.handshakes);
+    auto clientUs = results.clientCpu.count() / 1000.0 / count;
+    auto serverUs = results.serverCpu.count() / 1000.0 / count;
+    auto perCore = 1000000.0 / (clientUs + serverUs);
+    printf(
+        "%-22s %12llu %14.1f %14.1f %12.1f ",
+        toString(entry.first).data(),
+        static_cast<unsigned long long>(results.handshakes),
+        perCore,
+        clientUs,
+        serverUs);
+    if (FIZZ_BENCH_HAS_ALLOCATIONS) {
+      printf("%12.1f\n", results.allocations / count);
+    } else {
+      printf("%12s\n", "n/a");
+    }
+  }
+}
+} // namespace
+
+BENCHMARK(fullHandshakeRSA, iters) {
+  runHandshakes(Scenario::FullRSA, iters);
+}
+
+BENCHMARK(fullHandshakeP256, iters) {
+  runHandshakes(Scenario::FullP256, iters);
+}
+
+BENCHMARK(resumePskDheKe, iters) {
+  runHandshakes(Scenario::ResumePskDheKe, iters);
+}
+
+BENCHMARK(resumePskKe, iters) {
+  runHandshakes(Scenario::ResumePskKe, iters);
+}
+
+BENCHMARK(helloRetryRequest, iters) {
+  runHandshakes(Scenario::HelloRetryRequest, iters);
+}
+
+BENCHMARK(earlyData, iters) {
+  runHandshakes(Scenario::EarlyData, iters);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  printMeasurements();
+  return 0;
+}
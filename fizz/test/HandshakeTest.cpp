@@ -11,12 +11,16 @@
 
 #include <fizz/client/AsyncFizzClient.h>
 #include <fizz/client/test/Mocks.h>
+#include <fizz/compression/ZlibCertificateCompressor.h>
 #include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/AESGCMNative.h>
 #include <fizz/crypto/aead/OpenSSLEVPCipher.h>
 #include <fizz/crypto/test/TestUtil.h>
 #include <fizz/extensions/tokenbinding/TokenBindingClientExtension.h>
 #include <fizz/extensions/tokenbinding/TokenBindingContext.h>
 #include <fizz/extensions/tokenbinding/TokenBindingServerExtension.h>
+#include <fizz/protocol/NativeAeadFactory.h>
+#include <fizz/protocol/StatsFactory.h>
 #include <fizz/protocol/test/Matchers.h>
 #include <fizz/protocol/test/Utilities.h>
 #include <fizz/server/AsyncFizzServer.h>
@@ -654,6 +658,59 @@ TEST_F(HandshakeTest, CertRequestBadCert) {
   doHandshake();
 }
 
+TEST_F(HandshakeTest, CertCompression) {
+  auto zlib = std::make_shared<ZlibCertificateCompressor>();
+  auto certManager = std::make_unique<CertManager>();
+  std::vector<ssl::X509UniquePtr> p256Certs;
+  p256Certs.emplace_back(getCert(kP256Certificate));
+  certManager->addCert(
+      std::make_shared<SelfCertImpl<KeyType::P256>>(
+          getPrivateKey(kP256Key),
+          std::move(p256Certs),
+          std::vector<std::shared_ptr<CertificateCompressor>>{zlib}),
+      true);
+  serverContext_->setCertManager(std::move(certManager));
+  serverContext_->setSupportedCompressionAlgorithms(
+      {CertificateCompressionAlgorithm::zlib});
+  clientContext_->setCertDecompressors({zlib});
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+
+  EXPECT_EQ(
+      *client_->getState().serverCertCompAlgo(),
+      CertificateCompressionAlgorithm::zlib);
+  EXPECT_EQ(
+      *server_->getState().serverCertCompAlgo(),
+      CertificateCompressionAlgorithm::zlib);
+}
+
+TEST_F(HandshakeTest, CertCompressionNotSupportedByClient) {
+  auto zlib = std::make_shared<ZlibCertificateCompressor>();
+  auto certManager = std::make_unique<CertManager>();
+  std::vector<ssl::X509UniquePtr> p256Certs;
+  p256Certs.emplace_back(getCert(kP256Certificate));
+  certManager->addCert(
+      std::make_shared<SelfCertImpl<KeyType::P256>>(
+          getPrivateKey(kP256Key),
+          std::move(p256Certs),
+          std::vector<std::shared_ptr<CertificateCompressor>>{zlib}),
+      true);
+  serverContext_->setCertManager(std::move(certManager));
+  serverContext_->setSupportedCompressionAlgorithms(
+      {CertificateCompressionAlgorithm::zlib});
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+
+  EXPECT_FALSE(client_->getState().serverCertCompAlgo());
+  EXPECT_FALSE(server_->getState().serverCertCompAlgo());
+}
+
 TEST_F(HandshakeTest, EarlyDataAccepted) {
   clientContext_->setSendEarlyData(true);
   setupResume();
@@ -968,5 +1025,228 @@ TEST_F(HandshakeTest, TestBadCookie) {
 
   doServerHandshake();
 }
+
+TEST_F(HandshakeTest, TestExportImportConnectionState) {
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+
+  auto ekm = client_->getEkm("EXPORTER-test", nullptr, 32);
+  auto clientState = client_->exportConnectionState();
+  auto serverState = server_->exportConnectionState();
+
+  // Continue on new transports, as a process taking over the sockets would.
+  resetTransports();
+  client_->importConnectionState(std::move(clientState));
+  server_->importConnectionState(std::move(serverState));
+  client_->setReadCB(&clientRead_);
+  server_->setReadCB(&serverRead_);
+  EXPECT_EQ(*client_->getState().version(), expected_.version);
+  EXPECT_EQ(*client_->getState().cipher(), expected_.cipher);
+  EXPECT_EQ(client_->getState().group(), expected_.group);
+  EXPECT_EQ(*server_->getState().version(), expected_.version);
+  EXPECT_EQ(*server_->getState().cipher(), expected_.cipher);
+  EXPECT_EQ(*server_->getState().pskType(), expected_.pskType);
+  EXPECT_TRUE(IOBufEqualTo()(
+      client_->getEkm("EXPORTER-test", nullptr, 32), ekm));
+  EXPECT_TRUE(IOBufEqualTo()(
+      server_->getEkm("EXPORTER-test", nullptr, 32), ekm));
+  EXPECT_TRUE(certsMatch(
+      client_->getState().serverCert(), server_->getState().serverCert()));
+
+  sendAppData();
+}
+
+TEST_F(HandshakeTest, TestWriteAfterExport) {
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+
+  client_->exportConnectionState();
+  server_->exportConnectionState();
+  auto clientWritten = clientTransport_->getRawBytesWritten();
+  auto serverWritten = serverTransport_->getRawBytesWritten();
+
+  // The importing process owns the keys and sequence numbers now, so the
+  // exported connections must not write anything, not even close_notify.
+  MockWriteCallback clientWriteCallback;
+  MockWriteCallback serverWriteCallback;
+  EXPECT_CALL(clientWriteCallback, writeErr_(0, _));
+  EXPECT_CALL(serverWriteCallback, writeErr_(0, _));
+  client_->writeChain(&clientWriteCallback, IOBuf::copyBuffer("late"));
+  server_->writeChain(&serverWriteCallback, IOBuf::copyBuffer("late"));
+  EXPECT_FALSE(client_->good());
+  EXPECT_FALSE(server_->good());
+  client_->close();
+  server_->closeNow();
+  evb_.loop();
+
+  EXPECT_EQ(clientTransport_->getRawBytesWritten(), clientWritten);
+  EXPECT_EQ(serverTransport_->getRawBytesWritten(), serverWritten);
+}
+
+TEST_F(HandshakeTest, TestExportBeforeHandshake) {
+  EXPECT_THROW(client_->exportConnectionState(), std::runtime_error);
+  EXPECT_THROW(server_->exportConnectionState(), std::runtime_error);
+}
+
+TEST_F(HandshakeTest, TestHandshakeTiming) {
+  auto clientStats = std::make_shared<HandshakeTimingStats>();
+  auto serverStats = std::make_shared<HandshakeTimingStats>();
+  clientContext_->setHandshakeTimingStats(clientStats);
+  serverContext_->setHandshakeTimingStats(serverStats);
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+
+  auto serverTiming = server_->getState().handshakeTiming();
+  ASSERT_TRUE(serverTiming);
+  EXPECT_TRUE(serverTiming->timeTo(server::StateEnum::ExpectingFinished));
+  EXPECT_TRUE(serverTiming->timeTo(server::StateEnum::AcceptingData));
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::TicketDecrypt).count, 0u);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::CertSelection).count, 1u);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::Signing).count, 1u);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::KeyExchange).count, 1u);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::NewSessionTicket).count, 1u);
+
+  auto clientTiming = client_->getState().handshakeTiming();
+  ASSERT_TRUE(clientTiming);
+  EXPECT_TRUE(clientTiming->timeTo(client::StateEnum::Established));
+  EXPECT_EQ(clientTiming->stage(HandshakeStage::KeyExchange).count, 2u);
+
+  EXPECT_EQ(serverStats->getHandshakeSummary().count, 1u);
+  EXPECT_EQ(serverStats->getStageSummary(HandshakeStage::Signing).count, 1u);
+  EXPECT_EQ(
+      serverStats->getStageSummary(HandshakeStage::TicketDecrypt).count, 0);
+  EXPECT_EQ(clientStats->getHandshakeSummary().count, 1u);
+
+  sendAppData();
+}
+
+TEST_F(HandshakeTest, TestHandshakeTimingResume) {
+  setupResume();
+  auto serverStats = std::make_shared<HandshakeTimingStats>();
+  serverContext_->setHandshakeTimingStats(serverStats);
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+
+  auto serverTiming = server_->getState().handshakeTiming();
+  ASSERT_TRUE(serverTiming);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::TicketDecrypt).count, 1u);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::CertSelection).count, 0u);
+  EXPECT_EQ(serverTiming->stage(HandshakeStage::Signing).count, 0u);
+  EXPECT_FALSE(client_->getState().handshakeTiming());
+  EXPECT_EQ(
+      serverStats->getStageSummary(HandshakeStage::TicketDecrypt).count, 1);
+}
+
+TEST_F(HandshakeTest, TestStats) {
+  auto clientStats = std::make_shared<FizzStats>();
+  auto serverStats = std::make_shared<FizzStats>();
+  clientContext_->setStats(clientStats);
+  clientContext_->setFactory(std::make_unique<StatsFactory<>>(clientStats));
+  serverContext_->setStats(serverStats);
+  serverContext_->setFactory(std::make_unique<StatsFactory<>>(serverStats));
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+
+  auto clientSnapshot = clientStats->snapshot();
+  auto serverSnapshot = serverStats->snapshot();
+  EXPECT_EQ(clientSnapshot[StatsCounter::HandshakeSuccess], 1u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::HandshakeSuccess], 1u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::PskAttempted], 0u);
+  EXPECT_EQ(serverSnapshot.ciphers[expected_.cipher], 1u);
+  EXPECT_EQ(serverSnapshot.groups[*expected_.group], 1u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::ReplayCacheNotChecked], 1u);
+  EXPECT_GT(clientSnapshot[StatsCounter::RecordsEncrypted], 0u);
+  EXPECT_GT(serverSnapshot[StatsCounter::RecordsDecrypted], 0u);
+  EXPECT_GT(serverSnapshot[StatsCounter::BytesDecrypted], 0u);
+
+  resetTransports();
+  expected_.scheme = none;
+  expected_.pskType = PskType::Resumption;
+  expected_.pskMode = PskKeyExchangeMode::psk_dhe_ke;
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+
+  serverSnapshot = serverStats->snapshot();
+  EXPECT_EQ(clientStats->snapshot()[StatsCounter::PskAccepted], 1u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::HandshakeSuccess], 2u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::PskAttempted], 1u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::PskAccepted], 1u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::TicketDecryptFailure], 0u);
+  EXPECT_EQ(serverSnapshot[StatsCounter::HandshakeError], 0u);
+}
+
+TEST_F(HandshakeTest, TestNativeAesGcm) {
+  if (!AESGCMNative<AESGCM128>::isSupported()) {
+    return;
+  }
+  clientContext_->setFactory(std::make_unique<NativeAeadFactory<>>());
+  serverContext_->setFactory(std::make_unique<NativeAeadFactory<>>());
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+  resetTransports();
+
+  serverContext_->setSupportedCiphers({{CipherSuite::TLS_AES_256_GCM_SHA384}});
+  expected_.cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+}
+
+TEST_F(HandshakeTest, TestIdleCompaction) {
+  auto serverStats = std::make_shared<HandshakeTimingStats>();
+  serverContext_->setHandshakeTimingStats(serverStats);
+  client_->setIdleCompaction(true);
+  server_->setIdleCompaction(true);
+
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+
+  EXPECT_FALSE(server_->getState().handshakeContext());
+  EXPECT_FALSE(server_->getState().handshakeReadRecordLayer());
+  EXPECT_FALSE(server_->getState().handshakeTiming());
+  EXPECT_TRUE(server_->getState().serverCert());
+  EXPECT_EQ(serverStats->getHandshakeSummary().count, 1u);
+  EXPECT_FALSE(client_->getState().handshakeContext());
+  EXPECT_FALSE(client_->getState().attemptedPsk());
+  EXPECT_TRUE(client_->getState().serverCert());
+
+  sendAppData();
+
+  resetTransports();
+  client_->setIdleCompaction(true);
+  server_->setIdleCompaction(true);
+  expected_.scheme = none;
+  expected_.pskType = PskType::Resumption;
+  expected_.pskMode = PskKeyExchangeMode::psk_dhe_ke;
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  EXPECT_FALSE(client_->getState().attemptedPsk());
+  sendAppData();
+}
+
+TEST_F(HandshakeTest, TestHandshakeTimingDisabled) {
+  expectSuccess();
+  doHandshake();
+  EXPECT_FALSE(client_->getState().handshakeTiming());
+  EXPECT_FALSE(server_->getState().handshakeTiming());
+}
 } // namespace test
 } // namespace fizz
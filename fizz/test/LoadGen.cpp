@@ -0,0 +1,708 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Load generator for Fizz. Runs a multi-threaded echo/sink server, a
+ * multi-threaded client, or both in one process over loopback.
+ *
+ * The client spreads -connections concurrent AsyncFizzClient connections over
+ * -client_threads EventBase threads. Each connection picks its handshake type
+ * from the configured mix, then sends -request_size byte requests. In echo
+ * mode it waits for each response before sending the next request; in sink
+ * mode it keeps one write outstanding. After -requests_per_connection requests
+ * the connection is closed and replaced, 0 keeps connections open. At the end
+ * it reports handshake rate, throughput and latency percentiles.
+ *
+ * Example, scaling test over loopback:
+ *   LoadGen -mode=both -server_threads=4 -client_threads=4 -connections=400
+ *           -resume_percent=50 -early_percent=20 -requests_per_connection=10
+ */
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/client/PskCache.h>
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/protocol/test/Utilities.h>
+#include <fizz/server/AsyncFizzServer.h>
+#include <fizz/server/TicketTypes.h>
+#include <folly/Random.h>
+#include <folly/io/async/AsyncServerSocket.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/ssl/Init.h>
+#include <folly/stats/Histogram.h>
+
+#include <atomic>
+#include <thread>
+
+DEFINE_string(mode, "both", "server, client, or both (over loopback)");
+DEFINE_string(host, "127.0.0.1", "host to connect to in client mode");
+DEFINE_int32(port, 0, "port to listen on or connect to, 0 picks one in both");
+DEFINE_int32(server_threads, 1, "server EventBase threads");
+DEFINE_int32(client_threads, 1, "client EventBase threads");
+DEFINE_int32(connections, 10, "concurrent client connections");
+DEFINE_int32(duration, 10, "client run time in seconds");
+DEFINE_int32(resume_percent, 0, "percent of connections that resume");
+DEFINE_int32(
+    early_percent,
+    0,
+    "percent of connections that resume and send the first request as 0-RTT");
+DEFINE_int32(request_size, 1024, "bytes per request");
+DEFINE_int32(
+    requests_per_connection,
+    1,
+    "requests before a connection is replaced, 0 never replaces connections");
+DEFINE_bool(sink, false, "server discards data instead of echoing it");
+
+using namespace fizz;
+using namespace fizz::client;
+using namespace fizz::server;
+using namespace folly;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr folly::StringPiece kPskIdentity = "fizz-loadgen";
+
+class ServerConnection : public AsyncFizzServer::HandshakeCallback,
+                         public AsyncTransportWrapper::ReadCallback {
+ public:
+  explicit ServerConnection(AsyncFizzServer::UniquePtr transport)
+      : transport_(std::move(transport)) {}
+
+  void start() {
+    transport_->accept(this);
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzServer*) noexcept override {
+    transport_->setReadCB(this);
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer*,
+      folly::exception_wrapper ex) noexcept override {
+    VLOG(1) << "Server handshake error: " << ex.what();
+    delete this;
+  }
+
+  void fizzHandshakeAttemptFallback(std::unique_ptr<IOBuf>) override {
+    LOG(ERROR) << "Unexpected fallback attempt";
+    delete this;
+  }
+
+  void getReadBuffer(void**, size_t*) override {
+    throw std::runtime_error("getReadBuffer not implemented");
+  }
+
+  void readDataAvailable(size_t) noexcept override {
+    CHECK(false) << "readDataAvailable not implemented";
+  }
+
+  bool isBufferMovable() noexcept override {
+    return true;
+  }
+
+  void readBufferAvailable(std::unique_ptr<IOBuf> buf) noexcept override {
+    if (!FLAGS_sink) {
+      transport_->writeChain(nullptr, std::move(buf));
+    }
+  }
+
+  void readEOF() noexcept override {
+    delete this;
+  }
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    VLOG(1) << "Server read error: " << ex.what();
+    delete this;
+  }
+
+ private:
+  AsyncFizzServer::UniquePtr transport_;
+};
+
+/**
+ * Accepts connections on one server thread.
+ */
+class ServerAcceptor : public AsyncServerSocket::AcceptCallback {
+ public:
+  ServerAcceptor(EventBase* evb, std::shared_ptr<FizzServerContext> context)
+      : evb_(evb), context_(std::move(context)) {}
+
+  void connectionAccepted(
+      int fd,
+      const SocketAddress& /* clientAddr */) noexcept override {
+    AsyncSocket::UniquePtr sock(new AsyncSocket(evb_, fd));
+    sock->setNoDelay(true);
+    AsyncFizzServer::UniquePtr transport(
+        new AsyncFizzServer(std::move(sock), context_));
+    (new ServerConnection(std::move(transport)))->start();
+  }
+
+  void acceptError(const std::exception& ex) noexcept override {
+    LOG(ERROR) << "Accept error: " << ex.what();
+  }
+
+ private:
+  EventBase* evb_;
+  std::shared_ptr<FizzServerContext> context_;
+};
+
+class Server {
+ public:
+  Server(int port, size_t threads) {
+    auto certData = fizz::test::createCert("fizz-loadgen", false, nullptr);
+    std::vector<ssl::X509UniquePtr> certChain;
+    certChain.push_back(std::move(certData.cert));
+    auto certManager = std::make_unique<CertManager>();
+    certManager->addCert(
+        std::make_shared<SelfCertImpl<KeyType::P256>>(
+            std::move(certData.key), std::move(certChain)),
+        true);
+
+    auto ticketCipher = std::make_shared<AeadTicketCipher<
+        OpenSSLEVPCipher<AESGCM128>,
+        TicketCodec<CertificateStorage::X509>,
+        HkdfImpl<Sha256>>>();
+    auto ticketSeed = RandomGenerator<32>().generateRandom();
+    ticketCipher->setTicketSecrets({{range(ticketSeed)}});
+    ticketCipher->setValidity(std::chrono::hours(1));
+
+    context_ = std::make_shared<FizzServerContext>();
+    context_->setCertManager(std::move(certManager));
+    context_->setTicketCipher(std::move(ticketCipher));
+    context_->setEarlyDataSettings(
+        true,
+        {std::chrono::seconds(-10), std::chrono::seconds(10)},
+        std::make_shared<AllowAllReplayReplayCache>());
+
+    for (size_t i = 0; i < threads; ++i) {
+      threads_.push_back(std::make_unique<ScopedEventBaseThread>());
+      acceptors_.push_back(std::make_unique<ServerAcceptor>(
+          threads_.back()->getEventBase(), context_));
+    }
+
+    acceptThread_.getEventBase()->runInEventBaseThreadAndWait([&] {
+      socket_.reset(new AsyncServerSocket(acceptThread_.getEventBase()));
+      socket_->bind(port);
+      socket_->listen(1024);
+      for (size_t i = 0; i < threads; ++i) {
+        socket_->addAcceptCallback(
+            acceptors_[i].get(), threads_[i]->getEventBase());
+      }
+      socket_->startAccepting();
+      socket_->getAddress(&address_);
+    });
+  }
+
+  ~Server() {
+    acceptThread_.getEventBase()->runInEventBaseThreadAndWait(
+        [this] { socket_.reset(); });
+  }
+
+  const SocketAddress& getAddress() const {
+    return address_;
+  }
+
+ private:
+  std::shared_ptr<FizzServerContext> context_;
+  std::vector<std::unique_ptr<ServerAcceptor>> acceptors_;
+  std::vector<std::unique_ptr<ScopedEventBaseThread>> threads_;
+  ScopedEventBaseThread acceptThread_;
+  AsyncServerSocket::UniquePtr socket_;
+  SocketAddress address_;
+};
+
+enum class HandshakeKind { Full, Resume, EarlyData, NUM_KINDS };
+
+folly::StringPiece toString(HandshakeKind kind) {
+  switch (kind) {
+    case HandshakeKind::Full:
+      return "full";
+    case HandshakeKind::Resume:
+      return "resume";
+    case HandshakeKind::EarlyData:
+      return "early_data";
+    case HandshakeKind::NUM_KINDS:
+      break;
+  }
+  return "unknown";
+}
+
+constexpr size_t kNumKinds = static_cast<size_t>(HandshakeKind::NUM_KINDS);
+
+/**
+ * Results of one client thread. Only touched from that thread until it is
+ * merged after the run.
+ */
+struct ClientStats {
+  using Histogram = folly::Histogram<int64_t>;
+
+  ClientStats()
+      : requestLatency(kBucketUs, 0, kMaxUs),
+        handshakeLatency(kNumKinds, Histogram(kBucketUs, 0, kMaxUs)) {}
+
+  void merge(const ClientStats& other) {
+    for (size_t i = 0; i < kNumKinds; ++i) {
+      handshakes[i] += other.handshakes[i];
+      handshakeLatency[i].merge(other.handshakeLatency[i]);
+    }
+    attempted += other.attempted;
+    errors += other.errors;
+    requests += other.requests;
+    bytes += other.bytes;
+    requestLatency.merge(other.requestLatency);
+  }
+
+  static constexpr int64_t kBucketUs = 50;
+  static constexpr int64_t kMaxUs = 2000000;
+
+  // Indexed by the negotiated HandshakeKind, not the attempted one.
+  std::array<uint64_t, kNumKinds> handshakes{};
+  uint64_t attempted{0};
+  uint64_t errors{0};
+  uint64_t requests{0};
+  uint64_t bytes{0};
+  Histogram requestLatency;
+  std::vector<Histogram> handshakeLatency;
+};
+
+constexpr int64_t ClientStats::kBucketUs;
+constexpr int64_t ClientStats::kMaxUs;
+
+int64_t elapsedUs(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             Clock::now() - start)
+      .count();
+}
+
+class ClientWorker;
+
+class ClientConnection : public AsyncSocket::ConnectCallback,
+                         public AsyncFizzClient::HandshakeCallback,
+                         public AsyncTransportWrapper::ReadCallback,
+                         public AsyncTransportWrapper::WriteCallback {
+ public:
+  explicit ClientConnection(ClientWorker* worker) : worker_(worker) {}
+
+  void start();
+  void stop();
+
+  void connectSuccess() noexcept override;
+  void connectErr(const AsyncSocketException& ex) noexcept override;
+
+  void fizzHandshakeSuccess(AsyncFizzClient* client) noexcept override;
+  void fizzHandshakeError(
+      AsyncFizzClient* client,
+      folly::exception_wrapper ex) noexcept override;
+
+  void getReadBuffer(void**, size_t*) override {
+    throw std::runtime_error("getReadBuffer not implemented");
+  }
+
+  void readDataAvailable(size_t) noexcept override {
+    CHECK(false) << "readDataAvailable not implemented";
+  }
+
+  bool isBufferMovable() noexcept override {
+    return true;
+  }
+
+  void readBufferAvailable(std::unique_ptr<IOBuf> buf) noexcept override;
+  void readEOF() noexcept override;
+  void readErr(const AsyncSocketException& ex) noexcept override;
+
+  void writeSuccess() noexcept override;
+  void writeErr(size_t, const AsyncSocketException& ex) noexcept override;
+
+ private:
+  void sendRequest();
+  void requestDone();
+  void fail(folly::StringPiece what);
+  void reconnect();
+
+  ClientWorker* worker_;
+  AsyncSocket::UniquePtr socket_;
+  AsyncFizzClient::UniquePtr transport_;
+  HandshakeKind kind_{HandshakeKind::Full};
+  Clock::time_point handshakeStart_;
+  Clock::time_point requestStart_;
+  size_t pendingResponse_{0};
+  size_t requests_{0};
+  bool closing_{false};
+};
+
+std::atomic<uint64_t> totalHandshakes{0};
+std::atomic<uint64_t> totalBytes{0};
+
+/**
+ * A client EventBase thread and the connections it runs.
+ */
+class ClientWorker {
+ public:
+  ClientWorker(SocketAddress address, size_t connections)
+      : address_(std::move(address)) {
+    auto pskCache = std::make_shared<BasicPskCache>();
+    for (size_t i = 0; i < kNumKinds; ++i) {
+      auto context = std::make_shared<FizzClientContext>();
+      context->setPskCache(pskCache);
+      context->setSendEarlyData(
+          i == static_cast<size_t>(HandshakeKind::EarlyData));
+      contexts_[i] = std::move(context);
+    }
+    request_ = IOBuf::create(FLAGS_request_size);
+    memset(request_->writableData(), 'a', FLAGS_request_size);
+    request_->append(FLAGS_request_size);
+
+    thread_.getEventBase()->runInEventBaseThreadAndWait([&] {
+      for (size_t i = 0; i < connections; ++i) {
+        connections_.push_back(std::make_unique<ClientConnection>(this));
+        connections_.back()->start();
+      }
+    });
+  }
+
+  /**
+   * Closes every connection and returns the thread's results.
+   */
+  ClientStats stop() {
+    ClientStats stats;
+    thread_.getEventBase()->runInEventBaseThreadAndWait([&] {
+      stopping_ = true;
+      for (auto& connection : connections_) {
+        connection->stop();
+      }
+      stats = stats_;
+    });
+    return stats;
+  }
+
+  ~ClientWorker() {
+    thread_.getEventBase()->runInEventBaseThreadAndWait(
+        [this] { connections_.clear(); });
+  }
+
+  EventBase* getEventBase() {
+    return thread_.getEventBase();
+  }
+
+  const SocketAddress& getAddress() const {
+    return address_;
+  }
+
+  std::shared_ptr<const FizzClientContext> getContext(HandshakeKind kind) {
+    return contexts_[static_cast<size_t>(kind)];
+  }
+
+  std::unique_ptr<IOBuf> getRequest() const {
+    return request_->clone();
+  }
+
+  bool stopping() const {
+    return stopping_;
+  }
+
+  ClientStats& stats() {
+    return stats_;
+  }
+
+ private:
+  ScopedEventBaseThread thread_;
+  SocketAddress address_;
+  std::array<std::shared_ptr<FizzClientContext>, kNumKinds> contexts_;
+  std::unique_ptr<IOBuf> request_;
+  std::vector<std::unique_ptr<ClientConnection>> connections_;
+  ClientStats stats_;
+  bool stopping_{false};
+};
+
+void ClientConnection::start() {
+  auto pick = folly::Random::rand32(100);
+  if (pick < static_cast<uint32_t>(FLAGS_early_percent)) {
+    kind_ = HandshakeKind::EarlyData;
+  } else if (pick < static_cast<uint32_t>(
+                        FLAGS_early_percent + FLAGS_resume_percent)) {
+    kind_ = HandshakeKind::Resume;
+  } else {
+    kind_ = HandshakeKind::Full;
+  }
+  requests_ = 0;
+  pendingResponse_ = 0;
+  closing_ = false;
+  worker_->stats().attempted++;
+  socket_.reset(new AsyncSocket(worker_->getEventBase()));
+  handshakeStart_ = Clock::now();
+  socket_->connect(this, worker_->getAddress());
+}
+
+void ClientConnection::stop() {
+  if (transport_) {
+    transport_->setReadCB(nullptr);
+    transport_->closeNow();
+  }
+  if (socket_) {
+    socket_->closeNow();
+  }
+}
+
+void ClientConnection::connectSuccess() noexcept {
+  socket_->setNoDelay(true);
+  transport_.reset(
+      new AsyncFizzClient(std::move(socket_), worker_->getContext(kind_)));
+  folly::Optional<std::string> pskIdentity;
+  if (kind_ != HandshakeKind::Full) {
+    pskIdentity = kPskIdentity.str();
+  }
+  transport_->connect(this, nullptr, folly::none, std::move(pskIdentity));
+}
+
+void ClientConnection::connectErr(const AsyncSocketException& ex) noexcept {
+  fail(ex.what());
+}
+
+void ClientConnection::fizzHandshakeSuccess(AsyncFizzClient*) noexcept {
+  // A resumption may fall back to a full handshake, e.g. before the first
+  // ticket for the thread arrives; count what was negotiated.
+  const auto& state = transport_->getState();
+  auto negotiated = HandshakeKind::Full;
+  if (state.earlyDataType() == EarlyDataType::Attempted ||
+      state.earlyDataType() == EarlyDataType::Accepted) {
+    negotiated = HandshakeKind::EarlyData;
+  } else if (state.pskType() == PskType::Resumption) {
+    negotiated = HandshakeKind::Resume;
+  }
+  auto& stats = worker_->stats();
+  auto index = static_cast<size_t>(negotiated);
+  stats.handshakes[index]++;
+  stats.handshakeLatency[index].addValue(elapsedUs(handshakeStart_));
+  totalHandshakes.fetch_add(1, std::memory_order_relaxed);
+
+  transport_->setReadCB(this);
+  sendRequest();
+}
+
+void ClientConnection::fizzHandshakeError(
+    AsyncFizzClient*,
+    folly::exception_wrapper ex) noexcept {
+  fail(ex.what());
+}
+
+void ClientConnection::sendRequest() {
+  if (worker_->stopping()) {
+    return;
+  }
+  requestStart_ = Clock::now();
+  pendingResponse_ = FLAGS_request_size;
+  transport_->writeChain(this, worker_->getRequest());
+}
+
+void ClientConnection::writeSuccess() noexcept {
+  if (FLAGS_sink) {
+    worker_->stats().bytes += FLAGS_request_size;
+    totalBytes.fetch_add(FLAGS_request_size, std::memory_order_relaxed);
+    requestDone();
+  }
+}
+
+void ClientConnection::writeErr(
+    size_t,
+    const AsyncSocketException& ex) noexcept {
+  fail(ex.what());
+}
+
+void ClientConnection::readBufferAvailable(
+    std::unique_ptr<IOBuf> buf) noexcept {
+  auto length = buf->computeChainDataLength();
+  worker_->stats().bytes += length;
+  totalBytes.fetch_add(length, std::memory_order_relaxed);
+  if (length >= pendingResponse_) {
+    pendingResponse_ = 0;
+    requestDone();
+  } else {
+    pendingResponse_ -= length;
+  }
+}
+
+void ClientConnection::requestDone() {
+  auto& stats = worker_->stats();
+  stats.requests++;
+  if (!FLAGS_sink) {
+    stats.requestLatency.addValue(elapsedUs(requestStart_));
+  }
+  requests_++;
+  if (FLAGS_requests_per_connection > 0 &&
+      requests_ >= static_cast<size_t>(FLAGS_requests_per_connection)) {
+    reconnect();
+  } else {
+    sendRequest();
+  }
+}
+
+void ClientConnection::readEOF() noexcept {
+  fail("unexpected EOF");
+}
+
+void ClientConnection::readErr(const AsyncSocketException& ex) noexcept {
+  fail(ex.what());
+}
+
+void ClientConnection::fail(folly::StringPiece what) {
+  if (closing_ || worker_->stopping()) {
+    return;
+  }
+  VLOG(1) << "Client error: " << what;
+  worker_->stats().errors++;
+  reconnect();
+}
+
+void ClientConnection::reconnect() {
+  // Closing fails any outstanding write; don't count that as another error.
+  closing_ = true;
+  stop();
+  // Start over from the loop rather than from inside the transport's
+  // callback.
+  worker_->getEventBase()->runInLoop([this] {
+    transport_.reset();
+    socket_.reset();
+    if (!worker_->stopping()) {
+      start();
+    }
+  });
+}
+
+void printHistogram(
+    folly::StringPiece name,
+    const folly::Histogram<int64_t>& histogram,
+    uint64_t count) {
+  if (count == 0) {
+    return;
+  }
+  printf(
+      "%-22s %10llu %10lld %10lld %10lld %10lld\n",
+      name.data(),
+      static_cast<unsigned long long>(count),
+      static_cast<long long>(histogram.getPercentileEstimate(0.5)),
+      static_cast<long long>(histogram.getPercentileEstimate(0.9)),
+      static_cast<long long>(histogram.getPercentileEstimate(0.99)),
+      static_cast<long long>(histogram.getPercentileEstimate(0.999)));
+}
+
+void printStats(const ClientStats& stats, double seconds) {
+  uint64_t handshakes = 0;
+  for (auto count : stats.handshakes) {
+    handshakes += count;
+  }
+  printf("duration:              %.1f s\n", seconds);
+  printf(
+      "handshakes:            %llu of %llu attempted (%.1f/s), %llu errors\n",
+      static_cast<unsigned long long>(handshakes),
+      static_cast<unsigned long long>(stats.attempted),
+      handshakes / seconds,
+      static_cast<unsigned long long>(stats.errors));
+  printf(
+      "requests:              %llu (%.1f/s)\n",
+      static_cast<unsigned long long>(stats.requests),
+      stats.requests / seconds);
+  printf(
+      "throughput:            %.2f MB/s\n", stats.bytes / seconds / 1000000);
+  printf(
+      "\n%-22s %10s %10s %10s %10s %10s\n",
+      "latency (us)",
+      "count",
+      "p50",
+      "p90",
+      "p99",
+      "p99.9");
+  for (size_t i = 0; i < kNumKinds; ++i) {
+    printHistogram(
+        folly::to<std::string>(
+            "handshake_", toString(static_cast<HandshakeKind>(i))),
+        stats.handshakeLatency[i],
+        stats.handshakes[i]);
+  }
+  if (!FLAGS_sink) {
+    printHistogram("request", stats.requestLatency, stats.requests);
+  }
+}
+
+void runClients(const SocketAddress& address) {
+  LOG(INFO) << "Running " << FLAGS_connections << " connections on "
+            << FLAGS_client_threads << " threads against " << address;
+  std::vector<std::unique_ptr<ClientWorker>> workers;
+  auto start = Clock::now();
+  for (int i = 0; i < FLAGS_client_threads; ++i) {
+    size_t connections = FLAGS_connections / FLAGS_client_threads +
+        (i < FLAGS_connections % FLAGS_client_threads ? 1 : 0);
+    workers.push_back(std::make_unique<ClientWorker>(address, connections));
+  }
+
+  uint64_t lastHandshakes = 0;
+  uint64_t lastBytes = 0;
+  for (int i = 0; i < FLAGS_duration; ++i) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto handshakes = totalHandshakes.load(std::memory_order_relaxed);
+    auto bytes = totalBytes.load(std::memory_order_relaxed);
+    LOG(INFO) << (handshakes - lastHandshakes) << " handshakes/s, "
+              << (bytes - lastBytes) / 1000000.0 << " MB/s";
+    lastHandshakes = handshakes;
+    lastBytes = bytes;
+  }
+
+  ClientStats total;
+  for (auto& worker : workers) {
+    total.merge(worker->stop());
+  }
+  std::chrono::duration<double> seconds = Clock::now() - start;
+  workers.clear();
+  printStats(total, seconds.count());
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  FLAGS_logtostderr = true;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  folly::ssl::init();
+
+  if (FLAGS_mode != "server" && FLAGS_mode != "client" &&
+      FLAGS_mode != "both") {
+    LOG(ERROR) << "-mode must be server, client or both";
+    return 1;
+  }
+  if (FLAGS_server_threads < 1 || FLAGS_client_threads < 1 ||
+      FLAGS_connections < 1 || FLAGS_request_size < 1 ||
+      FLAGS_resume_percent < 0 || FLAGS_early_percent < 0 ||
+      FLAGS_resume_percent + FLAGS_early_percent > 100) {
+    LOG(ERROR) << "Invalid thread, connection, size or handshake mix flags";
+    return 1;
+  }
+
+  if (FLAGS_mode == "client") {
+    if (FLAGS_port == 0) {
+      LOG(ERROR) << "-port is required in client mode";
+      return 1;
+    }
+    runClients(SocketAddress(FLAGS_host, FLAGS_port));
+    return 0;
+  }
+
+  Server server(FLAGS_port, FLAGS_server_threads);
+  LOG(INFO) << "Serving on " << server.getAddress() << " with "
+            << FLAGS_server_threads << " threads";
+  if (FLAGS_mode == "server") {
+    while (true) {
+      /* sleep override */
+      std::this_thread::sleep_for(std::chrono::seconds(60));
+    }
+  }
+
+  SocketAddress address("127.0.0.1", server.getAddress().getPort());
+  runClients(address);
+  return 0;
+}
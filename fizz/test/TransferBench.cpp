@@ -0,0 +1,400 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * In-process app data benchmark. An AsyncFizzClient and an AsyncFizzServer
+ * complete a handshake over a pair of LocalTransports, then each iteration
+ * writes one buffer of the given size in the given direction (or one each way)
+ * through writeChain() and runs both sides until the peer's read callback has
+ * received it. This covers what the record layer benchmarks leave out: the
+ * state machine, action visitors, deliverAppData() and read buffering.
+ *
+ * Read callbacks are either movable (data handed over in IOBufs) or not (data
+ * copied into the callback's buffer). Each runs on its own long lived
+ * connection. As in HandshakeBench, both sides have their own EventBase so
+ * their CPU time is measured separately. The table printed after the folly
+ * benchmark table shows goodput per CPU second of client and server combined,
+ * each side's CPU per MB, and heap allocations per KB.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/ssl/Init.h>
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/server/AsyncFizzServer.h>
+#include <fizz/server/CertManager.h>
+#include <fizz/test/BenchUtil.h>
+
+#include <cstdio>
+#include <map>
+#include <tuple>
+
+using namespace fizz;
+using namespace fizz::client;
+using namespace fizz::server;
+using namespace fizz::test;
+using namespace fizz::test::bench;
+using namespace folly;
+
+namespace {
+
+// Data written per side before running the loops, so that writes queue up
+// the way they do on a busy connection.
+constexpr size_t kBatchBytes = 1024 * 1024;
+
+// Buffer offered by non-movable read callbacks.
+constexpr size_t kReadBufferSize = 16 * 1024;
+
+enum class Direction {
+  ClientToServer,
+  ServerToClient,
+  Both,
+};
+
+struct Config {
+  Direction direction;
+  size_t writeSize;
+  bool movable;
+
+  bool operator<(const Config& other) const {
+    return std::tie(direction, writeSize, movable) <
+        std::tie(other.direction, other.writeSize, other.movable);
+  }
+};
+
+std::string toString(const Config& config) {
+  std::string direction;
+  switch (config.direction) {
+    case Direction::ClientToServer:
+      direction = "c2s";
+      break;
+    case Direction::ServerToClient:
+      direction = "s2c";
+      break;
+    case Direction::Both:
+      direction = "both";
+      break;
+  }
+  return folly::to<std::string>(
+      direction, " ", config.writeSize, config.movable ? " movable" : " copy");
+}
+
+/**
+ * App bytes received, CPU time and allocations accumulated over the measured
+ * iterations of a configuration.
+ */
+struct Measurements {
+  uint64_t bytes{0};
+  std::chrono::nanoseconds clientCpu{0};
+  std::chrono::nanoseconds serverCpu{0};
+  uint64_t allocations{0};
+};
+
+std::map<Config, Measurements>& measurements() {
+  static std::map<Config, Measurements> results;
+  return results;
+}
+
+std::unique_ptr<IOBuf> makeBuf(size_t n) {
+  auto buf = IOBuf::create(n);
+  memset(buf->writableData(), 'x', n);
+  buf->append(n);
+  return buf;
+}
+
+/**
+ * Read callback that counts and discards what it receives.
+ */
+class CountingReader : public AsyncTransportWrapper::ReadCallback {
+ public:
+  explicit CountingReader(bool movable)
+      : movable_(movable), buf_(movable ? 0 : kReadBufferSize) {}
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_.data();
+    *lenReturn = buf_.size();
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    received += len;
+  }
+
+  bool isBufferMovable() noexcept override {
+    return movable_;
+  }
+
+  void readBufferAvailable(std::unique_ptr<IOBuf> data) noexcept override {
+    received += data->computeChainDataLength();
+  }
+
+  void readEOF() noexcept override {}
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << "Read error: " << ex.what();
+  }
+
+  uint64_t received{0};
+
+ private:
+  bool movable_;
+  std::vector<uint8_t> buf_;
+};
+
+class ClientCallback : public AsyncFizzClient::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(AsyncFizzClient*) noexcept override {
+    done = true;
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzClient*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "Client handshake error: " << ex.what();
+  }
+
+  bool done{false};
+};
+
+class ServerCallback : public AsyncFizzServer::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(AsyncFizzServer*) noexcept override {
+    done = true;
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "Server handshake error: " << ex.what();
+  }
+
+  void fizzHandshakeAttemptFallback(std::unique_ptr<IOBuf>) override {
+    LOG(FATAL) << "Unexpected fallback";
+  }
+
+  bool done{false};
+};
+
+/**
+ * An established connection whose read callbacks are movable or not.
+ */
+class Connection {
+ public:
+  explicit Connection(bool movable)
+      : clientRead_(movable), serverRead_(movable) {
+    auto clientContext = std::make_shared<FizzClientContext>();
+    auto serverContext = std::make_shared<FizzServerContext>();
+    auto certManager = std::make_unique<CertManager>();
+    std::vector<ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kP256Certificate));
+    certManager->addCert(
+        std::make_shared<SelfCertImpl<KeyType::P256>>(
+            getPrivateKey(kP256Key), std::move(certs)),
+        true);
+    serverContext->setCertManager(std::move(certManager));
+
+    auto clientTransport = new QueuedTransport(&pending_);
+    auto serverTransport = new QueuedTransport(&pending_);
+    clientTransport->attachEventBase(&clientEvb_);
+    serverTransport->attachEventBase(&serverEvb_);
+    clientTransport->setPeer(serverTransport);
+    serverTransport->setPeer(clientTransport);
+    client_.reset(new AsyncFizzClient(
+        LocalTransport::UniquePtr(clientTransport), clientContext));
+    server_.reset(new AsyncFizzServer(
+        LocalTransport::UniquePtr(serverTransport), serverContext));
+
+    ClientCallback clientCallback;
+    ServerCallback serverCallback;
+    client_->connect(
+        &clientCallback, nullptr, folly::none, std::string("Fizz"));
+    server_->accept(&serverCallback);
+    while (!clientCallback.done || !serverCallback.done || pending_ > 0) {
+      clientEvb_.loopOnce(EVLOOP_NONBLOCK);
+      serverEvb_.loopOnce(EVLOOP_NONBLOCK);
+    }
+
+    client_->setReadCB(&clientRead_);
+    server_->setReadCB(&serverRead_);
+  }
+
+  ~Connection() {
+    client_.reset();
+    server_.reset();
+    while (pending_ > 0) {
+      clientEvb_.loopOnce(EVLOOP_NONBLOCK);
+      serverEvb_.loopOnce(EVLOOP_NONBLOCK);
+    }
+  }
+
+  void transfer(const Config& config, size_t writes, Measurements& results) {
+    bool clientSends = config.direction != Direction::ServerToClient;
+    bool serverSends = config.direction != Direction::ClientToServer;
+    auto batchSize = std::max<size_t>(1, kBatchBytes / config.writeSize);
+
+    while (writes > 0) {
+      auto count = std::min(writes, batchSize);
+      writes -= count;
+
+      std::vector<std::unique_ptr<IOBuf>> clientBufs;
+      std::vector<std::unique_ptr<IOBuf>> serverBufs;
+      BENCHMARK_SUSPEND {
+        for (size_t i = 0; i < count; ++i) {
+          if (clientSends) {
+            clientBufs.push_back(makeBuf(config.writeSize));
+          }
+          if (serverSends) {
+            serverBufs.push_back(makeBuf(config.writeSize));
+          }
+        }
+      }
+
+      auto startAllocations = bench::allocations();
+      auto batchBytes = count * config.writeSize;
+      auto serverTarget = serverRead_.received + (clientSends ? batchBytes : 0);
+      auto clientTarget = clientRead_.received + (serverSends ? batchBytes : 0);
+
+      timeSide(results.clientCpu, [&] {
+        for (auto& buf : clientBufs) {
+          client_->writeChain(nullptr, std::move(buf));
+        }
+      });
+      timeSide(results.serverCpu, [&] {
+        for (auto& buf : serverBufs) {
+          server_->writeChain(nullptr, std::move(buf));
+        }
+      });
+      while (pending_ > 0 || clientRead_.received < clientTarget ||
+             serverRead_.received < serverTarget) {
+        timeSide(
+            results.clientCpu, [&] { clientEvb_.loopOnce(EVLOOP_NONBLOCK); });
+        timeSide(
+            results.serverCpu, [&] { serverEvb_.loopOnce(EVLOOP_NONBLOCK); });
+      }
+
+      results.bytes += (clientSends + serverSends) * batchBytes;
+      results.allocations += bench::allocations() - startAllocations;
+    }
+  }
+
+ private:
+  size_t pending_{0};
+  EventBase clientEvb_;
+  EventBase serverEvb_;
+  CountingReader clientRead_;
+  CountingReader serverRead_;
+  AsyncFizzClient::UniquePtr client_;
+  AsyncFizzServer::UniquePtr server_;
+};
+
+Connection& getConnection(bool movable) {
+  static std::map<bool, std::unique_ptr<Connection>> connections;
+  auto& connection = connections[movable];
+  if (!connection) {
+    connection = std::make_unique<Connection>(movable);
+  }
+  return *connection;
+}
+
+void transfer(
+    uint32_t iters,
+    Direction direction,
+    size_t writeSize,
+    bool movable) {
+  Connection* connection;
+  BENCHMARK_SUSPEND {
+    connection = &getConnection(movable);
+  }
+  Config config{direction, writeSize, movable};
+  connection->transfer(config, iters, measurements()[config]);
+}
+
+void clientToServer(uint32_t iters, size_t writeSize, bool movable) {
+  transfer(iters, Direction::ClientToServer, writeSize, movable);
+}
+
+void serverToClient(uint32_t iters, size_t writeSize, bool movable) {
+  transfer(iters, Direction::ServerToClient, writeSize, movable);
+}
+
+void bothWays(uint32_t iters, size_t writeSize, bool movable) {
+  transfer(iters, Direction::Both, writeSize, movable);
+}
+
+void printMeasurements() {
+  printf(
+      "%-22s %12s %12s %14s %14s %12s\n",
+      "transfer",
+      "MB",
+      "MB/s/core",
+      "client us/MB",
+      "server us/MB",
+      "allocs/KB");
+  for (const auto& entry : measurements()) {
+    const auto& results = entry.second;
+    if (results.bytes == 0) {
+      continue;
+    }
+    auto mb = results.bytes / (1024.0 * 1024.0);
+    auto clientUs = results.clientCpu.count() / 1000.0 / mb;
+    auto serverUs = results.serverCpu.count() / 1000.0 / mb;
+    auto perCore = 1000000.0 / (clientUs + serverUs);
+    printf(
+        "%-22s %12.1f %12.1f %14.1f %14.1f ",
+        toString(entry.first).c_str(),
+        mb,
+        perCore,
+        clientUs,
+        serverUs);
+    if (FIZZ_BENCH_HAS_ALLOCATIONS) {
+      printf("%12.3f\n", results.allocations / (mb * 1024.0));
+    } else {
+      printf("%12s\n", "n/a");
+    }
+  }
+}
+} // namespace
+
+BENCHMARK_NAMED_PARAM(clientToServer, 64, 64, true);
+BENCHMARK_NAMED_PARAM(clientToServer, 1k, 1024, true);
+BENCHMARK_NAMED_PARAM(clientToServer, 16k, 16384, true);
+BENCHMARK_NAMED_PARAM(clientToServer, 64k, 65536, true);
+BENCHMARK_NAMED_PARAM(serverToClient, 64, 64, true);
+BENCHMARK_NAMED_PARAM(serverToClient, 1k, 1024, true);
+BENCHMARK_NAMED_PARAM(serverToClient, 16k, 16384, true);
+BENCHMARK_NAMED_PARAM(serverToClient, 64k, 65536, true);
+BENCHMARK_NAMED_PARAM(bothWays, 64, 64, true);
+BENCHMARK_NAMED_PARAM(bothWays, 1k, 1024, true);
+BENCHMARK_NAMED_PARAM(bothWays, 16k, 16384, true);
+BENCHMARK_NAMED_PARAM(bothWays, 64k, 65536, true);
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(clientToServer, 64_copy, 64, false);
+BENCHMARK_NAMED_PARAM(clientToServer, 1k_copy, 1024, false);
+BENCHMARK_NAMED_PARAM(clientToServer, 16k_copy, 16384, false);
+BENCHMARK_NAMED_PARAM(clientToServer, 64k_copy, 65536, false);
+BENCHMARK_NAMED_PARAM(serverToClient, 64_copy, 64, false);
+BENCHMARK_NAMED_PARAM(serverToClient, 1k_copy, 1024, false);
+BENCHMARK_NAMED_PARAM(serverToClient, 16k_copy, 16384, false);
+BENCHMARK_NAMED_PARAM(serverToClient, 64k_copy, 65536, false);
+BENCHMARK_NAMED_PARAM(bothWays, 64_copy, 64, false);
+BENCHMARK_NAMED_PARAM(bothWays, 1k_copy, 1024, false);
+BENCHMARK_NAMED_PARAM(bothWays, 16k_copy, 16384, false);
+BENCHMARK_NAMED_PARAM(bothWays, 64k_copy, 65536, false);
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::ssl::init();
+  folly::runBenchmarks();
+  printMeasurements();
+  return 0;
+}